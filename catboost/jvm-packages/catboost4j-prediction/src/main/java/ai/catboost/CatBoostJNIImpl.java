@@ -2,6 +2,9 @@ package ai.catboost;
 
 import javax.annotation.Nullable;
 import javax.validation.constraints.NotNull;
+import java.nio.DoubleBuffer;
+import java.nio.FloatBuffer;
+import java.nio.IntBuffer;
 
 class CatBoostJNIImpl {
     final static void checkCall(@Nullable String message) throws CatBoostError {
@@ -80,4 +83,15 @@ class CatBoostJNIImpl {
             @Nullable float[][] numericFeatures,
             @Nullable int[][] catFeatureHashes,
             @NotNull double[] predictions);
+
+    @Nullable
+    final static native String catBoostModelPredictDirect(
+            long handle,
+            @Nullable FloatBuffer numericFeatures,
+            int numericFeatureCount,
+            @Nullable IntBuffer catFeatureHashes,
+            int catFeatureCount,
+            int documentCount,
+            int threadCount,
+            @NotNull DoubleBuffer predictions);
 }
\ No newline at end of file
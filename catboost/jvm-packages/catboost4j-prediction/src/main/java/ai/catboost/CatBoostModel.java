@@ -5,6 +5,11 @@ import javax.validation.constraints.NotNull;
 import java.io.ByteArrayOutputStream;
 import java.io.IOException;
 import java.io.InputStream;
+import java.nio.Buffer;
+import java.nio.ByteOrder;
+import java.nio.DoubleBuffer;
+import java.nio.FloatBuffer;
+import java.nio.IntBuffer;
 
 /**
  * CatBoost model, supports basic model application.
@@ -333,6 +338,57 @@ public class CatBoostModel implements AutoCloseable {
         return prediction;
     }
 
+    /**
+     * Apply model to a batch of objects stored in direct buffers, objects are evaluated in parallel and features are
+     * not copied. Buffers are read and written starting from their current positions, their byte order must be
+     * native (see {@link ByteOrder#nativeOrder()}).
+     *
+     * @param numericFeatures     Row-major numeric features matrix of size documentCount * numericFeatureCount.
+     * @param numericFeatureCount Numeric feature count of each object.
+     * @param catFeatureHashes    Row-major matrix of categoric feature hashes computed by
+     *                            {@link #hashCategoricalFeature(String)} of size documentCount * catFeatureCount.
+     * @param catFeatureCount     Categoric feature count of each object.
+     * @param documentCount       Object count.
+     * @param threadCount         Number of threads to use.
+     * @param predictions         Model predictions of size documentCount * {@link #getPredictionDimension()}.
+     * @throws CatBoostError In case of error within native library.
+     */
+    public void predict(
+            final @Nullable FloatBuffer numericFeatures,
+            final int numericFeatureCount,
+            final @Nullable IntBuffer catFeatureHashes,
+            final int catFeatureCount,
+            final int documentCount,
+            final int threadCount,
+            final @NotNull DoubleBuffer predictions) throws CatBoostError {
+        checkDirectBuffer(numericFeatures, numericFeatures == null || numericFeatures.order() == ByteOrder.nativeOrder());
+        checkDirectBuffer(catFeatureHashes, catFeatureHashes == null || catFeatureHashes.order() == ByteOrder.nativeOrder());
+        checkDirectBuffer(predictions, predictions.order() == ByteOrder.nativeOrder());
+        NativeLib.handle().catBoostModelPredictDirect(
+                handle,
+                numericFeatures == null ? null : numericFeatures.slice(),
+                numericFeatureCount,
+                catFeatureHashes == null ? null : catFeatureHashes.slice(),
+                catFeatureCount,
+                documentCount,
+                threadCount,
+                predictions.slice());
+    }
+
+    private static void checkDirectBuffer(
+            final @Nullable Buffer buffer,
+            final boolean hasNativeOrder) throws CatBoostError {
+        if (buffer == null) {
+            return;
+        }
+        if (!buffer.isDirect()) {
+            throw new CatBoostError("buffer is not direct");
+        }
+        if (!hasNativeOrder) {
+            throw new CatBoostError("buffer byte order is not native");
+        }
+    }
+
     @Override
     protected void finalize() throws Throwable {
         try {
@@ -2,12 +2,18 @@
 
 #include <catboost/libs/cat_feature/cat_feature.h>
 #include <catboost/libs/helpers/exception.h>
+#include <catboost/libs/model/formula_evaluator.h>
 #include <catboost/libs/model/model.h>
 
+#include <library/threading/local_executor/local_executor.h>
+
 #include <util/generic/scope.h>
 #include <util/generic/singleton.h>
 #include <util/generic/string.h>
+#include <util/generic/ymath.h>
 #include <util/stream/labeled.h>
+#include <util/system/guard.h>
+#include <util/system/mutex.h>
 #include <util/system/platform.h>
 
 #include <exception>
@@ -617,5 +623,122 @@ JNIEXPORT jstring JNICALL Java_ai_catboost_CatBoostJNIImpl_catBoostModelPredict_
     Y_END_JNI_API_CALL();
 }
 
+template <typename T>
+static TArrayRef<T> GetDirectBufferData(JNIEnv* const jenv, const jobject buffer) {
+    if (jenv->IsSameObject(buffer, NULL) == JNI_TRUE) {
+        return {};
+    }
+
+    auto* const data = jenv->GetDirectBufferAddress(buffer);
+    CB_ENSURE(data, "buffer is not direct or JVM doesn't support access to direct buffers");
+    const jlong capacity = jenv->GetDirectBufferCapacity(buffer);
+    CB_ENSURE(capacity >= 0, "failed to get direct buffer capacity");
+    return MakeArrayRef(static_cast<T*>(data), capacity);
+}
+
+// Executor is shared by all calling threads and only grows to the largest requested thread count,
+// so worker threads are neither created on every call nor kept for every calling thread
+static NPar::TLocalExecutor& GetLocalExecutor(const int threadCount) {
+    static TMutex lock;
+    auto& localExecutor = NPar::LocalExecutor();
+    with_lock (lock) {
+        const int missingThreadCount = threadCount - 1 - localExecutor.GetThreadCount();
+        if (missingThreadCount > 0) {
+            localExecutor.RunAdditionalThreads(missingThreadCount);
+        }
+    }
+    return localExecutor;
+}
+
+JNIEXPORT jstring JNICALL Java_ai_catboost_CatBoostJNIImpl_catBoostModelPredictDirect
+  (JNIEnv* jenv, jclass, jlong jhandle, jobject jnumericFeatures, jint jnumericFeatureCount, jobject jcatFeatureHashes, jint jcatFeatureCount, jint jdocumentCount, jint jthreadCount, jobject jpredictions) {
+    Y_BEGIN_JNI_API_CALL();
+
+    const auto* const model = ToConstFullModelPtr(jhandle);
+    CB_ENSURE(model, "got nullptr model pointer");
+    const size_t modelPredictionSize = model->ObliviousTrees.ApproxDimension;
+    const size_t minNumericFeatureCount = model->GetNumFloatFeatures();
+    const size_t minCatFeatureCount = model->GetNumCatFeatures();
+
+    CB_ENSURE(
+        jnumericFeatureCount >= 0 && jcatFeatureCount >= 0 && jdocumentCount >= 0,
+        "negative size: " LabeledOutput(jnumericFeatureCount, jcatFeatureCount, jdocumentCount));
+    CB_ENSURE(jthreadCount > 0, "thread count must be positive: " LabeledOutput(jthreadCount));
+    const size_t numericFeatureCount = jnumericFeatureCount;
+    const size_t catFeatureCount = jcatFeatureCount;
+    const size_t documentCount = jdocumentCount;
+
+    CB_ENSURE(
+        numericFeatureCount >= minNumericFeatureCount,
+        LabeledOutput(numericFeatureCount, minNumericFeatureCount));
+
+    CB_ENSURE(
+        catFeatureCount >= minCatFeatureCount,
+        LabeledOutput(catFeatureCount, minCatFeatureCount));
+
+    const TConstArrayRef<float> numericFeatures = GetDirectBufferData<const float>(jenv, jnumericFeatures);
+    const TConstArrayRef<int> catFeatures = GetDirectBufferData<const int>(jenv, jcatFeatureHashes);
+    const TArrayRef<double> predictions = GetDirectBufferData<double>(jenv, jpredictions);
+
+    CB_ENSURE(
+        numericFeatures.size() >= documentCount * numericFeatureCount,
+        "`numericFeatures` size is insufficient, must be at least document count * numeric feature count: "
+        LabeledOutput(numericFeatures.size(), documentCount * numericFeatureCount));
+    CB_ENSURE(
+        catFeatures.size() >= documentCount * catFeatureCount,
+        "`catFeatureHashes` size is insufficient, must be at least document count * categoric feature count: "
+        LabeledOutput(catFeatures.size(), documentCount * catFeatureCount));
+    CB_ENSURE(
+        predictions.size() >= documentCount * modelPredictionSize,
+        "`prediction` size is insufficient, must be at least document count * model prediction dimension: "
+        LabeledOutput(predictions.size(), documentCount * modelPredictionSize));
+
+    if (documentCount == 0) {
+        return nullptr;
+    }
+
+    // rows are references to the buffers, so features are not copied
+    const auto calcPart = [&] (size_t begin, size_t end) {
+        TVector<TConstArrayRef<float>> numericFeatureRows;
+        TVector<TConstArrayRef<int>> catFeatureRows;
+        if (numericFeatureCount) {
+            numericFeatureRows.reserve(end - begin);
+            for (size_t i = begin; i < end; ++i) {
+                numericFeatureRows.push_back(numericFeatures.Slice(i * numericFeatureCount, numericFeatureCount));
+            }
+        }
+        if (catFeatureCount) {
+            catFeatureRows.reserve(end - begin);
+            for (size_t i = begin; i < end; ++i) {
+                catFeatureRows.push_back(catFeatures.Slice(i * catFeatureCount, catFeatureCount));
+            }
+        }
+        model->Calc(
+            numericFeatureRows,
+            catFeatureRows,
+            predictions.Slice(begin * modelPredictionSize, (end - begin) * modelPredictionSize));
+    };
+
+    const size_t threadCount = jthreadCount;
+    if (threadCount == 1 || documentCount <= FORMULA_EVALUATION_BLOCK_SIZE) {
+        calcPart(0, documentCount);
+        return nullptr;
+    }
+
+    // one part per thread, part sizes are multiples of evaluation block size
+    const size_t partSize = CeilDiv(CeilDiv(documentCount, threadCount), FORMULA_EVALUATION_BLOCK_SIZE) * FORMULA_EVALUATION_BLOCK_SIZE;
+    const size_t partCount = CeilDiv(documentCount, partSize);
+    GetLocalExecutor(threadCount).ExecRangeWithThrow(
+        [&] (int partIdx) {
+            const size_t begin = partIdx * partSize;
+            calcPart(begin, Min(begin + partSize, documentCount));
+        },
+        0,
+        partCount,
+        NPar::TLocalExecutor::WAIT_COMPLETE);
+
+    Y_END_JNI_API_CALL();
+}
+
 #undef Y_BEGIN_JNI_API_CALL
 #undef Y_END_JNI_API_CALL
@@ -113,6 +113,14 @@ JNIEXPORT jstring JNICALL Java_ai_catboost_CatBoostJNIImpl_catBoostModelPredict_
 JNIEXPORT jstring JNICALL Java_ai_catboost_CatBoostJNIImpl_catBoostModelPredict__J_3_3F_3_3I_3D
   (JNIEnv *, jclass, jlong, jobjectArray, jobjectArray, jdoubleArray);
 
+/*
+ * Class:     ai_catboost_CatBoostJNIImpl
+ * Method:    catBoostModelPredictDirect
+ * Signature: (JLjava/nio/FloatBuffer;ILjava/nio/IntBuffer;IIILjava/nio/DoubleBuffer;)Ljava/lang/String;
+ */
+JNIEXPORT jstring JNICALL Java_ai_catboost_CatBoostJNIImpl_catBoostModelPredictDirect
+  (JNIEnv *, jclass, jlong, jobject, jint, jobject, jint, jint, jint, jobject);
+
 #ifdef __cplusplus
 }
 #endif
@@ -6,6 +6,11 @@ import org.junit.Test;
 
 import javax.validation.constraints.NotNull;
 import java.io.*;
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.nio.DoubleBuffer;
+import java.nio.FloatBuffer;
+import java.nio.IntBuffer;
 
 import static org.junit.Assert.fail;
 
@@ -729,6 +734,168 @@ public class CatBoostModelTest {
         }
     }
 
+    @Test
+    public void testSuccessfulPredictMultipleDirectBuffers() throws CatBoostError {
+        try(final CatBoostModel model = loadTestModel()) {
+            final float[] numericFeatures = new float[]{
+                    0.5f, 1.5f,
+                    0.7f, 6.4f,
+                    -2.0f, -1.0f};
+            final int[] catFeatures = new int[]{
+                    -805065478, 2136526169, 785836961,
+                    1982436109, 1400211492, 1076941191,
+                    -1883343840, -1452597217, 2122455585};
+            final double[] expected = new double[]{
+                    0.04666924366060905,
+                    0.026244613740247648,
+                    0.03094452158737013};
+
+            final FloatBuffer numericFeaturesBuffer = ByteBuffer.allocateDirect(numericFeatures.length * 4)
+                    .order(ByteOrder.nativeOrder())
+                    .asFloatBuffer();
+            numericFeaturesBuffer.put(numericFeatures).rewind();
+            final IntBuffer catFeaturesBuffer = ByteBuffer.allocateDirect(catFeatures.length * 4)
+                    .order(ByteOrder.nativeOrder())
+                    .asIntBuffer();
+            catFeaturesBuffer.put(catFeatures).rewind();
+
+            for (int threadCount : new int[]{1, 4}) {
+                final DoubleBuffer predictionsBuffer = ByteBuffer.allocateDirect(expected.length * 8)
+                        .order(ByteOrder.nativeOrder())
+                        .asDoubleBuffer();
+                model.predict(numericFeaturesBuffer, 2, catFeaturesBuffer, 3, 3, threadCount, predictionsBuffer);
+                final double[] predictions = new double[expected.length];
+                predictionsBuffer.get(predictions);
+                assertEqual(new CatBoostPredictions(3, 1, expected), new CatBoostPredictions(3, 1, predictions));
+            }
+        }
+    }
+
+    // documents are evaluated in parallel only if there are several evaluation blocks of 128 documents
+    static final int MANY_DOCUMENTS_COUNT = 1000;
+
+    // buffers are used starting from non-zero positions, data before them must not be read or overwritten
+    static final int BUFFER_POSITION = 7;
+
+    static void checkPredictManyDirectBuffers(
+            final @NotNull CatBoostModel model,
+            final int numericFeatureCount,
+            final int catFeatureCount,
+            final int threadCount,
+            final long seed) throws CatBoostError {
+        final int predictionDimension = model.getPredictionDimension();
+
+        final java.util.Random random = new java.util.Random(seed);
+        final float[][] numericFeatures = new float[MANY_DOCUMENTS_COUNT][numericFeatureCount];
+        final int[][] catFeatureHashes = new int[MANY_DOCUMENTS_COUNT][catFeatureCount];
+        for (int documentIndex = 0; documentIndex < MANY_DOCUMENTS_COUNT; ++documentIndex) {
+            for (int featureIndex = 0; featureIndex < numericFeatureCount; ++featureIndex) {
+                numericFeatures[documentIndex][featureIndex] = (float) (random.nextGaussian() * 5.0);
+            }
+            for (int featureIndex = 0; featureIndex < catFeatureCount; ++featureIndex) {
+                catFeatureHashes[documentIndex][featureIndex] = CatBoostModel.hashCategoricalFeature(
+                        String.valueOf(random.nextInt(10)));
+            }
+        }
+        final CatBoostPredictions expected = model.predict(numericFeatures, catFeatureHashes);
+
+        final FloatBuffer numericFeaturesBuffer = ByteBuffer
+                .allocateDirect((BUFFER_POSITION + MANY_DOCUMENTS_COUNT * numericFeatureCount) * 4)
+                .order(ByteOrder.nativeOrder())
+                .asFloatBuffer();
+        numericFeaturesBuffer.position(BUFFER_POSITION);
+        for (float[] row : numericFeatures) {
+            numericFeaturesBuffer.put(row);
+        }
+        numericFeaturesBuffer.position(BUFFER_POSITION);
+
+        final IntBuffer catFeaturesBuffer = ByteBuffer
+                .allocateDirect((BUFFER_POSITION + MANY_DOCUMENTS_COUNT * catFeatureCount) * 4)
+                .order(ByteOrder.nativeOrder())
+                .asIntBuffer();
+        catFeaturesBuffer.position(BUFFER_POSITION);
+        for (int[] row : catFeatureHashes) {
+            catFeaturesBuffer.put(row);
+        }
+        catFeaturesBuffer.position(BUFFER_POSITION);
+
+        final DoubleBuffer predictionsBuffer = ByteBuffer
+                .allocateDirect((BUFFER_POSITION + MANY_DOCUMENTS_COUNT * predictionDimension) * 8)
+                .order(ByteOrder.nativeOrder())
+                .asDoubleBuffer();
+        for (int i = 0; i < BUFFER_POSITION; ++i) {
+            predictionsBuffer.put(i, -1.0);
+        }
+        predictionsBuffer.position(BUFFER_POSITION);
+
+        model.predict(
+                numericFeaturesBuffer, numericFeatureCount,
+                catFeaturesBuffer, catFeatureCount,
+                MANY_DOCUMENTS_COUNT, threadCount,
+                predictionsBuffer);
+
+        for (int i = 0; i < BUFFER_POSITION; ++i) {
+            TestCase.assertEquals(-1.0, predictionsBuffer.get(i));
+        }
+        final double[] predictions = new double[MANY_DOCUMENTS_COUNT * predictionDimension];
+        predictionsBuffer.get(predictions);
+        assertEqual(expected, new CatBoostPredictions(MANY_DOCUMENTS_COUNT, predictionDimension, predictions));
+    }
+
+    @Test
+    public void testSuccessfulPredictManyDirectBuffers() throws CatBoostError {
+        try(final CatBoostModel model = loadTestModel()) {
+            for (int threadCount : new int[]{1, 2, 3, 4, 8}) {
+                checkPredictManyDirectBuffers(model, 2, 3, threadCount, threadCount);
+            }
+        }
+    }
+
+    @Test
+    public void testSuccessfulPredictManyDirectBuffersFromSeveralThreads() throws Exception {
+        try(final CatBoostModel model = loadTestModel()) {
+            final Thread[] threads = new Thread[4];
+            final Throwable[] errors = new Throwable[threads.length];
+            for (int threadIndex = 0; threadIndex < threads.length; ++threadIndex) {
+                final int index = threadIndex;
+                threads[index] = new Thread(new Runnable() {
+                    @Override
+                    public void run() {
+                        try {
+                            for (int iteration = 0; iteration < 5; ++iteration) {
+                                checkPredictManyDirectBuffers(model, 2, 3, 2 + index, index * 5 + iteration);
+                            }
+                        } catch (Throwable e) {
+                            errors[index] = e;
+                        }
+                    }
+                });
+                threads[index].start();
+            }
+            for (int threadIndex = 0; threadIndex < threads.length; ++threadIndex) {
+                threads[threadIndex].join();
+                if (errors[threadIndex] != null) {
+                    throw new AssertionError("prediction failed in thread " + threadIndex, errors[threadIndex]);
+                }
+            }
+        }
+    }
+
+    @Test
+    public void testFailPredictMultipleNonDirectBuffers() throws CatBoostError {
+        try(final CatBoostModel model = loadNumericOnlyTestModel()) {
+            try {
+                model.predict(
+                        FloatBuffer.wrap(new float[]{0.5f, 1.5f, -2.5f}), 3,
+                        null, 0,
+                        1, 1,
+                        DoubleBuffer.wrap(new double[1]));
+                fail();
+            } catch (CatBoostError e) {
+            }
+        }
+    }
+
     @Test
     public void testFailPredictMultipleNullInNumericHashes() throws CatBoostError {
         try(final CatBoostModel model = loadTestModel()) {
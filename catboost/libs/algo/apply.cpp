@@ -5,17 +5,167 @@
 #include <catboost/libs/data_new/model_dataset_compatibility.h>
 #include <catboost/libs/eval_result/eval_helpers.h>
 #include <catboost/libs/helpers/exception.h>
+#include <catboost/libs/helpers/maybe_owning_array_holder.h>
 #include <catboost/libs/logging/logging.h>
 
 #include <util/generic/array_ref.h>
 #include <util/generic/cast.h>
 #include <util/generic/utility.h>
+#include <util/generic/xrange.h>
 
 #include <cmath>
 
 using namespace NCB;
 using NPar::TLocalExecutor;
 
+
+namespace {
+    /* Features of quantized pool in the form suitable for model evaluation without de-quantization:
+     * float features are kept as bins of the pool and model borders are remapped to these bins,
+     * categorical features are converted from perfect hashes back to hashes used by model.
+     */
+    struct TQuantizedPoolFeatures {
+        TVector<TVector<ui8>> FloatBinsRemap; // [model float feature position in ObliviousTrees.FloatFeatures]
+        TVector<TConstArrayRef<ui8>> FloatBins; // [model flat feature index]
+        TVector<TConstArrayRef<ui32>> CatHashes; // [model flat feature index]
+        TVector<TMaybeOwningArrayHolder<ui8>> FloatBinsHolders;
+        TVector<TVector<ui32>> CatHashesHolders;
+    };
+}
+
+
+// model borders must be a subset of quantized pool borders, otherwise bins of pool can't be mapped to model splits
+static TVector<ui8> BuildFloatBinsRemap(
+    const TFloatFeature& floatFeature,
+    const TQuantizedFeaturesInfo& quantizedFeaturesInfo,
+    const TFloatFeatureIdx poolFloatFeatureIdx)
+{
+    CB_ENSURE(
+        quantizedFeaturesInfo.HasBorders(poolFloatFeatureIdx),
+        "Feature " << floatFeature.FeatureId << " has no borders in quantized pool");
+    const auto& poolBorders = quantizedFeaturesInfo.GetBorders(poolFloatFeatureIdx);
+    const auto& modelBorders = floatFeature.Borders;
+
+    const ENanMode nanMode = quantizedFeaturesInfo.GetNanMode(poolFloatFeatureIdx);
+    const bool modelNansAsMin = !floatFeature.HasNans
+        || floatFeature.NanValueTreatment != NCatBoostFbs::ENanValueTreatment_AsTrue;
+    if (nanMode == ENanMode::Max) {
+        CB_ENSURE(
+            !modelNansAsMin,
+            "Feature " << floatFeature.FeatureId << ": nan_mode=Max of quantized pool is incompatible with model");
+    } else if (nanMode == ENanMode::Min || quantizedFeaturesInfo.GetFloatFeaturesAllowNansInTestOnly()) {
+        CB_ENSURE(
+            modelNansAsMin,
+            "Feature " << floatFeature.FeatureId << ": nan_mode of quantized pool is incompatible with model");
+    }
+
+    // bin b of pool contains values from (poolBorders[b - 1], poolBorders[b]]
+    TVector<ui32> modelBins(poolBorders.size() + 1);
+    size_t modelBorderIdx = 0;
+    for (auto poolBin : xrange(poolBorders.size() + 1)) {
+        modelBins[poolBin] = modelBorderIdx;
+        if (poolBin == poolBorders.size()) {
+            break;
+        }
+        for (; modelBorderIdx < modelBorders.size() && modelBorders[modelBorderIdx] <= poolBorders[poolBin]; ++modelBorderIdx) {
+            CB_ENSURE(
+                modelBorders[modelBorderIdx] == poolBorders[poolBin],
+                "Feature " << floatFeature.FeatureId << ": model border " << modelBorders[modelBorderIdx]
+                << " is not present in quantized pool borders");
+        }
+    }
+    CB_ENSURE(
+        modelBorderIdx == modelBorders.size(),
+        "Feature " << floatFeature.FeatureId << ": model border " << modelBorders[modelBorderIdx]
+        << " is not present in quantized pool borders");
+
+    const size_t bucketCount = (modelBorders.size() + MAX_VALUES_PER_BIN - 1) / MAX_VALUES_PER_BIN;
+    TVector<ui8> binsRemap(bucketCount * QUANTIZED_FLOAT_BINS_COUNT);
+    for (auto bucketIdx : xrange(bucketCount)) {
+        const ui32 bucketStart = bucketIdx * MAX_VALUES_PER_BIN;
+        for (auto bin : xrange(QUANTIZED_FLOAT_BINS_COUNT)) {
+            const ui32 modelBin = modelBins[Min(bin, poolBorders.size())];
+            binsRemap[bucketIdx * QUANTIZED_FLOAT_BINS_COUNT + bin]
+                = (ui8)Min(modelBin - Min(modelBin, bucketStart), MAX_VALUES_PER_BIN);
+        }
+    }
+    return binsRemap;
+}
+
+static TQuantizedPoolFeatures PrepareQuantizedPoolFeatures(
+    const TFullModel& model,
+    const TQuantizedObjectsDataProvider& objectsData,
+    const THashMap<ui32, ui32>& columnReorderMap,
+    TLocalExecutor* executor)
+{
+    const auto& featuresLayout = *objectsData.GetFeaturesLayout();
+    const auto& quantizedFeaturesInfo = *objectsData.GetQuantizedFeaturesInfo();
+    const auto getPoolFlatFeatureIdx = [&] (int modelFlatFeatureIdx) -> ui32 {
+        return columnReorderMap.empty() ? modelFlatFeatureIdx : columnReorderMap.at(modelFlatFeatureIdx);
+    };
+
+    // quantized CPU data with consecutive subset is used in place
+    const auto* cpuObjectsData = dynamic_cast<const TQuantizedForCPUObjectsDataProvider*>(&objectsData);
+    TMaybe<ui32> consecutiveSubsetBegin;
+    if (cpuObjectsData) {
+        consecutiveSubsetBegin = cpuObjectsData->GetFeaturesArraySubsetIndexing().GetConsecutiveSubsetBegin();
+    }
+    const ui32 docCount = objectsData.GetObjectCount();
+
+    TQuantizedPoolFeatures result;
+    const auto& floatFeatures = model.ObliviousTrees.FloatFeatures;
+    result.FloatBinsRemap.resize(floatFeatures.size());
+    result.FloatBins.resize(model.ObliviousTrees.GetFlatFeatureVectorExpectedSize());
+    result.CatHashes.resize(model.ObliviousTrees.GetFlatFeatureVectorExpectedSize());
+    for (auto i : xrange(floatFeatures.size())) {
+        const auto& floatFeature = floatFeatures[i];
+        if (!floatFeature.UsedInModel()) {
+            continue;
+        }
+        const auto poolFloatFeatureIdx = featuresLayout.GetInternalFeatureIdx<EFeatureType::Float>(
+            getPoolFlatFeatureIdx(floatFeature.FlatFeatureIndex));
+        const auto maybeFeatureData = objectsData.GetFloatFeature(*poolFloatFeatureIdx);
+        CB_ENSURE(maybeFeatureData, "Feature " << floatFeature.FeatureId << " is not available in quantized pool");
+        result.FloatBinsRemap[i] = BuildFloatBinsRemap(floatFeature, quantizedFeaturesInfo, poolFloatFeatureIdx);
+        // packed features have no consecutive bins to refer to
+        const ui8* floatFeatureRawSrcData
+            = consecutiveSubsetBegin ? cpuObjectsData->GetFloatFeatureRawSrcData(*poolFloatFeatureIdx) : nullptr;
+        if (floatFeatureRawSrcData) {
+            result.FloatBins[floatFeature.FlatFeatureIndex] = MakeArrayRef(
+                floatFeatureRawSrcData + *consecutiveSubsetBegin,
+                docCount);
+        } else {
+            result.FloatBinsHolders.push_back((*maybeFeatureData)->ExtractValues(executor));
+            result.FloatBins[floatFeature.FlatFeatureIndex] = *result.FloatBinsHolders.back();
+        }
+    }
+
+    if (model.GetUsedCatFeaturesCount() == 0) {
+        return result;
+    }
+    const auto perfectHashedToHashedCatValuesMap
+        = quantizedFeaturesInfo.CalcPerfectHashedToHashedCatValuesMap(executor);
+    for (const auto& catFeature : model.ObliviousTrees.CatFeatures) {
+        if (!catFeature.UsedInModel) {
+            continue;
+        }
+        const auto poolCatFeatureIdx = featuresLayout.GetInternalFeatureIdx<EFeatureType::Categorical>(
+            getPoolFlatFeatureIdx(catFeature.FlatFeatureIndex));
+        const auto maybeFeatureData = objectsData.GetCatFeature(*poolCatFeatureIdx);
+        CB_ENSURE(maybeFeatureData, "Feature " << catFeature.FeatureId << " is not available in quantized pool");
+        const auto perfectHashedValues = (*maybeFeatureData)->ExtractValues(executor);
+        const auto& hashedValues = perfectHashedToHashedCatValuesMap[*poolCatFeatureIdx];
+        TVector<ui32> catHashes;
+        catHashes.yresize(docCount);
+        for (auto docIdx : xrange(docCount)) {
+            catHashes[docIdx] = hashedValues[perfectHashedValues[docIdx]];
+        }
+        result.CatHashesHolders.push_back(std::move(catHashes));
+        result.CatHashes[catFeature.FlatFeatureIndex] = result.CatHashesHolders.back();
+    }
+    return result;
+}
+
 TVector<TVector<double>> ApplyModelMulti(
     const TFullModel& model,
     const TObjectsDataProvider& objectsData,
@@ -25,7 +175,8 @@ TVector<TVector<double>> ApplyModelMulti(
     TLocalExecutor* executor)
 {
     const auto* const rawObjectsData = dynamic_cast<const TRawObjectsDataProvider*>(&objectsData);
-    CB_ENSURE(rawObjectsData, "Not supported for quantized pools");
+    const auto* const quantizedObjectsData = dynamic_cast<const TQuantizedObjectsDataProvider*>(&objectsData);
+    CB_ENSURE(rawObjectsData || quantizedObjectsData, "Unsupported objects data provider type");
 
     end = end == 0 ? model.GetTreeCount() : Min<int>(end, model.GetTreeCount());
     const int executorThreadCount = executor ? executor->GetThreadCount() : 0;
@@ -38,7 +189,6 @@ TVector<TVector<double>> ApplyModelMulti(
     TVector<double> approxesFlat;
     approxesFlat.yresize(docCount * approxesDimension);
     if (docCount > 0) {
-        const ui32 consecutiveSubsetBegin = GetConsecutiveSubsetBegin(*rawObjectsData);
         const int threadCount = executorThreadCount + 1; // one for current thread
         const int minBlockSize = ceil(10000.0 / sqrt(end - begin + 1)); // for 1 iteration it will be 7k docs, for 10k iterations it will be 100 docs.
         const int effectiveBlockCount = Min(threadCount, (docCount + minBlockSize - 1) / minBlockSize);
@@ -46,36 +196,67 @@ TVector<TVector<double>> ApplyModelMulti(
         TLocalExecutor::TExecRangeParams blockParams(0, docCount);
         blockParams.SetBlockCount(effectiveBlockCount);
 
-        const auto featuresLayout = rawObjectsData->GetFeaturesLayout();
-        const auto getFeatureDataPtr = [&](ui32 flatFeatureIdx) -> const float* {
-            return GetRawFeatureDataBeginPtr(
-                *rawObjectsData,
-                *featuresLayout,
-                consecutiveSubsetBegin,
-                flatFeatureIdx);
-        };
-        const auto applyOnBlock = [&](int blockId) {
-            TVector<TConstArrayRef<float>> repackedFeatures(model.ObliviousTrees.GetFlatFeatureVectorExpectedSize());
-            const int blockFirstIdx = blockParams.FirstId + blockId * blockParams.GetBlockSize();
-            const int blockLastIdx = Min(blockParams.LastId, blockFirstIdx + blockParams.GetBlockSize());
-            const int blockSize = blockLastIdx - blockFirstIdx;
-            if (columnReorderMap.empty()) {
-                for (size_t i = 0; i < model.ObliviousTrees.GetFlatFeatureVectorExpectedSize(); ++i) {
-                    repackedFeatures[i] = MakeArrayRef(getFeatureDataPtr(i) + blockFirstIdx, blockSize);
+        std::function<void(int)> applyOnBlock;
+        TQuantizedPoolFeatures quantizedPoolFeatures;
+        if (rawObjectsData) {
+            applyOnBlock = [&, consecutiveSubsetBegin = GetConsecutiveSubsetBegin(*rawObjectsData)](int blockId) {
+                const auto& featuresLayout = *rawObjectsData->GetFeaturesLayout();
+                const auto getFeatureDataPtr = [&](ui32 flatFeatureIdx) -> const float* {
+                    return GetRawFeatureDataBeginPtr(
+                        *rawObjectsData,
+                        featuresLayout,
+                        consecutiveSubsetBegin,
+                        flatFeatureIdx);
+                };
+                TVector<TConstArrayRef<float>> repackedFeatures(model.ObliviousTrees.GetFlatFeatureVectorExpectedSize());
+                const int blockFirstIdx = blockParams.FirstId + blockId * blockParams.GetBlockSize();
+                const int blockLastIdx = Min(blockParams.LastId, blockFirstIdx + blockParams.GetBlockSize());
+                const int blockSize = blockLastIdx - blockFirstIdx;
+                if (columnReorderMap.empty()) {
+                    for (size_t i = 0; i < model.ObliviousTrees.GetFlatFeatureVectorExpectedSize(); ++i) {
+                        repackedFeatures[i] = MakeArrayRef(getFeatureDataPtr(i) + blockFirstIdx, blockSize);
+                    }
+                } else {
+                    for (const auto& [origIdx, sourceIdx] : columnReorderMap) {
+                        repackedFeatures[origIdx] = MakeArrayRef(getFeatureDataPtr(sourceIdx) + blockFirstIdx, blockSize);
+                    }
                 }
+                model.CalcFlatTransposed(
+                    repackedFeatures,
+                    begin,
+                    end,
+                    MakeArrayRef(
+                        approxesFlat.data() + blockFirstIdx * approxesDimension,
+                        blockSize * approxesDimension));
+            };
+        } else {
+            if (executor) {
+                quantizedPoolFeatures = PrepareQuantizedPoolFeatures(model, *quantizedObjectsData, columnReorderMap, executor);
             } else {
-                for (const auto& [origIdx, sourceIdx] : columnReorderMap) {
-                    repackedFeatures[origIdx] = MakeArrayRef(getFeatureDataPtr(sourceIdx) + blockFirstIdx, blockSize);
-                }
+                TLocalExecutor localExecutor;
+                quantizedPoolFeatures = PrepareQuantizedPoolFeatures(model, *quantizedObjectsData, columnReorderMap, &localExecutor);
             }
-            model.CalcFlatTransposed(
-                repackedFeatures,
-                begin,
-                end,
-                MakeArrayRef(
-                    approxesFlat.data() + blockFirstIdx * approxesDimension,
-                    blockSize * approxesDimension));
-        };
+            applyOnBlock = [&](int blockId) {
+                const int blockFirstIdx = blockParams.FirstId + blockId * blockParams.GetBlockSize();
+                const int blockLastIdx = Min(blockParams.LastId, blockFirstIdx + blockParams.GetBlockSize());
+                const int blockSize = blockLastIdx - blockFirstIdx;
+                CalcGenericQuantized(
+                    model,
+                    quantizedPoolFeatures.FloatBinsRemap,
+                    [&](const TFloatFeature& floatFeature, size_t index) -> ui8 {
+                        return quantizedPoolFeatures.FloatBins[floatFeature.FlatFeatureIndex][blockFirstIdx + index];
+                    },
+                    [&](const TCatFeature& catFeature, size_t index) -> ui32 {
+                        return quantizedPoolFeatures.CatHashes[catFeature.FlatFeatureIndex][blockFirstIdx + index];
+                    },
+                    blockSize,
+                    begin,
+                    end,
+                    MakeArrayRef(
+                        approxesFlat.data() + blockFirstIdx * approxesDimension,
+                        blockSize * approxesDimension));
+            };
+        }
         if (executor) {
             executor->ExecRange(applyOnBlock, 0, blockParams.GetBlockCount(), TLocalExecutor::WAIT_COMPLETE);
         } else {
@@ -147,7 +328,7 @@ void TModelCalcerOnPool::ApplyModelMulti(
     TVector<double>* flatApproxBuffer,
     TVector<TVector<double>>* approx)
 {
-    const ui32 docCount = RawObjectsData->GetObjectCount();
+    const ui32 docCount = ObjectsData->GetObjectCount();
     auto approxDimension = SafeIntegerCast<ui32>(Model->ObliviousTrees.ApproxDimension);
     TVector<double>& approxFlat = *flatApproxBuffer;
     approxFlat.resize(static_cast<unsigned long>(docCount * approxDimension)); // TODO(annaveronika): yresize?
@@ -196,27 +377,54 @@ TModelCalcerOnPool::TModelCalcerOnPool(
     TObjectsDataProviderPtr objectsData,
     NPar::TLocalExecutor* executor)
     : Model(&model)
-    , RawObjectsData(dynamic_cast<TRawObjectsDataProvider*>(objectsData.Get()))
+    , ObjectsData(objectsData)
     , Executor(executor)
     , BlockParams(0, SafeIntegerCast<int>(objectsData->GetObjectCount()))
 {
     if (BlockParams.FirstId == BlockParams.LastId) {
         return;
     }
-    CB_ENSURE(RawObjectsData, "Not supported for quantized pools");
+    const auto* rawObjectsData = dynamic_cast<const TRawObjectsDataProvider*>(ObjectsData.Get());
+    const auto* quantizedObjectsData = dynamic_cast<const TQuantizedObjectsDataProvider*>(ObjectsData.Get());
+    CB_ENSURE(rawObjectsData || quantizedObjectsData, "Unsupported objects data provider type");
     THashMap<ui32, ui32> columnReorderMap;
-    CheckModelAndDatasetCompatibility(model, *RawObjectsData, &columnReorderMap);
+    CheckModelAndDatasetCompatibility(model, *ObjectsData, &columnReorderMap);
 
     const int threadCount = executor->GetThreadCount() + 1; // one for current thread
     BlockParams.SetBlockCount(threadCount);
     ThreadCalcers.resize(BlockParams.GetBlockCount());
 
-    const ui32 consecutiveSubsetBegin = GetConsecutiveSubsetBegin(*RawObjectsData);
-    const auto& featuresLayout = *RawObjectsData->GetFeaturesLayout();
+    if (quantizedObjectsData) {
+        const auto quantizedPoolFeatures = PrepareQuantizedPoolFeatures(
+            model,
+            *quantizedObjectsData,
+            columnReorderMap,
+            executor);
+        executor->ExecRange([&](int blockId) {
+            const int blockFirstId = BlockParams.FirstId + blockId * BlockParams.GetBlockSize();
+            const int blockLastId = Min(BlockParams.LastId, blockFirstId + BlockParams.GetBlockSize());
+            auto floatBinAccessor = [&](const TFloatFeature& floatFeature, size_t index) -> ui8 {
+                return quantizedPoolFeatures.FloatBins[floatFeature.FlatFeatureIndex][blockFirstId + index];
+            };
+            auto catAccessor = [&](const TCatFeature& catFeature, size_t index) -> ui32 {
+                return quantizedPoolFeatures.CatHashes[catFeature.FlatFeatureIndex][blockFirstId + index];
+            };
+            ThreadCalcers[blockId] = MakeHolder<TFeatureCachedTreeEvaluator>(
+                *Model,
+                quantizedPoolFeatures.FloatBinsRemap,
+                floatBinAccessor,
+                catAccessor,
+                blockLastId - blockFirstId);
+        }, 0, BlockParams.GetBlockCount(), NPar::TLocalExecutor::WAIT_COMPLETE);
+        return;
+    }
+
+    const ui32 consecutiveSubsetBegin = GetConsecutiveSubsetBegin(*rawObjectsData);
+    const auto& featuresLayout = *rawObjectsData->GetFeaturesLayout();
 
     auto getFeatureDataBeginPtr = [&](ui32 flatFeatureIdx) -> const float* {
         return GetRawFeatureDataBeginPtr(
-            *RawObjectsData,
+            *rawObjectsData,
             featuresLayout,
             consecutiveSubsetBegin,
             flatFeatureIdx);
@@ -72,7 +72,7 @@ public:
 
 private:
     const TFullModel* Model;
-    NCB::TRawObjectsDataProviderPtr RawObjectsData;
+    NCB::TObjectsDataProviderPtr ObjectsData;
     NPar::TLocalExecutor* Executor;
     NPar::TLocalExecutor::TExecRangeParams BlockParams;
     TVector<THolder<TFeatureCachedTreeEvaluator>> ThreadCalcers;
@@ -5,34 +5,224 @@
 #include "approx_updater_helpers.h"
 #include "error_functions.h"
 
+#include <catboost/libs/options/restrictions.h>
+
 void UpdateApproxDeltasMulti(
     bool storeExpApprox,
     const TVector<TIndexType>& indices,
     int docCount,
+    NPar::TLocalExecutor* localExecutor,
     TVector<TVector<double>>* leafValues, //leafValues[dimension][bucketId]
     TVector<TVector<double>>* resArr
 ) {
-    if (storeExpApprox) {
+    for (auto& dimensionLeafValues : *leafValues) {
+        ExpApproxIf(storeExpApprox, &dimensionLeafValues);
+    }
+    if (docCount == 0) {
+        return;
+    }
+    NPar::TLocalExecutor::TExecRangeParams blockParams(0, docCount);
+    blockParams.SetBlockCount(localExecutor->GetThreadCount() + 1);
+    localExecutor->ExecRange([&](int blockId) {
+        const int blockBegin = blockId * blockParams.GetBlockSize();
+        const int blockEnd = Min(blockBegin + blockParams.GetBlockSize(), docCount);
         for (int dim = 0; dim < leafValues->ysize(); ++dim) {
-            ExpApproxIf(storeExpApprox, &(*leafValues)[dim]);
-            for (int z = 0; z < docCount; ++z) {
-                (*resArr)[dim][z] = UpdateApprox</*StoreExpApprox*/ true>((*resArr)[dim][z], (*leafValues)[dim][indices[z]]);
+            const TVector<double>& dimensionLeafValues = (*leafValues)[dim];
+            TVector<double>& dimensionResArr = (*resArr)[dim];
+            if (storeExpApprox) {
+                for (int z = blockBegin; z < blockEnd; ++z) {
+                    dimensionResArr[z] = UpdateApprox</*StoreExpApprox*/ true>(dimensionResArr[z], dimensionLeafValues[indices[z]]);
+                }
+            } else {
+                for (int z = blockBegin; z < blockEnd; ++z) {
+                    dimensionResArr[z] = UpdateApprox</*StoreExpApprox*/ false>(dimensionResArr[z], dimensionLeafValues[indices[z]]);
+                }
             }
         }
-    } else {
-        for (int dim = 0; dim < leafValues->ysize(); ++dim) {
-            ExpApproxIf(storeExpApprox, &(*leafValues)[dim]);
-            for (int z = 0; z < docCount; ++z) {
-                (*resArr)[dim][z] = UpdateApprox</*StoreExpApprox*/ false>((*resArr)[dim][z], (*leafValues)[dim][indices[z]]);
+    }, 0, blockParams.GetBlockCount(), NPar::TLocalExecutor::WAIT_COMPLETE);
+}
+
+// derivative values of one block in ProcessDersMultiByBlocks and bucket sums of all blocks in UpdateBucketsMulti,
+// bounds memory for high approx dimensions with symmetric hessians and for deep trees
+static constexpr int MULTI_DERS_BLOCK_VALUE_COUNT = 1 << 20;
+
+void ProcessDersMultiByBlocks(
+    const IDerCalcer& error,
+    const TVector<TVector<double>>& approx,
+    const TVector<TVector<double>>& resArr,
+    const TVector<float>& target,
+    const TVector<float>& weight,
+    int begin,
+    int end,
+    bool calcDer2,
+    NPar::TLocalExecutor* localExecutor,
+    const TProcessDersMultiBlock& processBlock
+) {
+    if (begin >= end) {
+        return;
+    }
+    const int approxDimension = resArr.ysize();
+    const int der2Size = calcDer2 ? CalcInternalDer2DataSize(error.GetHessianType(), approxDimension) : 0;
+    const int blockSize = Min(end - begin, Max(1, MULTI_DERS_BLOCK_VALUE_COUNT / (approxDimension + der2Size)));
+    const TVector<TVector<double>>& approxes = approx.empty() ? resArr : approx;
+    const TVector<TVector<double>>& approxDeltas = approx.empty() ? approx : resArr;
+
+    TVector<double> ders;
+    ders.yresize(blockSize * approxDimension);
+    TVector<double> der2s;
+    der2s.yresize(blockSize * der2Size);
+    for (int blockBegin = begin; blockBegin < end; blockBegin += blockSize) {
+        const int blockEnd = Min(blockBegin + blockSize, end);
+        NPar::TLocalExecutor::TExecRangeParams subblockParams(blockBegin, blockEnd);
+        subblockParams.SetBlockCount(localExecutor->GetThreadCount() + 1);
+        localExecutor->ExecRange([&](int subblockId) {
+            const int subblockBegin = blockBegin + subblockId * subblockParams.GetBlockSize();
+            const int subblockEnd = Min(subblockBegin + subblockParams.GetBlockSize(), blockEnd);
+            const int offset = subblockBegin - blockBegin;
+            error.CalcDersMultiRange(
+                subblockBegin,
+                subblockEnd - subblockBegin,
+                approxes,
+                approxDeltas,
+                target.data(),
+                weight.empty() ? nullptr : weight.data(),
+                MakeArrayRef(ders.data() + offset * approxDimension, (subblockEnd - subblockBegin) * approxDimension),
+                MakeArrayRef(der2s.data() + offset * der2Size, (subblockEnd - subblockBegin) * der2Size));
+        }, 0, subblockParams.GetBlockCount(), NPar::TLocalExecutor::WAIT_COMPLETE);
+        processBlock(
+            blockBegin,
+            blockEnd,
+            MakeArrayRef(ders.data(), (blockEnd - blockBegin) * approxDimension),
+            MakeArrayRef(der2s.data(), (blockEnd - blockBegin) * der2Size));
+    }
+}
+
+// objects of one block of UpdateBucketsMulti are passed to CalcDersMultiRange by chunks of bounded size
+static constexpr int MULTI_DERS_CHUNK_VALUE_COUNT = 1 << 14;
+
+void UpdateBucketsMulti(
+    ELeavesEstimation estimationMethod,
+    const TVector<TIndexType>& indices,
+    const TVector<float>& target,
+    const TVector<float>& weight,
+    const TVector<TVector<double>>& approx,
+    const TVector<TVector<double>>& resArr,
+    const IDerCalcer& error,
+    int sampleCount,
+    int iteration,
+    NPar::TLocalExecutor* localExecutor,
+    TVector<TSumMulti>* buckets
+) {
+    const int approxDimension = resArr.ysize();
+    Y_ASSERT(approxDimension > 0);
+    if (sampleCount == 0) {
+        return;
+    }
+    const bool calcDer2 = estimationMethod == ELeavesEstimation::Newton;
+    const int der2Size = calcDer2 ? CalcInternalDer2DataSize(error.GetHessianType(), approxDimension) : 0;
+    const int leafCount = buckets->ysize();
+    const TVector<TVector<double>>& approxes = approx.empty() ? resArr : approx;
+    const TVector<TVector<double>>& approxDeltas = approx.empty() ? approx : resArr;
+    const float* weightsData = weight.empty() ? nullptr : weight.data();
+
+    // each block of objects accumulates its own bucket sums, they are added to buckets in order of blocks;
+    // bucket sums of all blocks take at most MULTI_DERS_BLOCK_VALUE_COUNT values
+    // and block count doesn't depend on thread count
+    const i64 bucketValueCount = i64(leafCount) * (approxDimension + der2Size);
+    const int blockCount = Min<i64>(CB_THREAD_LIMIT, MULTI_DERS_BLOCK_VALUE_COUNT / bucketValueCount);
+    if (blockCount < 2) {
+        // derivatives are added directly to buckets, only their calculation is parallel
+        ProcessDersMultiByBlocks(
+            error,
+            approx,
+            resArr,
+            target,
+            weight,
+            /*begin*/ 0,
+            sampleCount,
+            calcDer2,
+            localExecutor,
+            [&](int blockBegin, int blockEnd, TConstArrayRef<double> ders, TConstArrayRef<double> der2s) {
+                for (int z = blockBegin; z < blockEnd; ++z) {
+                    const int objectIdx = z - blockBegin;
+                    AddSampleToBucketMulti(
+                        estimationMethod,
+                        ders.Slice(objectIdx * approxDimension, approxDimension),
+                        der2s.Slice(objectIdx * der2Size, der2Size),
+                        weightsData ? weightsData[z] : 1,
+                        iteration,
+                        &(*buckets)[indices[z]]);
+                }
+            });
+        return;
+    }
+    NPar::TLocalExecutor::TExecRangeParams blockParams(0, sampleCount);
+    blockParams.SetBlockCount(blockCount);
+
+    TVector<TVector<double>> blockSumDers(blockParams.GetBlockCount()); // [blockId][leafId * approxDimension + dim]
+    TVector<TVector<double>> blockSumDer2s(blockParams.GetBlockCount()); // [blockId][leafId * der2Size + der2Idx]
+    TVector<TVector<double>> blockSumWeights(blockParams.GetBlockCount()); // [blockId][leafId]
+    const int chunkSize = Max(1, MULTI_DERS_CHUNK_VALUE_COUNT / (approxDimension + der2Size));
+    localExecutor->ExecRange([&](int blockId) {
+        TVector<double>& sumDers = blockSumDers[blockId];
+        TVector<double>& sumDer2s = blockSumDer2s[blockId];
+        TVector<double>& sumWeights = blockSumWeights[blockId];
+        sumDers.resize(leafCount * approxDimension, 0.0);
+        sumDer2s.resize(leafCount * der2Size, 0.0);
+        sumWeights.resize(leafCount, 0.0);
+
+        const int blockBegin = blockId * blockParams.GetBlockSize();
+        const int blockEnd = Min(blockBegin + blockParams.GetBlockSize(), sampleCount);
+        TVector<double> ders;
+        ders.yresize(Min(chunkSize, blockEnd - blockBegin) * approxDimension);
+        TVector<double> der2s;
+        der2s.yresize(Min(chunkSize, blockEnd - blockBegin) * der2Size);
+        for (int chunkBegin = blockBegin; chunkBegin < blockEnd; chunkBegin += chunkSize) {
+            const int chunkEnd = Min(chunkBegin + chunkSize, blockEnd);
+            error.CalcDersMultiRange(
+                chunkBegin,
+                chunkEnd - chunkBegin,
+                approxes,
+                approxDeltas,
+                target.data(),
+                weightsData,
+                MakeArrayRef(ders.data(), (chunkEnd - chunkBegin) * approxDimension),
+                MakeArrayRef(der2s.data(), (chunkEnd - chunkBegin) * der2Size));
+            for (int z = chunkBegin; z < chunkEnd; ++z) {
+                const int objectIdx = z - chunkBegin;
+                const int leafId = indices[z];
+                double* sumDer = sumDers.data() + leafId * approxDimension;
+                const double* der = ders.data() + objectIdx * approxDimension;
+                for (int dim = 0; dim < approxDimension; ++dim) {
+                    sumDer[dim] += der[dim];
+                }
+                double* sumDer2 = sumDer2s.data() + leafId * der2Size;
+                const double* der2 = der2s.data() + objectIdx * der2Size;
+                for (int der2Idx = 0; der2Idx < der2Size; ++der2Idx) {
+                    sumDer2[der2Idx] += der2[der2Idx];
+                }
+                sumWeights[leafId] += weightsData ? weightsData[z] : 1;
             }
         }
+    }, 0, blockParams.GetBlockCount(), NPar::TLocalExecutor::WAIT_COMPLETE);
+
+    for (int leafId = 0; leafId < leafCount; ++leafId) {
+        for (int blockId = 0; blockId < blockParams.GetBlockCount(); ++blockId) {
+            AddSampleToBucketMulti(
+                estimationMethod,
+                TConstArrayRef<double>(blockSumDers[blockId].data() + leafId * approxDimension, approxDimension),
+                TConstArrayRef<double>(blockSumDer2s[blockId].data() + leafId * der2Size, der2Size),
+                blockSumWeights[blockId][leafId],
+                iteration,
+                &(*buckets)[leafId]);
+        }
     }
 }
 
-template <typename TCalcModel, typename TAddSampleToBucket>
-void CalcApproxDeltaIterationMulti(
+template <typename TCalcModel>
+static void CalcApproxDeltaIterationMultiImpl(
     TCalcModel CalcModel,
-    TAddSampleToBucket AddSampleToBucket,
+    ELeavesEstimation estimationMethod,
     const TVector<TIndexType>& indices,
     const TVector<float>& target,
     const TVector<float>& weight,
@@ -40,11 +230,12 @@ void CalcApproxDeltaIterationMulti(
     const IDerCalcer& error,
     int iteration,
     float l2Regularizer,
+    NPar::TLocalExecutor* localExecutor,
     TVector<TSumMulti>* buckets,
     TVector<TVector<double>>* resArr,
     TVector<TVector<double>>* sumLeafValues
 ) {
-    UpdateBucketsMulti(AddSampleToBucket, indices, target, weight, bt.Approx, *resArr, error, bt.BodyFinish, iteration, buckets);
+    UpdateBucketsMulti(estimationMethod, indices, target, weight, bt.Approx, *resArr, error, bt.BodyFinish, iteration, localExecutor, buckets);
 
     // compute mixed model
     const int approxDimension = resArr->ysize();
@@ -54,27 +245,68 @@ void CalcApproxDeltaIterationMulti(
     if (sumLeafValues != nullptr) {
         AddElementwise(curLeafValues, sumLeafValues);
     }
-    UpdateApproxDeltasMulti(error.GetIsExpApprox(), indices, bt.BodyFinish, &curLeafValues, resArr);
+    UpdateApproxDeltasMulti(error.GetIsExpApprox(), indices, bt.BodyFinish, localExecutor, &curLeafValues, resArr);
 
     // compute tail
-    TVector<double> curApprox(approxDimension);
+    // derivatives of a tail object don't depend on updates made for preceding tail objects,
+    // so only adding them to buckets and updating the model are sequential
+    const bool calcDer2 = estimationMethod == ELeavesEstimation::Newton;
+    const int der2Size = calcDer2 ? CalcInternalDer2DataSize(error.GetHessianType(), approxDimension) : 0;
     TVector<double> avrg(approxDimension);
-    TVector<double> bufferDer(approxDimension);
-    THessianInfo bufferDer2(approxDimension, error.GetHessianType());
-    for (int z = bt.BodyFinish; z < bt.TailFinish; ++z) {
-        for (int dim = 0; dim < approxDimension; ++dim) {
-            curApprox[dim] = UpdateApprox(error.GetIsExpApprox(), bt.Approx[dim][z], (*resArr)[dim][z]);
-        }
+    ProcessDersMultiByBlocks(
+        error,
+        bt.Approx,
+        *resArr,
+        target,
+        weight,
+        bt.BodyFinish,
+        bt.TailFinish,
+        calcDer2,
+        localExecutor,
+        [&](int blockBegin, int blockEnd, TConstArrayRef<double> ders, TConstArrayRef<double> der2s) {
+            for (int z = blockBegin; z < blockEnd; ++z) {
+                const int objectIdx = z - blockBegin;
+                TSumMulti& bucket = (*buckets)[indices[z]];
+                AddSampleToBucketMulti(
+                    estimationMethod,
+                    ders.Slice(objectIdx * approxDimension, approxDimension),
+                    der2s.Slice(objectIdx * der2Size, der2Size),
+                    weight.empty() ? 1 : weight[z],
+                    iteration,
+                    &bucket);
 
-        TSumMulti& bucket = (*buckets)[indices[z]];
-        AddSampleToBucket(error, curApprox, target[z], weight.empty() ? 1 : weight[z], iteration,
-                          &bufferDer, &bufferDer2, &bucket);
+                CalcModel(bucket, iteration, l2Regularizer, bt.BodySumWeight, bt.BodyFinish, &avrg);
+                ExpApproxIf(error.GetIsExpApprox(), &avrg);
+                for (int dim = 0; dim < approxDimension; ++dim) {
+                    (*resArr)[dim][z] = UpdateApprox(error.GetIsExpApprox(), (*resArr)[dim][z], avrg[dim]);
+                }
+            }
+        });
+}
 
-        CalcModel(bucket, iteration, l2Regularizer, bt.BodySumWeight, bt.BodyFinish, &avrg);
-        ExpApproxIf(error.GetIsExpApprox(), &avrg);
-        for (int dim = 0; dim < approxDimension; ++dim) {
-            (*resArr)[dim][z] = UpdateApprox(error.GetIsExpApprox(), (*resArr)[dim][z], avrg[dim]);
-        }
+void CalcApproxDeltaIterationMulti(
+    ELeavesEstimation estimationMethod,
+    const TVector<TIndexType>& indices,
+    const TVector<float>& target,
+    const TVector<float>& weight,
+    const TFold::TBodyTail& bt,
+    const IDerCalcer& error,
+    int iteration,
+    float l2Regularizer,
+    NPar::TLocalExecutor* localExecutor,
+    TVector<TSumMulti>* buckets,
+    TVector<TVector<double>>* resArr,
+    TVector<TVector<double>>* sumLeafValues
+) {
+    if (estimationMethod == ELeavesEstimation::Newton) {
+        CalcApproxDeltaIterationMultiImpl(CalcModelNewtonMulti, estimationMethod,
+                                          indices, target, weight, bt, error, iteration, l2Regularizer,
+                                          localExecutor, buckets, resArr, sumLeafValues);
+    } else {
+        Y_ASSERT(estimationMethod == ELeavesEstimation::Gradient);
+        CalcApproxDeltaIterationMultiImpl(CalcModelGradientMulti, estimationMethod,
+                                          indices, target, weight, bt, error, iteration, l2Regularizer,
+                                          localExecutor, buckets, resArr, sumLeafValues);
     }
 }
 
@@ -96,23 +328,15 @@ void CalcApproxDeltaMulti(
     const int approxDimension = approxDelta->ysize();
     TVector<TSumMulti> buckets(leafCount, TSumMulti(gradientIterations, approxDimension, error.GetHessianType()));
     for (int it = 0; it < gradientIterations; ++it) {
-        if (estimationMethod == ELeavesEstimation::Newton) {
-            CalcApproxDeltaIterationMulti(CalcModelNewtonMulti, AddSampleToBucketNewtonMulti,
-                                          indices, ff.LearnTarget, ff.GetLearnWeights(), bt, error, it, l2Regularizer,
-                                          &buckets, approxDelta, sumLeafValues);
-        } else {
-            Y_ASSERT(estimationMethod == ELeavesEstimation::Gradient);
-            CalcApproxDeltaIterationMulti(CalcModelGradientMulti, AddSampleToBucketGradientMulti,
-                                          indices, ff.LearnTarget, ff.GetLearnWeights(), bt, error, it, l2Regularizer,
-                                          &buckets, approxDelta, sumLeafValues);
-        }
+        CalcApproxDeltaIterationMulti(estimationMethod, indices, ff.LearnTarget, ff.GetLearnWeights(), bt, error, it,
+                                      l2Regularizer, ctx->LocalExecutor, &buckets, approxDelta, sumLeafValues);
     }
 }
 
-template <typename TCalcModel, typename TAddSampleToBucket>
+template <typename TCalcModel>
 void CalcLeafValuesIterationMulti(
     TCalcModel CalcModel,
-    TAddSampleToBucket AddSampleToBucket,
+    ELeavesEstimation estimationMethod,
     const TVector<TIndexType>& indices,
     const TVector<float>& target,
     const TVector<float>& weight,
@@ -120,6 +344,7 @@ void CalcLeafValuesIterationMulti(
     int iteration,
     float l2Regularizer,
     double sumWeight,
+    NPar::TLocalExecutor* localExecutor,
     TVector<TSumMulti>* buckets,
     TVector<TVector<double>>* approx
 ) {
@@ -127,12 +352,12 @@ void CalcLeafValuesIterationMulti(
     int approxDimension = approx->ysize();
     int learnSampleCount = (*approx)[0].ysize();
 
-    UpdateBucketsMulti(AddSampleToBucket, indices, target, weight, /*approx*/ TVector<TVector<double>>(), *approx, error, learnSampleCount, iteration, buckets);
+    UpdateBucketsMulti(estimationMethod, indices, target, weight, /*approx*/ TVector<TVector<double>>(), *approx, error, learnSampleCount, iteration, localExecutor, buckets);
 
     TVector<TVector<double>> curLeafValues(approxDimension, TVector<double>(leafCount));
     CalcMixedModelMulti(CalcModel, *buckets, iteration, l2Regularizer, sumWeight, learnSampleCount, &curLeafValues);
 
-    UpdateApproxDeltasMulti(error.GetIsExpApprox(), indices, learnSampleCount, &curLeafValues, approx);
+    UpdateApproxDeltasMulti(error.GetIsExpApprox(), indices, learnSampleCount, localExecutor, &curLeafValues, approx);
 }
 
 void CalcLeafValuesMulti(
@@ -158,14 +383,14 @@ void CalcLeafValuesMulti(
     const float l2Regularizer = treeLearnerOptions.L2Reg;
     for (int it = 0; it < gradientIterations; ++it) {
         if (estimationMethod == ELeavesEstimation::Newton) {
-            CalcLeafValuesIterationMulti(CalcModelNewtonMulti, AddSampleToBucketNewtonMulti,
+            CalcLeafValuesIterationMulti(CalcModelNewtonMulti, estimationMethod,
                                          indices, ff.LearnTarget, ff.GetLearnWeights(), error, it, l2Regularizer,
-                                         ff.GetSumWeight(), &buckets, &approx);
+                                         ff.GetSumWeight(), ctx->LocalExecutor, &buckets, &approx);
         } else {
             Y_ASSERT(estimationMethod == ELeavesEstimation::Gradient);
-            CalcLeafValuesIterationMulti(CalcModelGradientMulti, AddSampleToBucketGradientMulti,
+            CalcLeafValuesIterationMulti(CalcModelGradientMulti, estimationMethod,
                                          indices, ff.LearnTarget, ff.GetLearnWeights(), error, it, l2Regularizer,
-                                         ff.GetSumWeight(), &buckets, &approx);
+                                         ff.GetSumWeight(), ctx->LocalExecutor, &buckets, &approx);
         }
     }
 
@@ -5,47 +5,62 @@
 #include "approx_updater_helpers.h"
 #include "error_functions.h"
 
+#include <library/threading/local_executor/local_executor.h>
+
+#include <util/generic/array_ref.h>
+#include <util/generic/vector.h>
+
+#include <functional>
+
 void UpdateApproxDeltasMulti(
     bool storeExpApprox,
     const TVector<TIndexType>& indices,
     int docCount,
+    NPar::TLocalExecutor* localExecutor,
     TVector<TVector<double>>* leafValues, //leafValues[dimension][bucketId]
     TVector<TVector<double>>* resArr
 );
 
-inline void AddSampleToBucketNewtonMulti(
-    const IDerCalcer& error,
-    const TVector<double>& approx,
-    float target,
+inline void AddSampleToBucketMulti(
+    ELeavesEstimation estimationMethod,
+    TConstArrayRef<double> der,
+    TConstArrayRef<double> der2,
     double weight,
     int iteration,
-    TVector<double>* curDer,
-    THessianInfo* curDer2,
     TSumMulti* bucket
 ) {
-    Y_ASSERT(curDer != nullptr && curDer2 != nullptr);
-    error.CalcDersMulti(approx, target, weight, curDer, curDer2);
-    bucket->AddDerDer2(*curDer, *curDer2, iteration);
+    if (estimationMethod == ELeavesEstimation::Newton) {
+        bucket->AddDerDer2(der, der2, iteration);
+    } else {
+        Y_ASSERT(estimationMethod == ELeavesEstimation::Gradient);
+        bucket->AddDerWeight(der, weight, iteration);
+    }
 }
 
-inline void AddSampleToBucketGradientMulti(
+// ders and der2s of objects [blockBegin, blockEnd) in IDerCalcer::CalcDersMultiRange layout
+using TProcessDersMultiBlock = std::function<void(
+    int blockBegin,
+    int blockEnd,
+    TConstArrayRef<double> ders,
+    TConstArrayRef<double> der2s)>;
+
+// Calculates derivatives of objects [begin, end) in parallel by blocks of bounded size
+// and passes the blocks to processBlock sequentially in order of objects.
+void ProcessDersMultiByBlocks(
     const IDerCalcer& error,
-    const TVector<double>& approx,
-    float target,
-    double weight,
-    int iteration,
-    TVector<double>* curDer,
-    THessianInfo* /*curDer2*/,
-    TSumMulti* bucket
-) {
-    Y_ASSERT(curDer != nullptr);
-    error.CalcDersMulti(approx, target, weight, curDer, nullptr);
-    bucket->AddDerWeight(*curDer, weight, iteration);
-}
+    const TVector<TVector<double>>& approx, // can be empty, then resArr contains approxes
+    const TVector<TVector<double>>& resArr,
+    const TVector<float>& target,
+    const TVector<float>& weight,
+    int begin,
+    int end,
+    bool calcDer2,
+    NPar::TLocalExecutor* localExecutor,
+    const TProcessDersMultiBlock& processBlock
+);
 
-template <typename TAddSampleToBucket>
 void UpdateBucketsMulti(
-    TAddSampleToBucket AddSampleToBucket,
+    ELeavesEstimation estimationMethod,
     const TVector<TIndexType>& indices,
     const TVector<float>& target,
     const TVector<float>& weight,
@@ -54,22 +69,9 @@ void UpdateBucketsMulti(
     const IDerCalcer& error,
     int sampleCount,
     int iteration,
+    NPar::TLocalExecutor* localExecutor,
     TVector<TSumMulti>* buckets
-) {
-    const int approxDimension = resArr.ysize();
-    Y_ASSERT(approxDimension > 0);
-    TVector<double> curApprox(approxDimension);
-    TVector<double> bufferDer(approxDimension);
-    THessianInfo bufferDer2(approxDimension, error.GetHessianType());
-    for (int z = 0; z < sampleCount; ++z) {
-        for (int dim = 0; dim < approxDimension; ++dim) {
-            curApprox[dim] = approx.empty() ? resArr[dim][z] : UpdateApprox(error.GetIsExpApprox(), approx[dim][z], resArr[dim][z]);
-        }
-        TSumMulti& bucket = (*buckets)[indices[z]];
-        AddSampleToBucket(error, curApprox, target[z], weight.empty() ? 1 : weight[z], iteration,
-                          &bufferDer, &bufferDer2, &bucket);
-    }
-}
+);
 
 template <typename TCalcModel>
 void CalcMixedModelMulti(
@@ -91,6 +93,23 @@ void CalcMixedModelMulti(
     }
 }
 
+// One leaf estimation iteration for objects of bt: body objects update buckets and then get
+// the mixed model values, tail objects are added to buckets one by one, each getting the updated model.
+void CalcApproxDeltaIterationMulti(
+    ELeavesEstimation estimationMethod,
+    const TVector<TIndexType>& indices,
+    const TVector<float>& target,
+    const TVector<float>& weight,
+    const TFold::TBodyTail& bt,
+    const IDerCalcer& error,
+    int iteration,
+    float l2Regularizer,
+    NPar::TLocalExecutor* localExecutor,
+    TVector<TSumMulti>* buckets,
+    TVector<TVector<double>>* resArr,
+    TVector<TVector<double>>* sumLeafValues // can be nullptr
+);
+
 void CalcApproxDeltaMulti(
     const TFold& ff,
     const TFold::TBodyTail& bt,
@@ -13,7 +13,7 @@ bool IsSamplingPerTree(const NCatboostOptions::TObliviousTreeLearnerOptions& fit
     return fitParams.SamplingFrequency.Get() == ESamplingFrequency::PerTree;
 }
 
-TVector<TBucketStats, TPoolAllocator>& TBucketStatsCache::GetStats(const TSplitCandidate& split, int splitStatsCount, bool* areStatsDirty) {
+TVector<TBucketStats, TPoolAllocator>* TBucketStatsCache::GetStats(const TSplitCandidate& split, int splitStatsCount, bool* areStatsDirty) {
     TVector<TBucketStats, TPoolAllocator>* splitStats;
     with_lock(Lock) {
         if (Stats.contains(split) && Stats[split] != nullptr) {
@@ -21,19 +21,28 @@ TVector<TBucketStats, TPoolAllocator>& TBucketStatsCache::GetStats(const TSplitC
             Y_ASSERT(splitStats->ysize() >= splitStatsCount);
             *areStatsDirty = false;
         } else {
+            const ui64 splitStatsSize = sizeof(TBucketStats) * MaxBodyTailCount * ApproxDimension * splitStatsCount;
+            if (AllocatedSize + splitStatsSize > SizeLimit) {
+                IsOverflowed = true;
+                return nullptr;
+            }
+            AllocatedSize += splitStatsSize;
             splitStats = new TVector<TBucketStats, TPoolAllocator>(MemoryPool.Get());
             splitStats->yresize(MaxBodyTailCount * ApproxDimension * splitStatsCount);
             Stats[split] = splitStats;
             *areStatsDirty = true;
         }
     }
-    return *splitStats;
+    return splitStats;
 }
 
 void TBucketStatsCache::GarbageCollect() {
-    if (MemoryPool->MemoryWaste() > InitialSize) { // limit memory overhead
+    // stats which did not fit are scored without the cache, the cache is refilled by candidates of the next tree
+    if (MemoryPool->MemoryWaste() > InitialSize || IsOverflowed) { // limit memory overhead
         Stats.clear();
         MemoryPool->Clear();
+        AllocatedSize = 0;
+        IsOverflowed = false;
     }
 }
 
@@ -215,9 +224,16 @@ static int GetMaxTailFinish(const TVector<TFold>& folds, int bodyTailIdx) {
     return maxTailFinish;
 }
 
-void TCalcScoreFold::Create(const TVector<TFold>& folds, bool isPairwiseScoring, int defaultCalcStatsObjBlockSize, float sampleRate) {
+void TCalcScoreFold::Create(
+    const TVector<TFold>& folds,
+    bool isPairwiseScoring,
+    int defaultCalcStatsObjBlockSize,
+    float sampleRate,
+    bool isSampledBySampleWeights
+) {
     BernoulliSampleRate = sampleRate;
     Y_ASSERT(BernoulliSampleRate > 0.0f && BernoulliSampleRate <= 1.0f);
+    IsSampledBySampleWeights = isSampledBySampleWeights;
     DocCount = folds[0].GetLearnSampleCount();
     Y_ASSERT(DocCount > 0);
     Indices.yresize(DocCount);
@@ -317,7 +333,6 @@ void TCalcScoreFold::SelectBlockFromFold(const TFoldType& fold, TSlice srcBlock,
     for (int bodyTailIdx = 0; bodyTailIdx < BodyTailCount; ++bodyTailIdx) {
         const auto& srcBodyTail = fold.BodyTailArr[bodyTailIdx];
         auto& dstBodyTail = BodyTailArr[bodyTailIdx];
-        const auto srcBodyBlock = srcBlock.Clip(srcBodyTail.BodyFinish);
         const auto srcTailBlock = srcBlock.Clip(srcBodyTail.TailFinish);
         int bodyCount = 0;
         int tailCount = 0;
@@ -325,15 +340,72 @@ void TCalcScoreFold::SelectBlockFromFold(const TFoldType& fold, TSlice srcBlock,
             SetElements(srcControlRef, srcTailBlock.GetConstRef(srcBodyTail.PairwiseWeights), GetElement<float>, dstBlock.GetRef(dstBodyTail.PairwiseWeights), &tailCount);
             SetElements(srcControlRef, srcTailBlock.GetConstRef(srcBodyTail.SamplePairwiseWeights), GetElement<float>, dstBlock.GetRef(dstBodyTail.SamplePairwiseWeights), &tailCount);
         }
-        for (int dim = 0; dim < ApproxDimension; ++dim) {
-            SetElements(srcControlRef, srcBodyBlock.GetConstRef(srcBodyTail.WeightedDerivatives[dim]), GetElement<double>, dstBlock.GetRef(dstBodyTail.WeightedDerivatives[dim]), &bodyCount);
-            SetElements(srcControlRef, srcTailBlock.GetConstRef(srcBodyTail.SampleWeightedDerivatives[dim]), GetElement<double>, dstBlock.GetRef(dstBodyTail.SampleWeightedDerivatives[dim]), &tailCount);
-        }
+        SelectBodyTailDerivatives(fold, bodyTailIdx, srcBlock, dstBlock, &bodyCount, &tailCount);
         AtomicAdd(dstBodyTail.BodyFinish, bodyCount); // these atomics may take up to 2-3% of iteration time
         AtomicAdd(dstBodyTail.TailFinish, tailCount);
     }
 }
 
+void TCalcScoreFold::SelectBodyTailDerivatives(
+    const TCalcScoreFold& fold,
+    int bodyTailIdx,
+    TSlice srcBlock,
+    TSlice dstBlock,
+    int* bodyCount,
+    int* tailCount
+) {
+    const auto srcControlRef = srcBlock.GetConstRef(Control);
+    const auto& srcBodyTail = fold.BodyTailArr[bodyTailIdx];
+    auto& dstBodyTail = BodyTailArr[bodyTailIdx];
+    const auto srcBodyBlock = srcBlock.Clip(srcBodyTail.BodyFinish);
+    const auto srcTailBlock = srcBlock.Clip(srcBodyTail.TailFinish);
+    for (int dim = 0; dim < ApproxDimension; ++dim) {
+        SetElements(srcControlRef, srcBodyBlock.GetConstRef(srcBodyTail.WeightedDerivatives[dim]), GetElement<double>, dstBlock.GetRef(dstBodyTail.WeightedDerivatives[dim]), bodyCount);
+        SetElements(srcControlRef, srcTailBlock.GetConstRef(srcBodyTail.SampleWeightedDerivatives[dim]), GetElement<double>, dstBlock.GetRef(dstBodyTail.SampleWeightedDerivatives[dim]), tailCount);
+    }
+}
+
+void TCalcScoreFold::SelectBodyTailDerivatives(
+    const TFold& fold,
+    int bodyTailIdx,
+    TSlice srcBlock,
+    TSlice dstBlock,
+    int* bodyCount,
+    int* tailCount
+) {
+    const auto srcControlRef = srcBlock.GetConstRef(Control);
+    const auto& srcBodyTail = fold.BodyTailArr[bodyTailIdx];
+    auto& dstBodyTail = BodyTailArr[bodyTailIdx];
+    const auto srcBodyBlock = srcBlock.Clip(srcBodyTail.BodyFinish);
+    const auto srcTailBlock = srcBlock.Clip(srcBodyTail.TailFinish);
+    const auto getDerivative = [] (const auto* source, size_t j) -> double { return source[j]; };
+    for (int dim = 0; dim < ApproxDimension; ++dim) {
+        fold.Derivatives.Visit(srcBodyTail.WeightedDerivatives[dim], [&] (auto weightedDerivatives) {
+            SetElements(srcControlRef, srcBodyBlock.GetConstRef(weightedDerivatives), getDerivative, dstBlock.GetRef(dstBodyTail.WeightedDerivatives[dim]), bodyCount);
+        });
+
+        // documents before the stored range are not used by scoring, zeros only keep positions of the rest
+        const auto& sampleWeightedRange = srcBodyTail.SampleWeightedDerivatives[dim];
+        const int unstoredCount = srcTailBlock.Clip(sampleWeightedRange.Begin).Size;
+        const auto dstSampleWeightedDerivatives = dstBlock.GetRef(dstBodyTail.SampleWeightedDerivatives[dim]);
+        int unstoredDstCount = 0;
+        SetElementsToConstant(srcControlRef.Slice(0, unstoredCount), 0.0, dstSampleWeightedDerivatives, &unstoredDstCount);
+        int storedDstCount = 0;
+        if (srcTailBlock.Size > unstoredCount) {
+            fold.Derivatives.Visit(sampleWeightedRange, [&] (auto sampleWeightedDerivatives) {
+                const int storedOffset = srcTailBlock.Offset + unstoredCount - sampleWeightedRange.Begin;
+                SetElements(
+                    srcControlRef.Slice(unstoredCount),
+                    sampleWeightedDerivatives.Slice(storedOffset, srcTailBlock.Size - unstoredCount),
+                    getDerivative,
+                    dstSampleWeightedDerivatives.Slice(unstoredDstCount),
+                    &storedDstCount);
+            });
+        }
+        *tailCount = unstoredDstCount + storedDstCount;
+    }
+}
+
 void TCalcScoreFold::SelectSmallestSplitSide(int curDepth, const TCalcScoreFold& fold, NPar::TLocalExecutor* localExecutor) {
     SetSmallestSideControl(curDepth, fold.DocCount, fold.Indices, localExecutor);
 
@@ -367,10 +439,11 @@ void TCalcScoreFold::SelectSmallestSplitSide(int curDepth, const TCalcScoreFold&
         SelectBlockFromFold(fold, srcBlock, dstBlock);
     }, 0, blockCount, NPar::TLocalExecutor::WAIT_COMPLETE);
     SetPermutationBlockSizeAndCalcStatsRanges(FoldPermutationBlockSizeNotSet, FoldPermutationBlockSizeNotSet);
+    IsDocInFoldBySrcIdxBuilt = false;
 }
 
 void TCalcScoreFold::Sample(const TFold& fold, const TVector<TIndexType>& indices, TRestorableFastRng64* rand, NPar::TLocalExecutor* localExecutor) {
-    SetSampledControl(indices.ysize(), rand);
+    SetSampledControl(fold, indices.ysize(), rand);
 
     TVectorSlicing srcBlocks;
     TVectorSlicing dstBlocks;
@@ -403,6 +476,7 @@ void TCalcScoreFold::Sample(const TFold& fold, const TVector<TIndexType>& indice
         (BernoulliSampleRate == 1.0f || IsPairwiseScoring) ? fold.PermutationBlockSize : FoldPermutationBlockSizeNotSet,
         (BernoulliSampleRate == 1.0f || IsPairwiseScoring) ? DocCount : FoldPermutationBlockSizeNotSet
     );
+    IsDocInFoldBySrcIdxBuilt = false;
 }
 
 void TCalcScoreFold::UpdateIndices(const TVector<TIndexType>& indices, NPar::TLocalExecutor* localExecutor) {
@@ -485,11 +559,17 @@ void TCalcScoreFold::SetSmallestSideControl(int curDepth, int docCount, const TU
     }
 }
 
-void TCalcScoreFold::SetSampledControl(int docCount, TRestorableFastRng64* rand) {
+void TCalcScoreFold::SetSampledControl(const TFold& fold, int docCount, TRestorableFastRng64* rand) {
     if (BernoulliSampleRate == 1.0f || IsPairwiseScoring) {
         Fill(Control.begin(), Control.end(), true);
         return;
     }
+    if (IsSampledBySampleWeights) {
+        for (int docIdx = 0; docIdx < docCount; ++docIdx) {
+            Control[docIdx] = fold.SampleWeights[docIdx] > 0.0f;
+        }
+        return;
+    }
     for (int docIdx = 0; docIdx < docCount; ++docIdx) {
         Control[docIdx] = rand->GenRandReal1() < BernoulliSampleRate;
     }
@@ -545,6 +625,20 @@ static bool HasPairs(const TVector<TQueryInfo>& learnQueriesInfo) {
     return false;
 }
 
+TConstArrayRef<ui32> TCalcScoreFold::GetDocInFoldBySrcIdx(ui32 srcSize, NPar::TLocalExecutor* localExecutor) const {
+    TGuard<TAdaptiveLock> guard(DocInFoldBySrcIdxLock);
+    if (!IsDocInFoldBySrcIdxBuilt) {
+        const ui32* docInDataProviderIndexing = GetDataPtr(LearnPermutationFeaturesSubset.Get<TIndexedSubset<ui32>>());
+        DocInFoldBySrcIdx.assign(srcSize, Max<ui32>());
+        NPar::ParallelFor(*localExecutor, 0, DocCount, [&] (int doc) {
+            DocInFoldBySrcIdx[docInDataProviderIndexing[doc]] = doc;
+        });
+        IsDocInFoldBySrcIdxBuilt = true;
+    }
+    Y_ASSERT(DocInFoldBySrcIdx.size() == srcSize);
+    return DocInFoldBySrcIdx;
+}
+
 void TCalcScoreFold::SetPermutationBlockSizeAndCalcStatsRanges(
     int nonCtrDataPermutationBlockSize,
     int ctrDataPermutationBlockSize
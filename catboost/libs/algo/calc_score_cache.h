@@ -44,13 +44,20 @@ static inline const TData* GetDataPtr(const TVector<TData, TAlloc>& data, size_t
     return GetDataPtr(TConstArrayRef<TData>(data), offset);
 }
 
+// Expected fraction of documents left for score calculation by bootstraps which drop documents
 static inline float GetBernoulliSampleRate(const NCatboostOptions::TOption<NCatboostOptions::TBootstrapConfig>& samplingConfig) {
-    if (samplingConfig->GetBootstrapType() == EBootstrapType::Bernoulli) {
+    const EBootstrapType bootstrapType = samplingConfig->GetBootstrapType();
+    if (bootstrapType == EBootstrapType::Bernoulli || bootstrapType == EBootstrapType::MVS) {
         return samplingConfig->GetTakenFraction();
     }
     return 1.0f;
 }
 
+// MVS bootstrap selects documents itself and drops ones with zero sample weights
+static inline bool IsSampledBySampleWeights(const NCatboostOptions::TOption<NCatboostOptions::TBootstrapConfig>& samplingConfig) {
+    return samplingConfig->GetBootstrapType() == EBootstrapType::MVS;
+}
+
 static inline int GetMaxBodyTailCount(const TVector<TFold>& folds) {
     int maxBodyTailCount = 0;
     for (const auto& fold : folds) {
@@ -105,16 +112,21 @@ inline static int CountNonCtrBuckets(
 
 struct TBucketStatsCache {
     THashMap<TSplitCandidate, THolder<TVector<TBucketStats, TPoolAllocator>>> Stats;
-    inline void Create(const TVector<TFold>& folds, int bucketCount, int depth) {
+    inline void Create(const TVector<TFold>& folds, int bucketCount, int depth, ui64 sizeLimit) {
         ApproxDimension = folds[0].GetApproxDimension();
+        SizeLimit = sizeLimit;
         MaxBodyTailCount = GetMaxBodyTailCount(folds);
         InitialSize = sizeof(TBucketStats) * bucketCount * (1U << depth) * ApproxDimension * MaxBodyTailCount;
         if (InitialSize == 0) {
             InitialSize = NSystemInfo::GetPageSize();
         }
         MemoryPool = new TMemoryPool(InitialSize);
+        AllocatedSize = 0;
+        IsOverflowed = false;
     }
-    TVector<TBucketStats, TPoolAllocator>& GetStats(const TSplitCandidate& split, int statsCount, bool* areStatsDirty);
+    // nullptr if stats of the split are not cached and do not fit into the size limit,
+    // memory of the cache is released only by GarbageCollect between trees
+    TVector<TBucketStats, TPoolAllocator>* GetStats(const TSplitCandidate& split, int statsCount, bool* areStatsDirty);
     void GarbageCollect();
     static TVector<TBucketStats> GetStatsInUse(int segmentCount,
         int segmentSize,
@@ -124,6 +136,9 @@ private:
     THolder<TMemoryPool> MemoryPool;
     TAdaptiveLock Lock;
     size_t InitialSize = 0;
+    ui64 SizeLimit = 0;
+    ui64 AllocatedSize = 0;
+    bool IsOverflowed = false;
     int MaxBodyTailCount = 0;
     int ApproxDimension = 0;
 };
@@ -203,6 +218,7 @@ struct TCalcScoreFold {
     ui32 FeaturesSubsetBegin;
 
     TUnsizedVector<ui32> IndexInFold;
+
     TUnsizedVector<float> LearnWeights;
     TUnsizedVector<float> SampleWeights;
     TVector<TQueryInfo> LearnQueriesInfo;
@@ -212,7 +228,13 @@ struct TCalcScoreFold {
     int CtrDataPermutationBlockSize = FoldPermutationBlockSizeNotSet;
 
 
-    void Create(const TVector<TFold>& folds, bool isPairwiseScoring, int defaultCalcStatsObjBlockSize, float sampleRate = 1.0f);
+    void Create(
+        const TVector<TFold>& folds,
+        bool isPairwiseScoring,
+        int defaultCalcStatsObjBlockSize,
+        float sampleRate = 1.0f,
+        bool isSampledBySampleWeights = false
+    );
     void SelectSmallestSplitSide(int curDepth, const TCalcScoreFold& fold, NPar::TLocalExecutor* localExecutor);
     void Sample(const TFold& fold, const TVector<TIndexType>& indices, TRestorableFastRng64* rand, NPar::TLocalExecutor* localExecutor);
     void UpdateIndices(const TVector<TIndexType>& indices, NPar::TLocalExecutor* localExecutor);
@@ -221,6 +243,12 @@ struct TCalcScoreFold {
     int GetApproxDimension() const;
     const TVector<float>& GetLearnWeights() const { return LearnWeights; }
 
+    /* position in fold of each object of features buckets arrays, Max<ui32>() for objects not in fold,
+     * used to accumulate stats of sparse features from their non-default objects,
+     * built by the first call after LearnPermutationFeaturesSubset changes
+     */
+    TConstArrayRef<ui32> GetDocInFoldBySrcIdx(ui32 srcSize, NPar::TLocalExecutor* localExecutor) const;
+
     bool HasQueryInfo() const;
 
     // for data with queries - query indices, object indices otherwise
@@ -235,8 +263,10 @@ private:
     using TSlice = TVectorSlicing::TSlice;
     template <typename TFoldType>
     void SelectBlockFromFold(const TFoldType& fold, TSlice srcBlock, TSlice dstBlock);
+    void SelectBodyTailDerivatives(const TCalcScoreFold& fold, int bodyTailIdx, TSlice srcBlock, TSlice dstBlock, int* bodyCount, int* tailCount);
+    void SelectBodyTailDerivatives(const TFold& fold, int bodyTailIdx, TSlice srcBlock, TSlice dstBlock, int* bodyCount, int* tailCount);
     void SetSmallestSideControl(int curDepth, int docCount, const TUnsizedVector<TIndexType>& indices, NPar::TLocalExecutor* localExecutor);
-    void SetSampledControl(int docCount, TRestorableFastRng64* rand);
+    void SetSampledControl(const TFold& fold, int docCount, TRestorableFastRng64* rand);
 
     void CreateBlocksAndUpdateQueriesInfoByControl(
         NPar::TLocalExecutor* localExecutor,
@@ -251,10 +281,14 @@ private:
     void SetPermutationBlockSizeAndCalcStatsRanges(int nonCtrDataPermutationBlockSize, int ctrDataPermutationBlockSize);
 
     TUnsizedVector<bool> Control;
+    mutable TVector<ui32> DocInFoldBySrcIdx;
+    mutable bool IsDocInFoldBySrcIdxBuilt = false;
+    mutable TAdaptiveLock DocInFoldBySrcIdxLock;
     int DocCount;
     int BodyTailCount;
     int ApproxDimension;
     float BernoulliSampleRate;
+    bool IsSampledBySampleWeights;
     bool HasPairwiseWeights;
     bool IsPairwiseScoring;
     int DefaultCalcStatsObjBlockSize;
@@ -266,9 +300,10 @@ struct TStats3D {
     TVector<TBucketStats> Stats; // [bodyTail & approxDim][leaf][bucket]
     int BucketCount = 0;
     int MaxLeafCount = 0;
+    ESplitType SplitType = ESplitType::FloatFeature; // needed to calc scores from reduced stats in distributed mode
 
     void Add(const TStats3D& stats3D);
 
-    SAVELOAD(Stats, BucketCount, MaxLeafCount);
+    SAVELOAD(Stats, BucketCount, MaxLeafCount, SplitType);
 };
 
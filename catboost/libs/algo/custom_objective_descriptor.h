@@ -20,8 +20,19 @@ struct TCustomObjectiveDescriptor {
         TVector<double>* ders,
         THessianInfo* der2,
         void* customData);
+    // Derivatives of count objects at once, der2s is nullptr if second derivatives are not needed
+    using TCalcDersMultiRangePtr = void (*)(
+        int count,
+        int approxDimension,
+        const double* approxes, // [dim * count + objectIdx]
+        const float* targets,
+        const float* weights, // can be nullptr
+        double* ders, // [objectIdx * approxDimension + dim]
+        double* der2s, // [objectIdx * der2Size + der2Idx], THessianInfo::Data layout of symmetric hessian
+        void* customData);
 
     void* CustomData = nullptr;
     TCalcDersRangePtr CalcDersRange = nullptr;
     TCalcDersMultiPtr CalcDersMulti = nullptr;
+    TCalcDersMultiRangePtr CalcDersMultiRange = nullptr; // optional, CalcDersMulti is used if not set
 };
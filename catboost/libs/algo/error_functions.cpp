@@ -2,6 +2,8 @@
 
 #include <util/generic/xrange.h>
 
+#include <array>
+
 template <int MaxDerivativeOrder, bool UseTDers, bool UseExpApprox, bool HasDelta>
 void IDerCalcer::CalcDersRangeImpl(
     int start,
@@ -107,6 +109,270 @@ void IDerCalcer::CalcDersRange(
     }
 }
 
+void IDerCalcer::CalcDersMultiRange(
+    int start,
+    int count,
+    const TVector<TVector<double>>& approxes,
+    const TVector<TVector<double>>& approxDeltas,
+    const float* targets,
+    const float* weights,
+    TArrayRef<double> ders,
+    TArrayRef<double> der2s
+) const {
+    const int approxDimension = approxes.ysize();
+    const bool hasDelta = !approxDeltas.empty();
+    TVector<double> curApprox(approxDimension);
+    TVector<double> curDer(approxDimension);
+    THessianInfo curDer2(approxDimension, HessianType);
+    const int der2Size = curDer2.Data.ysize();
+    Y_ASSERT(ders.size() >= (size_t)count * approxDimension);
+    Y_ASSERT(der2s.empty() || der2s.size() >= (size_t)count * der2Size);
+    for (int i = start; i < start + count; ++i) {
+        for (int dim = 0; dim < approxDimension; ++dim) {
+            curApprox[dim] = hasDelta ? UpdateApprox(IsExpApprox, approxes[dim][i], approxDeltas[dim][i]) : approxes[dim][i];
+        }
+        CalcDersMulti(curApprox, targets[i], weights ? weights[i] : 1, &curDer, der2s.empty() ? nullptr : &curDer2);
+        Copy(curDer.begin(), curDer.end(), ders.begin() + (size_t)(i - start) * approxDimension);
+        if (!der2s.empty()) {
+            Copy(curDer2.Data.begin(), curDer2.Data.end(), der2s.begin() + (size_t)(i - start) * der2Size);
+        }
+    }
+}
+
+// objects are processed by tiles of about this number of values,
+// exponents of a tile are calculated with one vectorized FastExpInplace call
+static constexpr int SOFTMAX_TILE_VALUE_COUNT = 1024;
+
+void TMultiClassError::CalcDersMultiRange(
+    int start,
+    int count,
+    const TVector<TVector<double>>& approxes,
+    const TVector<TVector<double>>& approxDeltas,
+    const float* targets,
+    const float* weights,
+    TArrayRef<double> ders,
+    TArrayRef<double> der2s
+) const {
+    const int approxDimension = approxes.ysize();
+    const bool hasDelta = !approxDeltas.empty();
+    const int der2Size = TSymmetricHessian::CalcInternalDer2DataSize(approxDimension);
+    Y_ASSERT(ders.size() >= (size_t)count * approxDimension);
+    Y_ASSERT(der2s.empty() || der2s.size() >= (size_t)count * der2Size);
+
+    const int tileSize = Max(1, SOFTMAX_TILE_VALUE_COUNT / approxDimension);
+    TVector<double> softmax; // [(objectIdx - tileStart) * approxDimension + dim]
+    softmax.yresize(tileSize * approxDimension);
+    for (int tileStart = start; tileStart < start + count; tileStart += tileSize) {
+        const int tileEnd = Min(tileStart + tileSize, start + count);
+        for (int dim = 0; dim < approxDimension; ++dim) {
+            const double* approx = approxes[dim].data();
+            const double* approxDelta = hasDelta ? approxDeltas[dim].data() : nullptr;
+            for (int i = tileStart; i < tileEnd; ++i) {
+                softmax[(i - tileStart) * approxDimension + dim] = hasDelta ? approx[i] + approxDelta[i] : approx[i];
+            }
+        }
+        for (int i = tileStart; i < tileEnd; ++i) {
+            double* objectSoftmax = softmax.data() + (i - tileStart) * approxDimension;
+            const double maxApprox = *MaxElement(objectSoftmax, objectSoftmax + approxDimension);
+            for (int dim = 0; dim < approxDimension; ++dim) {
+                objectSoftmax[dim] -= maxApprox;
+            }
+        }
+        FastExpInplace(softmax.data(), (tileEnd - tileStart) * approxDimension);
+
+        for (int i = tileStart; i < tileEnd; ++i) {
+            double* objectSoftmax = softmax.data() + (i - tileStart) * approxDimension;
+            double sumExpApprox = 0;
+            for (int dim = 0; dim < approxDimension; ++dim) {
+                sumExpApprox += objectSoftmax[dim];
+            }
+            for (int dim = 0; dim < approxDimension; ++dim) {
+                objectSoftmax[dim] /= sumExpApprox;
+            }
+
+            const double weight = weights ? weights[i] : 1.0;
+            double* objectDers = ders.data() + (size_t)(i - start) * approxDimension;
+            for (int dim = 0; dim < approxDimension; ++dim) {
+                objectDers[dim] = -weight * objectSoftmax[dim];
+            }
+            objectDers[static_cast<int>(targets[i])] += weight;
+
+            if (!der2s.empty()) {
+                double* objectDer2s = der2s.data() + (size_t)(i - start) * der2Size;
+                for (int dimY = 0; dimY < approxDimension; ++dimY) {
+                    const double weightedSoftmaxY = weight * objectSoftmax[dimY];
+                    *objectDer2s++ = weightedSoftmaxY * (objectSoftmax[dimY] - 1);
+                    for (int dimX = dimY + 1; dimX < approxDimension; ++dimX) {
+                        *objectDer2s++ = weightedSoftmaxY * objectSoftmax[dimX];
+                    }
+                }
+            }
+        }
+    }
+}
+
+void TCustomError::CalcDersMultiRange(
+    int start,
+    int count,
+    const TVector<TVector<double>>& approxes,
+    const TVector<TVector<double>>& approxDeltas,
+    const float* targets,
+    const float* weights,
+    TArrayRef<double> ders,
+    TArrayRef<double> der2s
+) const {
+    if (Descriptor.CalcDersMultiRange == nullptr) {
+        IDerCalcer::CalcDersMultiRange(start, count, approxes, approxDeltas, targets, weights, ders, der2s);
+        return;
+    }
+    const int approxDimension = approxes.ysize();
+    Y_ASSERT(ders.size() >= (size_t)count * approxDimension);
+    Y_ASSERT(der2s.empty() || der2s.size() >= (size_t)count * CalcInternalDer2DataSize(GetHessianType(), approxDimension));
+    TVector<double> flatApproxes; // [dim * count + objectIdx]
+    flatApproxes.yresize(count * approxDimension);
+    for (int dim = 0; dim < approxDimension; ++dim) {
+        double* dimApprox = flatApproxes.data() + dim * count;
+        Copy(approxes[dim].begin() + start, approxes[dim].begin() + start + count, dimApprox);
+        if (!approxDeltas.empty()) {
+            const double* dimDelta = approxDeltas[dim].data() + start;
+            for (int i = 0; i < count; ++i) {
+                dimApprox[i] += dimDelta[i];
+            }
+        }
+    }
+    Descriptor.CalcDersMultiRange(
+        count,
+        approxDimension,
+        flatApproxes.data(),
+        targets + start,
+        weights ? (weights + start) : nullptr,
+        ders.data(),
+        der2s.empty() ? nullptr : der2s.data(),
+        Descriptor.CustomData);
+}
+
+template <class TError>
+template <int MaxDerivativeOrder, bool UseTDers, bool HasDelta>
+void TDerCalcerWithInlinedDers<TError>::CalcDersRangeImpl(
+    int start,
+    int count,
+    const double* approxes,
+    const double* approxDeltas,
+    const float* targets,
+    const float* weights,
+    TDers* ders,
+    double* firstDers
+) const {
+    constexpr bool UseExpApprox = TError::UseExpApprox;
+    Y_ASSERT(UseExpApprox == GetIsExpApprox());
+    Y_ASSERT(HasDelta == (approxDeltas != nullptr));
+    Y_ASSERT(UseTDers == (ders != nullptr) && (ders != nullptr) == (firstDers == nullptr));
+    Y_ASSERT((MaxDerivativeOrder > 1) <= (ders != nullptr));
+    const TError& error = static_cast<const TError&>(*this);
+#pragma clang loop vectorize_width(4) interleave_count(2)
+    for (int i = start; i < start + count; ++i) {
+        double updatedApprox = approxes[i];
+        if (HasDelta) {
+            updatedApprox = UpdateApprox<UseExpApprox>(updatedApprox, approxDeltas[i]);
+        }
+        if (UseTDers) {
+            ders[i].Der1 = error.TError::CalcDer(updatedApprox, targets[i]);
+        } else {
+            firstDers[i] = error.TError::CalcDer(updatedApprox, targets[i]);
+        }
+        if (MaxDerivativeOrder >= 2) {
+            ders[i].Der2 = error.TError::CalcDer2(updatedApprox, targets[i]);
+        }
+        if (MaxDerivativeOrder >= 3) {
+            ders[i].Der3 = error.TError::CalcDer3(updatedApprox, targets[i]);
+        }
+    }
+    if (weights != nullptr) {
+#pragma clang loop vectorize_width(4) interleave_count(2)
+        for (int i = start; i < start + count; ++i) {
+            if (UseTDers) {
+                ders[i].Der1 *= weights[i];
+            } else {
+                firstDers[i] *= weights[i];
+            }
+            if (MaxDerivativeOrder >= 2) {
+                ders[i].Der2 *= weights[i];
+            }
+            if (MaxDerivativeOrder >= 3) {
+                ders[i].Der3 *= weights[i];
+            }
+        }
+    }
+}
+
+template <class TError>
+void TDerCalcerWithInlinedDers<TError>::CalcDersRange(
+    int start,
+    int count,
+    int maxDerivativeOrder,
+    const double* approxes,
+    const double* approxDeltas,
+    const float* targets,
+    const float* weights,
+    TDers* ders,
+    double* firstDers
+) const {
+    const bool hasDelta = approxDeltas != nullptr;
+    const bool useTDers = ders != nullptr;
+    switch (EncodeImplParameters(maxDerivativeOrder, useTDers, TError::UseExpApprox, hasDelta)) {
+        case EncodeImplParameters(1, false, TError::UseExpApprox, false):
+            return CalcDersRangeImpl<1, false, false>(start, count, approxes, approxDeltas, targets, weights, ders, firstDers);
+        case EncodeImplParameters(1, false, TError::UseExpApprox, true):
+            return CalcDersRangeImpl<1, false, true>(start, count, approxes, approxDeltas, targets, weights, ders, firstDers);
+        case EncodeImplParameters(1, true, TError::UseExpApprox, false):
+            return CalcDersRangeImpl<1, true, false>(start, count, approxes, approxDeltas, targets, weights, ders, firstDers);
+        case EncodeImplParameters(1, true, TError::UseExpApprox, true):
+            return CalcDersRangeImpl<1, true, true>(start, count, approxes, approxDeltas, targets, weights, ders, firstDers);
+        case EncodeImplParameters(2, true, TError::UseExpApprox, false):
+            return CalcDersRangeImpl<2, true, false>(start, count, approxes, approxDeltas, targets, weights, ders, firstDers);
+        case EncodeImplParameters(2, true, TError::UseExpApprox, true):
+            return CalcDersRangeImpl<2, true, true>(start, count, approxes, approxDeltas, targets, weights, ders, firstDers);
+        case EncodeImplParameters(3, true, TError::UseExpApprox, false):
+            return CalcDersRangeImpl<3, true, false>(start, count, approxes, approxDeltas, targets, weights, ders, firstDers);
+        case EncodeImplParameters(3, true, TError::UseExpApprox, true):
+            return CalcDersRangeImpl<3, true, true>(start, count, approxes, approxDeltas, targets, weights, ders, firstDers);
+        default:
+            Y_ASSERT(false);
+    }
+}
+
+template <class TError>
+void TDerCalcerWithInlinedDers<TError>::CalcFirstDerRange(
+    int start,
+    int count,
+    const double* approxes,
+    const double* approxDeltas,
+    const float* targets,
+    const float* weights,
+    double* firstDers
+) const {
+    CalcDersRange(start, count, /*maxDerivativeOrder*/ 1, approxes, approxDeltas, targets, weights, /*ders*/ nullptr, firstDers);
+}
+
+template <class TError>
+void TDerCalcerWithInlinedDers<TError>::CalcDersRange(
+    int start,
+    int count,
+    bool calcThirdDer,
+    const double* approxes,
+    const double* approxDeltas,
+    const float* targets,
+    const float* weights,
+    TDers* ders
+) const {
+    const int maxDerivativeOrder = calcThirdDer ? 3 : Min(GetMaxSupportedDerivativeOrder(), 2u);
+    CalcDersRange(start, count, maxDerivativeOrder, approxes, approxDeltas, targets, weights, ders, /*firstDers*/ nullptr);
+}
+
+template class TDerCalcerWithInlinedDers<TRMSEError>;
+template class TDerCalcerWithInlinedDers<TQuantileError>;
+template class TDerCalcerWithInlinedDers<TPoissonError>;
+
 namespace {
     template <int Capacity>
     class TExpForwardView {
@@ -149,33 +415,38 @@ static void CalcCrossEntropyDerRangeImpl(
     TDers* ders,
     double* firstDers
 ) {
-    TExpForwardView</*Capacity*/16> expApproxes(MakeArrayRef(approxes + start, count), 0);
-    TExpForwardView</*Capacity*/16> expApproxDeltas(MakeArrayRef(approxDeltas + start, count), 0);
     Y_ASSERT(HasDelta == (approxDeltas != nullptr));
-#pragma clang loop vectorize_width(4) interleave_count(2)
-    for (int i = start; i < start + count; ++i) {
-        double e;
+    // exponents are calculated by blocks with vectorized FastExpInplace, so that the loops below
+    // do not depend on the exp implementation and can be vectorized too
+    constexpr int BlockSize = 128;
+    std::array<double, BlockSize> expApproxes;
+    for (int blockStart = start; blockStart < start + count; blockStart += BlockSize) {
+        const int blockEnd = Min(blockStart + BlockSize, start + count);
         if (UseExpApprox) {
-            e = approxes[i];
+#pragma clang loop vectorize_width(4) interleave_count(2)
+            for (int i = blockStart; i < blockEnd; ++i) {
+                expApproxes[i - blockStart] = HasDelta ? approxes[i] * approxDeltas[i] : approxes[i];
+            }
         } else {
-            e = expApproxes[i - start];
-        }
-        if (HasDelta) {
-            if (UseExpApprox) {
-                e *= approxDeltas[i];
-            } else {
-                e *= expApproxDeltas[i - start];
+#pragma clang loop vectorize_width(4) interleave_count(2)
+            for (int i = blockStart; i < blockEnd; ++i) {
+                expApproxes[i - blockStart] = HasDelta ? approxes[i] + approxDeltas[i] : approxes[i];
             }
+            FastExpInplace(expApproxes.data(), blockEnd - blockStart);
         }
-        const double p = e / (1 + e);
-        if (UseTDers) {
-            ders[i].Der1 = targets[i] - p;
-            ders[i].Der2 = -p * (1 - p);
-            if (CalcThirdDer) {
-                ders[i].Der3 = -p * (1 - p) * (1 - 2 * p);
+#pragma clang loop vectorize_width(4) interleave_count(2)
+        for (int i = blockStart; i < blockEnd; ++i) {
+            const double e = expApproxes[i - blockStart];
+            const double p = e / (1 + e);
+            if (UseTDers) {
+                ders[i].Der1 = targets[i] - p;
+                ders[i].Der2 = -p * (1 - p);
+                if (CalcThirdDer) {
+                    ders[i].Der3 = -p * (1 - p) * (1 - 2 * p);
+                }
+            } else {
+                firstDers[i] = targets[i] - p;
             }
-        } else {
-            firstDers[i] = targets[i] - p;
         }
     }
     if (weights != nullptr) {
@@ -14,6 +14,8 @@
 #include <library/fast_exp/fast_exp.h>
 #include <library/threading/local_executor/local_executor.h>
 
+#include <util/generic/algorithm.h>
+#include <util/generic/array_ref.h>
 #include <util/generic/vector.h>
 #include <util/generic/ymath.h>
 #include <util/system/yassert.h>
@@ -88,6 +90,20 @@ public:
         CB_ENSURE(false, "Not implemented");
     }
 
+    // Derivatives of objects [start, start + count) for approxDimension > 1, ders of object are stored
+    // contiguously in ders and der2s (der2s in THessianInfo::Data layout, can be empty if not needed).
+    // Default implementation calls CalcDersMulti for each object.
+    virtual void CalcDersMultiRange(
+        int start,
+        int count,
+        const TVector<TVector<double>>& approxes, // [dim][objectIdx]
+        const TVector<TVector<double>>& approxDeltas, // [dim][objectIdx], can be empty
+        const float* targets,
+        const float* weights, // can be nullptr
+        TArrayRef<double> ders, // [(objectIdx - start) * approxDimension + dim]
+        TArrayRef<double> der2s // [(objectIdx - start) * der2Size + der2Idx]
+    ) const;
+
     virtual void CalcDersForQueries(
         int /*queryStartIndex*/,
         int /*queryEndIndex*/,
@@ -144,6 +160,60 @@ private:
     ) const;
 };
 
+// Range derivatives of TError with its CalcDer, CalcDer2 and CalcDer3 inlined into the loops
+// instead of being called virtually for each object.
+template <class TError>
+class TDerCalcerWithInlinedDers : public IDerCalcer {
+public:
+    using IDerCalcer::IDerCalcer;
+
+    void CalcFirstDerRange(
+        int start,
+        int count,
+        const double* approxes,
+        const double* approxDeltas,
+        const float* targets,
+        const float* weights,
+        double* firstDers
+    ) const override;
+
+    void CalcDersRange(
+        int start,
+        int count,
+        bool calcThirdDer,
+        const double* approxes,
+        const double* approxDeltas,
+        const float* targets,
+        const float* weights,
+        TDers* ders
+    ) const override;
+
+private:
+    template <int MaxDerivativeOrder, bool UseTDers, bool HasDelta>
+    void CalcDersRangeImpl(
+        int start,
+        int count,
+        const double* approxes,
+        const double* approxDeltas,
+        const float* targets,
+        const float* weights,
+        TDers* ders,
+        double* firstDers
+    ) const;
+
+    void CalcDersRange(
+        int start,
+        int count,
+        int maxDerivativeOrder,
+        const double* approxes,
+        const double* approxDeltas,
+        const float* targets,
+        const float* weights,
+        TDers* ders,
+        double* firstDers
+    ) const;
+};
+
 class TCrossEntropyError final : public IDerCalcer {
 public:
     explicit TCrossEntropyError(bool isExpApprox)
@@ -173,13 +243,16 @@ public:
     ) const override;
 };
 
-class TRMSEError final : public IDerCalcer {
+class TRMSEError final : public TDerCalcerWithInlinedDers<TRMSEError> {
+    friend class TDerCalcerWithInlinedDers<TRMSEError>;
+
 public:
+    static constexpr bool UseExpApprox = false;
     static constexpr double RMSE_DER2 = -1.0;
     static constexpr double RMSE_DER3 = 0.0;
 
     explicit TRMSEError(bool isExpApprox)
-    : IDerCalcer(isExpApprox)
+    : TDerCalcerWithInlinedDers(isExpApprox)
     {
         CB_ENSURE(isExpApprox == false, "Approx format does not match");
     }
@@ -198,21 +271,24 @@ private:
     }
 };
 
-class TQuantileError final : public IDerCalcer {
+class TQuantileError final : public TDerCalcerWithInlinedDers<TQuantileError> {
+    friend class TDerCalcerWithInlinedDers<TQuantileError>;
+
 public:
+    static constexpr bool UseExpApprox = false;
     static constexpr double QUANTILE_DER2_AND_DER3 = 0.0;
 
     const double Alpha;
 
     explicit TQuantileError(bool isExpApprox)
-    : IDerCalcer(isExpApprox)
+    : TDerCalcerWithInlinedDers(isExpApprox)
     , Alpha(0.5)
     {
         CB_ENSURE(isExpApprox == false, "Approx format does not match");
     }
 
     TQuantileError(double alpha, bool isExpApprox)
-    : IDerCalcer(isExpApprox)
+    : TDerCalcerWithInlinedDers(isExpApprox)
     , Alpha(alpha)
     {
         Y_ASSERT(Alpha > -1e-6 && Alpha < 1.0 + 1e-6);
@@ -322,10 +398,14 @@ private:
     }
 };
 
-class TPoissonError final : public IDerCalcer {
+class TPoissonError final : public TDerCalcerWithInlinedDers<TPoissonError> {
+    friend class TDerCalcerWithInlinedDers<TPoissonError>;
+
 public:
+    static constexpr bool UseExpApprox = true;
+
     explicit TPoissonError(bool isExpApprox)
-    : IDerCalcer(isExpApprox)
+    : TDerCalcerWithInlinedDers(isExpApprox)
     {
         CB_ENSURE(isExpApprox == true, "Approx format does not match");
     }
@@ -361,14 +441,9 @@ public:
     ) const override {
         const int approxDimension = approx.ysize();
 
-        TVector<double> softmax(approxDimension);
-        CalcSoftmax(approx, &softmax);
-
-        for (int dim = 0; dim < approxDimension; ++dim) {
-            (*der)[dim] = -softmax[dim];
-        }
-        int targetClass = static_cast<int>(target);
-        (*der)[targetClass] += 1;
+        // der holds softmax until derivatives are calculated from it
+        CalcSoftmax(approx, der);
+        const TVector<double>& softmax = *der;
 
         if (der2 != nullptr) {
             Y_ASSERT(der2->HessianType == EHessianType::Symmetric &&
@@ -382,6 +457,12 @@ public:
             }
         }
 
+        for (int dim = 0; dim < approxDimension; ++dim) {
+            (*der)[dim] = -softmax[dim];
+        }
+        int targetClass = static_cast<int>(target);
+        (*der)[targetClass] += 1;
+
         if (weight != 1) {
             for (int dim = 0; dim < approxDimension; ++dim) {
                 (*der)[dim] *= weight;
@@ -396,6 +477,17 @@ public:
             }
         }
     }
+
+    void CalcDersMultiRange(
+        int start,
+        int count,
+        const TVector<TVector<double>>& approxes,
+        const TVector<TVector<double>>& approxDeltas,
+        const float* targets,
+        const float* weights,
+        TArrayRef<double> ders,
+        TArrayRef<double> der2s
+    ) const override;
 };
 
 class TMultiClassOneVsAllError final : public IDerCalcer {
@@ -415,14 +507,13 @@ public:
     ) const override {
         const int approxDimension = approx.ysize();
 
-        TVector<double> prob = approx;
-        FastExpInplace(prob.data(), prob.ysize());
+        // der holds probabilities until derivatives are calculated from them
+        TVector<double>& prob = *der;
+        Copy(approx.begin(), approx.end(), prob.begin());
+        FastExpInplace(prob.data(), approxDimension);
         for (int dim = 0; dim < approxDimension; ++dim) {
             prob[dim] /= (1 + prob[dim]);
-            (*der)[dim] = -prob[dim];
         }
-        int targetClass = static_cast<int>(target);
-        (*der)[targetClass] += 1;
 
         if (der2 != nullptr) {
             Y_ASSERT(der2->HessianType == EHessianType::Diagonal &&
@@ -432,6 +523,12 @@ public:
             }
         }
 
+        for (int dim = 0; dim < approxDimension; ++dim) {
+            (*der)[dim] = -prob[dim];
+        }
+        int targetClass = static_cast<int>(target);
+        (*der)[targetClass] += 1;
+
         if (weight != 1) {
             for (int dim = 0; dim < approxDimension; ++dim) {
                 (*der)[dim] *= weight;
@@ -610,6 +707,17 @@ public:
         Descriptor.CalcDersMulti(approx, target, weight, der, der2, Descriptor.CustomData);
     }
 
+    void CalcDersMultiRange(
+        int start,
+        int count,
+        const TVector<TVector<double>>& approxes,
+        const TVector<TVector<double>>& approxDeltas,
+        const float* targets,
+        const float* weights,
+        TArrayRef<double> ders,
+        TArrayRef<double> der2s
+    ) const override;
+
     void CalcDersRange(
         int start,
         int count,
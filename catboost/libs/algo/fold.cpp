@@ -118,6 +118,7 @@ TFold TFold::BuildDynamicFold(
     double multiplier,
     bool storeExpApproxes,
     bool hasPairwiseWeights,
+    bool singlePrecisionDerivatives,
     TRestorableFastRng64& rand,
     NPar::TLocalExecutor* localExecutor
 ) {
@@ -171,8 +172,6 @@ TFold TFold::BuildDynamicFold(
         if (!baseline.empty()) {
             InitFromBaseline(leftPartLen, bt.TailFinish, baseline, ff.GetLearnPermutationArray(), storeExpApproxes, &bt.Approx);
         }
-        bt.WeightedDerivatives.resize(approxDimension, TVector<double>(bt.TailFinish));
-        bt.SampleWeightedDerivatives.resize(approxDimension, TVector<double>(bt.TailFinish));
         if (hasPairwiseWeights) {
             bt.PairwiseWeights.resize(bt.TailFinish);
             bt.PairwiseWeights.insert(bt.PairwiseWeights.begin(), pairwiseWeights.begin(), pairwiseWeights.begin() + bt.TailFinish);
@@ -181,6 +180,7 @@ TFold TFold::BuildDynamicFold(
         ff.BodyTailArr.emplace_back(std::move(bt));
         leftPartLen = (ui32)bt.TailFinish;
     }
+    ff.AllocateDerivatives(approxDimension, /*storeSampleWeightedTailOnly*/ true, singlePrecisionDerivatives);
     return ff;
 }
 
@@ -201,6 +201,7 @@ TFold TFold::BuildPlainFold(
     int approxDimension,
     bool storeExpApproxes,
     bool hasPairwiseWeights,
+    bool singlePrecisionDerivatives,
     TRestorableFastRng64& rand,
     NPar::TLocalExecutor* localExecutor
 ) {
@@ -229,8 +230,6 @@ TFold TFold::BuildPlainFold(
     TFold::TBodyTail bt(groupCountAsInt, groupCountAsInt, learnSampleCountAsInt, learnSampleCountAsInt, ff.GetSumWeight());
 
     bt.Approx.resize(approxDimension, TVector<double>(learnSampleCount, GetNeutralApprox(storeExpApproxes)));
-    bt.WeightedDerivatives.resize(approxDimension, TVector<double>(learnSampleCount));
-    bt.SampleWeightedDerivatives.resize(approxDimension, TVector<double>(learnSampleCount));
     if (hasPairwiseWeights) {
         bt.PairwiseWeights.resize(learnSampleCount);
         CalcPairwiseWeights(ff.LearnQueriesInfo, bt.TailQueryFinish, &bt.PairwiseWeights);
@@ -242,9 +241,22 @@ TFold TFold::BuildPlainFold(
         InitFromBaseline(0, learnSampleCount, baseline, ff.GetLearnPermutationArray(), storeExpApproxes, &bt.Approx);
     }
     ff.BodyTailArr.emplace_back(std::move(bt));
+    ff.AllocateDerivatives(approxDimension, /*storeSampleWeightedTailOnly*/ false, singlePrecisionDerivatives);
     return ff;
 }
 
+void TFold::AllocateDerivatives(int approxDimension, bool storeSampleWeightedTailOnly, bool singlePrecision) {
+    Derivatives = TDerivativesArena(singlePrecision);
+    for (auto& bt : BodyTailArr) {
+        const int sampleWeightedBegin = storeSampleWeightedTailOnly ? bt.BodyFinish : 0;
+        for (int dim = 0; dim < approxDimension; ++dim) {
+            bt.WeightedDerivatives.push_back(Derivatives.AddRange(0, bt.TailFinish));
+            bt.SampleWeightedDerivatives.push_back(Derivatives.AddRange(sampleWeightedBegin, bt.TailFinish));
+        }
+    }
+    Derivatives.Allocate();
+}
+
 
 void TFold::DropEmptyCTRs() {
     TVector<TProjection> emptyProjections;
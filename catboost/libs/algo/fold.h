@@ -25,6 +25,69 @@
 
 struct TRestorableFastRng64;
 
+/* Derivatives of all body/tail segments of a fold live in a single buffer and are addressed by
+ * offsets, so a fold can be moved or copied without fixing up pointers. With single precision
+ * storage they take half of the memory, computations are still done in double.
+ */
+class TDerivativesArena {
+public:
+    struct TRange {
+        size_t Offset = 0;
+        int Begin = 0; // index of the first document stored
+        int End = 0;
+    };
+
+public:
+    explicit TDerivativesArena(bool isSinglePrecision = false)
+        : IsSinglePrecisionFlag(isSinglePrecision) {
+    }
+
+    bool IsSinglePrecision() const {
+        return IsSinglePrecisionFlag;
+    }
+
+    // reserves place for documents [begin, end), memory is allocated by Allocate
+    TRange AddRange(int begin, int end) {
+        Y_ASSERT(begin <= end);
+        const TRange range{Size, begin, end};
+        Size += end - begin;
+        return range;
+    }
+
+    void Allocate() {
+        if (IsSinglePrecisionFlag) {
+            SingleData.resize(Size);
+        } else {
+            DoubleData.resize(Size);
+        }
+    }
+
+    // func is called with TArrayRef<double> or TArrayRef<float> indexed from range.Begin
+    template <typename TFunc>
+    void Visit(const TRange& range, TFunc&& func) {
+        if (IsSinglePrecisionFlag) {
+            func(MakeArrayRef(SingleData.data() + range.Offset, range.End - range.Begin));
+        } else {
+            func(MakeArrayRef(DoubleData.data() + range.Offset, range.End - range.Begin));
+        }
+    }
+
+    template <typename TFunc>
+    void Visit(const TRange& range, TFunc&& func) const {
+        if (IsSinglePrecisionFlag) {
+            func(TConstArrayRef<float>(SingleData.data() + range.Offset, range.End - range.Begin));
+        } else {
+            func(TConstArrayRef<double>(DoubleData.data() + range.Offset, range.End - range.Begin));
+        }
+    }
+
+private:
+    bool IsSinglePrecisionFlag;
+    size_t Size = 0;
+    TVector<double> DoubleData;
+    TVector<float> SingleData;
+};
+
 struct TFold {
     struct TBodyTail {
         TBodyTail(int bodyQueryFinish,
@@ -40,9 +103,9 @@ struct TFold {
         }
 
         TVector<TVector<double>> Approx;  // [dim][]
-        TVector<TVector<double>> WeightedDerivatives;  // [dim][]
-        // TODO(annaveronika): make a single vector<vector> for all BodyTail
-        TVector<TVector<double>> SampleWeightedDerivatives;  // [dim][]
+        TVector<TDerivativesArena::TRange> WeightedDerivatives;  // [dim] in TFold::Derivatives
+        // ordered boosting uses sample weighted derivatives of the tail only, so the body is not stored
+        TVector<TDerivativesArena::TRange> SampleWeightedDerivatives;  // [dim] in TFold::Derivatives
         TVector<float> PairwiseWeights;  // [dim][]
         TVector<float> SamplePairwiseWeights;  // [dim][]
 
@@ -75,6 +138,7 @@ struct TFold {
     ui32 FeaturesSubsetBegin;
 
     TVector<TBodyTail> BodyTailArr;
+    TDerivativesArena Derivatives;
     TVector<float> LearnTarget;
     TVector<float> SampleWeights; // Resulting bootstrapped weights of documents.
     TVector<TVector<int>> LearnTargetClass;
@@ -139,6 +203,7 @@ struct TFold {
         double multiplier,
         bool storeExpApproxes,
         bool hasPairwiseWeights,
+        bool singlePrecisionDerivatives,
         TRestorableFastRng64& rand,
         NPar::TLocalExecutor* localExecutor
     );
@@ -151,6 +216,7 @@ struct TFold {
         int approxDimension,
         bool storeExpApproxes,
         bool hasPairwiseWeights,
+        bool singlePrecisionDerivatives,
         TRestorableFastRng64& rand,
         NPar::TLocalExecutor* localExecutor
     );
@@ -173,6 +239,7 @@ private:
     void AssignTarget(NCB::TMaybeData<TConstArrayRef<float>> target,
                       const TVector<TTargetClassifier>& targetClassifiers);
     void SetWeights(TConstArrayRef<float> weights, ui32 learnSampleCount);
+    void AllocateDerivatives(int approxDimension, bool storeSampleWeightedTailOnly, bool singlePrecision);
 };
 
 class TDataset;
@@ -29,16 +29,27 @@ void TrimOnlineCTRcache(const TVector<TFold*>& folds) {
     }
 }
 
+static double CalcSquaredNorm(TConstArrayRef<double> values) {
+    // TODO(yazevnul): replace with `L2NormSquared` when it's implemented
+    return DotProduct(values.data(), values.data(), values.size());
+}
+
+static double CalcSquaredNorm(TConstArrayRef<float> values) {
+    double sum2 = 0;
+    for (float value : values) {
+        sum2 += (double)value * value;
+    }
+    return sum2;
+}
+
 static double CalcDerivativesStDevFromZeroOrderedBoosting(const TFold& fold) {
     double sum2 = 0;
     size_t count = 0;
     for (const auto& bt : fold.BodyTailArr) {
         for (const auto& perDimensionWeightedDerivatives : bt.WeightedDerivatives) {
-            // TODO(yazevnul): replace with `L2NormSquared` when it's implemented
-            sum2 += DotProduct(
-                perDimensionWeightedDerivatives.data() + bt.BodyFinish,
-                perDimensionWeightedDerivatives.data() + bt.BodyFinish,
-                bt.TailFinish - bt.BodyFinish);
+            fold.Derivatives.Visit(perDimensionWeightedDerivatives, [&](auto weightedDerivatives) {
+                sum2 += CalcSquaredNorm(weightedDerivatives.Slice(bt.BodyFinish, bt.TailFinish - bt.BodyFinish));
+            });
         }
 
         count += bt.TailFinish - bt.BodyFinish;
@@ -52,17 +63,16 @@ static double CalcDerivativesStDevFromZeroPlainBoosting(const TFold& fold) {
     Y_ASSERT(fold.BodyTailArr.size() == 1);
     Y_ASSERT(fold.BodyTailArr.front().WeightedDerivatives.size() > 0);
 
-    const auto& weightedDerivatives = fold.BodyTailArr.front().WeightedDerivatives;
+    const auto& bt = fold.BodyTailArr.front();
 
     double sum2 = 0;
-    for (const auto& perDimensionWeightedDerivatives : weightedDerivatives) {
-        sum2 += DotProduct(
-            perDimensionWeightedDerivatives.data(),
-            perDimensionWeightedDerivatives.data(),
-            perDimensionWeightedDerivatives.size());
+    for (const auto& perDimensionWeightedDerivatives : bt.WeightedDerivatives) {
+        fold.Derivatives.Visit(perDimensionWeightedDerivatives, [&](auto weightedDerivatives) {
+            sum2 += CalcSquaredNorm(weightedDerivatives);
+        });
     }
 
-    return sqrt(sum2 / weightedDerivatives.front().size());
+    return sqrt(sum2 / bt.TailFinish);
 }
 
 static double CalcDerivativesStDevFromZero(const TFold& fold, const EBoostingType boosting) {
@@ -276,6 +286,17 @@ static void AddTreeCtrs(const TQuantizedForCPUObjectsDataProvider& learnObjectsD
     }
 }
 
+static TVector<TProjection> GetOnlineCtrProjections(const TCandidateList& candList) {
+    TVector<TProjection> projections;
+    for (const auto& candidate : candList) {
+        const auto& splitCandidate = candidate.Candidates[0].SplitCandidate;
+        if (splitCandidate.Type == ESplitType::OnlineCtr) {
+            projections.push_back(splitCandidate.Ctr.Projection);
+        }
+    }
+    return projections;
+}
+
 static void SelectCtrsToDropAfterCalc(size_t memoryLimit,
                                       int sampleCount,
                                       int threadCount,
@@ -328,7 +349,54 @@ static void CalcBestScore(const TTrainingForCPUDataProviders& data,
     CB_ENSURE(static_cast<ui32>(ctx->LocalExecutor->GetThreadCount()) == ctx->Params.SystemOptions->NumThreads - 1);
     const TFlatPairsInfo pairs = UnpackPairsFromQueries(fold->LearnQueriesInfo);
     TCandidateList& candList = *candidateList;
-    ctx->LocalExecutor->ExecRange([&](int id) {
+
+    // Float and one-hot candidates are scored in groups, histograms of a group are built in one pass over documents
+    TVector<TVector<int>> fusedCandidateGroups;
+    TVector<int> otherCandidates;
+    if (!IsPairwiseScoring(ctx->Params.LossFunctionDescription->GetLossFunction())) {
+        for (int id : xrange(candList.ysize())) {
+            if (candList[id].Candidates[0].SplitCandidate.Type == ESplitType::OnlineCtr) {
+                otherCandidates.push_back(id);
+                continue;
+            }
+            Y_ASSERT(candList[id].Candidates.size() == 1);
+            if (fusedCandidateGroups.empty() || fusedCandidateGroups.back().ysize() == FUSED_HISTOGRAM_MAX_FEATURE_COUNT) {
+                fusedCandidateGroups.emplace_back();
+            }
+            fusedCandidateGroups.back().push_back(id);
+        }
+    } else {
+        otherCandidates.resize(candList.size());
+        Iota(otherCandidates.begin(), otherCandidates.end(), 0);
+    }
+
+    ctx->LocalExecutor->ExecRange([&](int groupIdx) {
+        const auto& group = fusedCandidateGroups[groupIdx];
+        TVector<TSplitCandidate> splits;
+        for (int id : group) {
+            splits.push_back(candList[id].Candidates[0].SplitCandidate);
+        }
+        TVector<TVector<TScoreBin>> scoreBins;
+        CalcScoresForFeatureGroup(*data.Learn->ObjectsData,
+                                  splitCounts,
+                                  ctx->SampledDocs,
+                                  ctx->SmallestSplitSideDocs,
+                                  *fold,
+                                  ctx->Params,
+                                  splits,
+                                  currentDepth,
+                                  ctx->UseTreeLevelCaching(),
+                                  ctx->LocalExecutor,
+                                  &ctx->PrevTreeLevelStats,
+                                  &scoreBins);
+        for (auto i : xrange(group.size())) {
+            const TVector<TVector<double>> allScores = {GetScores(scoreBins[i])};
+            SetBestScore(randSeed + group[i], allScores, scoreStDev, &candList[group[i]].Candidates);
+        }
+    }, 0, fusedCandidateGroups.ysize(), NPar::TLocalExecutor::WAIT_COMPLETE);
+
+    ctx->LocalExecutor->ExecRange([&](int otherCandidateIdx) {
+        const int id = otherCandidates[otherCandidateIdx];
         auto& candidate = candList[id];
         if (candidate.Candidates[0].SplitCandidate.Type == ESplitType::OnlineCtr) {
             const auto& proj = candidate.Candidates[0].SplitCandidate.Ctr.Projection;
@@ -370,7 +438,7 @@ static void CalcBestScore(const TTrainingForCPUDataProviders& data,
             fold->GetCtrRef(candidate.Candidates[0].SplitCandidate.Ctr.Projection).Feature.clear();
         }
         SetBestScore(randSeed + id, allScores, scoreStDev, &candidate.Candidates);
-    }, 0, candList.ysize(), NPar::TLocalExecutor::WAIT_COMPLETE);
+    }, 0, otherCandidates.ysize(), NPar::TLocalExecutor::WAIT_COMPLETE);
 }
 
 void GreedyTensorSearch(const TTrainingForCPUDataProviders& data,
@@ -431,6 +499,7 @@ void GreedyTensorSearch(const TTrainingForCPUDataProviders& data,
             * CalcDerivativesStDevFromZero(*fold, ctx->Params.BoostingOptions->BoostingType)
             * CalcDerivativesStDevFromZeroMultiplier(learnSampleCount, modelLength);
         if (!ctx->Params.SystemOptions->IsSingleHost()) {
+            MapCalcOnlineCtrs(data, GetOnlineCtrProjections(candList), fold, ctx);
             if (isPairwiseScoring) {
                 MapRemotePairwiseCalcScore(scoreStDev, &candList, ctx);
             } else {
@@ -450,7 +519,9 @@ void GreedyTensorSearch(const TTrainingForCPUDataProviders& data,
             }
         }
 
-        fold->DropEmptyCTRs();
+        if (ctx->Params.SystemOptions->IsSingleHost()) { // master keeps unique value counts of ctrs calculated on workers
+            fold->DropEmptyCTRs();
+        }
         CheckInterrupted(); // check after long-lasting operation
         profile.AddOperation(TStringBuilder() << "Calc scores " << curDepth);
 
@@ -490,7 +561,7 @@ void GreedyTensorSearch(const TTrainingForCPUDataProviders& data,
             ctx->LearnProgress.UsedCtrSplits.insert(std::make_pair(ctrType, projection));
         }
         auto bestSplit = TSplit(bestSplitCandidate->SplitCandidate, bestSplitCandidate->BestBinBorderId);
-        if (bestSplit.Type == ESplitType::OnlineCtr) {
+        if (bestSplit.Type == ESplitType::OnlineCtr && ctx->Params.SystemOptions->IsSingleHost()) {
             const auto& proj = bestSplit.Ctr.Projection;
             if (fold->GetCtrRef(proj).Feature.empty()) {
                 ComputeOnlineCTRs(data,
@@ -513,7 +584,6 @@ void GreedyTensorSearch(const TTrainingForCPUDataProviders& data,
                 }
             }
         } else {
-            Y_ASSERT(bestSplit.Type != ESplitType::OnlineCtr);
             MapSetIndices(*bestSplitCandidate, ctx);
         }
         currentSplitTree.AddSplit(bestSplit);
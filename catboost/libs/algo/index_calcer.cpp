@@ -10,6 +10,8 @@
 #include <catboost/libs/model/formula_evaluator.h>
 #include <catboost/libs/helpers/dense_hash.h>
 
+#include <type_traits>
+
 
 using namespace NCB;
 
@@ -28,13 +30,6 @@ static inline ui8 GetFeatureSplitIdx(const TSplit& split) {
     return split.BinBorder;
 }
 
-static inline const ui8* GetFloatHistogram(
-    const TSplit& split,
-    const TQuantizedForCPUObjectsDataProvider& objectsDataProvider
-) {
-    return *(*objectsDataProvider.GetFloatFeature((ui32)split.FeatureIdx))->GetArrayData().GetSrc();
-}
-
 static inline const ui32* GetRemappedCatFeatures(
     const TSplit& split,
     const TQuantizedForCPUObjectsDataProvider& objectsDataProvider
@@ -42,8 +37,9 @@ static inline const ui32* GetRemappedCatFeatures(
     return *(*objectsDataProvider.GetCatFeature((ui32)split.FeatureIdx))->GetArrayData().GetSrc();
 }
 
-template <typename TCount, bool (*CmpOp)(TCount, TCount), int vectorWidth>
-void BuildIndicesKernel(const ui32* permutation, const TCount* histogram, TCount value, int level, TIndexType* indices) {
+// histogram is a pointer or bins of a packed feature
+template <typename TCount, bool (*CmpOp)(TCount, TCount), int vectorWidth, typename THistogram>
+void BuildIndicesKernel(const ui32* permutation, const THistogram& histogram, TCount value, int level, TIndexType* indices) {
     Y_ASSERT(vectorWidth == 4);
     const ui32 perm0 = permutation[0];
     const ui32 perm1 = permutation[1];
@@ -63,11 +59,11 @@ void BuildIndicesKernel(const ui32* permutation, const TCount* histogram, TCount
     indices[3] = idx3 + CmpOp(hist3, value) * level;
 }
 
-template <typename TCount, bool (*CmpOp)(TCount, TCount)>
+template <typename TCount, bool (*CmpOp)(TCount, TCount), typename THistogram>
 void OfflineCtrBlock(const NPar::TLocalExecutor::TExecRangeParams& params,
                      int blockIdx,
                      const ui32* permutation,
-                     const TCount* histogram,
+                     const THistogram& histogram,
                      TCount value,
                      int level,
                      TIndexType* indices) {
@@ -99,12 +95,17 @@ void SetPermutedIndices(const TSplit& split,
     const int splitWeight = 1 << (curDepth - 1);
     TIndexType* indicesData = indices->data();
     if (split.Type == ESplitType::FloatFeature) {
-        localExecutor->ExecRange([&](int blockIdx) {
-            OfflineCtrBlock<ui8, IsTrueHistogram>(blockParams, blockIdx,
-                fold.LearnPermutationFeaturesSubset.Get<TIndexedSubset<ui32>>().data(),
-                GetFloatHistogram(split, objectsDataProvider),
-                GetFeatureSplitIdx(split), splitWeight, indicesData);
-        }, 0, blockParams.GetBlockCount(), NPar::TLocalExecutor::WAIT_COMPLETE);
+        objectsDataProvider.DispatchFloatFeatureSrcBins(
+            (ui32)split.FeatureIdx,
+            [&] (const auto& floatHistogram) {
+                localExecutor->ExecRange([&](int blockIdx) {
+                    OfflineCtrBlock<ui8, IsTrueHistogram>(blockParams, blockIdx,
+                        fold.LearnPermutationFeaturesSubset.Get<TIndexedSubset<ui32>>().data(),
+                        floatHistogram,
+                        GetFeatureSplitIdx(split), splitWeight, indicesData);
+                }, 0, blockParams.GetBlockCount(), NPar::TLocalExecutor::WAIT_COMPLETE);
+            }
+        );
     } else if (split.Type == ESplitType::OnlineCtr) {
         auto& ctr = fold.GetCtr(split.Ctr.Projection);
         localExecutor->ExecRange([&] (int i) {
@@ -187,13 +188,36 @@ static void BuildIndicesForDataset(const TSplitTree& tree,
     NPar::TLocalExecutor::TExecRangeParams blockParams(0, (int)sampleCount);
     blockParams.SetBlockSize(blockSize);
 
+    // bins of packed features are read from their packs
+    using TPackedFloatFeatureSrcBins = TQuantizedForCPUObjectsDataProvider::TPackedFloatFeatureSrcBins;
+    TVector<const ui8*> floatHistograms(tree.GetDepth(), nullptr);
+    TVector<TMaybe<TPackedFloatFeatureSrcBins>> packedFloatHistograms(tree.GetDepth());
+    for (int splitIdx = 0; splitIdx < tree.GetDepth(); ++splitIdx) {
+        if (tree.Splits[splitIdx].Type == ESplitType::FloatFeature) {
+            objectsDataProvider.DispatchFloatFeatureSrcBins(
+                (ui32)tree.Splits[splitIdx].FeatureIdx,
+                [&] (const auto& srcBins) {
+                    if constexpr (std::is_same<std::decay_t<decltype(srcBins)>, TPackedFloatFeatureSrcBins>::value) {
+                        packedFloatHistograms[splitIdx] = srcBins;
+                    } else {
+                        floatHistograms[splitIdx] = srcBins;
+                    }
+                }
+            );
+        }
+    }
+
     auto updateLearnIndex = [&](int blockIdx) {
         for (int splitIdx = 0; splitIdx < tree.GetDepth(); ++splitIdx) {
             const auto& split = tree.Splits[splitIdx];
             const int splitWeight = 1 << splitIdx;
-            if (split.Type == ESplitType::FloatFeature) {
+            if (split.Type == ESplitType::FloatFeature && packedFloatHistograms[splitIdx]) {
+                OfflineCtrBlock<ui8, IsTrueHistogram>(blockParams, blockIdx, permutation,
+                    *packedFloatHistograms[splitIdx],
+                    GetFeatureSplitIdx(split), splitWeight, indices);
+            } else if (split.Type == ESplitType::FloatFeature) {
                 OfflineCtrBlock<ui8, IsTrueHistogram>(blockParams, blockIdx, permutation,
-                    GetFloatHistogram(split, objectsDataProvider),
+                    floatHistograms[splitIdx],
                     GetFeatureSplitIdx(split), splitWeight, indices);
             } else if (split.Type == ESplitType::OnlineCtr) {
                 const TOnlineCTR& splitOnlineCtr = *onlineCtrs[splitIdx];
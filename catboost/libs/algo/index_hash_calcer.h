@@ -57,13 +57,15 @@ inline void CalcHashes(const TProjection& proj,
     }
 
     for (const TBinFeature& feature : proj.BinFeatures) {
-        NCB::SubsetWithAlternativeIndexing(
-            objectsDataProvider.GetFloatFeature((ui32)feature.FloatFeature),
-            &featuresSubsetIndexing
-        ).ForEach(
-            [feature, hashArr] (ui32 i, ui8 featureValue) {
-                const bool isTrueFeature = IsTrueHistogram(featureValue, (ui8)feature.SplitIdx);
-                hashArr[i] = CalcHash(hashArr[i], (ui64)isTrueFeature);
+        objectsDataProvider.DispatchFloatFeatureSrcBins(
+            (ui32)feature.FloatFeature,
+            [&] (const auto& srcBins) {
+                featuresSubsetIndexing.ForEach(
+                    [feature, hashArr, srcBins] (ui32 i, ui32 srcIdx) {
+                        const bool isTrueFeature = IsTrueHistogram(srcBins[srcIdx], (ui8)feature.SplitIdx);
+                        hashArr[i] = CalcHash(hashArr[i], (ui64)isTrueFeature);
+                    }
+                );
             }
         );
     }
@@ -16,6 +16,7 @@
 #include <util/generic/xrange.h>
 #include <util/folder/path.h>
 #include <util/system/fs.h>
+#include <util/system/mem_info.h>
 #include <util/stream/file.h>
 
 
@@ -94,6 +95,7 @@ void TLearnContext::InitContext(const TTrainingForCPUDataProviders& data) {
     }
     const auto storeExpApproxes = IsStoreExpApprox(Params.LossFunctionDescription->GetLossFunction());
     const bool hasPairwiseWeights = UsesPairsForCalculation(Params.LossFunctionDescription->GetLossFunction());
+    const bool singlePrecisionDerivatives = Params.BoostingOptions->DevSinglePrecisionDerivatives;
 
     if (IsPlainMode(Params.BoostingOptions->BoostingType)) {
         for (int foldIdx = 0; foldIdx < learningFoldCount; ++foldIdx) {
@@ -106,6 +108,7 @@ void TLearnContext::InitContext(const TTrainingForCPUDataProviders& data) {
                     LearnProgress.ApproxDimension,
                     storeExpApproxes,
                     hasPairwiseWeights,
+                    singlePrecisionDerivatives,
                     Rand,
                     LocalExecutor
                 )
@@ -123,6 +126,7 @@ void TLearnContext::InitContext(const TTrainingForCPUDataProviders& data) {
                     boostingOptions.FoldLenMultiplier,
                     storeExpApproxes,
                     hasPairwiseWeights,
+                    singlePrecisionDerivatives,
                     Rand,
                     LocalExecutor
                 )
@@ -139,6 +143,7 @@ void TLearnContext::InitContext(const TTrainingForCPUDataProviders& data) {
         LearnProgress.ApproxDimension,
         storeExpApproxes,
         hasPairwiseWeights,
+        singlePrecisionDerivatives,
         Rand,
         LocalExecutor
     );
@@ -165,7 +170,17 @@ void TLearnContext::InitContext(const TTrainingForCPUDataProviders& data) {
     }
 
     const ui32 maxBodyTailCount = Max(1, GetMaxBodyTailCount(LearnProgress.Folds));
-    UseTreeLevelCachingFlag = NeedToUseTreeLevelCaching(Params, maxBodyTailCount, LearnProgress.ApproxDimension);
+    const int nonCtrBucketCount = CountNonCtrBuckets(
+        CountSplits(LearnProgress.FloatFeatures),
+        *data.Learn->ObjectsData->GetQuantizedFeaturesInfo(),
+        Params.CatFeatureParams->OneHotMaxSize);
+    TreeLevelCacheSizeLimit = CalcTreeLevelCacheSizeLimit(Params);
+    UseTreeLevelCachingFlag = NeedToUseTreeLevelCaching(
+        Params,
+        maxBodyTailCount,
+        LearnProgress.ApproxDimension,
+        nonCtrBucketCount,
+        TreeLevelCacheSizeLimit);
 }
 
 void TLearnContext::SaveProgress() {
@@ -279,15 +294,36 @@ bool TLearnContext::UseTreeLevelCaching() const {
     return UseTreeLevelCachingFlag;
 }
 
+ui64 TLearnContext::GetTreeLevelCacheSizeLimit() const {
+    return TreeLevelCacheSizeLimit;
+}
+
+ui64 CalcTreeLevelCacheSizeLimit(const NCatboostOptions::TCatBoostOptions& params) {
+    const ui64 cpuUsedRamLimit = ParseMemorySizeDescription(params.SystemOptions->CpuUsedRamLimit.Get());
+    if (cpuUsedRamLimit == Max<ui64>()) {
+        return Max<ui64>();
+    }
+    // the data and folds are already in RAM, half of the rest is left to ctrs
+    const ui64 cpuRamUsage = NMemInfo::GetMemInfo().RSS;
+    return cpuRamUsage < cpuUsedRamLimit ? (cpuUsedRamLimit - cpuRamUsage) / 2 : 0;
+}
+
 bool NeedToUseTreeLevelCaching(
     const NCatboostOptions::TCatBoostOptions& params,
     ui32 maxBodyTailCount,
-    ui32 approxDimension) {
+    ui32 approxDimension,
+    ui32 nonCtrBucketCount,
+    ui64 cacheSizeLimit) {
 
-    const ui32 maxLeafCount = 1 << params.ObliviousTreeOptions->MaxDepth;
+    const ui64 maxLeafCount = 1ULL << params.ObliviousTreeOptions->MaxDepth;
     // TODO(nikitxskv): Pairwise scoring doesn't use statistics from previous tree level. Need to fix it.
-    return (
-        IsSamplingPerTree(params.ObliviousTreeOptions) &&
-        !IsPairwiseScoring(params.LossFunctionDescription->GetLossFunction()) &&
-        maxLeafCount * approxDimension * maxBodyTailCount < 64 * 1 * 10);
+    if (!IsSamplingPerTree(params.ObliviousTreeOptions) || IsPairwiseScoring(params.LossFunctionDescription->GetLossFunction())) {
+        return false;
+    }
+    if (cacheSizeLimit == Max<ui64>()) {
+        return maxLeafCount * approxDimension * maxBodyTailCount < 64 * 1 * 10;
+    }
+    // stats of non-ctr candidates must fit, candidates which stats do not fit into the cache are scored without it
+    const ui64 nonCtrStatsSize = sizeof(TBucketStats) * nonCtrBucketCount * maxLeafCount * approxDimension * maxBodyTailCount;
+    return nonCtrStatsSize <= cacheSizeLimit;
 }
@@ -120,6 +120,7 @@ public:
     void SaveProgress();
     bool TryLoadProgress();
     bool UseTreeLevelCaching() const;
+    ui64 GetTreeLevelCacheSizeLimit() const;
 
 public:
     TRestorableFastRng64 Rand;
@@ -136,9 +137,15 @@ public:
 
 private:
     bool UseTreeLevelCachingFlag;
+    ui64 TreeLevelCacheSizeLimit = Max<ui64>();
 };
 
+// Max<ui64>() if used_ram_limit is not set, otherwise a half of the RAM left under used_ram_limit
+ui64 CalcTreeLevelCacheSizeLimit(const NCatboostOptions::TCatBoostOptions& params);
+
 bool NeedToUseTreeLevelCaching(
     const NCatboostOptions::TCatBoostOptions& params,
     ui32 maxBodyTailCount,
-    ui32 approxDimension);
+    ui32 approxDimension,
+    ui32 nonCtrBucketCount,
+    ui64 cacheSizeLimit);
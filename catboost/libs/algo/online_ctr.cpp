@@ -9,6 +9,7 @@
 #include <catboost/libs/helpers/resource_constrained_executor.h>
 #include <catboost/libs/model/model.h>
 
+#include <util/generic/algorithm.h>
 #include <util/generic/bitops.h>
 #include <util/generic/utility.h>
 #include <util/stream/format.h>
@@ -337,6 +338,29 @@ static inline void CountOnlineCTRTotal(const TVector<ui64>& hashArr, int sampleC
     }
 }
 
+void CalcOnlineCtrHashes(const TProjection& proj,
+                         const TQuantizedForCPUObjectsDataProvider& objectsData,
+                         const TFeaturesArraySubsetIndexing& featuresSubsetIndexing,
+                         TArrayRef<ui64> hashArr) {
+    if (hashArr.empty()) {
+        return;
+    }
+    if (proj.IsSingleCatFeature()) {
+        // Shortcut for simple ctrs
+        SubsetWithAlternativeIndexing(
+            objectsData.GetCatFeature((ui32)proj.CatFeatures[0]),
+            &featuresSubsetIndexing
+        ).ForEach(
+            [hashArr] (ui32 i, ui32 featureValue) {
+                hashArr[i] = (ui64)featureValue + 1;
+            }
+        );
+    } else {
+        Fill(hashArr.begin(), hashArr.end(), 0);
+        CalcHashes(proj, objectsData, featuresSubsetIndexing, nullptr, hashArr.begin(), hashArr.end());
+    }
+}
+
 void ComputeOnlineCTRs(const TTrainingForCPUDataProviders& data,
                        const TFold& fold,
                        const TProjection& proj,
@@ -356,54 +380,26 @@ void ComputeOnlineCTRs(const TTrainingForCPUDataProviders& data,
     Y_STATIC_THREAD(THashArr) tlsHashArr;
     Y_STATIC_THREAD(TRehashHash) rehashHashTlsVal;
     TVector<ui64>& hashArr = tlsHashArr.Get();
+    Clear(&hashArr, totalSampleCount);
+    CalcOnlineCtrHashes(
+        proj,
+        *data.Learn->ObjectsData,
+        fold.LearnPermutationFeaturesSubset,
+        TArrayRef<ui64>(hashArr.data(), learnSampleCount));
+    for (size_t docOffset = learnSampleCount, testIdx = 0; docOffset < totalSampleCount && testIdx < data.Test.size(); ++testIdx) {
+        const size_t testSampleCount = data.Test[testIdx]->GetObjectCount();
+        CalcOnlineCtrHashes(
+            proj,
+            *data.Test[testIdx]->ObjectsData,
+            data.Test[testIdx]->ObjectsData->GetFeaturesArraySubsetIndexing(),
+            TArrayRef<ui64>(hashArr.data() + docOffset, testSampleCount));
+        docOffset += testSampleCount;
+    }
     if (proj.IsSingleCatFeature()) {
-        // Shortcut for simple ctrs
-        Clear(&hashArr, totalSampleCount);
-        TArrayRef<ui64> hashArrView = hashArr;
-        if (learnSampleCount > 0) {
-            SubsetWithAlternativeIndexing(
-                data.Learn->ObjectsData->GetCatFeature((ui32)proj.CatFeatures[0]),
-                &fold.LearnPermutationFeaturesSubset
-            ).ForEach(
-                [hashArrView] (ui32 i, ui32 featureValue) {
-                    hashArrView[i] = (ui64)featureValue + 1;
-                }
-            );
-        }
-        for (size_t docOffset = learnSampleCount, testIdx = 0; docOffset < totalSampleCount && testIdx < data.Test.size(); ++testIdx) {
-            const size_t testSampleCount = data.Test[testIdx]->GetObjectCount();
-            (*data.Test[testIdx]->ObjectsData->GetCatFeature((ui32)proj.CatFeatures[0]))->GetArrayData()
-                .ForEach(
-                    [hashArrView, docOffset] (ui32 i, ui32 featureValue) {
-                        hashArrView[docOffset + i] = (ui64)featureValue + 1;
-                    }
-                );
-
-            docOffset += testSampleCount;
-        }
         rehashHashTlsVal.Get().MakeEmpty(
             quantizedFeaturesInfo.GetUniqueValuesCounts(TCatFeatureIdx(proj.CatFeatures[0])).OnLearnOnly
         );
     } else {
-        Clear(&hashArr, totalSampleCount);
-        CalcHashes(
-            proj,
-            *data.Learn->ObjectsData,
-            fold.LearnPermutationFeaturesSubset,
-            nullptr,
-            hashArr.begin(),
-            hashArr.begin() + learnSampleCount);
-        for (size_t docOffset = learnSampleCount, testIdx = 0; docOffset < totalSampleCount && testIdx < data.Test.size(); ++testIdx) {
-            const size_t testSampleCount = data.Test[testIdx]->GetObjectCount();
-            CalcHashes(
-                proj,
-                *data.Test[testIdx]->ObjectsData,
-                data.Test[testIdx]->ObjectsData->GetFeaturesArraySubsetIndexing(),
-                nullptr,
-                hashArr.begin() + docOffset,
-                hashArr.begin() + docOffset + testSampleCount);
-            docOffset += testSampleCount;
-        }
         size_t approxBucketsCount = 1;
         for (auto cf : proj.CatFeatures) {
             approxBucketsCount *= quantizedFeaturesInfo.GetUniqueValuesCounts(TCatFeatureIdx(cf)).OnLearnOnly;
@@ -503,6 +499,202 @@ void ComputeOnlineCTRs(const TTrainingForCPUDataProviders& data,
     }
 }
 
+static int GetOnlineCtrStatsSize(const TVector<int>& targetClassesCount) {
+    return 1 + Accumulate(targetClassesCount, 0);
+}
+
+TOnlineCtrHashCounts CountOnlineCtrHashes(TConstArrayRef<ui64> learnHashArr, const TFold& fold) {
+    const int statsSize = GetOnlineCtrStatsSize(fold.TargetClassesCount);
+    TOnlineCtrHashCounts hashCounts;
+    for (size_t docIdx = 0; docIdx < learnHashArr.size(); ++docIdx) {
+        auto& stats = hashCounts[learnHashArr[docIdx]];
+        if (stats.empty()) {
+            stats.resize(statsSize);
+        }
+        ++stats[0];
+        int classesOffset = 1;
+        for (int classifierIdx = 0; classifierIdx < fold.TargetClassesCount.ysize(); ++classifierIdx) {
+            ++stats[classesOffset + fold.LearnTargetClass[classifierIdx][docIdx]];
+            classesOffset += fold.TargetClassesCount[classifierIdx];
+        }
+    }
+    return hashCounts;
+}
+
+TVector<TOnlineCtrShardStats> MergeOnlineCtrHashCounts(const TVector<TOnlineCtrHashCounts>& shardHashCounts,
+                                                       TConstArrayRef<ui64> testHashArr,
+                                                       const TVector<TCtrInfo>& ctrInfo,
+                                                       const TVector<int>& targetClassesCount,
+                                                       ui64 topSize,
+                                                       ECounterCalc counterCalcMethod) {
+    const int statsSize = GetOnlineCtrStatsSize(targetClassesCount);
+
+    // enumerate buckets the same way ComputeReindexHash does for the whole learn set
+    THashMap<ui64, ui32> learnCounts;
+    for (const auto& hashCounts : shardHashCounts) {
+        for (const auto& [hash, stats] : hashCounts) {
+            learnCounts[hash] += stats[0];
+        }
+    }
+    THashMap<ui64, ui32> hashToBucket;
+    if (learnCounts.size() <= topSize) {
+        for (const auto& [hash, count] : learnCounts) {
+            hashToBucket.emplace(hash, hashToBucket.size());
+        }
+    } else {
+        using TFreqPair = std::pair<ui64, ui32>;
+        TVector<TFreqPair> freqValList(learnCounts.begin(), learnCounts.end());
+        // ties are broken by hash to make buckets independent of the number of shards
+        std::nth_element(freqValList.begin(), freqValList.begin() + topSize, freqValList.end(),
+                         [](const TFreqPair& a, const TFreqPair& b) {
+                             return a.second > b.second || (a.second == b.second && a.first < b.first);
+                         });
+        for (ui32 bucket = 0; bucket < topSize; ++bucket) {
+            hashToBucket[freqValList[bucket].first] = bucket;
+        }
+    }
+    const size_t learnBucketCount = hashToBucket.size();
+    const auto getLearnBucket = [&] (ui64 hash) {
+        const ui32* bucket = hashToBucket.FindPtr(hash);
+        return bucket ? *bucket : (ui32)learnBucketCount - 1;
+    };
+
+    const bool hasCounterCtrs = AnyOf(ctrInfo, [] (const auto& info) { return info.Type == ECtrType::Counter; });
+    size_t counterBucketCount = learnBucketCount;
+    TVector<int> counterTotal;
+    int counterDenominator = 0;
+    if (hasCounterCtrs) {
+        counterTotal.resize(learnBucketCount);
+        for (const auto& hashCounts : shardHashCounts) {
+            for (const auto& [hash, stats] : hashCounts) {
+                counterTotal[getLearnBucket(hash)] += stats[0];
+            }
+        }
+        if (counterCalcMethod == ECounterCalc::Full) {
+            // test documents get new buckets for hashes out of the learn buckets, as in UpdateReindexHash
+            THashMap<ui64, ui32> counterHashToBucket = hashToBucket;
+            for (ui64 hash : testHashArr) {
+                const ui32 bucket = counterHashToBucket.emplace(hash, counterHashToBucket.size()).first->second;
+                if (bucket >= counterTotal.size()) {
+                    counterTotal.resize(bucket + 1);
+                }
+                ++counterTotal[bucket];
+            }
+            counterBucketCount = counterHashToBucket.size();
+        }
+        counterDenominator = *MaxElement(counterTotal.begin(), counterTotal.end());
+    }
+
+    TVector<TOnlineCtrShardStats> shardStats(shardHashCounts.size());
+    TVector<int> precedingStats(learnBucketCount * statsSize); // [bucketIdx][stats]
+    for (size_t shardIdx = 0; shardIdx < shardHashCounts.size(); ++shardIdx) {
+        auto& stats = shardStats[shardIdx];
+        stats.CtrInfo = ctrInfo;
+        stats.CounterDenominator = counterDenominator;
+        stats.UniqueValuesCount = learnBucketCount;
+        stats.CounterUniqueValuesCount = counterBucketCount;
+
+        THashMap<ui32, ui32> learnBucketToShardBucket;
+        for (const auto& [hash, counts] : shardHashCounts[shardIdx]) {
+            const ui32 learnBucket = getLearnBucket(hash);
+            const auto [bucketIt, isNew] = learnBucketToShardBucket.emplace(learnBucket, learnBucketToShardBucket.size());
+            const ui32 shardBucket = bucketIt->second;
+            stats.HashToBucket[hash] = shardBucket;
+            if (isNew) {
+                const int* learnBucketStats = precedingStats.data() + learnBucket * statsSize;
+                stats.BucketStats.insert(stats.BucketStats.end(), learnBucketStats, learnBucketStats + statsSize);
+                if (hasCounterCtrs) {
+                    stats.CounterTotal.push_back(counterTotal[learnBucket]);
+                }
+            }
+        }
+        for (const auto& [hash, counts] : shardHashCounts[shardIdx]) {
+            int* learnBucketStats = precedingStats.data() + getLearnBucket(hash) * statsSize;
+            for (int statIdx = 0; statIdx < statsSize; ++statIdx) {
+                learnBucketStats[statIdx] += counts[statIdx];
+            }
+        }
+    }
+    return shardStats;
+}
+
+void ComputeOnlineCTRsForShard(const TOnlineCtrShardStats& shardStats,
+                               TConstArrayRef<ui64> learnHashArr,
+                               const TFold& fold,
+                               TOnlineCTR* dst) {
+    const auto& ctrInfo = shardStats.CtrInfo;
+    const size_t sampleCount = learnHashArr.size();
+    const int statsSize = GetOnlineCtrStatsSize(fold.TargetClassesCount);
+    TVector<int> classesOffsets(fold.TargetClassesCount.size()); // [classifierIdx]
+    for (int classifierIdx = 0, classesOffset = 1; classifierIdx < fold.TargetClassesCount.ysize(); ++classifierIdx) {
+        classesOffsets[classifierIdx] = classesOffset;
+        classesOffset += fold.TargetClassesCount[classifierIdx];
+    }
+
+    dst->UniqueValuesCount = shardStats.UniqueValuesCount;
+    dst->CounterUniqueValuesCount = shardStats.CounterUniqueValuesCount;
+    dst->Feature.resize(ctrInfo.size());
+    TVector<TVector<float>> shifts(ctrInfo.size());
+    TVector<TVector<float>> norms(ctrInfo.size());
+    for (int ctrIdx = 0; ctrIdx < ctrInfo.ysize(); ++ctrIdx) {
+        const int targetClassesCount = fold.TargetClassesCount[ctrInfo[ctrIdx].TargetClassifierIdx];
+        const ui32 targetBorderCount = GetTargetBorderCount(ctrInfo[ctrIdx], targetClassesCount);
+        const auto& priors = ctrInfo[ctrIdx].Priors;
+        dst->Feature[ctrIdx].SetSizes(priors.size(), targetBorderCount);
+        for (ui32 border = 0; border < targetBorderCount; ++border) {
+            for (int prior = 0; prior < priors.ysize(); ++prior) {
+                Clear(&dst->Feature[ctrIdx][border][prior], sampleCount);
+            }
+        }
+        CalcNormalization(priors, &shifts[ctrIdx], &norms[ctrIdx]);
+    }
+
+    TVector<int> bucketStats = shardStats.BucketStats;
+    for (size_t docIdx = 0; docIdx < sampleCount; ++docIdx) {
+        const ui32 bucket = shardStats.HashToBucket.at(learnHashArr[docIdx]);
+        int* stats = bucketStats.data() + bucket * statsSize;
+        const int totalCount = stats[0];
+        for (int ctrIdx = 0; ctrIdx < ctrInfo.ysize(); ++ctrIdx) {
+            const ECtrType ctrType = ctrInfo[ctrIdx].Type;
+            const ui32 classifierIdx = ctrInfo[ctrIdx].TargetClassifierIdx;
+            const int targetClassesCount = fold.TargetClassesCount[classifierIdx];
+            const int* classCounts = stats + classesOffsets[classifierIdx];
+            const ui32 ctrBorderCount = ctrInfo[ctrIdx].BorderCount;
+            const auto& priors = ctrInfo[ctrIdx].Priors;
+            auto& feature = dst->Feature[ctrIdx];
+            const auto setCtr = [&] (int border, float countInClass, int total) {
+                for (int prior = 0; prior < priors.ysize(); ++prior) {
+                    feature[border][prior][docIdx] = CalcCTR(countInClass, total,
+                        priors[prior], shifts[ctrIdx][prior], norms[ctrIdx][prior], ctrBorderCount);
+                }
+            };
+            if (ctrType == ECtrType::Counter) {
+                setCtr(0, shardStats.CounterTotal[bucket], shardStats.CounterDenominator);
+            } else if (ctrType == ECtrType::BinarizedTargetMeanValue) {
+                const int targetBorderCount = targetClassesCount - 1;
+                float sum = 0;
+                for (int classIdx = 1; classIdx < targetClassesCount; ++classIdx) {
+                    sum += classCounts[classIdx] * (static_cast<float>(classIdx) / targetBorderCount);
+                }
+                setCtr(0, sum, totalCount);
+            } else {
+                Y_ASSERT(ctrType == ECtrType::Buckets || ctrType == ECtrType::Borders);
+                int goodCount = totalCount;
+                const int targetBorderCount = GetTargetBorderCount(ctrInfo[ctrIdx], targetClassesCount);
+                for (int border = 0; border < targetBorderCount; ++border) {
+                    UpdateGoodCount(classCounts[border], ctrType, &goodCount);
+                    setCtr(border, goodCount, totalCount);
+                }
+            }
+        }
+
+        ++stats[0];
+        for (int classifierIdx = 0; classifierIdx < fold.TargetClassesCount.ysize(); ++classifierIdx) {
+            ++stats[classesOffsets[classifierIdx] + fold.LearnTargetClass[classifierIdx][docIdx]];
+        }
+    }
+}
+
 void CalcFinalCtrsImpl(
     const ECtrType ctrType,
     const ui64 ctrLeafCountLimit,
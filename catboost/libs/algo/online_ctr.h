@@ -1,5 +1,6 @@
 #pragma once
 
+#include "ctr_helper.h"
 #include "index_hash_calcer.h"
 #include "projection.h"
 #include "target_classifier.h"
@@ -10,8 +11,10 @@
 #include <catboost/libs/model/ctr_data.h>
 #include <catboost/libs/model/online_ctr.h>
 
+#include <library/binsaver/bin_saver.h>
 #include <library/threading/local_executor/local_executor.h>
 
+#include <util/generic/hash.h>
 #include <util/generic/maybe.h>
 #include <util/system/types.h>
 
@@ -59,6 +62,48 @@ void ComputeOnlineCTRs(const NCB::TTrainingForCPUDataProviders& data,
                        const TLearnContext* ctx,
                        TOnlineCTR* dst);
 
+
+/* Online ctrs for distributed training are computed in three steps:
+ * - each worker counts target classes per projection hash over its contiguous part of the learn set,
+ * - master merges the counts into initial statistics of each part,
+ * - each worker computes ctr values for its part starting from these statistics.
+ */
+
+// hash -> [total count, class counts for target classifier 0, class counts for target classifier 1, ...]
+using TOnlineCtrHashCounts = THashMap<ui64, TVector<int>>;
+
+struct TOnlineCtrShardStats {
+    TVector<TCtrInfo> CtrInfo;
+    THashMap<ui64, ui32> HashToBucket; // only hashes present in the shard
+    TVector<int> BucketStats; // [bucketIdx][same layout as in TOnlineCtrHashCounts], counted over preceding shards
+    TVector<int> CounterTotal; // [bucketIdx], empty if there are no Counter ctrs
+    int CounterDenominator = 0;
+    size_t UniqueValuesCount = 0;
+    size_t CounterUniqueValuesCount = 0;
+
+    SAVELOAD(CtrInfo, HashToBucket, BucketStats, CounterTotal, CounterDenominator, UniqueValuesCount, CounterUniqueValuesCount);
+};
+
+void CalcOnlineCtrHashes(const TProjection& proj,
+                         const NCB::TQuantizedForCPUObjectsDataProvider& objectsData,
+                         const NCB::TFeaturesArraySubsetIndexing& featuresSubsetIndexing,
+                         TArrayRef<ui64> hashArr);
+
+TOnlineCtrHashCounts CountOnlineCtrHashes(TConstArrayRef<ui64> learnHashArr, const TFold& fold);
+
+// shardHashCounts are in learn permutation order, testHashArr is used only by Counter ctrs with ECounterCalc::Full
+TVector<TOnlineCtrShardStats> MergeOnlineCtrHashCounts(const TVector<TOnlineCtrHashCounts>& shardHashCounts,
+                                                       TConstArrayRef<ui64> testHashArr,
+                                                       const TVector<TCtrInfo>& ctrInfo,
+                                                       const TVector<int>& targetClassesCount,
+                                                       ui64 topSize,
+                                                       ECounterCalc counterCalcMethod);
+
+void ComputeOnlineCTRsForShard(const TOnlineCtrShardStats& shardStats,
+                               TConstArrayRef<ui64> learnHashArr,
+                               const TFold& fold,
+                               TOnlineCTR* dst);
+
 class TCtrValueTable;
 
 
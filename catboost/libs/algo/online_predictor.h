@@ -7,6 +7,7 @@
 #include <library/binsaver/bin_saver.h>
 #include <library/containers/2d_array/2d_array.h>
 
+#include <util/generic/array_ref.h>
 #include <util/generic/vector.h>
 #include <util/system/yassert.h>
 
@@ -63,8 +64,8 @@ struct TSumMulti {
                SumDer2History == other.SumDer2History;
     }
 
-    void AddDerWeight(const TVector<double>& delta, double weight, int gradientIteration) {
-        Y_ASSERT(delta.ysize() == SumDerHistory[gradientIteration].ysize());
+    void AddDerWeight(TConstArrayRef<double> delta, double weight, int gradientIteration) {
+        Y_ASSERT(delta.size() == SumDerHistory[gradientIteration].size());
         for (int dim = 0; dim < SumDerHistory[gradientIteration].ysize(); ++dim) {
             SumDerHistory[gradientIteration][dim] += delta[dim];
         }
@@ -80,6 +81,19 @@ struct TSumMulti {
         }
         SumDer2History[gradientIteration].AddDer2(der2);
     }
+
+    // der2 is in THessianInfo::Data layout
+    void AddDerDer2(TConstArrayRef<double> delta, TConstArrayRef<double> der2, int gradientIteration) {
+        Y_ASSERT(delta.size() == SumDerHistory[gradientIteration].size());
+        for (int dim = 0; dim < SumDerHistory[gradientIteration].ysize(); ++dim) {
+            SumDerHistory[gradientIteration][dim] += delta[dim];
+        }
+        TVector<double>& sumDer2 = SumDer2History[gradientIteration].Data;
+        Y_ASSERT(der2.size() == sumDer2.size());
+        for (int idx = 0; idx < sumDer2.ysize(); ++idx) {
+            sumDer2[idx] += der2[idx];
+        }
+    }
     SAVELOAD(SumDerHistory, SumDer2History, SumWeights);
 };
 
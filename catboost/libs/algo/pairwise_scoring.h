@@ -24,9 +24,10 @@ struct TBucketPairWeightStatistics {
 struct TPairwiseStats {
     TVector<TVector<double>> DerSums; // [leafCount][bucketCount]
     TArray2D<TVector<TBucketPairWeightStatistics>> PairWeightStatistics; // [leafCount][leafCount][bucketCount]
+    ESplitType SplitType = ESplitType::FloatFeature; // for TRemotePairwiseScoreCalcer
 
     void Add(const TPairwiseStats& rhs);
-    SAVELOAD(DerSums, PairWeightStatistics);
+    SAVELOAD(DerSums, PairWeightStatistics, SplitType);
 };
 
 
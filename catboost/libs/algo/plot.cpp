@@ -8,15 +8,19 @@
 #include <catboost/libs/options/json_helper.h>
 
 #include <util/folder/path.h>
+#include <util/generic/algorithm.h>
 #include <util/generic/array_ref.h>
+#include <util/generic/bitops.h>
 #include <util/generic/guid.h>
 #include <util/generic/utility.h>
 #include <util/generic/xrange.h>
+#include <util/generic/ymath.h>
+#include <util/memory/blob.h>
 #include <util/stream/fwd.h>
 #include <util/string/builder.h>
 #include <util/system/file.h>
+#include <util/system/unaligned_mem.h>
 #include <util/system/yassert.h>
-#include <util/ysaveload.h>
 
 #include <cmath>
 
@@ -126,24 +130,14 @@ TMetricsPlotCalcer& TMetricsPlotCalcer::FinishProceedDataSetForNonAdditiveMetric
     ui32 end = Min<ui32>(ProcessedIterationsCount + ProcessedIterationsStep, Iterations.size());
     ComputeNonAdditiveMetrics(begin, end);
     ProcessedIterationsCount = end;
+    LastApproxesDocOffset = 0;
     if (AreAllIterationsProcessed()) {
-        DeleteApprox(end - 1);
-    } else {
-        LastApproxes = MakeHolder<TIFStream>(GetApproxFileName(end - 1));
+        LastApproxes.clear();
+        LastApproxes.shrink_to_fit();
     }
     return *this;
 }
 
-static void Load(ui32 docCount, IInputStream* input, TVector<TVector<double>>* output) {
-    TVector<double> line;
-    for (ui32 i = 0; i < docCount; ++i) {
-        ::Load(input, line);
-        for (ui32 dim = 0; dim < output->size(); ++dim) {
-            (*output)[dim][i] = line[dim];
-        }
-    }
-}
-
 static ui32 GetDocCount(TConstArrayRef<TProcessedDataProvider> datasetParts) {
     ui32 answer = 0;
     for (const auto& datasetPart : datasetParts) {
@@ -218,8 +212,15 @@ TMetricsPlotCalcer& TMetricsPlotCalcer::ProceedDataSet(
     if (beginIterationIndex == 0) {
         begin = 0;
     } else {
-        begin = Iterations[beginIterationIndex];
-        Load(docCount, LastApproxes.Get(), &CurApproxBuffer);
+        begin = Iterations[beginIterationIndex - 1] + 1;
+        CB_ENSURE(
+            LastApproxes.size() == CurApproxBuffer.size() && LastApproxes[0].size() >= LastApproxesDocOffset + docCount,
+            "Approxes of the previous plot line do not match the dataset");
+        for (ui32 dim = 0; dim < CurApproxBuffer.size(); ++dim) {
+            const auto lastApprox = LastApproxes[dim].begin() + LastApproxesDocOffset;
+            Copy(lastApprox, lastApprox + docCount, CurApproxBuffer[dim].begin());
+        }
+        LastApproxesDocOffset += docCount;
     }
 
     const auto target = GetTarget(processedData.TargetData);
@@ -229,6 +230,14 @@ TMetricsPlotCalcer& TMetricsPlotCalcer::ProceedDataSet(
     for (ui32 iterationIndex = beginIterationIndex; iterationIndex < endIterationIndex; ++iterationIndex) {
         end = Iterations[iterationIndex] + 1;
         modelCalcerOnPool.ApplyModelMulti(EPredictionType::InternalRawFormulaVal, begin, end, &FlatApproxBuffer, &NextApproxBuffer);
+        if (!isAdditiveMetrics) {
+            // the first plot line is saved as the difference from zero, not from the baseline
+            if (iterationIndex == 0) {
+                PrevApproxBuffer.clear();
+            } else {
+                PrevApproxBuffer = CurApproxBuffer;
+            }
+        }
         Append(NextApproxBuffer, &CurApproxBuffer);
 
         if (isAdditiveMetrics) {
@@ -239,12 +248,13 @@ TMetricsPlotCalcer& TMetricsPlotCalcer::ProceedDataSet(
                 groupInfos,
                 iterationIndex);
         } else {
-            SaveApproxToFile(iterationIndex, CurApproxBuffer);
+            SaveApproxToFile(iterationIndex, PrevApproxBuffer, CurApproxBuffer);
         }
         begin = end;
     }
     ClearApproxBuffer(&CurApproxBuffer);
     ClearApproxBuffer(&NextApproxBuffer);
+    ClearApproxBuffer(&PrevApproxBuffer);
 
     return *this;
 }
@@ -252,14 +262,29 @@ TMetricsPlotCalcer& TMetricsPlotCalcer::ProceedDataSet(
 void TMetricsPlotCalcer::ComputeNonAdditiveMetrics(ui32 begin, ui32 end) {
     const auto& target = NonAdditiveMetricsData.Target;
     const auto& weights = NonAdditiveMetricsData.Weights;
-    for (ui32 idx = begin; idx < end; ++idx) {
-        auto approx = LoadApprox(idx);
-        for (ui32 metricId = 0; metricId < NonAdditiveMetrics.size(); ++metricId) {
-            NonAdditiveMetricPlots[metricId][idx] = NonAdditiveMetrics[metricId]->Eval(approx, target, weights, {}, 0, target.size(), Executor);
-        }
-        if (idx != 0) {
-            DeleteApprox(idx - 1);
+    // each plot line is decoded from the previous one, then the lines of a batch are evaluated concurrently,
+    // batches bound the number of approxes loaded at once
+    const ui32 batchSize = Executor.GetThreadCount() + 1;
+    TVector<TVector<TVector<double>>> approxes;
+    for (ui32 batchBegin = begin; batchBegin < end; batchBegin += batchSize) {
+        const ui32 batchEnd = Min(batchBegin + batchSize, end);
+        approxes.resize(batchEnd - batchBegin);
+        for (ui32 idx = batchBegin; idx < batchEnd; ++idx) {
+            const auto& prevApprox = idx == batchBegin ? LastApproxes : approxes[idx - batchBegin - 1];
+            approxes[idx - batchBegin] = LoadApprox(idx, prevApprox);
+            DeleteApprox(idx);
         }
+        Executor.ExecRangeWithThrow(
+            [&] (int idx) {
+                const auto& approx = approxes[idx - batchBegin];
+                for (ui32 metricId = 0; metricId < NonAdditiveMetrics.size(); ++metricId) {
+                    NonAdditiveMetricPlots[metricId][idx] = NonAdditiveMetrics[metricId]->Eval(approx, target, weights, {}, 0, target.size(), Executor);
+                }
+            },
+            batchBegin,
+            batchEnd,
+            NPar::TLocalExecutor::WAIT_COMPLETE);
+        LastApproxes = std::move(approxes[batchEnd - batchBegin - 1]);
     }
 }
 
@@ -350,27 +375,150 @@ TString TMetricsPlotCalcer::GetApproxFileName(ui32 plotLineIndex) {
     return NonAdditiveMetricsData.ApproxFiles[plotLineIndex];
 }
 
-void TMetricsPlotCalcer::SaveApproxToFile(ui32 plotLineIndex,
-                                          const TVector<TVector<double>>& approx) {
-    auto fileName = GetApproxFileName(plotLineIndex);
-    ui32 docCount = approx[0].size();
-    TFile file(fileName, EOpenModeFlag::ForAppend | EOpenModeFlag::OpenAlways);
-    TOFStream out(file);
-    TVector<double> line(approx.size());
+// Approx files store, for every value, the xor of its bits with the same value of the previous plot line
+// (with zero for the first line) without the leading zero bytes: the sign, the exponent and the high
+// mantissa bits seldom change between plot lines.
+// Values are laid out as [objectIdx * approxDimension + dim] and encoded in blocks of a ui32 value count and
+// a ui32 byte size followed by pairs of values: one byte with the significant byte counts of both values
+// in its low and high halves, then the significant bytes of the values from the lowest one.
+// Dataset parts are appended one after another.
+static const size_t APPROX_BLOCK_VALUE_COUNT = 1 << 16;
+static const size_t APPROX_BLOCK_HEADER_SIZE = 2 * sizeof(ui32);
+
+static inline ui32 GetSignificantByteCount(ui64 delta) {
+    return delta == 0 ? 0 : CeilDiv<ui32>(GetValueBitCount(delta), 8);
+}
+
+static inline ui8* WriteSignificantBytes(ui64 delta, ui32 byteCount, ui8* dst) {
+    for (ui32 i = 0; i < byteCount; ++i) {
+        *dst++ = static_cast<ui8>(delta);
+        delta >>= 8;
+    }
+    return dst;
+}
 
-    for (ui32 i = 0; i < docCount; ++i) {
-        for (ui32 dim = 0; dim < approx.size(); ++dim) {
-            line[dim] = approx[dim][i];
+static inline ui64 ReadSignificantBytes(ui32 byteCount, const ui8** src) {
+    ui64 delta = 0;
+    for (ui32 i = 0; i < byteCount; ++i) {
+        delta |= static_cast<ui64>((*src)[i]) << (8 * i);
+    }
+    *src += byteCount;
+    return delta;
+}
+
+static void EncodeApproxBlock(TConstArrayRef<ui64> deltas, TVector<ui8>* block) {
+    block->yresize(APPROX_BLOCK_HEADER_SIZE + deltas.size() * (sizeof(ui64) + 1));
+    ui8* dst = block->data() + APPROX_BLOCK_HEADER_SIZE;
+    for (size_t i = 0; i < deltas.size(); i += 2) {
+        const ui64 first = deltas[i];
+        const ui64 second = i + 1 < deltas.size() ? deltas[i + 1] : 0;
+        const ui32 firstByteCount = GetSignificantByteCount(first);
+        const ui32 secondByteCount = GetSignificantByteCount(second);
+        *dst++ = static_cast<ui8>(firstByteCount | (secondByteCount << 4));
+        dst = WriteSignificantBytes(first, firstByteCount, dst);
+        dst = WriteSignificantBytes(second, secondByteCount, dst);
+    }
+    const ui32 byteSize = dst - block->data() - APPROX_BLOCK_HEADER_SIZE;
+    WriteUnaligned<ui32>(block->data(), deltas.size());
+    WriteUnaligned<ui32>(block->data() + sizeof(ui32), byteSize);
+    block->resize(APPROX_BLOCK_HEADER_SIZE + byteSize);
+}
+
+static void DecodeApproxBlock(const ui8* src, const ui8* end, TArrayRef<ui64> deltas) {
+    for (size_t i = 0; i < deltas.size(); i += 2) {
+        CB_ENSURE(src < end, "Approx file is corrupted");
+        const ui32 firstByteCount = *src & 0xF;
+        const ui32 secondByteCount = *src >> 4;
+        ++src;
+        CB_ENSURE(
+            firstByteCount <= sizeof(ui64) && secondByteCount <= sizeof(ui64) && firstByteCount + secondByteCount <= size_t(end - src),
+            "Approx file is corrupted");
+        deltas[i] = ReadSignificantBytes(firstByteCount, &src);
+        if (i + 1 < deltas.size()) {
+            deltas[i + 1] = ReadSignificantBytes(secondByteCount, &src);
+        }
+    }
+    CB_ENSURE(src == end, "Approx file is corrupted");
+}
+
+void TMetricsPlotCalcer::SaveApproxToFile(
+    ui32 plotLineIndex,
+    const TVector<TVector<double>>& prevApprox,
+    const TVector<TVector<double>>& approx
+) {
+    auto fileName = GetApproxFileName(plotLineIndex);
+    const ui32 approxDimension = approx.size();
+    const ui32 docCount = approx[0].size();
+    ApproxDeltaBuffer.yresize((size_t)docCount * approxDimension);
+    NPar::ParallelFor(Executor, 0, docCount, [&](int i) {
+        for (ui32 dim = 0; dim < approxDimension; ++dim) {
+            const ui64 prevBits = prevApprox.empty() ? 0 : ReadUnaligned<ui64>(&prevApprox[dim][i]);
+            ApproxDeltaBuffer[(size_t)i * approxDimension + dim] = ReadUnaligned<ui64>(&approx[dim][i]) ^ prevBits;
         }
-        ::Save(&out, line);
+    });
+    const size_t blockCount = CeilDiv<size_t>(ApproxDeltaBuffer.size(), APPROX_BLOCK_VALUE_COUNT);
+    EncodedApproxBlocks.resize(blockCount);
+    NPar::ParallelFor(Executor, 0, blockCount, [&](int blockIdx) {
+        const size_t blockBegin = (size_t)blockIdx * APPROX_BLOCK_VALUE_COUNT;
+        const size_t blockEnd = Min(blockBegin + APPROX_BLOCK_VALUE_COUNT, ApproxDeltaBuffer.size());
+        EncodeApproxBlock(
+            MakeArrayRef(ApproxDeltaBuffer.data() + blockBegin, blockEnd - blockBegin),
+            &EncodedApproxBlocks[blockIdx]);
+    });
+    TFile file(fileName, EOpenModeFlag::ForAppend | EOpenModeFlag::OpenAlways);
+    for (const auto& block : EncodedApproxBlocks) {
+        file.Write(block.data(), block.size());
     }
 }
 
-TVector<TVector<double>> TMetricsPlotCalcer::LoadApprox(ui32 plotLineIndex) {
-    TIFStream input(GetApproxFileName(plotLineIndex));
-    ui32 docCount = NonAdditiveMetricsData.Target.size();
-    TVector<TVector<double>> result(Model.ObliviousTrees.ApproxDimension, TVector<double>(docCount));
-    Load(docCount, &input, &result);
+TVector<TVector<double>> TMetricsPlotCalcer::LoadApprox(
+    ui32 plotLineIndex,
+    const TVector<TVector<double>>& prevApprox
+) const {
+    const ui32 docCount = NonAdditiveMetricsData.Target.size();
+    const ui32 approxDimension = Model.ObliviousTrees.ApproxDimension;
+    const TBlob approxFile = TBlob::FromFile(NonAdditiveMetricsData.ApproxFiles[plotLineIndex]);
+    const ui8* data = approxFile.AsUnsignedCharPtr();
+
+    // block sizes are in the headers, so blocks are found first and decoded in parallel
+    TVector<size_t> blockOffsets;
+    TVector<size_t> blockValueOffsets;
+    size_t offset = 0;
+    size_t valueCount = 0;
+    while (offset < approxFile.Size()) {
+        CB_ENSURE(approxFile.Size() - offset >= APPROX_BLOCK_HEADER_SIZE, "Approx file is corrupted");
+        const ui32 blockValueCount = ReadUnaligned<ui32>(data + offset);
+        const ui32 blockByteSize = ReadUnaligned<ui32>(data + offset + sizeof(ui32));
+        CB_ENSURE(approxFile.Size() - offset - APPROX_BLOCK_HEADER_SIZE >= blockByteSize, "Approx file is corrupted");
+        blockOffsets.push_back(offset);
+        blockValueOffsets.push_back(valueCount);
+        offset += APPROX_BLOCK_HEADER_SIZE + blockByteSize;
+        valueCount += blockValueCount;
+    }
+    CB_ENSURE(valueCount == (size_t)docCount * approxDimension, "Approx file size does not match the dataset");
+    CB_ENSURE(
+        prevApprox.empty() || (prevApprox.size() == approxDimension && prevApprox[0].size() == docCount),
+        "Approxes of the previous plot line do not match the dataset");
+
+    TVector<TVector<double>> result(approxDimension, TVector<double>(docCount));
+    Executor.ExecRangeWithThrow(
+        [&] (int blockIdx) {
+            const ui8* block = data + blockOffsets[blockIdx];
+            TVector<ui64> deltas;
+            deltas.yresize(ReadUnaligned<ui32>(block));
+            const ui8* blockData = block + APPROX_BLOCK_HEADER_SIZE;
+            DecodeApproxBlock(blockData, blockData + ReadUnaligned<ui32>(block + sizeof(ui32)), deltas);
+            for (size_t i = 0; i < deltas.size(); ++i) {
+                const size_t valueIdx = blockValueOffsets[blockIdx] + i;
+                const ui32 docIdx = valueIdx / approxDimension;
+                const ui32 dim = valueIdx % approxDimension;
+                const ui64 prevBits = prevApprox.empty() ? 0 : ReadUnaligned<ui64>(&prevApprox[dim][docIdx]);
+                WriteUnaligned<ui64>(&result[dim][docIdx], deltas[i] ^ prevBits);
+            }
+        },
+        0,
+        blockOffsets.size(),
+        NPar::TLocalExecutor::WAIT_COMPLETE);
     return result;
 }
 
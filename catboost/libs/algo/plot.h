@@ -12,7 +12,6 @@
 #include <util/generic/ptr.h>
 #include <util/generic/string.h>
 #include <util/generic/vector.h>
-#include <util/stream/input.h>
 #include <util/system/fs.h>
 #include <util/system/types.h>
 
@@ -158,9 +157,15 @@ private:
 
     TString GetApproxFileName(ui32 plotLineIndex);
 
-    void SaveApproxToFile(ui32 plotLineIndex, const TVector<TVector<double>>& approx);
+    // approx is encoded as the difference from prevApprox, the approx of the previous plot line,
+    // empty prevApprox is used for the first plot line
+    void SaveApproxToFile(
+        ui32 plotLineIndex,
+        const TVector<TVector<double>>& prevApprox,
+        const TVector<TVector<double>>& approx);
 
-    TVector<TVector<double>> LoadApprox(ui32 plotLineIndex);
+    // file of plotLineIndex must have been created by SaveApproxToFile with the same prevApprox
+    TVector<TVector<double>> LoadApprox(ui32 plotLineIndex, const TVector<TVector<double>>& prevApprox) const;
     void DeleteApprox(ui32 plotLineIndex);
 
 private:
@@ -183,12 +188,16 @@ private:
 
     ui32 ProcessedIterationsCount;
     ui32 ProcessedIterationsStep;
-    THolder<IInputStream> LastApproxes;
+    TVector<TVector<double>> LastApproxes; // approxes of the last processed plot line, all dataset parts
+    ui32 LastApproxesDocOffset = 0;
 
     TNonAdditiveMetricData NonAdditiveMetricsData;
 
     TVector<double> FlatApproxBuffer;
+    TVector<ui64> ApproxDeltaBuffer;
+    TVector<TVector<ui8>> EncodedApproxBlocks;
     TVector<TVector<double>> CurApproxBuffer;
+    TVector<TVector<double>> PrevApproxBuffer;
     TVector<TVector<double>> NextApproxBuffer;
 };
 
@@ -8,6 +8,9 @@
 #include <catboost/libs/helpers/map_merge.h>
 #include <catboost/libs/options/defaults_helper.h>
 
+#include <util/generic/algorithm.h>
+#include <util/generic/map.h>
+
 #include <type_traits>
 
 using namespace NCB;
@@ -92,11 +95,11 @@ inline static const TOnlineCTR& GetCtr(
 
 // Helper function for calculating index of leaf for each document given a new split.
 // Calculates indices when a permutation is given.
-template <typename TBucketIndexType, typename TFullIndexType>
+template <typename TBucketIndex, typename TFullIndexType>
 inline static void SetSingleIndex(
     const TCalcScoreFold& fold,
     const TStatsIndexer& indexer,
-    TBucketIndexType* bucketIndex,
+    const TBucketIndex& bucketIndex, // pointer or bins of packed feature, indexed by doc in data provider
     const ui32* bucketIndexing, // can be nullptr for simple case, use bucketBeginOffset instead then
     const int bucketBeginOffset,
     const int permBlockSize,
@@ -171,15 +174,20 @@ inline static void BuildSingleIndex(
         const int docInDataProviderBeginOffset = simpleIndexing ? fold.FeaturesSubsetBegin : 0;
 
         if (split.Type == ESplitType::FloatFeature) {
-            SetSingleIndex(
-                fold,
-                indexer,
-                *((*objectsDataProvider.GetFloatFeature((ui32)split.FeatureIdx))->GetArrayData().GetSrc()),
-                docInDataProviderIndexing,
-                docInDataProviderBeginOffset,
-                fold.NonCtrDataPermutationBlockSize,
-                docIndexRange,
-                singleIdx
+            objectsDataProvider.DispatchFloatFeatureSrcBins(
+                (ui32)split.FeatureIdx,
+                [&] (const auto& floatFeatureSrcBins) {
+                    SetSingleIndex(
+                        fold,
+                        indexer,
+                        floatFeatureSrcBins,
+                        docInDataProviderIndexing,
+                        docInDataProviderBeginOffset,
+                        fold.NonCtrDataPermutationBlockSize,
+                        docIndexRange,
+                        singleIdx
+                    );
+                }
             );
         } else {
             Y_ASSERT(split.Type == ESplitType::OneHotFeature);
@@ -397,13 +405,16 @@ static void CalcStatsImpl(
                     GetCtr(allCtrs, ctr.Projection).Feature[ctr.CtrIdx][ctr.TargetBorderIdx][ctr.PriorIdx];
                 setOutput([buckets](ui32 docIdx) { return buckets[docIdx]; });
             } else if (split.Type == ESplitType::FloatFeature) {
-                const ui8* bucketSrcData =
-                    *((*objectsDataProvider.GetFloatFeature((ui32)split.FeatureIdx))->GetArrayData().GetSrc());
                 const ui32* bucketIndexing
                     = fold.LearnPermutationFeaturesSubset.Get<TIndexedSubset<ui32>>().data();
-                setOutput(
-                    [bucketSrcData, bucketIndexing](ui32 docIdx) {
-                        return bucketSrcData[bucketIndexing[docIdx]];
+                objectsDataProvider.DispatchFloatFeatureSrcBins(
+                    (ui32)split.FeatureIdx,
+                    [&] (const auto& bucketSrcData) {
+                        setOutput(
+                            [bucketSrcData, bucketIndexing](ui32 docIdx) {
+                                return bucketSrcData[bucketIndexing[docIdx]];
+                            }
+                        );
                     }
                 );
             } else {
@@ -429,6 +440,20 @@ static void CalcStatsImpl(
 }
 
 
+// Index ranges of TCalcScoreFold are ranges of queries if fold has query info
+inline static NCB::TIndexRange<int> GetCalcStatsDocIndexRange(
+    const TCalcScoreFold& fold,
+    NCB::TIndexRange<int> indexRange
+) {
+    return fold.HasQueryInfo() ?
+        NCB::TIndexRange<int>(
+            fold.LearnQueriesInfo[indexRange.Begin].Begin,
+            (indexRange.End == 0) ? 0 : fold.LearnQueriesInfo[indexRange.End - 1].End
+        )
+        : indexRange;
+}
+
+
 template <typename TFullIndexType, typename TIsCaching>
 static void CalcStatsImpl(
     const TCalcScoreFold& fold,
@@ -468,14 +493,17 @@ static void CalcStatsImpl(
         localExecutor,
         fold.GetCalcStatsIndexRanges(),
         /*mapFunc*/[&](NCB::TIndexRange<int> indexRange, TBucketStatsRefOptionalHolder* output) {
-            NCB::TIndexRange<int> docIndexRange = fold.HasQueryInfo() ?
-                NCB::TIndexRange<int>(
-                    fold.LearnQueriesInfo[indexRange.Begin].Begin,
-                    (indexRange.End == 0) ? 0 : fold.LearnQueriesInfo[indexRange.End - 1].End
-                )
-                : indexRange;
+            const NCB::TIndexRange<int> docIndexRange = GetCalcStatsDocIndexRange(fold, indexRange);
 
-            BuildSingleIndex(fold, objectsDataProvider, allCtrs, split, indexer, docIndexRange, &singleIdx);
+            BuildSingleIndex(
+                fold,
+                objectsDataProvider,
+                allCtrs,
+                split,
+                indexer,
+                docIndexRange,
+                &singleIdx
+            );
 
             if (output->NonInited()) {
                 (*output) = TBucketStatsRefOptionalHolder(statsCount);
@@ -534,6 +562,320 @@ static void CalcStatsImpl(
 }
 
 
+// Documents are processed in blocks small enough for their leaf indices, derivatives and
+// data provider indices to stay in cache while buckets of all features of a group are read.
+static constexpr int FUSED_HISTOGRAM_DOC_BLOCK_SIZE = 2048;
+
+
+// Calls updateFunc(doc, &leafStats) for each document in docIndexRange and each feature of the group,
+// feature with nullptr buckets has all documents in bucket 0 (used to calculate leaf totals)
+template <typename TBucketIndexType, typename TUpdateFunc>
+inline static void UpdateFusedStats(
+    const TCalcScoreFold& fold,
+    TConstArrayRef<const TBucketIndexType*> featureBuckets,
+    TConstArrayRef<int> bucketCounts,
+    NCB::TIndexRange<int> docIndexRange,
+    TConstArrayRef<TBucketStats*> stats,
+    TUpdateFunc updateFunc
+) {
+    const TIndexType* indices = GetDataPtr(fold.Indices);
+    const bool simpleIndexing = fold.NonCtrDataPermutationBlockSize == fold.GetDocCount();
+    const ui32* docInDataProviderIndexing =
+        simpleIndexing ?
+        nullptr
+        : fold.LearnPermutationFeaturesSubset.Get<TIndexedSubset<ui32>>().data();
+    const int docInDataProviderBeginOffset = simpleIndexing ? fold.FeaturesSubsetBegin : 0;
+
+    ui32 blockDocInDataProvider[FUSED_HISTOGRAM_DOC_BLOCK_SIZE];
+    for (int blockBegin = docIndexRange.Begin; blockBegin < docIndexRange.End; blockBegin += FUSED_HISTOGRAM_DOC_BLOCK_SIZE) {
+        const int blockEnd = Min(blockBegin + FUSED_HISTOGRAM_DOC_BLOCK_SIZE, docIndexRange.End);
+        if (simpleIndexing) {
+            for (int doc = blockBegin; doc < blockEnd; ++doc) {
+                blockDocInDataProvider[doc - blockBegin] = docInDataProviderBeginOffset + doc;
+            }
+        } else {
+            for (int doc = blockBegin; doc < blockEnd; ++doc) {
+                blockDocInDataProvider[doc - blockBegin] = docInDataProviderIndexing[doc];
+            }
+        }
+        for (auto featureIdx : xrange(featureBuckets.size())) {
+            const TBucketIndexType* buckets = featureBuckets[featureIdx];
+            const int bucketCount = bucketCounts[featureIdx];
+            TBucketStats* featureStats = stats[featureIdx];
+            if (buckets == nullptr) {
+                for (int doc = blockBegin; doc < blockEnd; ++doc) {
+                    updateFunc(doc, featureStats + bucketCount * indices[doc]);
+                }
+                continue;
+            }
+            for (int doc = blockBegin; doc < blockEnd; ++doc) {
+                const int bucket = buckets[blockDocInDataProvider[doc - blockBegin]];
+                updateFunc(doc, featureStats + bucketCount * indices[doc] + bucket);
+            }
+        }
+    }
+}
+
+
+// Same as CalcStatsKernel, but for a group of features
+template <typename TBucketIndexType>
+inline static void CalcFusedStatsKernel(
+    bool isCaching,
+    const TCalcScoreFold& fold,
+    bool isPlainMode,
+    TConstArrayRef<const TBucketIndexType*> featureBuckets,
+    TConstArrayRef<int> bucketCounts,
+    int depth,
+    const TCalcScoreFold::TBodyTail& bt,
+    int dim,
+    NCB::TIndexRange<int> docIndexRange,
+    TConstArrayRef<TBucketStats*> stats
+) {
+    Y_ASSERT(!isCaching || depth > 0);
+    for (auto featureIdx : xrange(stats.size())) {
+        const TStatsIndexer indexer(bucketCounts[featureIdx]);
+        TBucketStats* featureStats = stats[featureIdx];
+        Fill(
+            featureStats + (isCaching ? indexer.CalcSize(depth - 1) : 0),
+            featureStats + indexer.CalcSize(depth),
+            TBucketStats{0, 0, 0, 0}
+        );
+    }
+
+    if (bt.TailFinish <= docIndexRange.Begin) {
+        return;
+    }
+    const bool hasPairwiseWeights = !bt.PairwiseWeights.empty();
+    const float* weightsData = hasPairwiseWeights ?
+        GetDataPtr(bt.PairwiseWeights) : GetDataPtr(fold.LearnWeights);
+    const float* sampleWeightsData = hasPairwiseWeights ?
+        GetDataPtr(bt.SamplePairwiseWeights) : GetDataPtr(fold.SampleWeights);
+    const double* sampleWeightedDerivativesData = GetDataPtr(bt.SampleWeightedDerivatives[dim]);
+
+    const auto updateWeighted = [&] (NCB::TIndexRange<int> range) {
+        UpdateFusedStats(
+            fold,
+            featureBuckets,
+            bucketCounts,
+            range,
+            stats,
+            [=] (int doc, TBucketStats* leafStats) {
+                leafStats->SumWeightedDelta += sampleWeightedDerivativesData[doc];
+                leafStats->SumWeight += sampleWeightsData[doc];
+            }
+        );
+    };
+
+    const int tailFinishInRange = Min((int)bt.TailFinish, docIndexRange.End);
+    if (isPlainMode) {
+        updateWeighted(NCB::TIndexRange<int>(docIndexRange.Begin, tailFinishInRange));
+        return;
+    }
+    if (bt.BodyFinish > docIndexRange.Begin) {
+        const double* derivativesData = GetDataPtr(bt.WeightedDerivatives[dim]);
+        const NCB::TIndexRange<int> bodyRange(docIndexRange.Begin, Min((int)bt.BodyFinish, docIndexRange.End));
+        if (weightsData == nullptr) {
+            UpdateFusedStats(
+                fold,
+                featureBuckets,
+                bucketCounts,
+                bodyRange,
+                stats,
+                [=] (int doc, TBucketStats* leafStats) {
+                    leafStats->SumDelta += derivativesData[doc];
+                    leafStats->Count += 1;
+                }
+            );
+        } else {
+            UpdateFusedStats(
+                fold,
+                featureBuckets,
+                bucketCounts,
+                bodyRange,
+                stats,
+                [=] (int doc, TBucketStats* leafStats) {
+                    leafStats->SumDelta += derivativesData[doc];
+                    leafStats->Count += weightsData[doc];
+                }
+            );
+        }
+    }
+    if (tailFinishInRange > bt.BodyFinish) {
+        updateWeighted(NCB::TIndexRange<int>(Max((int)bt.BodyFinish, docIndexRange.Begin), tailFinishInRange));
+    }
+}
+
+
+// Same as CalcStatsImpl, but reads derivatives and leaf indices once for a group of features,
+// stats from previous level are not fixed up
+template <typename TBucketIndexType>
+static void CalcFusedStatsImpl(
+    const TCalcScoreFold& fold,
+    TConstArrayRef<const TBucketIndexType*> featureBuckets,
+    TConstArrayRef<int> bucketCounts,
+    TConstArrayRef<int> splitStatsCounts,
+    bool isCaching,
+    bool isPlainMode,
+    int depth,
+    NPar::TLocalExecutor* localExecutor,
+    TVector<TBucketStatsRefOptionalHolder>* stats
+) {
+    Y_ASSERT(!isCaching || depth > 0);
+
+    const int featureCount = featureBuckets.size();
+    const int approxDimension = fold.GetApproxDimension();
+    const int bodyTailStatsCount = fold.GetBodyTailCount() * approxDimension;
+
+    NCB::MapMerge(
+        localExecutor,
+        fold.GetCalcStatsIndexRanges(),
+        /*mapFunc*/[&](NCB::TIndexRange<int> indexRange, TVector<TBucketStatsRefOptionalHolder>* output) {
+            const NCB::TIndexRange<int> docIndexRange = GetCalcStatsDocIndexRange(fold, indexRange);
+
+            if (output->empty()) {
+                output->resize(featureCount);
+                for (auto featureIdx : xrange(featureCount)) {
+                    (*output)[featureIdx] = TBucketStatsRefOptionalHolder(
+                        bodyTailStatsCount * splitStatsCounts[featureIdx]);
+                }
+            } else {
+                Y_ASSERT(docIndexRange.Begin == 0);
+            }
+
+            TVector<TBucketStats*> statsSubsets(featureCount);
+            for (int bodyTailIdx : xrange(fold.GetBodyTailCount())) {
+                for (int dim : xrange(approxDimension)) {
+                    for (auto featureIdx : xrange(featureCount)) {
+                        statsSubsets[featureIdx] = (*output)[featureIdx].GetData().Data()
+                            + (bodyTailIdx * approxDimension + dim) * splitStatsCounts[featureIdx];
+                    }
+                    CalcFusedStatsKernel(
+                        isCaching && (indexRange.Begin == 0),
+                        fold,
+                        isPlainMode,
+                        featureBuckets,
+                        bucketCounts,
+                        depth,
+                        fold.BodyTailArr[bodyTailIdx],
+                        dim,
+                        docIndexRange,
+                        statsSubsets
+                    );
+                }
+            }
+        },
+        /*mergeFunc*/[&](
+            TVector<TBucketStatsRefOptionalHolder>* output,
+            TVector<TVector<TBucketStatsRefOptionalHolder>>&& addVector
+        ) {
+            for (auto featureIdx : xrange(featureCount)) {
+                const int filledSplitStatsCount = TStatsIndexer(bucketCounts[featureIdx]).CalcSize(depth);
+                for (int statsIdx : xrange(bodyTailStatsCount)) {
+                    const int statsBegin = statsIdx * splitStatsCounts[featureIdx];
+                    TBucketStats* outputStatsSubset = (*output)[featureIdx].GetData().Data() + statsBegin;
+                    for (const auto& addItem : addVector) {
+                        const TBucketStats* addStatsSubset = addItem[featureIdx].GetData().Data() + statsBegin;
+                        for (int i : xrange(filledSplitStatsCount)) {
+                            outputStatsSubset[i].Add(addStatsSubset[i]);
+                        }
+                    }
+                }
+            }
+        },
+        stats
+    );
+}
+
+
+// Adds histogram of a features pack to histogram of one of its features for leaves in leafIndexRange
+inline static void UnpackFeaturesPackStats(
+    const TStatsIndexer& packIndexer,
+    const TBucketStats* packStats,
+    NCB::TIndexRange<int> leafIndexRange,
+    const TQuantizedForCPUObjectsDataProvider::TPackedFeatureIndex& packedIndex,
+    const TStatsIndexer& featureIndexer,
+    TBucketStats* featureStats
+) {
+    const int bucketMask = (1 << packedIndex.BitCount) - 1;
+    for (int leaf : leafIndexRange.Iter()) {
+        Fill(
+            featureStats + featureIndexer.GetIndex(leaf, 0),
+            featureStats + featureIndexer.GetIndex(leaf + 1, 0),
+            TBucketStats{0, 0, 0, 0}
+        );
+        for (int packValue : xrange(packIndexer.BucketCount)) {
+            const int bucket = (packValue >> packedIndex.BitOffset) & bucketMask;
+            // pack values with such buckets do not occur in data
+            if (bucket < featureIndexer.BucketCount) {
+                featureStats[featureIndexer.GetIndex(leaf, bucket)].Add(packStats[packIndexer.GetIndex(leaf, packValue)]);
+            }
+        }
+    }
+}
+
+
+// Builds histogram of a sparse feature for leaves in leafIndexRange from stats of documents
+// with non-default bins, stats of the default bin are leaf totals minus stats of other bins
+inline static void CalcSparseFeatureStats(
+    const TCalcScoreFold& fold,
+    TConstArrayRef<ui32> docInFoldBySrcIdx,
+    const TQuantizedForCPUObjectsDataProvider::TSparseFeatureValues& sparseValues,
+    bool isPlainMode,
+    NCB::TIndexRange<int> leafIndexRange,
+    const TBucketStats* leafTotals, // [leaf]
+    const TStatsIndexer& indexer,
+    const TCalcScoreFold::TBodyTail& bt,
+    int dim,
+    TBucketStats* stats
+) {
+    Fill(
+        stats + indexer.GetIndex(leafIndexRange.Begin, 0),
+        stats + indexer.GetIndex(leafIndexRange.End, 0),
+        TBucketStats{0, 0, 0, 0}
+    );
+
+    const TIndexType* indices = GetDataPtr(fold.Indices);
+    const bool hasPairwiseWeights = !bt.PairwiseWeights.empty();
+    const float* weightsData = hasPairwiseWeights ?
+        GetDataPtr(bt.PairwiseWeights) : GetDataPtr(fold.LearnWeights);
+    const float* sampleWeightsData = hasPairwiseWeights ?
+        GetDataPtr(bt.SamplePairwiseWeights) : GetDataPtr(fold.SampleWeights);
+    const double* sampleWeightedDerivativesData = GetDataPtr(bt.SampleWeightedDerivatives[dim]);
+    const double* derivativesData = isPlainMode ? nullptr : GetDataPtr(bt.WeightedDerivatives[dim]);
+    const int bodyFinish = isPlainMode ? 0 : (int)bt.BodyFinish;
+    const int tailFinish = bt.TailFinish;
+
+    for (auto i : xrange(sparseValues.NonDefaultSrcIndices.size())) {
+        const ui32 srcIdx = sparseValues.NonDefaultSrcIndices[i];
+        if (srcIdx >= docInFoldBySrcIdx.size()) {
+            break;
+        }
+        const ui32 doc = docInFoldBySrcIdx[srcIdx];
+        if (doc >= (ui32)tailFinish) {
+            continue;
+        }
+        TBucketStats& leafStats = stats[indexer.GetIndex(indices[doc], sparseValues.NonDefaultBins[i])];
+        if ((int)doc < bodyFinish) {
+            leafStats.SumDelta += derivativesData[doc];
+            leafStats.Count += weightsData == nullptr ? 1.0f : weightsData[doc];
+        } else {
+            leafStats.SumWeightedDelta += sampleWeightedDerivativesData[doc];
+            leafStats.SumWeight += sampleWeightsData[doc];
+        }
+    }
+
+    for (int leaf : leafIndexRange.Iter()) {
+        TBucketStats& defaultStats = stats[indexer.GetIndex(leaf, sparseValues.DefaultBin)];
+        defaultStats = leafTotals[leaf];
+        for (int bucket : xrange(indexer.BucketCount)) {
+            if (bucket != sparseValues.DefaultBin) {
+                defaultStats.Remove(stats[indexer.GetIndex(leaf, bucket)]);
+            }
+        }
+    }
+}
+
+
 // Calculate score numerator summand
 inline static double CountDp(double avrg, const TBucketStats& leafStats) {
     return avrg * leafStats.SumWeightedDelta;
@@ -822,7 +1164,15 @@ void CalcStatsAndScores(
 
         const auto& treeOptions = fitParams.ObliviousTreeOptions.Get();
 
-        if (!useTreeLevelCaching) {
+        TVector<TBucketStats, TPoolAllocator>* splitStatsFromCache = nullptr;
+        bool areStatsDirty = true;
+        if (useTreeLevelCaching) {
+            splitStatsFromCache = statsFromPrevTree->GetStats(
+                split,
+                indexer.CalcSize(treeOptions.MaxDepth),
+                &areStatsDirty); // thread-safe access
+        }
+        if (splitStatsFromCache == nullptr) {
             splitStatsCount = indexer.CalcSize(depth);
             const int statsCount =
                 fold.GetBodyTailCount() * fold.GetApproxDimension() * splitStatsCount;
@@ -842,10 +1192,7 @@ void CalcStatsAndScores(
             );
         } else {
             splitStatsCount = indexer.CalcSize(treeOptions.MaxDepth);
-            bool areStatsDirty;
-            TVector<TBucketStats, TPoolAllocator>& splitStatsFromCache =
-                statsFromPrevTree->GetStats(split, splitStatsCount, &areStatsDirty); // thread-safe access
-            extOrInSplitStats = TBucketStatsRefOptionalHolder(splitStatsFromCache);
+            extOrInSplitStats = TBucketStatsRefOptionalHolder(*splitStatsFromCache);
             if (depth == 0 || areStatsDirty) {
                 selectCalcStatsImpl(
                     /*isCaching*/ std::false_type(),
@@ -865,7 +1212,7 @@ void CalcStatsAndScores(
                 TBucketStatsCache::GetStatsInUse(fold.GetBodyTailCount() * fold.GetApproxDimension(),
                     splitStatsCount,
                     indexer.CalcSize(depth),
-                    splitStatsFromCache
+                    *splitStatsFromCache
                 ).swap(stats3d->Stats);
                 stats3d->BucketCount = bucketCount;
                 stats3d->MaxLeafCount = 1U << depth;
@@ -889,6 +1236,264 @@ void CalcStatsAndScores(
     }
 }
 
+void CalcScoresForFeatureGroup(
+    const TQuantizedForCPUObjectsDataProvider& objectsDataProvider,
+    const TVector<int>& splitsCount,
+    const TCalcScoreFold& fold,
+    const TCalcScoreFold& prevLevelData,
+    const TFold& initialFold,
+    const NCatboostOptions::TCatBoostOptions& fitParams,
+    TConstArrayRef<TSplitCandidate> splits,
+    int depth,
+    bool useTreeLevelCaching,
+    NPar::TLocalExecutor* localExecutor,
+    TBucketStatsCache* statsFromPrevTree,
+    TVector<TVector<TScoreBin>>* scoreBins
+) {
+    CB_ENSURE(
+        !IsPairwiseScoring(fitParams.LossFunctionDescription->GetLossFunction()),
+        "Fused histograms are not supported for pairwise scoring");
+
+    const int featureCount = splits.size();
+    const bool isPlainMode = IsPlainMode(fitParams.BoostingOptions->BoostingType);
+    const float l2Regularizer = static_cast<const float>(fitParams.ObliviousTreeOptions->L2Reg);
+    const int bodyTailStatsCount = fold.GetBodyTailCount() * fold.GetApproxDimension();
+
+    TVector<int> bucketCounts(featureCount);
+    TVector<int> splitStatsCounts(featureCount);
+    TVector<TBucketStatsRefOptionalHolder> splitStats(featureCount);
+    TVector<bool> useCachedStats(featureCount, false);
+    for (auto featureIdx : xrange(featureCount)) {
+        const auto& split = splits[featureIdx];
+        CB_ENSURE(
+            split.Type == ESplitType::FloatFeature || split.Type == ESplitType::OneHotFeature,
+            "Fused histograms are supported only for float and one-hot features");
+        bucketCounts[featureIdx] =
+            GetSplitCount(splitsCount, *objectsDataProvider.GetQuantizedFeaturesInfo(), split) + 1;
+        const TStatsIndexer indexer(bucketCounts[featureIdx]);
+        TVector<TBucketStats, TPoolAllocator>* splitStatsFromCache = nullptr;
+        bool areStatsDirty = true;
+        if (useTreeLevelCaching) {
+            splitStatsFromCache = statsFromPrevTree->GetStats(
+                split,
+                indexer.CalcSize(fitParams.ObliviousTreeOptions->MaxDepth),
+                &areStatsDirty); // thread-safe access
+        }
+        if (splitStatsFromCache == nullptr) {
+            splitStatsCounts[featureIdx] = indexer.CalcSize(depth);
+            splitStats[featureIdx] = TBucketStatsRefOptionalHolder(bodyTailStatsCount * splitStatsCounts[featureIdx]);
+        } else {
+            splitStatsCounts[featureIdx] = indexer.CalcSize(fitParams.ObliviousTreeOptions->MaxDepth);
+            splitStats[featureIdx] = TBucketStatsRefOptionalHolder(*splitStatsFromCache);
+            useCachedStats[featureIdx] = depth > 0 && !areStatsDirty;
+        }
+    }
+
+    // features which stats are updated from previous level are calculated on smaller fold
+    for (bool isCaching : {false, true}) {
+        const TCalcScoreFold& statsFold = isCaching ? prevLevelData : fold;
+
+        TMap<ui32, TVector<int>> packedFeatureIndices; // packIdx -> [featureIdx]
+        for (auto featureIdx : xrange(featureCount)) {
+            const auto& split = splits[featureIdx];
+            if (useCachedStats[featureIdx] == isCaching && split.Type == ESplitType::FloatFeature) {
+                const auto& packedIndex = objectsDataProvider.GetFloatFeaturePackedIndex((ui32)split.FeatureIdx);
+                if (packedIndex) {
+                    packedFeatureIndices[packedIndex->PackIdx].push_back(featureIdx);
+                }
+            }
+        }
+        // packed features have no bins of their own, their stats are always unpacked from the histogram of a pack
+
+        TVector<const ui8*> floatBuckets;
+        TVector<const ui32*> oneHotBuckets;
+        TVector<int> floatFeatureIndices;
+        TVector<int> oneHotFeatureIndices;
+        TVector<int> sparseFeatureIndices;
+        for (auto featureIdx : xrange(featureCount)) {
+            const auto& split = splits[featureIdx];
+            if (useCachedStats[featureIdx] != isCaching) {
+                continue;
+            }
+            if (split.Type == ESplitType::FloatFeature) {
+                if (objectsDataProvider.GetFloatFeatureSparseValues((ui32)split.FeatureIdx)) {
+                    sparseFeatureIndices.push_back(featureIdx);
+                    continue;
+                }
+                if (objectsDataProvider.GetFloatFeaturePackedIndex((ui32)split.FeatureIdx)) {
+                    continue;
+                }
+                floatBuckets.push_back(objectsDataProvider.GetFloatFeatureRawSrcData((ui32)split.FeatureIdx));
+                floatFeatureIndices.push_back(featureIdx);
+            } else {
+                oneHotBuckets.push_back(objectsDataProvider.GetCatFeatureRawSrcData((ui32)split.FeatureIdx));
+                oneHotFeatureIndices.push_back(featureIdx);
+            }
+        }
+        const auto calcGroupStats = [&] (const auto& featureBuckets, const TVector<int>& featureIndices) {
+            if (featureIndices.empty()) {
+                return;
+            }
+            TVector<int> groupBucketCounts;
+            TVector<int> groupSplitStatsCounts;
+            TVector<TBucketStatsRefOptionalHolder> groupStats;
+            for (int featureIdx : featureIndices) {
+                groupBucketCounts.push_back(bucketCounts[featureIdx]);
+                groupSplitStatsCounts.push_back(splitStatsCounts[featureIdx]);
+                groupStats.emplace_back(splitStats[featureIdx].GetData());
+            }
+            CalcFusedStatsImpl(
+                statsFold,
+                MakeArrayRef(featureBuckets),
+                MakeArrayRef(groupBucketCounts),
+                MakeArrayRef(groupSplitStatsCounts),
+                isCaching,
+                isPlainMode,
+                depth,
+                localExecutor,
+                &groupStats
+            );
+        };
+        calcGroupStats(floatBuckets, floatFeatureIndices);
+        calcGroupStats(oneHotBuckets, oneHotFeatureIndices);
+
+        if (!packedFeatureIndices.empty()) {
+            using TFeaturesPack = TQuantizedForCPUObjectsDataProvider::TFeaturesPack;
+            const TStatsIndexer packIndexer(1 << (sizeof(TFeaturesPack) * CHAR_BIT));
+            const int packSplitStatsCount = packIndexer.CalcSize(depth);
+            TVector<const TFeaturesPack*> packBuckets;
+            for (const auto& [packIdx, packFeatureIndices] : packedFeatureIndices) {
+                packBuckets.push_back(objectsDataProvider.GetFeaturesPackRawSrcData(packIdx));
+            }
+            const TVector<int> packBucketCounts(packBuckets.size(), packIndexer.BucketCount);
+            const TVector<int> packSplitStatsCounts(packBuckets.size(), packSplitStatsCount);
+            TVector<TBucketStatsRefOptionalHolder> packStats(packBuckets.size());
+            for (auto& packStatsHolder : packStats) {
+                packStatsHolder = TBucketStatsRefOptionalHolder(bodyTailStatsCount * packSplitStatsCount);
+            }
+            CalcFusedStatsImpl(
+                statsFold,
+                TConstArrayRef<const TFeaturesPack*>(packBuckets),
+                MakeArrayRef(packBucketCounts),
+                MakeArrayRef(packSplitStatsCounts),
+                isCaching,
+                isPlainMode,
+                depth,
+                localExecutor,
+                &packStats
+            );
+
+            const int leafCount = 1 << depth;
+            const NCB::TIndexRange<int> leafIndexRange(isCaching ? leafCount / 2 : 0, leafCount);
+            int packStatsIdx = 0;
+            for (const auto& [packIdx, packFeatureIndices] : packedFeatureIndices) {
+                for (int featureIdx : packFeatureIndices) {
+                    const auto& packedIndex =
+                        *objectsDataProvider.GetFloatFeaturePackedIndex((ui32)splits[featureIdx].FeatureIdx);
+                    for (int statsIdx : xrange(bodyTailStatsCount)) {
+                        UnpackFeaturesPackStats(
+                            packIndexer,
+                            packStats[packStatsIdx].GetData().Data() + statsIdx * packSplitStatsCount,
+                            leafIndexRange,
+                            packedIndex,
+                            TStatsIndexer(bucketCounts[featureIdx]),
+                            splitStats[featureIdx].GetData().Data() + statsIdx * splitStatsCounts[featureIdx]
+                        );
+                    }
+                }
+                ++packStatsIdx;
+            }
+        }
+
+        if (!sparseFeatureIndices.empty()) {
+            const int leafCount = 1 << depth;
+            const TVector<const ui8*> totalsBuckets = {nullptr};
+            const TVector<int> totalsBucketCounts = {1};
+            const TVector<int> totalsSplitStatsCounts = {leafCount};
+            TVector<TBucketStatsRefOptionalHolder> leafTotals(1);
+            leafTotals[0] = TBucketStatsRefOptionalHolder(bodyTailStatsCount * leafCount);
+            CalcFusedStatsImpl(
+                statsFold,
+                MakeArrayRef(totalsBuckets),
+                MakeArrayRef(totalsBucketCounts),
+                MakeArrayRef(totalsSplitStatsCounts),
+                isCaching,
+                isPlainMode,
+                depth,
+                localExecutor,
+                &leafTotals
+            );
+
+            const NCB::TIndexRange<int> leafIndexRange(isCaching ? leafCount / 2 : 0, leafCount);
+            const int approxDimension = statsFold.GetApproxDimension();
+            const auto docInFoldBySrcIdx = statsFold.GetDocInFoldBySrcIdx(
+                objectsDataProvider.GetFloatFeatureSparseValues((ui32)splits[sparseFeatureIndices[0]].FeatureIdx)->SrcSize,
+                localExecutor
+            );
+            localExecutor->ExecRangeWithThrow(
+                [&] (int sparseFeatureIdx) {
+                    const int featureIdx = sparseFeatureIndices[sparseFeatureIdx];
+                    const auto& sparseValues =
+                        *objectsDataProvider.GetFloatFeatureSparseValues((ui32)splits[featureIdx].FeatureIdx);
+                    for (int bodyTailIdx : xrange(statsFold.GetBodyTailCount())) {
+                        for (int dim : xrange(approxDimension)) {
+                            const int statsIdx = bodyTailIdx * approxDimension + dim;
+                            CalcSparseFeatureStats(
+                                statsFold,
+                                docInFoldBySrcIdx,
+                                sparseValues,
+                                isPlainMode,
+                                leafIndexRange,
+                                leafTotals[0].GetData().Data() + statsIdx * leafCount,
+                                TStatsIndexer(bucketCounts[featureIdx]),
+                                statsFold.BodyTailArr[bodyTailIdx],
+                                dim,
+                                splitStats[featureIdx].GetData().Data() + statsIdx * splitStatsCounts[featureIdx]
+                            );
+                        }
+                    }
+                },
+                0,
+                sparseFeatureIndices.ysize(),
+                NPar::TLocalExecutor::WAIT_COMPLETE
+            );
+        }
+
+        if (isCaching) {
+            for (auto featureIdx : xrange(featureCount)) {
+                if (!useCachedStats[featureIdx]) {
+                    continue;
+                }
+                const TStatsIndexer indexer(bucketCounts[featureIdx]);
+                for (int statsIdx : xrange(bodyTailStatsCount)) {
+                    FixUpStats(
+                        depth,
+                        indexer,
+                        prevLevelData.SmallestSplitSideValue,
+                        splitStats[featureIdx].GetData().Data() + statsIdx * splitStatsCounts[featureIdx]
+                    );
+                }
+            }
+        }
+    }
+
+    scoreBins->resize(featureCount);
+    for (auto featureIdx : xrange(featureCount)) {
+        CalculateNonPairwiseScore(
+            fold,
+            initialFold,
+            splits[featureIdx],
+            isPlainMode,
+            1 << depth,
+            l2Regularizer,
+            TStatsIndexer(bucketCounts[featureIdx]),
+            splitStats[featureIdx].GetData().Data(),
+            splitStatsCounts[featureIdx],
+            &(*scoreBins)[featureIdx]
+        );
+    }
+}
+
 TVector<TScoreBin> GetScoreBins(
     const TStats3D& stats,
     ESplitType splitType,
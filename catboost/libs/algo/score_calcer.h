@@ -38,6 +38,27 @@ void CalcStatsAndScores(
     TVector<TScoreBin>* scoreBins // can be nullptr, if so - don't calc and return this data (used in dictributed mode now)
 );
 
+// Max number of float or one-hot features which histograms are built in one pass over documents
+constexpr int FUSED_HISTOGRAM_MAX_FEATURE_COUNT = 32;
+
+// Same as CalcStatsAndScores with scoreBins for each of float or one-hot split candidates,
+// but derivatives, weights and leaf indices are read once per document for all candidates.
+// Not applicable to pairwise scoring.
+void CalcScoresForFeatureGroup(
+    const NCB::TQuantizedForCPUObjectsDataProvider& objectsDataProvider,
+    const TVector<int>& splitsCount,
+    const TCalcScoreFold& fold,
+    const TCalcScoreFold& prevLevelData,
+    const TFold& initialFold,
+    const NCatboostOptions::TCatBoostOptions& fitParams,
+    TConstArrayRef<TSplitCandidate> splits,
+    int depth,
+    bool useTreeLevelCaching,
+    NPar::TLocalExecutor* localExecutor,
+    TBucketStatsCache* statsFromPrevTree,
+    TVector<TVector<TScoreBin>>* scoreBins // [splitIdx][binFeatureIdx]
+);
+
 TVector<TScoreBin> GetScoreBins(
     const TStats3D& stats,
     ESplitType splitType,
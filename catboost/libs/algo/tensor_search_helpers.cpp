@@ -2,6 +2,14 @@
 
 #include <catboost/libs/helpers/restorable_rng.h>
 
+#include <util/generic/algorithm.h>
+#include <util/generic/cast.h>
+#include <util/generic/xrange.h>
+#include <util/generic/ymath.h>
+
+#include <cmath>
+#include <limits>
+
 THolder<IDerCalcer> BuildError(
     const NCatboostOptions::TCatBoostOptions& params,
     const TMaybe<TCustomObjectiveDescriptor>& descriptor
@@ -155,6 +163,97 @@ static void GenerateBernoulliWeightsForPairs(
     }, 0, blockParams.GetBlockCount(), NPar::TLocalExecutor::WAIT_COMPLETE);
 }
 
+double CalcMvsThreshold(TArrayRef<double> values, double sampleSize) {
+    // quickselect over candidate thresholds: sumSmall is sum of values known to be below threshold,
+    // largeCount is count of values known to be above it
+    double sumSmall = 0;
+    double largeCount = 0;
+    double minLarge = std::numeric_limits<double>::infinity();
+    auto begin = values.begin();
+    auto end = values.end();
+    while (begin != end) {
+        const double pivot = *(begin + (end - begin) / 2);
+        const auto lessEnd = std::partition(begin, end, [=] (double value) { return value < pivot; });
+        const auto equalEnd = std::partition(lessEnd, end, [=] (double value) { return value == pivot; });
+        const double sumLess = Accumulate(begin, lessEnd, 0.0);
+        if (pivot == 0 || (sumSmall + sumLess) / pivot + largeCount + (end - lessEnd) > sampleSize) {
+            sumSmall += sumLess + pivot * (equalEnd - lessEnd);
+            begin = equalEnd;
+        } else {
+            largeCount += end - lessEnd;
+            minLarge = pivot;
+            end = lessEnd;
+        }
+    }
+    return largeCount < sampleSize ? sumSmall / (sampleSize - largeCount) : minLarge;
+}
+
+void GenerateMvsSampleWeights(
+    TConstArrayRef<double> gradientNorms,
+    double threshold,
+    ui64 randSeed,
+    NPar::TLocalExecutor* localExecutor,
+    TArrayRef<float> sampleWeights
+) {
+    Y_ASSERT(gradientNorms.size() == sampleWeights.size());
+    NPar::TLocalExecutor::TExecRangeParams blockParams(0, SafeIntegerCast<int>(gradientNorms.size()));
+    blockParams.SetBlockSize(1000);
+    localExecutor->ExecRange([&](int blockIdx) {
+        TRestorableFastRng64 rand(randSeed + blockIdx);
+        rand.Advance(10); // reduce correlation between RNGs in different threads
+        NPar::TLocalExecutor::BlockedLoopBody(blockParams, [=, &rand](int i) {
+            // zero threshold means that all documents are large
+            const double probability = threshold > 0 ? Min(1.0, gradientNorms[i] / threshold) : 1.0;
+            sampleWeights[i] = rand.GenRandReal1() < probability ? 1.0 / probability : 0.0;
+        })(blockIdx);
+    }, 0, blockParams.GetBlockCount(), NPar::TLocalExecutor::WAIT_COMPLETE);
+}
+
+// Keeps documents with large gradients, samples others with probabilities proportional to gradients
+// and reweights them, so that sampled gradient sums are unbiased
+static void GenerateMvsWeights(
+    int learnSampleCount,
+    float takenFraction,
+    NPar::TLocalExecutor* localExecutor,
+    TRestorableFastRng64* rand,
+    TFold* fold
+) {
+    if (takenFraction == 1.0f) {
+        Fill(fold->SampleWeights.begin(), fold->SampleWeights.end(), 1);
+        return;
+    }
+
+    Y_ASSERT(fold->BodyTailArr.size() == 1);
+    const auto& bt = fold->BodyTailArr[0];
+    const auto& derivativesArena = fold->Derivatives;
+    TVector<double> gradientNorms;
+    gradientNorms.yresize(learnSampleCount);
+    TVector<double> thresholdCandidates;
+    thresholdCandidates.yresize(learnSampleCount);
+    NPar::TLocalExecutor::TExecRangeParams blockParams(0, learnSampleCount);
+    blockParams.SetBlockSize(4000);
+    localExecutor->ExecRange([&](int blockIdx) {
+        const int blockBegin = blockIdx * blockParams.GetBlockSize();
+        const int blockEnd = Min(blockBegin + blockParams.GetBlockSize(), learnSampleCount);
+        Fill(gradientNorms.begin() + blockBegin, gradientNorms.begin() + blockEnd, 0.0);
+        for (const auto& derivativesRange : bt.WeightedDerivatives) {
+            Y_ASSERT(derivativesRange.Begin == 0 && derivativesRange.End == learnSampleCount);
+            derivativesArena.Visit(derivativesRange, [&](auto derivatives) {
+                for (int i : xrange(blockBegin, blockEnd)) {
+                    gradientNorms[i] += Sqr<double>(derivatives[i]);
+                }
+            });
+        }
+        for (int i : xrange(blockBegin, blockEnd)) {
+            gradientNorms[i] = sqrt(gradientNorms[i]);
+            thresholdCandidates[i] = gradientNorms[i];
+        }
+    }, 0, blockParams.GetBlockCount(), NPar::TLocalExecutor::WAIT_COMPLETE);
+
+    const double threshold = CalcMvsThreshold(thresholdCandidates, takenFraction * learnSampleCount);
+    GenerateMvsSampleWeights(gradientNorms, threshold, rand->GenRand(), localExecutor, fold->SampleWeights);
+}
+
 static void CalcWeightedData(
     int learnSampleCount,
     EBoostingType boostingType,
@@ -179,12 +278,19 @@ static void CalcWeightedData(
              , NPar::TLocalExecutor::WAIT_COMPLETE);
         }
         for (int dim = 0; dim < approxDimension; ++dim) {
-            const double* weightedDerivativesData = bt.WeightedDerivatives[dim].data();
-            double* sampleWeightedDerivativesData = bt.SampleWeightedDerivatives[dim].data();
-            localExecutor->ExecRange([=](int z) {
-                sampleWeightedDerivativesData[z] = weightedDerivativesData[z] * sampleWeightsData[z];
-            }, NPar::TLocalExecutor::TExecRangeParams(begin, bt.TailFinish).SetBlockSize(4000)
-             , NPar::TLocalExecutor::WAIT_COMPLETE);
+            const int sampleWeightedBegin = bt.SampleWeightedDerivatives[dim].Begin;
+            Y_ASSERT(sampleWeightedBegin <= begin);
+            const auto& weightedDerivativesArena = ff.Derivatives;
+            weightedDerivativesArena.Visit(bt.WeightedDerivatives[dim], [&](auto weightedDerivatives) {
+                ff.Derivatives.Visit(bt.SampleWeightedDerivatives[dim], [&](auto sampleWeightedDerivatives) {
+                    const auto* weightedDerivativesData = weightedDerivatives.data();
+                    auto* sampleWeightedDerivativesData = sampleWeightedDerivatives.data();
+                    localExecutor->ExecRange([=](int z) {
+                        sampleWeightedDerivativesData[z - sampleWeightedBegin] = weightedDerivativesData[z] * sampleWeightsData[z];
+                    }, NPar::TLocalExecutor::TExecRangeParams(begin, bt.TailFinish).SetBlockSize(4000)
+                     , NPar::TLocalExecutor::WAIT_COMPLETE);
+                });
+            });
         }
     }
 
@@ -225,6 +331,10 @@ void Bootstrap(
                 GenerateRandomWeights(learnSampleCount, baggingTemperature, localExecutor, rand, fold);
             }
             break;
+        case EBootstrapType::MVS:
+            CB_ENSURE(!isPairwiseScoring, "MVS bootstrap is not supported for pairwise scoring");
+            GenerateMvsWeights(learnSampleCount, takenFraction, localExecutor, rand, fold);
+            break;
         case EBootstrapType::No:
             if (!isPairwiseScoring) {
                 Fill(fold->SampleWeights.begin(), fold->SampleWeights.end(), 1);
@@ -239,6 +349,40 @@ void Bootstrap(
     sampledDocs->Sample(*fold, indices, rand, localExecutor);
 }
 
+static void CalcFirstDerRange(
+    const IDerCalcer& error,
+    int start,
+    int count,
+    const double* approxes,
+    const float* targets,
+    const float* weights,
+    TArrayRef<double> firstDers
+) {
+    error.CalcFirstDerRange(start, count, approxes, /*approxDeltas*/ nullptr, targets, weights, firstDers.data());
+}
+
+static void CalcFirstDerRange(
+    const IDerCalcer& error,
+    int start,
+    int count,
+    const double* approxes,
+    const float* targets,
+    const float* weights,
+    TArrayRef<float> firstDers
+) {
+    TVector<double> blockFirstDers;
+    blockFirstDers.yresize(count);
+    error.CalcFirstDerRange(
+        0,
+        count,
+        approxes + start,
+        /*approxDeltas*/ nullptr,
+        targets + start,
+        weights ? weights + start : nullptr,
+        blockFirstDers.data());
+    Copy(blockFirstDers.begin(), blockFirstDers.end(), firstDers.begin() + start);
+}
+
 void CalcWeightedDerivatives(
     const IDerCalcer& error,
     int bodyTailIdx,
@@ -251,7 +395,7 @@ void CalcWeightedDerivatives(
     const TVector<TVector<double>>& approx = bt.Approx;
     const TVector<float>& target = takenFold->LearnTarget;
     const TVector<float>& weight = takenFold->GetLearnWeights();
-    TVector<TVector<double>>* weightedDerivatives = &bt.WeightedDerivatives;
+    TDerivativesArena& derivatives = takenFold->Derivatives;
 
     if (error.GetErrorType() == EErrorType::QuerywiseError || error.GetErrorType() == EErrorType::PairwiseError) {
         TVector<TQueryInfo> recalculatedQueriesInfo;
@@ -262,11 +406,13 @@ void CalcWeightedDerivatives(
         const TVector<TQueryInfo>& queriesInfo = shouldGenerateYetiRankPairs ? recalculatedQueriesInfo : takenFold->LearnQueriesInfo;
 
         const int tailQueryFinish = bt.TailQueryFinish;
-        TVector<TDers> ders((*weightedDerivatives)[0].ysize());
+        TVector<TDers> ders(bt.TailFinish);
         error.CalcDersForQueries(0, tailQueryFinish, approx[0], target, weight, queriesInfo, &ders, localExecutor);
-        for (int docId = 0; docId < ders.ysize(); ++docId) {
-            (*weightedDerivatives)[0][docId] = ders[docId].Der1;
-        }
+        derivatives.Visit(bt.WeightedDerivatives[0], [&](auto weightedDerivatives) {
+            for (int docId = 0; docId < ders.ysize(); ++docId) {
+                weightedDerivatives[docId] = ders[docId].Der1;
+            }
+        });
         if (params.LossFunctionDescription->GetLossFunction() == ELossFunction::YetiRankPairwise) {
             // In case of YetiRankPairwise loss function we need to store generated pairs for tree structure building.
             Y_ASSERT(takenFold->BodyTailArr.size() == 1);
@@ -280,28 +426,41 @@ void CalcWeightedDerivatives(
 
         Y_ASSERT(error.GetErrorType() == EErrorType::PerObjectError);
         if (approxDimension == 1) {
+            derivatives.Visit(bt.WeightedDerivatives[0], [&](auto weightedDerivatives) {
+                localExecutor->ExecRange([&](int blockId) {
+                    const int blockOffset = blockId * blockParams.GetBlockSize();
+                    CalcFirstDerRange(
+                        error,
+                        blockOffset,
+                        Min<int>(blockParams.GetBlockSize(), tailFinish - blockOffset),
+                        approx[0].data(),
+                        target.data(),
+                        weight.data(),
+                        weightedDerivatives);
+                }, 0, blockParams.GetBlockCount(), NPar::TLocalExecutor::WAIT_COMPLETE);
+            });
+        } else {
             localExecutor->ExecRange([&](int blockId) {
                 const int blockOffset = blockId * blockParams.GetBlockSize();
-                error.CalcFirstDerRange(blockOffset, Min<int>(blockParams.GetBlockSize(), tailFinish - blockOffset),
-                    approx[0].data(),
-                    nullptr, // no approx deltas
+                const int blockSize = Min<int>(blockParams.GetBlockSize(), tailFinish - blockOffset);
+                TVector<double> blockDers; // [(z - blockOffset) * approxDimension + dim]
+                blockDers.yresize(blockSize * approxDimension);
+                error.CalcDersMultiRange(
+                    blockOffset,
+                    blockSize,
+                    approx,
+                    /*approxDeltas*/ {},
                     target.data(),
-                    weight.data(),
-                    (*weightedDerivatives)[0].data());
-            }, 0, blockParams.GetBlockCount(), NPar::TLocalExecutor::WAIT_COMPLETE);
-        } else {
-            localExecutor->ExecRange([&](int blockId) {
-                TVector<double> curApprox(approxDimension);
-                TVector<double> curDelta(approxDimension);
-                NPar::TLocalExecutor::BlockedLoopBody(blockParams, [&](int z) {
-                    for (int dim = 0; dim < approxDimension; ++dim) {
-                        curApprox[dim] = approx[dim][z];
-                    }
-                    error.CalcDersMulti(curApprox, target[z], weight.empty() ? 1 : weight[z], &curDelta, nullptr);
-                    for (int dim = 0; dim < approxDimension; ++dim) {
-                        (*weightedDerivatives)[dim][z] = curDelta[dim];
-                    }
-                })(blockId);
+                    weight.empty() ? nullptr : weight.data(),
+                    blockDers,
+                    /*der2s*/ {});
+                for (int dim = 0; dim < approxDimension; ++dim) {
+                    derivatives.Visit(bt.WeightedDerivatives[dim], [&](auto weightedDerivatives) {
+                        for (int z = 0; z < blockSize; ++z) {
+                            weightedDerivatives[blockOffset + z] = blockDers[z * approxDimension + dim];
+                        }
+                    });
+                }
             }, 0, blockParams.GetBlockCount(), NPar::TLocalExecutor::WAIT_COMPLETE);
         }
     }
@@ -41,6 +41,20 @@ struct TCandidatesInfoList {
 
 using TCandidateList = TVector<TCandidatesInfoList>;
 
+// Threshold mu of minimal variance sampling, such that sum of min(1, value / mu) over values is sampleSize,
+// values are reordered
+double CalcMvsThreshold(TArrayRef<double> values, double sampleSize);
+
+// Documents with gradient norms above threshold get weight 1, others are taken with probability
+// gradientNorm / threshold and weight threshold / gradientNorm
+void GenerateMvsSampleWeights(
+    TConstArrayRef<double> gradientNorms,
+    double threshold,
+    ui64 randSeed,
+    NPar::TLocalExecutor* localExecutor,
+    TArrayRef<float> sampleWeights
+);
+
 void Bootstrap(const NCatboostOptions::TCatBoostOptions& params,
                const TVector<TIndexType>& indices,
                TFold* fold,
@@ -97,7 +97,10 @@ void TrainOneIteration(const NCB::TTrainingForCPUDataProviders& data, TLearnCont
         TrimOnlineCTRcache(trainFolds);
         TrimOnlineCTRcache({ &ctx->LearnProgress.AveragingFold });
         {
-            TVector<TFold*> allFolds = trainFolds;
+            TVector<TFold*> allFolds;
+            if (ctx->Params.SystemOptions->IsSingleHost()) { // workers calculate learn ctrs, master needs only test ctrs
+                allFolds = trainFolds;
+            }
             allFolds.push_back(&ctx->LearnProgress.AveragingFold);
 
             struct TLocalJobData {
@@ -177,9 +180,9 @@ void TrainOneIteration(const NCB::TTrainingForCPUDataProviders& data, TLearnCont
             UpdateAvrgApprox(error->GetIsExpApprox(), data.Learn->GetObjectCount(), indices, treeValues, data.Test, &ctx->LearnProgress, ctx->LocalExecutor);
         } else {
             if (ctx->LearnProgress.ApproxDimension == 1) {
-                MapSetApproxesSimple(*error, bestSplitTree, data.Test, &treeValues, &sumLeafWeights, ctx);
+                MapSetApproxesSimple(*error, bestSplitTree, data, &treeValues, &sumLeafWeights, ctx);
             } else {
-                MapSetApproxesMulti(*error, bestSplitTree, data.Test, &treeValues, &sumLeafWeights, ctx);
+                MapSetApproxesMulti(*error, bestSplitTree, data, &treeValues, &sumLeafWeights, ctx);
             }
         }
 
@@ -0,0 +1,114 @@
+#include <catboost/libs/algo/apply.h>
+#include <catboost/libs/data_new/data_provider_builders.h>
+#include <catboost/libs/data_new/quantization.h>
+#include <catboost/libs/train_lib/train_model.h>
+
+#include <library/unittest/registar.h>
+
+#include <util/random/fast.h>
+#include <util/string/cast.h>
+#include <util/generic/vector.h>
+#include <util/generic/xrange.h>
+
+
+using namespace NCB;
+
+
+Y_UNIT_TEST_SUITE(TApplyTest) {
+    Y_UNIT_TEST(TestApplyOnQuantizedPool) {
+        const size_t DocCount = 2000;
+        const ui32 FloatFeatureCount = 5;
+        const ui32 CatFeatureFlatIdx = FloatFeatureCount;
+
+        TReallyFastRng32 rng(42);
+
+        TVector<float> target(DocCount);
+        TVector<TVector<float>> features(FloatFeatureCount, TVector<float>(DocCount)); // [featureIdx][objectIdx]
+        TVector<TString> catFeature(DocCount);
+        for (auto i : xrange(DocCount)) {
+            for (auto j : xrange(FloatFeatureCount)) {
+                features[j][i] = rng.GenRandReal2();
+            }
+            const ui32 catValue = rng.Uniform(7);
+            catFeature[i] = ToString(catValue);
+            target[i] = features[0][i] + 0.5 * features[1][i] * features[2][i] + 0.1 * catValue;
+        }
+
+        TDataProviders dataProviders;
+        dataProviders.Learn = CreateDataProvider(
+            [&] (IRawFeaturesOrderDataVisitor* visitor) {
+                TDataMetaInfo metaInfo;
+                metaInfo.HasTarget = true;
+                metaInfo.FeaturesLayout = MakeIntrusive<TFeaturesLayout>(
+                    FloatFeatureCount + 1,
+                    TVector<ui32>{CatFeatureFlatIdx},
+                    TVector<TString>{}
+                );
+
+                visitor->Start(metaInfo, DocCount, EObjectsOrder::Undefined, {});
+                for (auto factorId : xrange(FloatFeatureCount)) {
+                    visitor->AddFloatFeature(
+                        factorId,
+                        TMaybeOwningConstArrayHolder<float>::CreateOwning(TVector<float>(features[factorId]))
+                    );
+                }
+                visitor->AddCatFeature(CatFeatureFlatIdx, TConstArrayRef<TString>(catFeature));
+                visitor->AddTarget(target);
+                visitor->Finish();
+            }
+        );
+
+        NJson::TJsonValue params;
+        params.InsertValue("iterations", 20);
+        params.InsertValue("border_count", 16);
+        params.InsertValue("random_seed", 1);
+        params.InsertValue("thread_count", 1);
+        TFullModel model;
+        TrainModel(params, nullptr, Nothing(), Nothing(), dataProviders, "", &model, {});
+        UNIT_ASSERT(model.GetUsedCatFeaturesCount() > 0);
+
+        // quantize the same data with borders that are a superset of model borders
+        const auto& featuresLayout = *dataProviders.Learn->MetaInfo.FeaturesLayout;
+        auto quantizedFeaturesInfo = MakeIntrusive<TQuantizedFeaturesInfo>(
+            featuresLayout,
+            TConstArrayRef<ui32>(),
+            NCatboostOptions::TBinarizationOptions());
+        for (const auto& floatFeature : model.ObliviousTrees.FloatFeatures) {
+            TVector<float> borders;
+            for (auto borderIdx : xrange(floatFeature.Borders.size())) {
+                const float border = floatFeature.Borders[borderIdx];
+                const float prevBorder = borderIdx ? floatFeature.Borders[borderIdx - 1] : border - 1.0f;
+                borders.push_back((prevBorder + border) / 2);
+                borders.push_back(border);
+            }
+            const auto floatFeatureIdx = TFloatFeatureIdx(floatFeature.FeatureIndex);
+            quantizedFeaturesInfo->SetBorders(floatFeatureIdx, std::move(borders));
+            quantizedFeaturesInfo->SetNanMode(floatFeatureIdx, ENanMode::Forbidden);
+        }
+
+        NPar::TLocalExecutor localExecutor;
+        localExecutor.RunAdditionalThreads(3);
+        TRestorableFastRng64 rand(0);
+        const auto quantizedObjectsData = Quantize(
+            TQuantizationOptions(),
+            dynamic_cast<TRawObjectsDataProvider*>(dataProviders.Learn->ObjectsData.Get()),
+            quantizedFeaturesInfo,
+            &rand,
+            &localExecutor);
+
+        const auto expected = ApplyModelMulti(model, *dataProviders.Learn->ObjectsData);
+        const auto actual = ApplyModelMulti(model, *quantizedObjectsData, false, EPredictionType::RawFormulaVal, 0, 0, 4);
+        UNIT_ASSERT_VALUES_EQUAL(expected[0].size(), actual[0].size());
+        for (auto i : xrange(DocCount)) {
+            UNIT_ASSERT_DOUBLES_EQUAL(expected[0][i], actual[0][i], 1e-9);
+        }
+
+        TModelCalcerOnPool calcerOnPool(model, quantizedObjectsData, &localExecutor);
+        TVector<double> flatApproxBuffer;
+        TVector<TVector<double>> approx;
+        calcerOnPool.ApplyModelMulti(EPredictionType::RawFormulaVal, 0, 0, &flatApproxBuffer, &approx);
+        for (auto i : xrange(DocCount)) {
+            UNIT_ASSERT_DOUBLES_EQUAL(expected[0][i], approx[0][i], 1e-9);
+        }
+    }
+}
@@ -0,0 +1,226 @@
+#include <catboost/libs/algo/approx_calcer_multi.h>
+
+#include <library/threading/local_executor/local_executor.h>
+#include <library/unittest/registar.h>
+
+#include <util/generic/xrange.h>
+#include <util/generic/ymath.h>
+#include <util/random/fast.h>
+
+
+// reference implementation: derivatives of objects are calculated and added to buckets one by one
+
+static void UpdateBucketsMultiByObjects(
+    ELeavesEstimation estimationMethod,
+    const TVector<TIndexType>& indices,
+    const TVector<float>& target,
+    const TVector<float>& weight,
+    const TVector<TVector<double>>& approx,
+    const TVector<TVector<double>>& resArr,
+    const IDerCalcer& error,
+    int sampleCount,
+    int iteration,
+    TVector<TSumMulti>* buckets
+) {
+    const int approxDimension = resArr.ysize();
+    TVector<double> curApprox(approxDimension);
+    TVector<double> der(approxDimension);
+    THessianInfo der2(approxDimension, error.GetHessianType());
+    for (int z = 0; z < sampleCount; ++z) {
+        for (int dim = 0; dim < approxDimension; ++dim) {
+            curApprox[dim] = approx.empty() ? resArr[dim][z] : UpdateApprox(error.GetIsExpApprox(), approx[dim][z], resArr[dim][z]);
+        }
+        const double objectWeight = weight.empty() ? 1 : weight[z];
+        TSumMulti& bucket = (*buckets)[indices[z]];
+        if (estimationMethod == ELeavesEstimation::Newton) {
+            error.CalcDersMulti(curApprox, target[z], objectWeight, &der, &der2);
+            bucket.AddDerDer2(der, der2, iteration);
+        } else {
+            error.CalcDersMulti(curApprox, target[z], objectWeight, &der, nullptr);
+            bucket.AddDerWeight(der, objectWeight, iteration);
+        }
+    }
+}
+
+template <typename TCalcModel>
+static void CalcApproxDeltaIterationMultiByObjects(
+    TCalcModel CalcModel,
+    ELeavesEstimation estimationMethod,
+    const TVector<TIndexType>& indices,
+    const TVector<float>& target,
+    const TVector<float>& weight,
+    const TFold::TBodyTail& bt,
+    const IDerCalcer& error,
+    int iteration,
+    float l2Regularizer,
+    TVector<TSumMulti>* buckets,
+    TVector<TVector<double>>* resArr,
+    TVector<TVector<double>>* sumLeafValues
+) {
+    UpdateBucketsMultiByObjects(estimationMethod, indices, target, weight, bt.Approx, *resArr, error, bt.BodyFinish, iteration, buckets);
+
+    const int approxDimension = resArr->ysize();
+    const int leafCount = buckets->ysize();
+    TVector<TVector<double>> curLeafValues(approxDimension, TVector<double>(leafCount));
+    CalcMixedModelMulti(CalcModel, *buckets, iteration, l2Regularizer, bt.BodySumWeight, bt.BodyFinish, &curLeafValues);
+    AddElementwise(curLeafValues, sumLeafValues);
+    for (int dim = 0; dim < approxDimension; ++dim) {
+        ExpApproxIf(error.GetIsExpApprox(), &curLeafValues[dim]);
+        for (int z = 0; z < bt.BodyFinish; ++z) {
+            (*resArr)[dim][z] = UpdateApprox(error.GetIsExpApprox(), (*resArr)[dim][z], curLeafValues[dim][indices[z]]);
+        }
+    }
+
+    TVector<double> curApprox(approxDimension);
+    TVector<double> avrg(approxDimension);
+    TVector<double> der(approxDimension);
+    THessianInfo der2(approxDimension, error.GetHessianType());
+    for (int z = bt.BodyFinish; z < bt.TailFinish; ++z) {
+        for (int dim = 0; dim < approxDimension; ++dim) {
+            curApprox[dim] = UpdateApprox(error.GetIsExpApprox(), bt.Approx[dim][z], (*resArr)[dim][z]);
+        }
+        const double objectWeight = weight.empty() ? 1 : weight[z];
+        TSumMulti& bucket = (*buckets)[indices[z]];
+        if (estimationMethod == ELeavesEstimation::Newton) {
+            error.CalcDersMulti(curApprox, target[z], objectWeight, &der, &der2);
+            bucket.AddDerDer2(der, der2, iteration);
+        } else {
+            error.CalcDersMulti(curApprox, target[z], objectWeight, &der, nullptr);
+            bucket.AddDerWeight(der, objectWeight, iteration);
+        }
+
+        CalcModel(bucket, iteration, l2Regularizer, bt.BodySumWeight, bt.BodyFinish, &avrg);
+        ExpApproxIf(error.GetIsExpApprox(), &avrg);
+        for (int dim = 0; dim < approxDimension; ++dim) {
+            (*resArr)[dim][z] = UpdateApprox(error.GetIsExpApprox(), (*resArr)[dim][z], avrg[dim]);
+        }
+    }
+}
+
+static void CheckEqual(const TVector<double>& actual, const TVector<double>& expected) {
+    UNIT_ASSERT_VALUES_EQUAL(actual.size(), expected.size());
+    for (auto i : xrange(expected.size())) {
+        UNIT_ASSERT_DOUBLES_EQUAL(actual[i], expected[i], 1e-8 * Max(1.0, Abs(expected[i])));
+    }
+}
+
+static void CheckEqualBuckets(const TVector<TSumMulti>& actual, const TVector<TSumMulti>& expected) {
+    UNIT_ASSERT_VALUES_EQUAL(actual.size(), expected.size());
+    for (auto leafId : xrange(expected.size())) {
+        UNIT_ASSERT_VALUES_EQUAL(actual[leafId].SumDerHistory.size(), expected[leafId].SumDerHistory.size());
+        for (auto iteration : xrange(expected[leafId].SumDerHistory.size())) {
+            CheckEqual(actual[leafId].SumDerHistory[iteration], expected[leafId].SumDerHistory[iteration]);
+            CheckEqual(actual[leafId].SumDer2History[iteration].Data, expected[leafId].SumDer2History[iteration].Data);
+        }
+        UNIT_ASSERT_DOUBLES_EQUAL(actual[leafId].SumWeights, expected[leafId].SumWeights, 1e-8 * Max(1.0, expected[leafId].SumWeights));
+    }
+}
+
+// leaf estimation iterations of a multiclass tree with body and tail objects
+static void CheckApproxDeltaMulti(
+    const IDerCalcer& error,
+    ELeavesEstimation estimationMethod,
+    int approxDimension,
+    int leafCount,
+    int bodyFinish,
+    int tailFinish,
+    bool hasWeights
+) {
+    const int gradientIterations = 3;
+    const float l2Regularizer = 3;
+
+    TReallyFastRng32 rng(0);
+    TVector<TIndexType> indices(tailFinish);
+    TVector<float> target(tailFinish);
+    TVector<float> weight(hasWeights ? tailFinish : 0);
+    TVector<TVector<double>> approx(approxDimension, TVector<double>(tailFinish));
+    double bodySumWeight = 0;
+    for (auto z : xrange(tailFinish)) {
+        indices[z] = rng.Uniform(leafCount);
+        target[z] = rng.Uniform(approxDimension);
+        if (hasWeights) {
+            weight[z] = 2 * rng.GenRandReal1();
+        }
+        if (z < bodyFinish) {
+            bodySumWeight += hasWeights ? weight[z] : 1;
+        }
+        for (auto dim : xrange(approxDimension)) {
+            approx[dim][z] = 4 * rng.GenRandReal1() - 2;
+        }
+    }
+    TFold::TBodyTail bt(/*bodyQueryFinish*/ bodyFinish, /*tailQueryFinish*/ tailFinish, bodyFinish, tailFinish, bodySumWeight);
+    bt.Approx = approx;
+
+    NPar::TLocalExecutor localExecutor;
+    localExecutor.RunAdditionalThreads(3);
+
+    TVector<TSumMulti> buckets(leafCount, TSumMulti(gradientIterations, approxDimension, error.GetHessianType()));
+    TVector<TVector<double>> resArr(approxDimension, TVector<double>(tailFinish, 0.0));
+    TVector<TVector<double>> sumLeafValues(approxDimension, TVector<double>(leafCount, 0.0));
+
+    TVector<TSumMulti> expectedBuckets = buckets;
+    TVector<TVector<double>> expectedResArr = resArr;
+    TVector<TVector<double>> expectedSumLeafValues = sumLeafValues;
+
+    for (int iteration = 0; iteration < gradientIterations; ++iteration) {
+        CalcApproxDeltaIterationMulti(
+            estimationMethod,
+            indices,
+            target,
+            weight,
+            bt,
+            error,
+            iteration,
+            l2Regularizer,
+            &localExecutor,
+            &buckets,
+            &resArr,
+            &sumLeafValues);
+        if (estimationMethod == ELeavesEstimation::Newton) {
+            CalcApproxDeltaIterationMultiByObjects(CalcModelNewtonMulti, estimationMethod, indices, target, weight, bt,
+                                                   error, iteration, l2Regularizer, &expectedBuckets, &expectedResArr, &expectedSumLeafValues);
+        } else {
+            CalcApproxDeltaIterationMultiByObjects(CalcModelGradientMulti, estimationMethod, indices, target, weight, bt,
+                                                   error, iteration, l2Regularizer, &expectedBuckets, &expectedResArr, &expectedSumLeafValues);
+        }
+
+        CheckEqualBuckets(buckets, expectedBuckets);
+        for (auto dim : xrange(approxDimension)) {
+            CheckEqual(resArr[dim], expectedResArr[dim]);
+            CheckEqual(sumLeafValues[dim], expectedSumLeafValues[dim]);
+        }
+    }
+
+    // leaf values calculation passes approxes in resArr and an empty approx
+    TVector<TSumMulti> leafBuckets(leafCount, TSumMulti(1, approxDimension, error.GetHessianType()));
+    TVector<TSumMulti> expectedLeafBuckets = leafBuckets;
+    UpdateBucketsMulti(estimationMethod, indices, target, weight, /*approx*/ {}, approx, error, tailFinish, 0, &localExecutor, &leafBuckets);
+    UpdateBucketsMultiByObjects(estimationMethod, indices, target, weight, /*approx*/ {}, approx, error, tailFinish, 0, &expectedLeafBuckets);
+    CheckEqualBuckets(leafBuckets, expectedLeafBuckets);
+}
+
+static void CheckApproxDeltaMulti(const IDerCalcer& error, int approxDimension) {
+    for (auto estimationMethod : {ELeavesEstimation::Newton, ELeavesEstimation::Gradient}) {
+        for (bool hasWeights : {false, true}) {
+            // tail only, body and tail, and enough objects for several blocks of bucket sums
+            CheckApproxDeltaMulti(error, estimationMethod, approxDimension, /*leafCount*/ 8, /*bodyFinish*/ 0, /*tailFinish*/ 31, hasWeights);
+            CheckApproxDeltaMulti(error, estimationMethod, approxDimension, /*leafCount*/ 8, /*bodyFinish*/ 301, /*tailFinish*/ 602, hasWeights);
+            CheckApproxDeltaMulti(error, estimationMethod, approxDimension, /*leafCount*/ 8, /*bodyFinish*/ 20000, /*tailFinish*/ 40000, hasWeights);
+            // deep tree, bucket sums take few blocks or, for high dimensions with hessians, are added directly
+            CheckApproxDeltaMulti(error, estimationMethod, approxDimension, /*leafCount*/ 1 << 15, /*bodyFinish*/ 20000, /*tailFinish*/ 40000, hasWeights);
+        }
+    }
+}
+
+Y_UNIT_TEST_SUITE(TApproxCalcerMultiTest) {
+    Y_UNIT_TEST(TestMultiClassApproxDelta) {
+        CheckApproxDeltaMulti(TMultiClassError(/*isExpApprox*/ false), 3);
+        CheckApproxDeltaMulti(TMultiClassError(/*isExpApprox*/ false), 7);
+    }
+
+    // uses default IDerCalcer::CalcDersMultiRange
+    Y_UNIT_TEST(TestMultiClassOneVsAllApproxDelta) {
+        CheckApproxDeltaMulti(TMultiClassOneVsAllError(/*isExpApprox*/ false), 3);
+        CheckApproxDeltaMulti(TMultiClassOneVsAllError(/*isExpApprox*/ false), 7);
+    }
+}
@@ -0,0 +1,69 @@
+#include <catboost/libs/algo/calc_score_cache.h>
+
+#include <library/unittest/registar.h>
+
+static TVector<TFold> MakeFolds(int approxDimension, int bodyTailCount) {
+    TFold fold;
+    for (int bodyTailIdx = 0; bodyTailIdx < bodyTailCount; ++bodyTailIdx) {
+        fold.BodyTailArr.emplace_back(0, 0, 0, 0, 0.0);
+        fold.BodyTailArr.back().Approx.resize(approxDimension);
+    }
+    TVector<TFold> folds;
+    folds.push_back(std::move(fold));
+    return folds;
+}
+
+static TSplitCandidate MakeFloatSplit(int featureIdx) {
+    TSplitCandidate split;
+    split.Type = ESplitType::FloatFeature;
+    split.FeatureIdx = featureIdx;
+    return split;
+}
+
+Y_UNIT_TEST_SUITE(TBucketStatsCacheTest) {
+    Y_UNIT_TEST(TestStatsAreKeptBetweenLevels) {
+        const int bucketCount = 16;
+        const int depth = 6;
+        const int statsCount = bucketCount << depth;
+        TBucketStatsCache cache;
+        cache.Create(MakeFolds(/*approxDimension*/ 2, /*bodyTailCount*/ 1), bucketCount, depth, Max<ui64>());
+
+        bool areStatsDirty;
+        auto& stats = *cache.GetStats(MakeFloatSplit(0), statsCount, &areStatsDirty);
+        UNIT_ASSERT(areStatsDirty);
+        UNIT_ASSERT_VALUES_EQUAL(stats.ysize(), 2 * statsCount);
+        stats[0].SumWeight = 42;
+
+        const auto& cachedStats = *cache.GetStats(MakeFloatSplit(0), statsCount, &areStatsDirty);
+        UNIT_ASSERT(!areStatsDirty);
+        UNIT_ASSERT_VALUES_EQUAL(cachedStats[0].SumWeight, 42);
+
+        UNIT_ASSERT(cache.GetStats(MakeFloatSplit(1), statsCount, &areStatsDirty));
+        UNIT_ASSERT(areStatsDirty);
+        UNIT_ASSERT_VALUES_EQUAL(cache.Stats.size(), 2);
+    }
+
+    Y_UNIT_TEST(TestStatsAreNotCachedOverSizeLimit) {
+        const int bucketCount = 16;
+        const int depth = 6;
+        const int statsCount = bucketCount << depth;
+        const ui64 sizeLimit = sizeof(TBucketStats) * statsCount;
+        TBucketStatsCache cache;
+        cache.Create(MakeFolds(/*approxDimension*/ 1, /*bodyTailCount*/ 1), bucketCount, depth, sizeLimit);
+
+        // within a tree the cache does not grow past the limit, cached stats stay available
+        bool areStatsDirty;
+        UNIT_ASSERT(cache.GetStats(MakeFloatSplit(0), statsCount, &areStatsDirty));
+        UNIT_ASSERT(areStatsDirty);
+        UNIT_ASSERT(!cache.GetStats(MakeFloatSplit(1), statsCount, &areStatsDirty));
+        UNIT_ASSERT(cache.GetStats(MakeFloatSplit(0), statsCount, &areStatsDirty));
+        UNIT_ASSERT(!areStatsDirty);
+        UNIT_ASSERT_VALUES_EQUAL(cache.Stats.size(), 1);
+
+        // between trees the overflowed cache is cleared for candidates of the next tree
+        cache.GarbageCollect();
+        UNIT_ASSERT(cache.Stats.empty());
+        UNIT_ASSERT(cache.GetStats(MakeFloatSplit(1), statsCount, &areStatsDirty));
+        UNIT_ASSERT(areStatsDirty);
+    }
+}
@@ -0,0 +1,198 @@
+#include <catboost/libs/algo/error_functions.h>
+
+#include <library/unittest/registar.h>
+
+#include <util/generic/xrange.h>
+#include <util/random/fast.h>
+
+#include <cmath>
+#include <functional>
+
+using TReferenceDers = std::function<TDers(double approx, float target)>;
+
+// count is not a multiple of vector width or of exponent block size to check loop tails
+static void CheckDersRange(const IDerCalcer& error, const TReferenceDers& referenceDers, bool isExpApprox) {
+    const int start = 3;
+    const int count = 301;
+    TReallyFastRng32 rng(0);
+    TVector<double> approxes(start + count);
+    TVector<double> approxDeltas(start + count);
+    TVector<float> targets(start + count);
+    TVector<float> weights(start + count);
+    for (auto i : xrange(start + count)) {
+        approxes[i] = 4 * rng.GenRandReal1() - 2;
+        approxDeltas[i] = rng.GenRandReal1() - 0.5;
+        if (isExpApprox) {
+            approxes[i] = std::exp(approxes[i]);
+            approxDeltas[i] = std::exp(approxDeltas[i]);
+        }
+        targets[i] = rng.GenRandReal1();
+        weights[i] = 2 * rng.GenRandReal1();
+    }
+
+    for (bool hasDelta : {false, true}) {
+        for (bool hasWeights : {false, true}) {
+            const double* deltasPtr = hasDelta ? approxDeltas.data() : nullptr;
+            const float* weightsPtr = hasWeights ? weights.data() : nullptr;
+            TVector<TDers> ders(start + count);
+            TVector<double> firstDers(start + count);
+            error.CalcDersRange(start, count, /*calcThirdDer*/ true, approxes.data(), deltasPtr, targets.data(), weightsPtr, ders.data());
+            error.CalcFirstDerRange(start, count, approxes.data(), deltasPtr, targets.data(), weightsPtr, firstDers.data());
+            for (auto i : xrange(start, start + count)) {
+                double approx = approxes[i];
+                if (hasDelta) {
+                    approx = UpdateApprox(isExpApprox, approx, approxDeltas[i]);
+                }
+                const double weight = hasWeights ? weights[i] : 1.0;
+                const TDers expected = referenceDers(approx, targets[i]);
+                UNIT_ASSERT_DOUBLES_EQUAL(ders[i].Der1, weight * expected.Der1, 1e-6);
+                UNIT_ASSERT_DOUBLES_EQUAL(ders[i].Der2, weight * expected.Der2, 1e-6);
+                UNIT_ASSERT_DOUBLES_EQUAL(ders[i].Der3, weight * expected.Der3, 1e-6);
+                UNIT_ASSERT_DOUBLES_EQUAL(firstDers[i], weight * expected.Der1, 1e-6);
+            }
+        }
+    }
+}
+
+static void CheckDersMultiRange(const IDerCalcer& error, int approxDimension) {
+    const int start = 3;
+    const int count = 301;
+    TReallyFastRng32 rng(0);
+    TVector<TVector<double>> approxes(approxDimension, TVector<double>(start + count));
+    TVector<TVector<double>> approxDeltas(approxDimension, TVector<double>(start + count));
+    TVector<float> targets(start + count);
+    TVector<float> weights(start + count);
+    for (auto i : xrange(start + count)) {
+        for (auto dim : xrange(approxDimension)) {
+            approxes[dim][i] = 20 * rng.GenRandReal1() - 10;
+            approxDeltas[dim][i] = rng.GenRandReal1() - 0.5;
+        }
+        targets[i] = rng.Uniform(approxDimension);
+        weights[i] = 2 * rng.GenRandReal1();
+    }
+
+    const int der2Size = approxDimension * (approxDimension + 1) / 2;
+    for (bool hasDelta : {false, true}) {
+        for (bool hasWeights : {false, true}) {
+            const auto& deltas = hasDelta ? approxDeltas : TVector<TVector<double>>();
+            const float* weightsPtr = hasWeights ? weights.data() : nullptr;
+            TVector<double> ders(count * approxDimension);
+            TVector<double> der2s(count * der2Size);
+            error.CalcDersMultiRange(start, count, approxes, deltas, targets.data(), weightsPtr, ders, der2s);
+
+            TVector<double> approx(approxDimension);
+            TVector<double> expectedDer(approxDimension);
+            THessianInfo expectedDer2(approxDimension, EHessianType::Symmetric);
+            for (auto i : xrange(start, start + count)) {
+                for (auto dim : xrange(approxDimension)) {
+                    approx[dim] = approxes[dim][i] + (hasDelta ? approxDeltas[dim][i] : 0);
+                }
+                error.CalcDersMulti(approx, targets[i], hasWeights ? weights[i] : 1, &expectedDer, &expectedDer2);
+                for (auto dim : xrange(approxDimension)) {
+                    UNIT_ASSERT_DOUBLES_EQUAL(ders[(i - start) * approxDimension + dim], expectedDer[dim], 1e-9);
+                }
+                for (auto idx : xrange(der2Size)) {
+                    UNIT_ASSERT_DOUBLES_EQUAL(der2s[(i - start) * der2Size + idx], expectedDer2.Data[idx], 1e-9);
+                }
+            }
+        }
+    }
+}
+
+// derivatives of -(sum_dim (approx[dim] - [dim == target])^2 + (sum_dim approx[dim])^2) / 2
+static void CalcCustomDersMulti(
+    const TVector<double>& approx,
+    float target,
+    float weight,
+    TVector<double>* ders,
+    THessianInfo* der2,
+    void* /*customData*/
+) {
+    const int approxDimension = approx.ysize();
+    const double approxSum = Accumulate(approx, 0.0);
+    for (int dim = 0; dim < approxDimension; ++dim) {
+        (*ders)[dim] = weight * ((dim == static_cast<int>(target)) - approx[dim] - approxSum);
+    }
+    if (der2 != nullptr) {
+        int idx = 0;
+        for (int dimY = 0; dimY < approxDimension; ++dimY) {
+            for (int dimX = dimY; dimX < approxDimension; ++dimX) {
+                der2->Data[idx++] = -weight * (1 + (dimX == dimY));
+            }
+        }
+    }
+}
+
+static void CalcCustomDersMultiRange(
+    int count,
+    int approxDimension,
+    const double* approxes,
+    const float* targets,
+    const float* weights,
+    double* ders,
+    double* der2s,
+    void* customData
+) {
+    TVector<double> approx(approxDimension);
+    TVector<double> der(approxDimension);
+    THessianInfo der2(approxDimension, EHessianType::Symmetric);
+    for (int i = 0; i < count; ++i) {
+        for (int dim = 0; dim < approxDimension; ++dim) {
+            approx[dim] = approxes[dim * count + i];
+        }
+        CalcCustomDersMulti(approx, targets[i], weights ? weights[i] : 1, &der, der2s ? &der2 : nullptr, customData);
+        Copy(der.begin(), der.end(), ders + i * approxDimension);
+        if (der2s) {
+            Copy(der2.Data.begin(), der2.Data.end(), der2s + i * der2.Data.ysize());
+        }
+    }
+}
+
+Y_UNIT_TEST_SUITE(TErrorFunctionsTest) {
+    Y_UNIT_TEST(TestRMSEDersRange) {
+        CheckDersRange(
+            TRMSEError(/*isExpApprox*/ false),
+            [] (double approx, float target) { return TDers{target - approx, -1.0, 0.0}; },
+            /*isExpApprox*/ false);
+    }
+
+    Y_UNIT_TEST(TestQuantileDersRange) {
+        const double alpha = 0.3;
+        CheckDersRange(
+            TQuantileError(alpha, /*isExpApprox*/ false),
+            [=] (double approx, float target) { return TDers{target - approx > 0 ? alpha : alpha - 1, 0.0, 0.0}; },
+            /*isExpApprox*/ false);
+    }
+
+    Y_UNIT_TEST(TestPoissonDersRange) {
+        CheckDersRange(
+            TPoissonError(/*isExpApprox*/ true),
+            [] (double approxExp, float target) { return TDers{target - approxExp, -approxExp, -approxExp}; },
+            /*isExpApprox*/ true);
+    }
+
+    Y_UNIT_TEST(TestCrossEntropyDersRange) {
+        const auto referenceDers = [] (double approxExp, float target) {
+            const double p = approxExp / (1 + approxExp);
+            return TDers{target - p, -p * (1 - p), -p * (1 - p) * (1 - 2 * p)};
+        };
+        CheckDersRange(TCrossEntropyError(/*isExpApprox*/ true), referenceDers, /*isExpApprox*/ true);
+        CheckDersRange(
+            TCrossEntropyError(/*isExpApprox*/ false),
+            [&] (double approx, float target) { return referenceDers(std::exp(approx), target); },
+            /*isExpApprox*/ false);
+    }
+
+    Y_UNIT_TEST(TestMultiClassDersMultiRange) {
+        // 301 objects of 5 classes span two softmax tiles
+        CheckDersMultiRange(TMultiClassError(/*isExpApprox*/ false), 5);
+        CheckDersMultiRange(TMultiClassError(/*isExpApprox*/ false), 2);
+    }
+
+    Y_UNIT_TEST(TestCustomDersMultiRange) {
+        TCustomObjectiveDescriptor descriptor;
+        descriptor.CalcDersMulti = &CalcCustomDersMulti;
+        descriptor.CalcDersMultiRange = &CalcCustomDersMultiRange;
+        CheckDersMultiRange(TCustomError(NCatboostOptions::TCatBoostOptions(ETaskType::CPU), descriptor), 3);
+    }
+}
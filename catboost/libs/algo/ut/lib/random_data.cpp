@@ -0,0 +1,142 @@
+#include "random_data.h"
+
+#include <catboost/libs/data_new/data_provider_builders.h>
+#include <catboost/libs/train_lib/train_model.h>
+
+#include <util/generic/algorithm.h>
+#include <util/generic/maybe.h>
+#include <util/generic/xrange.h>
+#include <util/random/fast.h>
+#include <util/string/cast.h>
+
+
+namespace NCB {
+    namespace NAlgoUT {
+
+    static TVector<float> RandomDenseFeature(ui32 objectCount, TFastRng<ui64>* prng) {
+        TVector<float> values(objectCount);
+        for (auto& value : values) {
+            value = prng->GenRandReal1();
+        }
+        return values;
+    }
+
+    static TVector<float> RandomPackableFeature(ui32 objectCount, ui32 valueCount, TFastRng<ui64>* prng) {
+        TVector<float> values(objectCount);
+        for (auto& value : values) {
+            value = static_cast<float>(prng->Uniform(valueCount));
+        }
+        return values;
+    }
+
+    static TVector<float> RandomSparseFeature(ui32 objectCount, TFastRng<ui64>* prng) {
+        TVector<float> values(objectCount, 0.0f);
+        for (auto i : xrange(objectCount / 50)) {
+            Y_UNUSED(i);
+            values[prng->Uniform(objectCount)] = 1.0f + prng->GenRandReal1();
+        }
+        return values;
+    }
+
+    TDataProviderPtr CreateRandomDataProvider(const TRandomDataSpec& spec) {
+        const ui32 objectCount = spec.ObjectCount;
+        const ui32 floatFeatureCount = spec.GetFloatFeatureCount();
+        TVector<ui32> catFeatureIndices(spec.OneHotFeatureCount);
+        Iota(catFeatureIndices.begin(), catFeatureIndices.end(), floatFeatureCount);
+
+        TFastRng<ui64> prng(spec.Seed);
+        return CreateDataProvider(
+            [&] (IRawFeaturesOrderDataVisitor* visitor) {
+                TDataMetaInfo metaInfo;
+                metaInfo.HasTarget = true;
+                metaInfo.FeaturesLayout = MakeIntrusive<TFeaturesLayout>(
+                    floatFeatureCount + spec.OneHotFeatureCount,
+                    catFeatureIndices,
+                    TVector<TString>{}
+                );
+
+                visitor->Start(metaInfo, objectCount, EObjectsOrder::Undefined, {});
+
+                TVector<float> target(objectCount, 0.0f);
+                ui32 featureIdx = 0;
+                auto addFloatFeature = [&] (TVector<float>&& values) {
+                    visitor->AddFloatFeature(
+                        featureIdx++,
+                        TMaybeOwningConstArrayHolder<float>::CreateOwning(std::move(values))
+                    );
+                };
+                for (auto denseFeatureIdx : xrange(spec.DenseFeatureCount)) {
+                    Y_UNUSED(denseFeatureIdx);
+                    TVector<float> values = RandomDenseFeature(objectCount, &prng);
+                    for (auto objectIdx : xrange(objectCount)) {
+                        target[objectIdx] += values[objectIdx] / spec.DenseFeatureCount;
+                    }
+                    addFloatFeature(std::move(values));
+                }
+                for (auto constFeatureIdx : xrange(spec.ConstFeatureCount)) {
+                    Y_UNUSED(constFeatureIdx);
+                    addFloatFeature(TVector<float>(objectCount, 0.0f));
+                }
+                for (auto packableFeatureIdx : xrange(spec.PackableFeatureCount)) {
+                    // 1, 2 and 4 bits per feature
+                    addFloatFeature(RandomPackableFeature(objectCount, 2 + packableFeatureIdx % 15, &prng));
+                }
+                for (auto sparseFeatureIdx : xrange(spec.SparseFeatureCount)) {
+                    Y_UNUSED(sparseFeatureIdx);
+                    addFloatFeature(RandomSparseFeature(objectCount, &prng));
+                }
+
+                for (auto oneHotFeatureIdx : xrange(spec.OneHotFeatureCount)) {
+                    TVector<TString> values(objectCount);
+                    for (auto& value : values) {
+                        value = ToString(prng.Uniform(3));
+                    }
+                    visitor->AddCatFeature(floatFeatureCount + oneHotFeatureIdx, TConstArrayRef<TString>(values));
+                }
+
+                for (auto& value : target) {
+                    value = (1.0f - spec.TargetNoiseShare) * value + spec.TargetNoiseShare * prng.GenRandReal1();
+                    if (spec.ClassCount > 0) {
+                        value = Min<ui32>(value * spec.ClassCount, spec.ClassCount - 1);
+                    }
+                }
+                visitor->AddTarget(target);
+
+                visitor->Finish();
+            }
+        );
+    }
+
+    TFullModel TrainRandomModel(TDataProviderPtr learnData, NJson::TJsonValue params) {
+        const auto insertDefault = [&] (TStringBuf key, const NJson::TJsonValue& value) {
+            if (!params.Has(key)) {
+                params.InsertValue(key, value);
+            }
+        };
+        insertDefault("iterations", 10);
+        insertDefault("depth", 4);
+        insertDefault("random_seed", 0);
+        insertDefault("loss_function", "RMSE");
+        insertDefault("logging_level", "Silent");
+        insertDefault("allow_writing_files", false);
+
+        TDataProviders dataProviders;
+        dataProviders.Learn = learnData;
+
+        TFullModel model;
+        TrainModel(
+            params,
+            nullptr,
+            Nothing(),
+            Nothing(),
+            std::move(dataProviders),
+            "",
+            &model,
+            {}
+        );
+        return model;
+    }
+
+    }
+
+}
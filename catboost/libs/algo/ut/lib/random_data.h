@@ -0,0 +1,42 @@
+#pragma once
+
+#include <catboost/libs/data_new/data_provider.h>
+#include <catboost/libs/model/model.h>
+
+#include <library/json/json_value.h>
+
+#include <util/system/types.h>
+
+
+namespace NCB {
+    namespace NAlgoUT {
+
+    /* Float features go in the order: dense, constant, packable, sparse, then one-hot cat features.
+     * The target is a mean of dense features mixed with uniform noise, it is quantized to classes
+     * for classification.
+     */
+    struct TRandomDataSpec {
+        ui32 ObjectCount = 0;
+        ui32 DenseFeatureCount = 0;
+        ui32 ConstFeatureCount = 0; // all values are zero
+        ui32 PackableFeatureCount = 0; // at most 16 different values, quantized to at most 4 bits
+        ui32 SparseFeatureCount = 0; // 2% of non-zero values
+        ui32 OneHotFeatureCount = 0; // 3 different values
+        ui32 ClassCount = 0; // 0 for regression
+        float TargetNoiseShare = 0.0f;
+        ui64 Seed = 0;
+
+    public:
+        ui32 GetFloatFeatureCount() const {
+            return DenseFeatureCount + ConstFeatureCount + PackableFeatureCount + SparseFeatureCount;
+        }
+    };
+
+    TDataProviderPtr CreateRandomDataProvider(const TRandomDataSpec& spec);
+
+    // params default to 10 iterations of depth 4 with RMSE, random_seed 0, silent and without files
+    TFullModel TrainRandomModel(TDataProviderPtr learnData, NJson::TJsonValue params = {});
+
+    }
+
+}
@@ -0,0 +1,110 @@
+#include <catboost/libs/algo/fold.h>
+#include <catboost/libs/algo/online_ctr.h>
+
+#include <library/unittest/registar.h>
+
+#include <util/generic/xrange.h>
+#include <util/random/fast.h>
+
+static TVector<TArray2D<TVector<ui8>>> CalcShardedCtrs(
+    const TVector<ui64>& hashes,
+    const TVector<int>& targetClass,
+    const TVector<TCtrInfo>& ctrInfo,
+    const TVector<size_t>& shardStarts,
+    ui64 topSize
+) {
+    const auto makeFold = [&] (size_t begin, size_t end) {
+        TFold fold;
+        fold.TargetClassesCount = {3};
+        fold.LearnTargetClass = {TVector<int>(targetClass.begin() + begin, targetClass.begin() + end)};
+        return fold;
+    };
+    TVector<TFold> folds;
+    TVector<TOnlineCtrHashCounts> shardHashCounts;
+    for (auto shardIdx : xrange(shardStarts.size())) {
+        const size_t begin = shardStarts[shardIdx];
+        const size_t end = shardIdx + 1 < shardStarts.size() ? shardStarts[shardIdx + 1] : hashes.size();
+        folds.push_back(makeFold(begin, end));
+        shardHashCounts.push_back(CountOnlineCtrHashes(MakeArrayRef(hashes.data() + begin, end - begin), folds.back()));
+    }
+    const auto shardStats = MergeOnlineCtrHashCounts(shardHashCounts, {}, ctrInfo, {3}, topSize, ECounterCalc::Full);
+
+    TVector<TArray2D<TVector<ui8>>> result(ctrInfo.size());
+    for (auto ctrIdx : xrange(ctrInfo.size())) {
+        result[ctrIdx].SetSizes(ctrInfo[ctrIdx].Priors.size(), GetTargetBorderCount(ctrInfo[ctrIdx], 3));
+    }
+    for (auto shardIdx : xrange(shardStarts.size())) {
+        const size_t begin = shardStarts[shardIdx];
+        TOnlineCTR ctr;
+        ComputeOnlineCTRsForShard(
+            shardStats[shardIdx],
+            MakeArrayRef(hashes.data() + begin, folds[shardIdx].LearnTargetClass[0].size()),
+            folds[shardIdx],
+            &ctr);
+        UNIT_ASSERT_VALUES_EQUAL(ctr.UniqueValuesCount, shardStats[0].UniqueValuesCount);
+        for (auto ctrIdx : xrange(ctrInfo.size())) {
+            for (auto border : xrange(result[ctrIdx].GetYSize())) {
+                for (auto prior : xrange(result[ctrIdx].GetXSize())) {
+                    const auto& shardValues = ctr.Feature[ctrIdx][border][prior];
+                    auto& values = result[ctrIdx][border][prior];
+                    values.insert(values.end(), shardValues.begin(), shardValues.end());
+                }
+            }
+        }
+    }
+    return result;
+}
+
+Y_UNIT_TEST_SUITE(TOnlineCtrTest) {
+    Y_UNIT_TEST(TestShardedCtrsMatchSingleShard) {
+        const size_t docCount = 1000;
+        TReallyFastRng32 rng(0);
+        TVector<ui64> hashes(docCount);
+        TVector<int> targetClass(docCount);
+        for (auto docIdx : xrange(docCount)) {
+            hashes[docIdx] = rng.Uniform(37) * 1000003;
+            targetClass[docIdx] = rng.Uniform(3);
+        }
+        TVector<TCtrInfo> ctrInfo(4);
+        const ECtrType ctrTypes[] = {ECtrType::Borders, ECtrType::Buckets, ECtrType::BinarizedTargetMeanValue, ECtrType::Counter};
+        for (auto ctrIdx : xrange(ctrInfo.size())) {
+            ctrInfo[ctrIdx].Type = ctrTypes[ctrIdx];
+            ctrInfo[ctrIdx].BorderCount = 15;
+            ctrInfo[ctrIdx].TargetClassifierIdx = 0;
+            ctrInfo[ctrIdx].Priors = {0.0f, 0.5f, 1.0f};
+        }
+
+        for (ui64 topSize : {Max<ui64>(), (ui64)10}) {
+            const auto expected = CalcShardedCtrs(hashes, targetClass, ctrInfo, {0}, topSize);
+            const auto actual = CalcShardedCtrs(hashes, targetClass, ctrInfo, {0, 1, 333, 334, 900}, topSize);
+            for (auto ctrIdx : xrange(ctrInfo.size())) {
+                for (auto border : xrange(expected[ctrIdx].GetYSize())) {
+                    for (auto prior : xrange(expected[ctrIdx].GetXSize())) {
+                        UNIT_ASSERT_VALUES_EQUAL(expected[ctrIdx][border][prior].size(), docCount);
+                        UNIT_ASSERT(expected[ctrIdx][border][prior] == actual[ctrIdx][border][prior]);
+                    }
+                }
+            }
+        }
+    }
+
+    Y_UNIT_TEST(TestSingleShardBordersCtr) {
+        const TVector<ui64> hashes = {1, 2, 1, 1, 2, 1};
+        const TVector<int> targetClass = {2, 0, 1, 0, 2, 2};
+        TCtrInfo ctrInfo;
+        ctrInfo.Type = ECtrType::Borders;
+        ctrInfo.BorderCount = 255;
+        ctrInfo.TargetClassifierIdx = 0;
+        ctrInfo.Priors = {0.0f};
+        const auto ctrs = CalcShardedCtrs(hashes, targetClass, {ctrInfo}, {0}, Max<ui64>());
+
+        // border 1 counts documents of class 2 seen before the document with the same hash
+        const TVector<int> goodCount = {0, 0, 1, 1, 0, 1};
+        const TVector<int> totalCount = {0, 0, 1, 2, 1, 3};
+        for (auto docIdx : xrange(hashes.size())) {
+            UNIT_ASSERT_VALUES_EQUAL(
+                ctrs[0][1][0][docIdx],
+                CalcCTR(goodCount[docIdx], totalCount[docIdx], 0.0f, 0.0f, 1.0f, 255));
+        }
+    }
+}
@@ -0,0 +1,145 @@
+#include <catboost/libs/algo/plot.h>
+#include <catboost/libs/algo/ut/lib/random_data.h>
+
+#include <catboost/libs/metrics/metric.h>
+#include <catboost/libs/target/data_providers.h>
+
+#include <library/threading/local_executor/local_executor.h>
+#include <library/unittest/registar.h>
+
+#include <util/folder/path.h>
+#include <util/folder/tempdir.h>
+#include <util/generic/xrange.h>
+#include <util/generic/ymath.h>
+
+
+using namespace NCB;
+using namespace NCB::NAlgoUT;
+
+
+static TDataProviderPtr CreateRandomClassificationDataProvider(ui32 objectCount, ui32 classCount, ui64 seed) {
+    TRandomDataSpec spec;
+    spec.ObjectCount = objectCount;
+    spec.DenseFeatureCount = 4;
+    spec.ClassCount = classCount;
+    spec.TargetNoiseShare = 0.2f;
+    spec.Seed = seed;
+    return CreateRandomDataProvider(spec);
+}
+
+// same order of calls as in eval-metrics mode, returned: score[metricIdx][plotLineIdx]
+static TVector<TVector<double>> CalcMetricsPlot(
+    const TFullModel& model,
+    const TVector<TDataProviderPtr>& datasetParts,
+    int evalPeriod,
+    int processedIterationsStep,
+    int threadCount,
+    bool calcOnParts
+) {
+    NPar::TLocalExecutor executor;
+    executor.RunAdditionalThreads(threadCount - 1);
+
+    const int approxDimension = model.ObliviousTrees.ApproxDimension;
+    const auto metrics = CreateMetricsFromDescription(
+        {"AUC", approxDimension > 1 ? "MultiClass" : "Logloss"},
+        approxDimension
+    );
+    TTempDir tmpDir;
+    TMetricsPlotCalcer plotCalcer = CreateMetricCalcer(
+        model,
+        /*begin*/ 0,
+        /*end*/ 0,
+        evalPeriod,
+        processedIterationsStep,
+        executor,
+        tmpDir.Name(),
+        metrics
+    );
+
+    TRestorableFastRng64 rand(0);
+    TVector<TProcessedDataProvider> processedDatasetParts;
+    for (const auto& datasetPart : datasetParts) {
+        processedDatasetParts.push_back(
+            CreateModelCompatibleProcessedDataProvider(*datasetPart, {}, model, &rand, &executor)
+        );
+    }
+
+    for (const auto& datasetPart : processedDatasetParts) {
+        plotCalcer.ProceedDataSetForAdditiveMetrics(datasetPart);
+    }
+    if (calcOnParts) {
+        while (!plotCalcer.AreAllIterationsProcessed()) {
+            for (const auto& datasetPart : processedDatasetParts) {
+                plotCalcer.ProceedDataSetForNonAdditiveMetrics(datasetPart);
+            }
+            plotCalcer.FinishProceedDataSetForNonAdditiveMetrics();
+        }
+
+        // approx files are deleted as soon as their plot lines are evaluated
+        TVector<TString> tmpFiles;
+        TFsPath(tmpDir.Name()).ListNames(tmpFiles);
+        UNIT_ASSERT_VALUES_EQUAL(tmpFiles.size(), 0);
+    } else {
+        plotCalcer.ComputeNonAdditiveMetrics(processedDatasetParts);
+    }
+    return plotCalcer.GetMetricsScore();
+}
+
+static void CheckEqualScores(const TVector<TVector<double>>& actual, const TVector<TVector<double>>& expected) {
+    UNIT_ASSERT_VALUES_EQUAL(actual.size(), expected.size());
+    for (auto metricIdx : xrange(expected.size())) {
+        UNIT_ASSERT_VALUES_EQUAL(actual[metricIdx].size(), expected[metricIdx].size());
+        for (auto plotLineIdx : xrange(expected[metricIdx].size())) {
+            const double expectedScore = expected[metricIdx][plotLineIdx];
+            UNIT_ASSERT_DOUBLES_EQUAL(actual[metricIdx][plotLineIdx], expectedScore, 1e-9 * Max(1.0, Abs(expectedScore)));
+        }
+    }
+}
+
+// non-additive metrics calculated in iteration chunks over saved approxes match the ones calculated in memory
+static void CheckNonAdditiveMetricsOnParts(ui32 classCount) {
+    // the last part is saved in several encoded blocks of approx values
+    const TVector<TDataProviderPtr> datasetParts = {
+        CreateRandomClassificationDataProvider(/*objectCount*/ 700, classCount, /*seed*/ 0),
+        CreateRandomClassificationDataProvider(/*objectCount*/ 1, classCount, /*seed*/ 1),
+        CreateRandomClassificationDataProvider(/*objectCount*/ 70000, classCount, /*seed*/ 2)
+    };
+    NJson::TJsonValue params;
+    params.InsertValue("iterations", 20);
+    params.InsertValue("loss_function", classCount > 2 ? "MultiClass" : "Logloss");
+    const TFullModel model = TrainRandomModel(datasetParts[0], params);
+
+    for (int evalPeriod : {1, 3}) {
+        const auto expected = CalcMetricsPlot(
+            model,
+            datasetParts,
+            evalPeriod,
+            /*processedIterationsStep*/ -1,
+            /*threadCount*/ 1,
+            /*calcOnParts*/ false
+        );
+        for (int processedIterationsStep : {1, 2, 5, 100}) {
+            for (int threadCount : {1, 4}) {
+                const auto scores = CalcMetricsPlot(
+                    model,
+                    datasetParts,
+                    evalPeriod,
+                    processedIterationsStep,
+                    threadCount,
+                    /*calcOnParts*/ true
+                );
+                CheckEqualScores(scores, expected);
+            }
+        }
+    }
+}
+
+Y_UNIT_TEST_SUITE(TMetricsPlotCalcerTest) {
+    Y_UNIT_TEST(TestNonAdditiveMetricsOnParts) {
+        CheckNonAdditiveMetricsOnParts(/*classCount*/ 2);
+    }
+
+    Y_UNIT_TEST(TestNonAdditiveMetricsOnPartsMultiClass) {
+        CheckNonAdditiveMetricsOnParts(/*classCount*/ 3);
+    }
+}
@@ -0,0 +1,338 @@
+#include <catboost/libs/algo/calc_score_cache.h>
+#include <catboost/libs/algo/index_calcer.h>
+#include <catboost/libs/algo/learn_context.h>
+#include <catboost/libs/algo/score_calcer.h>
+#include <catboost/libs/algo/tensor_search_helpers.h>
+#include <catboost/libs/algo/ut/lib/random_data.h>
+#include <catboost/libs/model/features.h>
+#include <catboost/libs/options/plain_options_helper.h>
+#include <catboost/libs/train_lib/data.h>
+#include <catboost/libs/train_lib/train_model.h>
+
+#include <library/unittest/registar.h>
+
+#include <util/generic/algorithm.h>
+#include <util/generic/xrange.h>
+
+
+using namespace NCB;
+using namespace NCB::NAlgoUT;
+
+
+static NJson::TJsonValue MakePlainParams(bool isOrdered, bool isMultiClass, bool isSampled) {
+    NJson::TJsonValue plainParams;
+    plainParams.InsertValue("iterations", 1);
+    plainParams.InsertValue("depth", 4);
+    plainParams.InsertValue("border_count", 32);
+    plainParams.InsertValue("one_hot_max_size", 4);
+    plainParams.InsertValue("random_seed", 0);
+    plainParams.InsertValue("thread_count", 4);
+    plainParams.InsertValue("boosting_type", isOrdered ? "Ordered" : "Plain");
+    plainParams.InsertValue("loss_function", isMultiClass ? "MultiClass" : "RMSE");
+    plainParams.InsertValue("sampling_frequency", "PerTree");
+    if (isSampled) {
+        plainParams.InsertValue("bootstrap_type", "Bernoulli");
+        plainParams.InsertValue("subsample", 0.5);
+    } else {
+        plainParams.InsertValue("bootstrap_type", "No");
+    }
+    plainParams.InsertValue("logging_level", "Silent");
+    plainParams.InsertValue("allow_writing_files", false);
+    return plainParams;
+}
+
+static void CheckScoresAreEqual(TConstArrayRef<double> lhs, TConstArrayRef<double> rhs) {
+    UNIT_ASSERT_VALUES_EQUAL(lhs.size(), rhs.size());
+    for (auto i : xrange(lhs.size())) {
+        UNIT_ASSERT_DOUBLES_EQUAL(lhs[i], rhs[i], 1e-6 * Max(1.0, Abs(lhs[i])));
+    }
+}
+
+/* Grows a tree by the best split at each level and checks that at each level scores of float and one-hot
+ * candidates calculated in groups of groupSize by CalcScoresForFeatureGroup are the same as scores
+ * calculated for each candidate by CalcStatsAndScores. Stats of packed features are unpacked from histograms
+ * of packs and stats of sparse features are accumulated from non-default objects in the former,
+ * both are calculated from decoded bins in the latter.
+ */
+static void CheckFusedScores(
+    const TRandomDataSpec& spec,
+    const NJson::TJsonValue& plainParams,
+    bool useTreeLevelCaching,
+    int limitedCacheIdx, // stats cache which holds stats of two features only, -1 for none
+    int groupSize
+) {
+    NJson::TJsonValue jsonParams;
+    NJson::TJsonValue outputJsonParams;
+    NCatboostOptions::PlainJsonToOptions(plainParams, &jsonParams, &outputJsonParams);
+    NCatboostOptions::TCatBoostOptions catBoostOptions(NCatboostOptions::LoadOptions(jsonParams));
+    NCatboostOptions::TOutputFilesOptions outputOptions;
+    outputOptions.Load(outputJsonParams);
+
+    NPar::TLocalExecutor localExecutor;
+    localExecutor.RunAdditionalThreads(catBoostOptions.SystemOptions->NumThreads.Get() - 1);
+    TRestorableFastRng64 rand(catBoostOptions.RandomSeed.Get());
+
+    TDataProviders dataProviders;
+    dataProviders.Learn = CreateRandomDataProvider(spec);
+    TLabelConverter labelConverter;
+    const TTrainingForCPUDataProviders data = GetTrainingData(
+        std::move(dataProviders),
+        /*bordersFile*/ Nothing(),
+        /*ensureConsecutiveLearnFeaturesDataForCpu*/ true,
+        /*allowWriteFiles*/ false,
+        /*quantizedFeaturesInfo*/ nullptr,
+        &catBoostOptions,
+        &labelConverter,
+        &localExecutor,
+        &rand
+    ).Cast<TQuantizedForCPUObjectsDataProvider>();
+
+    THolder<TLearnContext> ctx = CreateLearnContext(
+        jsonParams,
+        outputOptions,
+        /*objectiveDescriptor*/ Nothing(),
+        /*evalMetricDescriptor*/ Nothing(),
+        data,
+        labelConverter,
+        /*rand*/ Nothing(),
+        &localExecutor
+    );
+    const auto& objectsData = *data.Learn->ObjectsData;
+    const auto& params = ctx->Params;
+    const int maxDepth = params.ObliviousTreeOptions->MaxDepth;
+    const TVector<int> splitCounts = CountSplits(ctx->LearnProgress.FloatFeatures);
+
+    // packed features must be stored in packs only
+    ui32 packedFeatureCount = 0;
+    for (auto floatFeatureIdx : xrange(spec.GetFloatFeatureCount())) {
+        if (objectsData.GetFloatFeaturePackedIndex(floatFeatureIdx)) {
+            UNIT_ASSERT(dynamic_cast<const TPackedFloatValuesHolder*>(*objectsData.GetFloatFeature(floatFeatureIdx)));
+            UNIT_ASSERT(!objectsData.GetFloatFeatureRawSrcData(floatFeatureIdx));
+            ++packedFeatureCount;
+        }
+    }
+    UNIT_ASSERT(packedFeatureCount <= spec.PackableFeatureCount);
+    if (spec.PackableFeatureCount > 1) {
+        UNIT_ASSERT(packedFeatureCount > 0);
+    }
+
+    // sparse features must be stored as non-default bins only
+    const ui32 sparseFeatureBegin = spec.GetFloatFeatureCount() - spec.SparseFeatureCount;
+    for (auto floatFeatureIdx : xrange(spec.GetFloatFeatureCount())) {
+        const bool isSparse = objectsData.GetFloatFeatureSparseValues(floatFeatureIdx) != nullptr;
+        UNIT_ASSERT_VALUES_EQUAL(isSparse, floatFeatureIdx >= sparseFeatureBegin);
+        if (isSparse) {
+            UNIT_ASSERT(dynamic_cast<const TSparseFloatValuesHolder*>(*objectsData.GetFloatFeature(floatFeatureIdx)));
+            UNIT_ASSERT(!objectsData.GetFloatFeatureRawSrcData(floatFeatureIdx));
+        }
+    }
+
+    TVector<TSplitCandidate> candidates;
+    objectsData.GetFeaturesLayout()->IterateOverAvailableFeatures<EFeatureType::Float>(
+        [&] (TFloatFeatureIdx floatFeatureIdx) {
+            TSplitCandidate split;
+            split.Type = ESplitType::FloatFeature;
+            split.FeatureIdx = (int)*floatFeatureIdx;
+            candidates.push_back(split);
+        }
+    );
+    objectsData.GetFeaturesLayout()->IterateOverAvailableFeatures<EFeatureType::Categorical>(
+        [&] (TCatFeatureIdx catFeatureIdx) {
+            const auto uniqueValuesCount =
+                objectsData.GetQuantizedFeaturesInfo()->GetUniqueValuesCounts(catFeatureIdx).OnLearnOnly;
+            if (uniqueValuesCount > 1 && uniqueValuesCount <= params.CatFeatureParams->OneHotMaxSize.Get()) {
+                TSplitCandidate split;
+                split.Type = ESplitType::OneHotFeature;
+                split.FeatureIdx = (int)*catFeatureIdx;
+                candidates.push_back(split);
+            }
+        }
+    );
+    UNIT_ASSERT_VALUES_EQUAL(candidates.size(), spec.GetFloatFeatureCount() + spec.OneHotFeatureCount);
+
+    TFold* fold = &ctx->LearnProgress.Folds[0];
+    const auto error = BuildError(params, Nothing());
+    for (int bodyTailIdx : xrange(fold->BodyTailArr.ysize())) {
+        CalcWeightedDerivatives(*error, bodyTailIdx, params, /*randomSeed*/ bodyTailIdx, fold, &localExecutor);
+    }
+
+    const int defaultCalcStatsObjBlockSize = static_cast<int>(params.ObliviousTreeOptions->DevScoreCalcObjBlockSize);
+    TCalcScoreFold sampledDocs;
+    sampledDocs.Create(
+        ctx->LearnProgress.Folds,
+        /*isPairwiseScoring*/ false,
+        defaultCalcStatsObjBlockSize,
+        GetBernoulliSampleRate(params.ObliviousTreeOptions->BootstrapConfig),
+        IsSampledBySampleWeights(params.ObliviousTreeOptions->BootstrapConfig)
+    );
+    TCalcScoreFold smallestSplitSideDocs;
+    smallestSplitSideDocs.Create(ctx->LearnProgress.Folds, /*isPairwiseScoring*/ false, defaultCalcStatsObjBlockSize);
+
+    // each way of calculation keeps its own stats from previous level
+    // candidates which stats do not fit into a limited cache are scored without it
+    const ui64 limitedCacheSize =
+        2 * sizeof(TBucketStats) * fold->BodyTailArr.size() * fold->GetApproxDimension()
+        * ((*MaxElement(splitCounts.begin(), splitCounts.end()) + 1) << maxDepth);
+    TBucketStatsCache statsCaches[2];
+    for (int cacheIdx : xrange(2)) {
+        statsCaches[cacheIdx].Create(
+            ctx->LearnProgress.Folds,
+            CountNonCtrBuckets(splitCounts, *objectsData.GetQuantizedFeaturesInfo(), params.CatFeatureParams->OneHotMaxSize),
+            maxDepth,
+            cacheIdx == limitedCacheIdx ? limitedCacheSize : Max<ui64>()
+        );
+    }
+
+    TVector<TIndexType> indices(objectsData.GetObjectCount());
+    Bootstrap(params, indices, fold, &sampledDocs, &localExecutor, &ctx->Rand);
+
+    for (int depth : xrange(maxDepth)) {
+        TVector<TVector<double>> scores(candidates.size());
+        for (auto candidateIdx : xrange(candidates.size())) {
+            TVector<TScoreBin> scoreBins;
+            CalcStatsAndScores(
+                objectsData,
+                splitCounts,
+                fold->GetAllCtrs(),
+                sampledDocs,
+                smallestSplitSideDocs,
+                fold,
+                TFlatPairsInfo(),
+                params,
+                candidates[candidateIdx],
+                depth,
+                useTreeLevelCaching,
+                &localExecutor,
+                &statsCaches[0],
+                /*stats3d*/ nullptr,
+                /*pairwiseStats*/ nullptr,
+                &scoreBins
+            );
+            scores[candidateIdx] = GetScores(scoreBins);
+        }
+
+        for (int groupBegin = 0; groupBegin < candidates.ysize(); groupBegin += groupSize) {
+            const int groupEnd = Min(groupBegin + groupSize, candidates.ysize());
+            TVector<TVector<TScoreBin>> scoreBins;
+            CalcScoresForFeatureGroup(
+                objectsData,
+                splitCounts,
+                sampledDocs,
+                smallestSplitSideDocs,
+                *fold,
+                params,
+                MakeArrayRef(candidates).Slice(groupBegin, groupEnd - groupBegin),
+                depth,
+                useTreeLevelCaching,
+                &localExecutor,
+                &statsCaches[1],
+                &scoreBins
+            );
+            UNIT_ASSERT_VALUES_EQUAL(scoreBins.ysize(), groupEnd - groupBegin);
+            for (int candidateIdx : xrange(groupBegin, groupEnd)) {
+                CheckScoresAreEqual(GetScores(scoreBins[candidateIdx - groupBegin]), scores[candidateIdx]);
+            }
+        }
+
+        int bestCandidateIdx = 0;
+        int bestBinIdx = 0;
+        for (auto candidateIdx : xrange(candidates.size())) {
+            for (auto binIdx : xrange(scores[candidateIdx].size())) {
+                if (scores[candidateIdx][binIdx] > scores[bestCandidateIdx][bestBinIdx]) {
+                    bestCandidateIdx = candidateIdx;
+                    bestBinIdx = binIdx;
+                }
+            }
+        }
+        const TSplit bestSplit(candidates[bestCandidateIdx], bestBinIdx);
+        SetPermutedIndices(bestSplit, objectsData, depth + 1, *fold, &indices, &localExecutor);
+        sampledDocs.UpdateIndices(indices, &localExecutor);
+        if (useTreeLevelCaching) {
+            smallestSplitSideDocs.SelectSmallestSplitSide(depth + 1, sampledDocs, &localExecutor);
+        }
+    }
+}
+
+static void CheckFusedScoresForAllModes(const TRandomDataSpec& spec, int groupSize) {
+    for (bool isOrdered : {false, true}) {
+        for (bool isSampled : {false, true}) {
+            const auto plainParams = MakePlainParams(isOrdered, /*isMultiClass*/ spec.ClassCount > 0, isSampled);
+            CheckFusedScores(spec, plainParams, /*useTreeLevelCaching*/ false, /*limitedCacheIdx*/ -1, groupSize);
+            for (int limitedCacheIdx : {-1, 0, 1}) {
+                CheckFusedScores(spec, plainParams, /*useTreeLevelCaching*/ true, limitedCacheIdx, groupSize);
+            }
+        }
+    }
+}
+
+Y_UNIT_TEST_SUITE(TScoreCalcerTest) {
+    Y_UNIT_TEST(TestFusedScoresForSmallGroups) {
+        TRandomDataSpec spec;
+        spec.ObjectCount = 500;
+        spec.DenseFeatureCount = 5;
+        spec.OneHotFeatureCount = 2;
+        spec.TargetNoiseShare = 0.1f;
+        spec.Seed = 20190410;
+        CheckFusedScoresForAllModes(spec, /*groupSize*/ 3);
+    }
+
+    Y_UNIT_TEST(TestFusedScoresForLargeGroups) {
+        TRandomDataSpec spec;
+        spec.ObjectCount = 500;
+        spec.DenseFeatureCount = FUSED_HISTOGRAM_MAX_FEATURE_COUNT + 6;
+        spec.OneHotFeatureCount = 2;
+        spec.TargetNoiseShare = 0.1f;
+        spec.Seed = 20190411;
+        // groups as in tensor search and a single group of all candidates
+        CheckFusedScoresForAllModes(spec, FUSED_HISTOGRAM_MAX_FEATURE_COUNT);
+        CheckFusedScoresForAllModes(spec, FUSED_HISTOGRAM_MAX_FEATURE_COUNT + 8);
+    }
+
+    Y_UNIT_TEST(TestFusedScoresForMultiClass) {
+        TRandomDataSpec spec;
+        spec.ObjectCount = 500;
+        spec.DenseFeatureCount = 5;
+        spec.OneHotFeatureCount = 2;
+        spec.ClassCount = 3;
+        spec.TargetNoiseShare = 0.1f;
+        spec.Seed = 20190412;
+        CheckFusedScoresForAllModes(spec, /*groupSize*/ 4);
+    }
+
+    Y_UNIT_TEST(TestFusedScoresForPackedFeatures) {
+        TRandomDataSpec spec;
+        spec.ObjectCount = 500;
+        spec.DenseFeatureCount = 3;
+        spec.PackableFeatureCount = 9;
+        spec.OneHotFeatureCount = 1;
+        spec.TargetNoiseShare = 0.1f;
+        spec.Seed = 20190413;
+        // groups which contain a part of a pack and all packs
+        CheckFusedScoresForAllModes(spec, /*groupSize*/ 4);
+        CheckFusedScoresForAllModes(spec, /*groupSize*/ 13);
+    }
+
+    Y_UNIT_TEST(TestFusedScoresForSparseFeatures) {
+        TRandomDataSpec spec;
+        spec.ObjectCount = 1000;
+        spec.DenseFeatureCount = 2;
+        spec.PackableFeatureCount = 2;
+        spec.SparseFeatureCount = 4;
+        spec.OneHotFeatureCount = 1;
+        spec.TargetNoiseShare = 0.1f;
+        spec.Seed = 20190414;
+        CheckFusedScoresForAllModes(spec, /*groupSize*/ 3);
+        CheckFusedScoresForAllModes(spec, /*groupSize*/ 9);
+    }
+
+    Y_UNIT_TEST(TestFusedScoresForSparseFeaturesMultiClass) {
+        TRandomDataSpec spec;
+        spec.ObjectCount = 1000;
+        spec.DenseFeatureCount = 2;
+        spec.SparseFeatureCount = 3;
+        spec.ClassCount = 3;
+        spec.TargetNoiseShare = 0.1f;
+        spec.Seed = 20190415;
+        CheckFusedScoresForAllModes(spec, /*groupSize*/ 5);
+    }
+}
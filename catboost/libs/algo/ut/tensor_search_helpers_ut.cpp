@@ -0,0 +1,101 @@
+#include <catboost/libs/algo/tensor_search_helpers.h>
+
+#include <library/threading/local_executor/local_executor.h>
+#include <library/unittest/registar.h>
+
+#include <util/generic/xrange.h>
+#include <util/random/fast.h>
+
+static double CalcMvsSampleSize(const TVector<double>& values, double threshold) {
+    double sampleSize = 0;
+    for (double value : values) {
+        sampleSize += threshold > 0 ? Min(1.0, value / threshold) : 1.0;
+    }
+    return sampleSize;
+}
+
+Y_UNIT_TEST_SUITE(TTensorSearchHelpersTest) {
+    Y_UNIT_TEST(TestMvsThreshold) {
+        TVector<double> values = {3, 0, 10, 1, 2};
+        UNIT_ASSERT_DOUBLES_EQUAL(CalcMvsThreshold(values, 3), 3.0, 1e-9);
+
+        TReallyFastRng32 rng(0);
+        TVector<double> randomValues(10000);
+        for (auto& value : randomValues) {
+            // heavy tail, so that some values are above threshold
+            value = rng.GenRandReal1() < 0.01 ? 1000 * rng.GenRandReal1() : rng.GenRandReal1();
+        }
+        for (double sampleSize : {1.0, 100.0, 2000.0, 9999.0}) {
+            TVector<double> candidates = randomValues;
+            const double threshold = CalcMvsThreshold(candidates, sampleSize);
+            UNIT_ASSERT_DOUBLES_EQUAL(CalcMvsSampleSize(randomValues, threshold), sampleSize, 1e-6 * sampleSize);
+        }
+    }
+
+    Y_UNIT_TEST(TestMvsThresholdTakesAll) {
+        TVector<double> values = {1, 2, 3};
+        const double threshold = CalcMvsThreshold(values, 3);
+        UNIT_ASSERT(threshold > 0 && threshold <= 1);
+        UNIT_ASSERT_DOUBLES_EQUAL(CalcMvsSampleSize({1, 2, 3}, threshold), 3.0, 1e-9);
+
+        TVector<double> zeros(5, 0.0);
+        UNIT_ASSERT_DOUBLES_EQUAL(CalcMvsSampleSize(zeros, CalcMvsThreshold(zeros, 2)), 5.0, 1e-9);
+    }
+
+    Y_UNIT_TEST(TestMvsSampleWeights) {
+        const int docCount = 100000;
+        const double sampleRate = 0.2;
+        TReallyFastRng32 rng(0);
+        TVector<double> gradientNorms(docCount);
+        for (auto& gradientNorm : gradientNorms) {
+            // heavy tail, so that some documents are above threshold
+            gradientNorm = rng.GenRandReal1() < 0.01 ? 1000 * rng.GenRandReal1() : rng.GenRandReal1();
+        }
+        TVector<double> candidates = gradientNorms;
+        const double threshold = CalcMvsThreshold(candidates, sampleRate * docCount);
+
+        NPar::TLocalExecutor localExecutor;
+        localExecutor.RunAdditionalThreads(3);
+        TVector<float> sampleWeights(docCount);
+        GenerateMvsSampleWeights(gradientNorms, threshold, /*randSeed*/ 0, &localExecutor, sampleWeights);
+
+        int largeCount = 0;
+        int sampledCount = 0;
+        double gradientSum = 0;
+        double sampledGradientSum = 0;
+        for (auto i : xrange(docCount)) {
+            if (gradientNorms[i] >= threshold) {
+                UNIT_ASSERT_VALUES_EQUAL(sampleWeights[i], 1.0f);
+                ++largeCount;
+            } else if (sampleWeights[i] != 0.0f) {
+                UNIT_ASSERT_DOUBLES_EQUAL(sampleWeights[i], threshold / gradientNorms[i], 1e-5 * sampleWeights[i]);
+            }
+            sampledCount += sampleWeights[i] != 0.0f;
+            gradientSum += gradientNorms[i];
+            sampledGradientSum += sampleWeights[i] * gradientNorms[i];
+        }
+        UNIT_ASSERT(largeCount > 0);
+        // sampled sum is an unbiased estimate of the sum, sample size is as requested on average
+        UNIT_ASSERT_DOUBLES_EQUAL(sampledGradientSum, gradientSum, 0.02 * gradientSum);
+        UNIT_ASSERT_DOUBLES_EQUAL(sampledCount, sampleRate * docCount, 0.02 * sampleRate * docCount);
+
+        // weights depend only on the seed, not on the number of threads
+        NPar::TLocalExecutor serialExecutor;
+        TVector<float> serialSampleWeights(docCount);
+        GenerateMvsSampleWeights(gradientNorms, threshold, /*randSeed*/ 0, &serialExecutor, serialSampleWeights);
+        UNIT_ASSERT_EQUAL(sampleWeights, serialSampleWeights);
+    }
+
+    Y_UNIT_TEST(TestMvsSampleWeightsForZeroGradients) {
+        TVector<double> gradientNorms(10, 0.0);
+        TVector<double> candidates = gradientNorms;
+        const double threshold = CalcMvsThreshold(candidates, 5);
+
+        NPar::TLocalExecutor localExecutor;
+        TVector<float> sampleWeights(gradientNorms.size());
+        GenerateMvsSampleWeights(gradientNorms, threshold, /*randSeed*/ 0, &localExecutor, sampleWeights);
+        for (float sampleWeight : sampleWeights) {
+            UNIT_ASSERT_VALUES_EQUAL(sampleWeight, 1.0f);
+        }
+    }
+}
@@ -1,4 +1,5 @@
 
+#include <catboost/libs/algo/apply.h>
 #include <catboost/libs/data_new/data_provider_builders.h>
 #include <catboost/libs/train_lib/train_model.h>
 
@@ -125,4 +126,62 @@ Y_UNIT_TEST_SUITE(TTrainTest) {
             UNIT_ASSERT( Equal<float>(features[j], (**rawObjectsData.GetFloatFeature(j)).GetArrayData()) );
         }
     }
+
+    Y_UNIT_TEST(TestSinglePrecisionDerivativesInOrderedBoosting) {
+        const size_t DocCount = 2000;
+        const ui32 FactorCount = 4;
+
+        TReallyFastRng32 rng(17);
+
+        TVector<float> target(DocCount);
+        TVector<TVector<float>> features(FactorCount, TVector<float>(DocCount)); // [featureIdx][objectIdx]
+        for (auto i : xrange(DocCount)) {
+            for (auto j : xrange(FactorCount)) {
+                features[j][i] = rng.GenRandReal2();
+            }
+            target[i] = features[0][i] + 0.3 * features[1][i] + 0.01 * rng.GenRandReal2();
+        }
+
+        TDataProviders dataProviders;
+        dataProviders.Learn = CreateDataProvider(
+            [&] (IRawFeaturesOrderDataVisitor* visitor) {
+                TDataMetaInfo metaInfo;
+                metaInfo.HasTarget = true;
+                metaInfo.FeaturesLayout = MakeIntrusive<TFeaturesLayout>(
+                    FactorCount,
+                    TVector<ui32>{},
+                    TVector<TString>{}
+                );
+
+                visitor->Start(metaInfo, DocCount, EObjectsOrder::Undefined, {});
+                for (auto factorId : xrange(FactorCount)) {
+                    visitor->AddFloatFeature(
+                        factorId,
+                        TMaybeOwningConstArrayHolder<float>::CreateOwning(TVector<float>(features[factorId]))
+                    );
+                }
+                visitor->AddTarget(target);
+                visitor->Finish();
+            }
+        );
+
+        const auto trainModel = [&] (bool singlePrecisionDerivatives) {
+            NJson::TJsonValue params;
+            params.InsertValue("iterations", 20);
+            params.InsertValue("boosting_type", "Ordered");
+            params.InsertValue("random_seed", 1);
+            params.InsertValue("thread_count", 1);
+            params.InsertValue("dev_single_precision_derivatives", singlePrecisionDerivatives);
+            TFullModel model;
+            TrainModel(params, nullptr, Nothing(), Nothing(), dataProviders, "", &model, {});
+            return model;
+        };
+
+        const auto expected = ApplyModelMulti(trainModel(false), *dataProviders.Learn->ObjectsData);
+        const auto actual = ApplyModelMulti(trainModel(true), *dataProviders.Learn->ObjectsData);
+        UNIT_ASSERT_VALUES_EQUAL(expected[0].size(), actual[0].size());
+        for (auto i : xrange(DocCount)) {
+            UNIT_ASSERT_DOUBLES_EQUAL(expected[0][i], actual[0][i], 1e-4);
+        }
+    }
 }
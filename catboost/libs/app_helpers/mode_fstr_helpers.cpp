@@ -72,6 +72,22 @@ void NCB::PrepareFstrModeParamsParser(
         .Handler1T<TString>([&params](const TString& fstrType) {
             CB_ENSURE(TryFromString<EFstrType>(fstrType, params.FstrType), fstrType + " fstr type is not supported");
         });
+    parser.AddLongOption("shap-output-format", "Should be one of: Tsv, Binary")
+        .RequiredArgument("format")
+        .Handler1T<TString>([&params](const TString& format) {
+            CB_ENSURE(
+                TryFromString<EShapValuesOutputFormat>(format, params.ShapValuesOutputFormat),
+                format + " SHAP values output format is not supported");
+        });
+    parser.AddLongOption("shap-top-size", "Output only this number of features with the largest absolute SHAP values for each document, 0 means all features (only for Binary output format)")
+        .RequiredArgument("INT")
+        .StoreResult(&params.ShapValuesTopSize);
+    parser.AddLongOption("shap-prepared-trees-input-path", "Use SHAP values prepared for the trees of the model from this file")
+        .RequiredArgument("PATH")
+        .StoreResult(&params.ShapPreparedTreesInputPath);
+    parser.AddLongOption("shap-prepared-trees-output-path", "Save SHAP values prepared for the trees of the model to this file")
+        .RequiredArgument("PATH")
+        .StoreResult(&params.ShapPreparedTreesOutputPath);
     parser.AddLongOption("verbose", "Log writing period")
         .DefaultValue("0")
         .Handler1T<TString>([&params](const TString& verbose) {
@@ -116,9 +132,24 @@ void NCB::ModeFstrSingleHost(const NCB::TAnalyticalModeCommonParams& params) {
         case EFstrType::InternalInteraction:
             CalcAndOutputInteraction(model, nullptr, &params.OutputPath.Path);
             break;
-        case EFstrType::ShapValues:
-            CalcAndOutputShapValues(model, *poolLoader(), params.OutputPath.Path, params.Verbose, localExecutor.Get());
+        case EFstrType::ShapValues: {
+            const TShapPreparedTrees preparedTrees = params.ShapPreparedTreesInputPath.empty()
+                ? PrepareTrees(model, poolLoader().Get(), params.Verbose, localExecutor.Get())
+                : LoadShapPreparedTrees(model, params.ShapPreparedTreesInputPath);
+            if (!params.ShapPreparedTreesOutputPath.empty()) {
+                SaveShapPreparedTrees(model, preparedTrees, params.ShapPreparedTreesOutputPath);
+            }
+            CalcAndOutputShapValues(
+                model,
+                preparedTrees,
+                *poolLoader(),
+                params.OutputPath.Path,
+                params.Verbose,
+                localExecutor.Get(),
+                params.ShapValuesOutputFormat,
+                params.ShapValuesTopSize);
             break;
+        }
         default:
             Y_ASSERT(false);
     }
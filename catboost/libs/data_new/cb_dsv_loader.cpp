@@ -6,9 +6,12 @@
 
 #include <library/object_factory/object_factory.h>
 
+#include <util/generic/algorithm.h>
+#include <util/generic/cast.h>
 #include <util/generic/maybe.h>
 #include <util/generic/strbuf.h>
 #include <util/generic/vector.h>
+#include <util/generic/xrange.h>
 #include <util/stream/file.h>
 #include <util/string/iterator.h>
 #include <util/string/split.h>
@@ -17,6 +20,132 @@
 
 namespace NCB {
 
+    /* parse data line into visitor
+     * lineIdx is an index of object in the current block of visitor,
+     * floatFeatures and catFeatures are buffers that can be reused between calls
+     */
+    static void ParseDsvLine(
+        TStringBuf line,
+        ui32 lineIdx,
+        char fieldDelimiter,
+        const TVector<TColumn>& columnsDescription,
+        const TFeaturesLayout& featuresLayout,
+        const TVector<bool>& featureIgnored,
+        IRawObjectsOrderDataVisitor* visitor,
+        TVector<float>* floatFeatures,
+        TVector<ui32>* catFeatures
+    ) {
+        ui32 featureId = 0;
+        ui32 baselineIdx = 0;
+
+        floatFeatures->yresize(featuresLayout.GetFloatFeatureCount());
+        catFeatures->yresize(featuresLayout.GetCatFeatureCount());
+
+        size_t tokenCount = 0;
+        for (const auto& it : StringSplitter(line).Split(fieldDelimiter)) {
+            const TStringBuf token = it.Token();
+            CB_ENSURE(
+                tokenCount < columnsDescription.size(),
+                "wrong columns number: expected " << columnsDescription.ysize()
+                << ", found more"
+            );
+            try {
+                switch (columnsDescription[tokenCount].Type) {
+                    case EColumn::Categ: {
+                        if (!featureIgnored[featureId]) {
+                            const ui32 catFeatureIdx = featuresLayout.GetInternalFeatureIdx(featureId);
+                            if (IsNanValue(token)) {
+                                (*catFeatures)[catFeatureIdx] = visitor->GetCatFeatureValue(featureId, "nan");
+                            } else {
+                                (*catFeatures)[catFeatureIdx] = visitor->GetCatFeatureValue(featureId, token);
+                            }
+                        }
+                        ++featureId;
+                        break;
+                    }
+                    case EColumn::Num: {
+                        if (!featureIgnored[featureId]) {
+                            if (!TryParseFloatFeatureValue(
+                                    token,
+                                    &(*floatFeatures)[featuresLayout.GetInternalFeatureIdx(featureId)]
+                                 ))
+                            {
+                                CB_ENSURE(
+                                    false,
+                                    "Factor " << featureId << " cannot be parsed as float."
+                                    " Try correcting column description file."
+                                );
+                            }
+                        }
+                        ++featureId;
+                        break;
+                    }
+                    case EColumn::Label: {
+                        CB_ENSURE(token.length() != 0, "empty values not supported for Label");
+                        visitor->AddTarget(lineIdx, TString(token));
+                        break;
+                    }
+                    case EColumn::Weight: {
+                        CB_ENSURE(token.length() != 0, "empty values not supported for weight");
+                        visitor->AddWeight(lineIdx, FromString<float>(token));
+                        break;
+                    }
+                    case EColumn::Auxiliary: {
+                        break;
+                    }
+                    case EColumn::GroupId: {
+                        CB_ENSURE(token.length() != 0, "empty values not supported for GroupId");
+                        visitor->AddGroupId(lineIdx, CalcGroupIdFor(token));
+                        break;
+                    }
+                    case EColumn::GroupWeight: {
+                        CB_ENSURE(token.length() != 0, "empty values not supported for GroupWeight");
+                        visitor->AddGroupWeight(lineIdx, FromString<float>(token));
+                        break;
+                    }
+                    case EColumn::SubgroupId: {
+                        CB_ENSURE(token.length() != 0, "empty values not supported for SubgroupId");
+                        visitor->AddSubgroupId(lineIdx, CalcSubgroupIdFor(token));
+                        break;
+                    }
+                    case EColumn::Baseline: {
+                        CB_ENSURE(token.length() != 0, "empty values not supported for Baseline");
+                        visitor->AddBaseline(lineIdx, baselineIdx, FromString<float>(token));
+                        ++baselineIdx;
+                        break;
+                    }
+                    case EColumn::DocId: {
+                        break;
+                    }
+                    case EColumn::Timestamp: {
+                        CB_ENSURE(token.length() != 0, "empty values not supported for Timestamp");
+                        visitor->AddTimestamp(lineIdx, FromString<ui64>(token));
+                        break;
+                    }
+                    default: {
+                        CB_ENSURE(false, "wrong column type");
+                    }
+                }
+            } catch (yexception& e) {
+                throw TCatBoostException() << "Column " << tokenCount << " (type "
+                    << columnsDescription[tokenCount].Type << ", value = \"" << token
+                    << "\"): " << e.what();
+            }
+            ++tokenCount;
+        }
+        if (!floatFeatures->empty()) {
+            visitor->AddAllFloatFeatures(lineIdx, *floatFeatures);
+        }
+        if (!catFeatures->empty()) {
+            visitor->AddAllCatFeatures(lineIdx, *catFeatures);
+        }
+        CB_ENSURE(
+            tokenCount == columnsDescription.size(),
+            "wrong columns number: expected " << columnsDescription.ysize()
+            << ", found " << tokenCount
+        );
+    }
+
     TCBDsvDataLoader::TCBDsvDataLoader(TDatasetLoaderPullArgs&& args)
         : TCBDsvDataLoader(
             TLineDataLoaderPushArgs {
@@ -83,115 +212,19 @@ namespace NCB {
         auto& columnsDescription = DataMetaInfo.ColumnsInfo->Columns;
 
         auto parseBlock = [&](TString& line, int lineIdx) {
-            const auto& featuresLayout = *DataMetaInfo.FeaturesLayout;
-
-            ui32 featureId = 0;
-            ui32 baselineIdx = 0;
-
             TVector<float> floatFeatures;
-            floatFeatures.yresize(featuresLayout.GetFloatFeatureCount());
-
             TVector<ui32> catFeatures;
-            catFeatures.yresize(featuresLayout.GetCatFeatureCount());
-
-            size_t tokenCount = 0;
-            TVector<TStringBuf> tokens = StringSplitter(line).Split(FieldDelimiter);
             try {
-                for (const auto& token : tokens) {
-                    try {
-                        switch (columnsDescription[tokenCount].Type) {
-                            case EColumn::Categ: {
-                                if (!FeatureIgnored[featureId]) {
-                                    const ui32 catFeatureIdx = featuresLayout.GetInternalFeatureIdx(featureId);
-                                    if (IsNanValue(token)) {
-                                        catFeatures[catFeatureIdx] = visitor->GetCatFeatureValue(featureId, "nan");
-                                    } else {
-                                        catFeatures[catFeatureIdx] = visitor->GetCatFeatureValue(featureId, token);
-                                    }
-                                }
-                                ++featureId;
-                                break;
-                            }
-                            case EColumn::Num: {
-                                if (!FeatureIgnored[featureId]) {
-                                    if (!TryParseFloatFeatureValue(
-                                            token,
-                                            &floatFeatures[featuresLayout.GetInternalFeatureIdx(featureId)]
-                                         ))
-                                    {
-                                        CB_ENSURE(
-                                            false,
-                                            "Factor " << featureId << " cannot be parsed as float."
-                                            " Try correcting column description file."
-                                        );
-                                    }
-                                }
-                                ++featureId;
-                                break;
-                            }
-                            case EColumn::Label: {
-                                CB_ENSURE(token.length() != 0, "empty values not supported for Label");
-                                visitor->AddTarget(lineIdx, TString(token));
-                                break;
-                            }
-                            case EColumn::Weight: {
-                                CB_ENSURE(token.length() != 0, "empty values not supported for weight");
-                                visitor->AddWeight(lineIdx, FromString<float>(token));
-                                break;
-                            }
-                            case EColumn::Auxiliary: {
-                                break;
-                            }
-                            case EColumn::GroupId: {
-                                CB_ENSURE(token.length() != 0, "empty values not supported for GroupId");
-                                visitor->AddGroupId(lineIdx, CalcGroupIdFor(token));
-                                break;
-                            }
-                            case EColumn::GroupWeight: {
-                                CB_ENSURE(token.length() != 0, "empty values not supported for GroupWeight");
-                                visitor->AddGroupWeight(lineIdx, FromString<float>(token));
-                                break;
-                            }
-                            case EColumn::SubgroupId: {
-                                CB_ENSURE(token.length() != 0, "empty values not supported for SubgroupId");
-                                visitor->AddSubgroupId(lineIdx, CalcSubgroupIdFor(token));
-                                break;
-                            }
-                            case EColumn::Baseline: {
-                                CB_ENSURE(token.length() != 0, "empty values not supported for Baseline");
-                                visitor->AddBaseline(lineIdx, baselineIdx, FromString<float>(token));
-                                ++baselineIdx;
-                                break;
-                            }
-                            case EColumn::DocId: {
-                                break;
-                            }
-                            case EColumn::Timestamp: {
-                                CB_ENSURE(token.length() != 0, "empty values not supported for Timestamp");
-                                visitor->AddTimestamp(lineIdx, FromString<ui64>(token));
-                                break;
-                            }
-                            default: {
-                                CB_ENSURE(false, "wrong column type");
-                            }
-                        }
-                    } catch (yexception& e) {
-                        throw TCatBoostException() << "Column " << tokenCount << " (type "
-                            << columnsDescription[tokenCount].Type << ", value = \"" << token
-                            << "\"): " << e.what();
-                    }
-                    ++tokenCount;
-                }
-                if (!floatFeatures.empty()) {
-                    visitor->AddAllFloatFeatures(lineIdx, floatFeatures);
-                }
-                if (!catFeatures.empty()) {
-                    visitor->AddAllCatFeatures(lineIdx, catFeatures);
-                }
-                CB_ENSURE(
-                    tokenCount == columnsDescription.size(),
-                    "wrong columns number: expected " << columnsDescription.ysize()
-                    << ", found " << tokenCount
+                ParseDsvLine(
+                    line,
+                    lineIdx,
+                    FieldDelimiter,
+                    columnsDescription,
+                    *DataMetaInfo.FeaturesLayout,
+                    FeatureIgnored,
+                    visitor,
+                    &floatFeatures,
+                    &catFeatures
                 );
             } catch (yexception& e) {
                 throw TCatBoostException() << "Error in dsv data. Line " <<
@@ -202,9 +235,166 @@ namespace NCB {
         AsyncRowProcessor.ProcessBlock(parseBlock);
     }
 
+    // byte size of data range that is processed by one thread at once when loading from memory-mapped file
+    constexpr size_t MAPPED_DSV_CHUNK_SIZE = 64 << 20;
+
+    // cuts next line from data, supports both '\n' and "\r\n" line endings
+    static TStringBuf NextLine(TStringBuf* data) {
+        TStringBuf line = data->NextTok('\n');
+        line.ChopSuffix("\r");
+        return line;
+    }
+
+    TCBDsvMappedDataLoader::TCBDsvMappedDataLoader(TDatasetLoaderPullArgs&& args)
+        : Args(std::move(args.CommonArgs))
+        , Data(TBlob::FromFile(args.PoolPath.Path))
+    {
+        CB_ENSURE(!Args.PairsFilePath.Inited() || CheckExists(Args.PairsFilePath),
+                  "TCBDsvMappedDataLoader:PairsFilePath does not exist");
+        CB_ENSURE(!Args.GroupWeightsFilePath.Inited() || CheckExists(Args.GroupWeightsFilePath),
+                  "TCBDsvMappedDataLoader:GroupWeightsFilePath does not exist");
+
+        const char fieldDelimiter = Args.PoolFormat.Delimiter;
+        TStringBuf data(Data.AsCharPtr(), Data.Size());
+
+        TMaybe<TVector<TString>> headerColumns;
+        if (Args.PoolFormat.HasHeader) {
+            CB_ENSURE(!data.empty(), "TCBDsvMappedDataLoader: no header in file");
+            headerColumns = TVector<TString>(StringSplitter(NextLine(&data)).Split(fieldDelimiter));
+        }
+
+        CB_ENSURE(!data.empty(), "TCBDsvMappedDataLoader: no data rows in pool");
+        TStringBuf firstLineData = data;
+        const ui32 columnsCount = StringSplitter(NextLine(&firstLineData)).Split(fieldDelimiter).Count();
+
+        auto columnsDescription = TDataColumnsMetaInfo{ Args.CdProvider->GetColumnsDescription(columnsCount) };
+        auto featureIds = columnsDescription.GenerateFeatureIds(headerColumns);
+
+        DataMetaInfo = TDataMetaInfo(
+            std::move(columnsDescription),
+            Args.GroupWeightsFilePath.Inited(),
+            Args.PairsFilePath.Inited(),
+            &featureIds
+        );
+
+        ProcessIgnoredFeaturesList(Args.IgnoredFeatures, &DataMetaInfo, &FeatureIgnored);
+
+        // split data into chunks that end at line ends
+        const size_t threadCount = Args.LocalExecutor->GetThreadCount() + 1;
+        const size_t chunkCount = Max(threadCount, (data.size() + MAPPED_DSV_CHUNK_SIZE - 1) / MAPPED_DSV_CHUNK_SIZE);
+        size_t chunkStart = 0;
+        for (auto chunkIdx : xrange<size_t>(1, chunkCount + 1)) {
+            if (chunkStart == data.size()) {
+                break;
+            }
+            size_t chunkEnd = data.size() / chunkCount * chunkIdx;
+            if (chunkIdx == chunkCount) {
+                chunkEnd = data.size();
+            } else {
+                chunkEnd = data.find('\n', Max(chunkEnd, chunkStart + 1) - 1);
+                chunkEnd = (chunkEnd == TStringBuf::npos) ? data.size() : chunkEnd + 1;
+            }
+            Chunks.push_back(data.SubStr(chunkStart, chunkEnd - chunkStart));
+            chunkStart = chunkEnd;
+        }
+
+        TVector<ui64> chunkLineCounts(Chunks.size());
+        Args.LocalExecutor->ExecRangeWithThrow(
+            [&] (int chunkIdx) {
+                const TStringBuf chunk = Chunks[chunkIdx];
+                chunkLineCounts[chunkIdx] = Count(chunk.begin(), chunk.end(), '\n') + (chunk.back() != '\n');
+            },
+            0,
+            SafeIntegerCast<int>(Chunks.size()),
+            NPar::TLocalExecutor::WAIT_COMPLETE
+        );
+
+        ui64 lineCount = 0;
+        ChunkLineOffsets.reserve(Chunks.size() + 1);
+        for (auto chunkLineCount : chunkLineCounts) {
+            ChunkLineOffsets.push_back((ui32)lineCount);
+            lineCount += chunkLineCount;
+            CB_ENSURE(
+                lineCount <= Max<ui32>(), "CatBoost does not support datasets with more than "
+                << Max<ui32>() << " objects"
+            );
+        }
+        ChunkLineOffsets.push_back((ui32)lineCount);
+    }
+
+    void TCBDsvMappedDataLoader::Do(IRawObjectsOrderDataVisitor* visitor) {
+        const ui32 objectCount = GetObjectCount();
+        visitor->Start(false, DataMetaInfo, objectCount, Args.ObjectsOrder, {});
+        visitor->StartNextBlock(objectCount);
+        ParseChunks(0, Chunks.size(), visitor);
+        SetGroupWeights(Args.GroupWeightsFilePath, objectCount, visitor);
+        SetPairs(Args.PairsFilePath, objectCount, visitor);
+        visitor->Finish();
+    }
+
+    bool TCBDsvMappedDataLoader::DoBlock(IRawObjectsOrderDataVisitor* visitor) {
+        CB_ENSURE(!Args.PairsFilePath.Inited(),
+                  "TCBDsvMappedDataLoader::DoBlock does not support pairs data");
+        CB_ENSURE(!Args.GroupWeightsFilePath.Inited(),
+                  "TCBDsvMappedDataLoader::DoBlock does not support group weights data");
+
+        if (NextChunk == Chunks.size()) {
+            return false;
+        }
+        // one chunk per thread
+        const size_t chunkEnd = Min(NextChunk + Args.LocalExecutor->GetThreadCount() + 1, Chunks.size());
+        const ui32 objectCount = ChunkLineOffsets[chunkEnd] - ChunkLineOffsets[NextChunk];
+        visitor->Start(true, DataMetaInfo, objectCount, Args.ObjectsOrder, {});
+        visitor->StartNextBlock(objectCount);
+        ParseChunks(NextChunk, chunkEnd, visitor);
+        visitor->Finish();
+        NextChunk = chunkEnd;
+        return true;
+    }
+
+    void TCBDsvMappedDataLoader::ParseChunks(
+        size_t chunkBegin,
+        size_t chunkEnd,
+        IRawObjectsOrderDataVisitor* visitor
+    ) {
+        const auto& columnsDescription = DataMetaInfo.ColumnsInfo->Columns;
+        const auto& featuresLayout = *DataMetaInfo.FeaturesLayout;
+        const ui32 blockLineOffset = ChunkLineOffsets[chunkBegin];
+
+        Args.LocalExecutor->ExecRangeWithThrow(
+            [&] (int chunkIdx) {
+                TVector<float> floatFeatures;
+                TVector<ui32> catFeatures;
+                TStringBuf chunk = Chunks[chunkIdx];
+                for (ui32 lineIdx = ChunkLineOffsets[chunkIdx]; !chunk.empty(); ++lineIdx) {
+                    try {
+                        ParseDsvLine(
+                            NextLine(&chunk),
+                            lineIdx - blockLineOffset,
+                            Args.PoolFormat.Delimiter,
+                            columnsDescription,
+                            featuresLayout,
+                            FeatureIgnored,
+                            visitor,
+                            &floatFeatures,
+                            &catFeatures
+                        );
+                    } catch (yexception& e) {
+                        throw TCatBoostException() << "Error in dsv data. Line " << lineIdx + 1 << ": " << e.what();
+                    }
+                }
+            },
+            SafeIntegerCast<int>(chunkBegin),
+            SafeIntegerCast<int>(chunkEnd),
+            NPar::TLocalExecutor::WAIT_COMPLETE
+        );
+    }
+
+
     namespace {
         TDatasetLoaderFactory::TRegistrator<TCBDsvDataLoader> DefDataLoaderReg("");
         TDatasetLoaderFactory::TRegistrator<TCBDsvDataLoader> CBDsvDataLoaderReg("dsv");
+        TDatasetLoaderFactory::TRegistrator<TCBDsvMappedDataLoader> CBDsvMappedDataLoaderReg("mmap-dsv");
     }
 }
 
@@ -10,6 +10,7 @@
 #include <util/generic/string.h>
 #include <util/generic/vector.h>
 #include <util/generic/ylimits.h>
+#include <util/memory/blob.h>
 #include <util/system/types.h>
 
 
@@ -73,4 +74,34 @@ namespace NCB {
         THolder<NCB::ILineDataReader> LineDataReader;
     };
 
+
+    /* Loads dsv pool from memory-mapped file (scheme "mmap-dsv").
+     * Data is split into newline-aligned byte ranges, lines of different ranges are counted and parsed
+     * in parallel directly into visitor without copying them to intermediate strings.
+     */
+    class TCBDsvMappedDataLoader : public IRawObjectsOrderDatasetLoader {
+    public:
+        explicit TCBDsvMappedDataLoader(TDatasetLoaderPullArgs&& args);
+
+        void Do(IRawObjectsOrderDataVisitor* visitor) override;
+
+        bool DoBlock(IRawObjectsOrderDataVisitor* visitor) override;
+
+        ui32 GetObjectCount() const {
+            return ChunkLineOffsets.back();
+        }
+
+    private:
+        void ParseChunks(size_t chunkBegin, size_t chunkEnd, IRawObjectsOrderDataVisitor* visitor);
+
+    private:
+        TDatasetLoaderCommonArgs Args;
+        TBlob Data;
+        TVector<TStringBuf> Chunks; // newline-aligned parts of data w/o header
+        TVector<ui32> ChunkLineOffsets; // index of first line in chunk, last element is line count
+        size_t NextChunk = 0; // for DoBlock
+        TDataMetaInfo DataMetaInfo;
+        TVector<bool> FeatureIgnored;
+    };
+
 }
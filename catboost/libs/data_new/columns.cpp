@@ -1 +1,56 @@
 #include "columns.h"
+
+#include <util/generic/xrange.h>
+
+
+namespace NCB {
+
+    THolder<IQuantizedFloatValuesHolder> TPackedFloatValuesHolder::CloneWithNewSubsetIndexing(
+        const TFeaturesArraySubsetIndexing* subsetIndexing
+    ) const {
+        return MakeHolder<TPackedFloatValuesHolder>(GetId(), SrcPacks, BitOffset, BitCount, subsetIndexing);
+    }
+
+    TMaybeOwningArrayHolder<ui8> TPackedFloatValuesHolder::ExtractValues(
+        NPar::TLocalExecutor* localExecutor
+    ) const {
+        TVector<ui8> result;
+        result.yresize(GetSize());
+
+        const TFeaturesPack* srcPacks = (*SrcPacks).data();
+        TConstPtrArraySubset<TFeaturesPack>(&srcPacks, SubsetIndexing).ParallelForEach(
+            [&] (ui32 idx, TFeaturesPack pack) {
+                result[idx] = GetBin(pack);
+            },
+            localExecutor
+        );
+
+        return TMaybeOwningArrayHolder<ui8>::CreateOwning(std::move(result));
+    }
+
+
+    TVector<ui8> TSparseFloatValues::ExtractSrcBins() const {
+        TVector<ui8> srcBins(SrcSize, DefaultBin);
+        for (auto i : xrange(NonDefaultSrcIndices.size())) {
+            srcBins[NonDefaultSrcIndices[i]] = NonDefaultBins[i];
+        }
+        return srcBins;
+    }
+
+
+    THolder<IQuantizedFloatValuesHolder> TSparseFloatValuesHolder::CloneWithNewSubsetIndexing(
+        const TFeaturesArraySubsetIndexing* subsetIndexing
+    ) const {
+        return MakeHolder<TSparseFloatValuesHolder>(GetId(), SrcValues, subsetIndexing);
+    }
+
+    TMaybeOwningArrayHolder<ui8> TSparseFloatValuesHolder::ExtractValues(
+        NPar::TLocalExecutor* localExecutor
+    ) const {
+        const TVector<ui8> srcBins = SrcValues->ExtractSrcBins();
+        return TMaybeOwningArrayHolder<ui8>::CreateOwning(
+            GetSubset<ui8>(srcBins, *SubsetIndexing, localExecutor)
+        );
+    }
+
+}
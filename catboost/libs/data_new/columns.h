@@ -10,12 +10,14 @@
 
 #include <util/system/types.h>
 #include <util/generic/noncopyable.h>
+#include <util/generic/ptr.h>
 #include <util/generic/string.h>
 #include <util/generic/vector.h>
 #include <util/generic/yexception.h>
 #include <util/stream/buffer.h>
 #include <util/system/yassert.h>
 
+#include <climits>
 #include <cmath>
 #include <type_traits>
 
@@ -220,6 +222,108 @@ namespace NCB {
     using TQuantizedFloatValuesHolder = TCompressedValuesHolderImpl<IQuantizedFloatValuesHolder>;
 
 
+    /* Float feature with a few bins stored in bits [BitOffset, BitOffset + BitCount) of packs
+     * shared with other such features, used on CPU instead of TQuantizedFloatValuesHolder
+     */
+    class TPackedFloatValuesHolder: public IQuantizedFloatValuesHolder {
+    public:
+        using TFeaturesPack = ui8;
+    public:
+        TPackedFloatValuesHolder(ui32 featureId,
+                                 TMaybeOwningConstArrayHolder<TFeaturesPack> srcPacks,
+                                 ui32 bitOffset,
+                                 ui32 bitCount,
+                                 const TFeaturesArraySubsetIndexing* subsetIndexing)
+            : IQuantizedFloatValuesHolder(featureId, subsetIndexing->Size())
+            , SrcPacks(std::move(srcPacks))
+            , BitOffset(bitOffset)
+            , BitCount(bitCount)
+            , SubsetIndexing(subsetIndexing)
+        {
+            CB_ENSURE(SubsetIndexing, "subsetIndexing is empty");
+            CB_ENSURE_INTERNAL(
+                BitOffset + BitCount <= sizeof(TFeaturesPack) * CHAR_BIT,
+                "Feature bits are out of pack"
+            );
+        }
+
+        THolder<IQuantizedFloatValuesHolder> CloneWithNewSubsetIndexing(
+            const TFeaturesArraySubsetIndexing* subsetIndexing
+        ) const override;
+
+        TMaybeOwningArrayHolder<ui8> ExtractValues(NPar::TLocalExecutor* localExecutor) const override;
+
+        // packs are without subset indexing, they are shared with other features of the pack
+        const TMaybeOwningConstArrayHolder<TFeaturesPack>& GetSrcPacks() const {
+            return SrcPacks;
+        }
+
+        ui32 GetBitOffset() const {
+            return BitOffset;
+        }
+
+        ui32 GetBitCount() const {
+            return BitCount;
+        }
+
+        ui8 GetBin(TFeaturesPack pack) const {
+            return (pack >> BitOffset) & ((1u << BitCount) - 1);
+        }
+
+    private:
+        TMaybeOwningConstArrayHolder<TFeaturesPack> SrcPacks;
+        ui32 BitOffset;
+        ui32 BitCount;
+        const TFeaturesArraySubsetIndexing* SubsetIndexing;
+    };
+
+
+    // bins of float feature with most of objects in the default bin
+    struct TSparseFloatValues {
+        ui32 SrcSize = 0;
+        ui8 DefaultBin = 0;
+        // indices in data without subset indexing, sorted
+        TVector<ui32> NonDefaultSrcIndices;
+        TVector<ui8> NonDefaultBins;
+
+    public:
+        // bins of all objects of data without subset indexing
+        TVector<ui8> ExtractSrcBins() const;
+    };
+
+    /* Float feature with only non-default bins stored, used on CPU instead of TQuantizedFloatValuesHolder
+     * for features with most of objects in the default bin
+     */
+    class TSparseFloatValuesHolder: public IQuantizedFloatValuesHolder {
+    public:
+        TSparseFloatValuesHolder(ui32 featureId,
+                                 TAtomicSharedPtr<const TSparseFloatValues> srcValues,
+                                 const TFeaturesArraySubsetIndexing* subsetIndexing)
+            : IQuantizedFloatValuesHolder(featureId, subsetIndexing->Size())
+            , SrcValues(std::move(srcValues))
+            , SubsetIndexing(subsetIndexing)
+        {
+            CB_ENSURE(SubsetIndexing, "subsetIndexing is empty");
+            CB_ENSURE_INTERNAL(SrcValues, "srcValues is empty");
+        }
+
+        THolder<IQuantizedFloatValuesHolder> CloneWithNewSubsetIndexing(
+            const TFeaturesArraySubsetIndexing* subsetIndexing
+        ) const override;
+
+        TMaybeOwningArrayHolder<ui8> ExtractValues(NPar::TLocalExecutor* localExecutor) const override;
+
+        // values are without subset indexing, they are shared with subsets
+        const TSparseFloatValues& GetSrcValues() const {
+            return *SrcValues;
+        }
+
+    private:
+        TAtomicSharedPtr<const TSparseFloatValues> SrcValues;
+        const TFeaturesArraySubsetIndexing* SubsetIndexing;
+    };
+
+
     /* interface instead of concrete TQuantizedFloatValuesHolder because there is
      * an alternative implementation TExternalFloatValuesHolder for GPU
      */
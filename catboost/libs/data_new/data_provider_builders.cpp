@@ -849,6 +849,14 @@ namespace NCB {
             CB_ENSURE(false, "Categorical features are not yet supported in serialized quantized pools");
         }
 
+        void AddFloatFeature(ui32 flatFeatureIdx, TMaybeOwningConstArrayHolder<ui8> features) override {
+            CheckDataSize((*features).size(), (size_t)ObjectCount, "float feature");
+            FloatFeaturesStorage.SetInPlace(
+                GetInternalFeatureIdx<EFeatureType::Float>(flatFeatureIdx),
+                *features
+            );
+        }
+
         // TRawTargetData
 
         void AddTargetPart(ui32 objectOffset, TUnalignedArrayBuf<float> targetPart) override {
@@ -1008,12 +1016,16 @@ namespace NCB {
 
             TVector<TIndexHelper<ui64>> IndexHelpers; // [perTypeFeatureIdx]
 
+            ui32 ObjectCount = 0;
+
         public:
             void PrepareForInitialization(
                 const TFeaturesLayout& featuresLayout,
                 ui32 objectCount,
                 const TPoolQuantizationSchema& quantizationSchema
             ) {
+                ObjectCount = objectCount;
+
                 const size_t perTypeFeatureCount = (size_t)featuresLayout.GetFeatureCount(FeatureType);
                 Storage.resize(perTypeFeatureCount);
                 DstView.resize(perTypeFeatureCount);
@@ -1052,17 +1064,8 @@ namespace NCB {
                             << " has no data in quantized pool"
                         );
 
-                        auto& maybeSharedStoragePtr = Storage[perTypeFeatureIdx];
-                        if (!maybeSharedStoragePtr || (maybeSharedStoragePtr->RefCount() > 1)) {
-                            /* storage is either uninited or shared with some other references
-                             * so it has to be reset to be reused
-                             */
-                            Storage[perTypeFeatureIdx] = MakeIntrusive<TVectorHolder<ui64>>();
-                        }
-                        maybeSharedStoragePtr->Data.yresize(
-                            IndexHelpers[perTypeFeatureIdx].CompressedSize(objectCount)
-                        );
-                        DstView[perTypeFeatureIdx] =  maybeSharedStoragePtr->Data;
+                        // storage is allocated at first Set call, it is not needed if data is used in place
+                        DstView[perTypeFeatureIdx] = TArrayRef<ui64>();
                     } else {
                         Storage[perTypeFeatureIdx] = nullptr;
                         DstView[perTypeFeatureIdx] = TArrayRef<ui64>();
@@ -1076,6 +1079,7 @@ namespace NCB {
                 TConstArrayRef<ui8> featuresPart
             ) {
                 if (IsAvailable[*perTypeFeatureIdx]) {
+                    AllocateIfNeeded(*perTypeFeatureIdx);
                     memcpy(
                         ((ui8*)DstView[*perTypeFeatureIdx].data()) + objectOffset,
                         featuresPart.data(),
@@ -1084,6 +1088,24 @@ namespace NCB {
                 }
             }
 
+            void SetInPlace(TFeatureIdx<FeatureType> perTypeFeatureIdx, TConstArrayRef<ui8> features) {
+                if (IsAvailable[*perTypeFeatureIdx]) {
+                    CB_ENSURE_INTERNAL(
+                        IndexHelpers[*perTypeFeatureIdx].GetBitsPerKey() == 8,
+                        "In place feature data is supported only for 8 bits per key"
+                    );
+                    CB_ENSURE_INTERNAL(
+                        reinterpret_cast<uintptr_t>(features.data()) % alignof(ui64) == 0,
+                        "In place feature data is not aligned"
+                    );
+                    Storage[*perTypeFeatureIdx] = nullptr;
+                    DstView[*perTypeFeatureIdx] = TArrayRef<ui64>(
+                        (ui64*)features.data(),
+                        IndexHelpers[*perTypeFeatureIdx].CompressedSize(ObjectCount)
+                    );
+                }
+            }
+
             template <class IColumnType>
             void GetResult(
                 ui32 objectCount,
@@ -1104,6 +1126,7 @@ namespace NCB {
                 result->reserve(featureCount);
                 for (auto perTypeFeatureIdx : xrange(featureCount)) {
                     if (IsAvailable[perTypeFeatureIdx]) {
+                        AllocateIfNeeded(perTypeFeatureIdx);
                         result->push_back(
                             MakeHolder<TCompressedValuesHolderImpl<IColumnType>>(
                                 /* featureId */ featuresLayout.GetExternalFeatureIdx(
@@ -1125,6 +1148,24 @@ namespace NCB {
                     }
                 }
             }
+
+        private:
+            void AllocateIfNeeded(ui32 perTypeFeatureIdx) {
+                if (DstView[perTypeFeatureIdx].data()) {
+                    return;
+                }
+                auto& maybeSharedStoragePtr = Storage[perTypeFeatureIdx];
+                if (!maybeSharedStoragePtr || (maybeSharedStoragePtr->RefCount() > 1)) {
+                    /* storage is either uninited or shared with some other references
+                     * so it has to be reset to be reused
+                     */
+                    maybeSharedStoragePtr = MakeIntrusive<TVectorHolder<ui64>>();
+                }
+                maybeSharedStoragePtr->Data.yresize(
+                    IndexHelpers[perTypeFeatureIdx].CompressedSize(ObjectCount)
+                );
+                DstView[perTypeFeatureIdx] = maybeSharedStoragePtr->Data;
+            }
         };
 
     private:
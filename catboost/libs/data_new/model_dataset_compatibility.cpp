@@ -80,12 +80,6 @@ namespace NCB {
         const TObjectsDataProvider& objectsData,
         THashMap<ui32, ui32>* columnIndexesReorderMap)
     {
-        // TODO(akhropov): Quantized datasets support. MLTOOLS-2582.
-        CB_ENSURE(
-            dynamic_cast<const TRawObjectsDataProvider*>(&objectsData),
-            "Non-raw pools are incompatible with models"
-        );
-
         const auto& datasetFeaturesLayout = *objectsData.GetFeaturesLayout();
 
         const auto datasetCatFeatureInternalIdxToExternalIdx =
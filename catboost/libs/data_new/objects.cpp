@@ -9,6 +9,7 @@
 
 #include <util/generic/algorithm.h>
 #include <util/generic/cast.h>
+#include <util/generic/hash.h>
 #include <util/stream/format.h>
 
 #include <algorithm>
@@ -860,6 +861,295 @@ NCB::TQuantizedForCPUObjectsDataProvider::TQuantizedForCPUObjectsDataProvider(
         CatFeatureUniqueValuesCounts[catFeatureIdx] =
             Data.QuantizedFeaturesInfo->GetUniqueValuesCounts(TCatFeatureIdx(catFeatureIdx));
     }
+
+    // executor is not passed for subsets, their features are already packed
+    NPar::TLocalExecutor serialExecutor;
+    MakeSparseFloatFeatures(localExecutor.GetOrElse(&serialExecutor));
+    PackFloatFeatures(localExecutor.GetOrElse(&serialExecutor));
+}
+
+
+TMaybeOwningConstArrayHolder<ui8> NCB::TQuantizedForCPUObjectsDataProvider::GetFloatFeatureSrcBins(
+    ui32 floatFeatureIdx
+) const {
+    if (const auto* sparseValues = FloatFeaturesSparseValues[floatFeatureIdx]) {
+        return TMaybeOwningConstArrayHolder<ui8>::CreateOwning(sparseValues->ExtractSrcBins());
+    }
+
+    const auto& packedIndex = FloatFeaturesPackedIndices[floatFeatureIdx];
+    if (!packedIndex) {
+        const auto& feature = static_cast<const TQuantizedFloatValuesHolder&>(*Data.FloatFeatures[floatFeatureIdx]);
+        return TMaybeOwningConstArrayHolder<ui8>::CreateNonOwning(
+            MakeArrayRef(GetFloatFeatureRawSrcData(floatFeatureIdx), feature.GetCompressedData().GetSrc()->GetSize())
+        );
+    }
+
+    const TConstArrayRef<TFeaturesPack> srcPacks = *FeaturesPacks[packedIndex->PackIdx];
+    const ui32 bitOffset = packedIndex->BitOffset;
+    const ui32 mask = (1u << packedIndex->BitCount) - 1;
+    TVector<ui8> srcBins;
+    srcBins.yresize(srcPacks.size());
+    for (auto srcIdx : xrange(srcPacks.size())) {
+        srcBins[srcIdx] = (srcPacks[srcIdx] >> bitOffset) & mask;
+    }
+    return TMaybeOwningConstArrayHolder<ui8>::CreateOwning(std::move(srcBins));
+}
+
+
+const ui8* NCB::TQuantizedForCPUObjectsDataProvider::GetSparseFloatFeatureDecodedSrcBins(
+    ui32 floatFeatureIdx
+) const {
+    TGuard<TAdaptiveLock> guard(SparseFloatFeaturesDecodedSrcBinsLock);
+    auto& srcBins = SparseFloatFeaturesDecodedSrcBins[floatFeatureIdx];
+    if (!srcBins) {
+        srcBins = MakeHolder<TVector<ui8>>(FloatFeaturesSparseValues[floatFeatureIdx]->ExtractSrcBins());
+    }
+    return srcBins->data();
+}
+
+
+static TSparseFloatValues MakeSparseFloatValues(TConstArrayRef<ui8> srcBins, ui8 defaultBin, ui64 nonDefaultCount) {
+    TSparseFloatValues sparseValues;
+    sparseValues.SrcSize = SafeIntegerCast<ui32>(srcBins.size());
+    sparseValues.DefaultBin = defaultBin;
+    sparseValues.NonDefaultSrcIndices.reserve(nonDefaultCount);
+    sparseValues.NonDefaultBins.reserve(nonDefaultCount);
+    for (auto srcIdx : xrange(srcBins.size())) {
+        if (srcBins[srcIdx] != defaultBin) {
+            sparseValues.NonDefaultSrcIndices.push_back(srcIdx);
+            sparseValues.NonDefaultBins.push_back(srcBins[srcIdx]);
+        }
+    }
+    return sparseValues;
+}
+
+
+void NCB::TQuantizedForCPUObjectsDataProvider::MakeSparseFloatFeatures(NPar::TLocalExecutor* localExecutor) {
+    FloatFeaturesSparseValues.assign(Data.FloatFeatures.size(), nullptr);
+    SparseFloatFeaturesDecodedSrcBins.clear();
+    SparseFloatFeaturesDecodedSrcBins.resize(Data.FloatFeatures.size());
+
+    NPar::ParallelFor(
+        *localExecutor,
+        0,
+        SafeIntegerCast<ui32>(Data.FloatFeatures.size()),
+        [&] (ui32 floatFeatureIdx) {
+            // features of subsets and of consecutive data are already sparse, their values are shared
+            const auto* sparseFeature = dynamic_cast<const TSparseFloatValuesHolder*>(
+                Data.FloatFeatures[floatFeatureIdx].Get()
+            );
+            if (sparseFeature) {
+                FloatFeaturesSparseValues[floatFeatureIdx] = &sparseFeature->GetSrcValues();
+                return;
+            }
+
+            // packed features are not sparse
+            const auto* feature = dynamic_cast<const TQuantizedFloatValuesHolder*>(
+                Data.FloatFeatures[floatFeatureIdx].Get()
+            );
+            if (!feature) {
+                return;
+            }
+            const ui64 srcSize = feature->GetCompressedData().GetSrc()->GetSize();
+            const TConstArrayRef<ui8> srcBins(*(feature->GetArrayData().GetSrc()), srcSize);
+
+            TVector<ui64> binCounts(1 << CHAR_BIT, 0);
+            for (auto bin : srcBins) {
+                ++binCounts[bin];
+            }
+            const ui8 defaultBin = MaxElement(binCounts.begin(), binCounts.end()) - binCounts.begin();
+            const ui64 nonDefaultCount = srcSize - binCounts[defaultBin];
+            if (nonDefaultCount > MaxSparseFeatureNonDefaultShare * srcSize) {
+                return;
+            }
+
+            // array of ui8 is dropped
+            auto sparseValues = MakeAtomicShared<TSparseFloatValues>(
+                MakeSparseFloatValues(srcBins, defaultBin, nonDefaultCount)
+            );
+            FloatFeaturesSparseValues[floatFeatureIdx] = sparseValues.Get();
+            Data.FloatFeatures[floatFeatureIdx] = MakeHolder<TSparseFloatValuesHolder>(
+                feature->GetId(),
+                std::move(sparseValues),
+                CommonData.SubsetIndexing.Get()
+            );
+        }
+    );
+}
+
+
+void NCB::TQuantizedForCPUObjectsDataProvider::PackFloatFeatures(NPar::TLocalExecutor* localExecutor) {
+    constexpr ui32 packBitCount = sizeof(TFeaturesPack) * CHAR_BIT;
+
+    FeaturesPacks.clear();
+    FloatFeaturesPackedIndices.assign(Data.FloatFeatures.size(), Nothing());
+
+    // features of subsets and of consecutive data are already packed, their packs are shared
+    THashMap<const TFeaturesPack*, ui32> packIndices; // src packs data -> packIdx
+    TVector<TVector<ui32>> packedFeatures; // [new packIdx]
+    ui32 usedBitCount = packBitCount;
+    for (auto floatFeatureIdx : xrange(Data.FloatFeatures.size())) {
+        const TFloatFeatureIdx typedFloatFeatureIdx(floatFeatureIdx);
+        if (!Data.FloatFeatures[floatFeatureIdx]) {
+            continue;
+        }
+        const auto* packedFeature = dynamic_cast<const TPackedFloatValuesHolder*>(
+            Data.FloatFeatures[floatFeatureIdx].Get()
+        );
+        if (packedFeature) {
+            const auto& srcPacks = packedFeature->GetSrcPacks();
+            const auto [packIt, isNewPack] = packIndices.emplace((*srcPacks).data(), FeaturesPacks.size());
+            if (isNewPack) {
+                FeaturesPacks.push_back(srcPacks);
+            }
+            FloatFeaturesPackedIndices[floatFeatureIdx] =
+                TPackedFeatureIndex{packIt->second, packedFeature->GetBitOffset(), packedFeature->GetBitCount()};
+            continue;
+        }
+        if (!Data.QuantizedFeaturesInfo->HasBorders(typedFloatFeatureIdx)
+            || FloatFeaturesSparseValues[floatFeatureIdx])
+        {
+            continue;
+        }
+        // bins are in [0, borderCount]
+        const ui32 borderCount = Data.QuantizedFeaturesInfo->GetBorders(typedFloatFeatureIdx).size();
+        ui32 bitCount = 1;
+        while ((1u << bitCount) <= borderCount) {
+            bitCount *= 2;
+        }
+        if (bitCount > MaxPackedFeatureBitCount) {
+            continue;
+        }
+        if (usedBitCount + bitCount > packBitCount) {
+            packedFeatures.emplace_back();
+            usedBitCount = 0;
+        }
+        // PackIdx is set below
+        FloatFeaturesPackedIndices[floatFeatureIdx] = TPackedFeatureIndex{0, usedBitCount, bitCount};
+        packedFeatures.back().push_back(floatFeatureIdx);
+        usedBitCount += bitCount;
+    }
+
+    // pack with a single feature does not save anything
+    EraseIf(
+        packedFeatures,
+        [&] (const TVector<ui32>& featureIndices) {
+            if (featureIndices.size() < 2) {
+                for (auto floatFeatureIdx : featureIndices) {
+                    FloatFeaturesPackedIndices[floatFeatureIdx] = Nothing();
+                }
+                return true;
+            }
+            return false;
+        }
+    );
+
+    for (const auto& featureIndices : packedFeatures) {
+        const ui32 packIdx = FeaturesPacks.size();
+        const ui64 srcSize = static_cast<const TQuantizedFloatValuesHolder&>(*Data.FloatFeatures[featureIndices[0]])
+            .GetCompressedData().GetSrc()->GetSize();
+        TVector<const ui8*> featuresSrcData;
+        TVector<ui32> bitOffsets;
+        for (auto floatFeatureIdx : featureIndices) {
+            const auto& feature = static_cast<const TQuantizedFloatValuesHolder&>(*Data.FloatFeatures[floatFeatureIdx]);
+            CB_ENSURE_INTERNAL(
+                feature.GetCompressedData().GetSrc()->GetSize() == srcSize,
+                "Float features have different source data sizes"
+            );
+            featuresSrcData.push_back(*(feature.GetArrayData().GetSrc()));
+            bitOffsets.push_back(FloatFeaturesPackedIndices[floatFeatureIdx]->BitOffset);
+            FloatFeaturesPackedIndices[floatFeatureIdx]->PackIdx = packIdx;
+        }
+
+        TVector<TFeaturesPack> pack;
+        pack.yresize(srcSize);
+        NPar::ParallelFor(
+            *localExecutor,
+            0,
+            SafeIntegerCast<ui32>(srcSize),
+            [&] (ui32 srcIdx) {
+                TFeaturesPack packValue = 0;
+                for (auto i : xrange(featuresSrcData.size())) {
+                    packValue |= featuresSrcData[i][srcIdx] << bitOffsets[i];
+                }
+                pack[srcIdx] = packValue;
+            }
+        );
+        FeaturesPacks.push_back(TMaybeOwningConstArrayHolder<TFeaturesPack>::CreateOwning(std::move(pack)));
+
+        // arrays of ui8 are dropped, packs hold all data of these features
+        for (auto floatFeatureIdx : featureIndices) {
+            const auto& packedIndex = *FloatFeaturesPackedIndices[floatFeatureIdx];
+            Data.FloatFeatures[floatFeatureIdx] = MakeHolder<TPackedFloatValuesHolder>(
+                Data.FloatFeatures[floatFeatureIdx]->GetId(),
+                FeaturesPacks.back(),
+                packedIndex.BitOffset,
+                packedIndex.BitCount,
+                CommonData.SubsetIndexing.Get()
+            );
+        }
+    }
+}
+
+
+void NCB::TQuantizedForCPUObjectsDataProvider::MakeConsecutiveSparseFloatFeatures(
+    const TFeaturesArraySubsetIndexing* newSubsetIndexing,
+    NPar::TLocalExecutor* localExecutor
+) {
+    for (auto floatFeatureIdx : xrange(Data.FloatFeatures.size())) {
+        const auto* sparseValues = FloatFeaturesSparseValues[floatFeatureIdx];
+        if (!sparseValues) {
+            continue;
+        }
+        const auto& feature = *Data.FloatFeatures[floatFeatureIdx];
+        const auto bins = feature.ExtractValues(localExecutor);
+        const ui64 nonDefaultCount = CountIf(*bins, [&] (ui8 bin) { return bin != sparseValues->DefaultBin; });
+        FloatFeaturesSparseValues[floatFeatureIdx] = nullptr;
+        Data.FloatFeatures[floatFeatureIdx] = MakeHolder<TSparseFloatValuesHolder>(
+            feature.GetId(),
+            MakeAtomicShared<TSparseFloatValues>(
+                MakeSparseFloatValues(*bins, sparseValues->DefaultBin, nonDefaultCount)
+            ),
+            newSubsetIndexing
+        );
+    }
+}
+
+
+void NCB::TQuantizedForCPUObjectsDataProvider::MakeConsecutiveFeaturesPacks(
+    const TFeaturesArraySubsetIndexing* newSubsetIndexing,
+    NPar::TLocalExecutor* localExecutor
+) {
+    const auto& subsetIndexing = GetFeaturesArraySubsetIndexing();
+
+    TVector<TMaybeOwningConstArrayHolder<TFeaturesPack>> consecutivePacks;
+    for (const auto& srcPacks : FeaturesPacks) {
+        TVector<TFeaturesPack> packs;
+        packs.yresize(GetObjectCount());
+        const TFeaturesPack* srcPacksData = (*srcPacks).data();
+        TConstPtrArraySubset<TFeaturesPack>(&srcPacksData, &subsetIndexing).ParallelForEach(
+            [&] (ui32 idx, TFeaturesPack pack) {
+                packs[idx] = pack;
+            },
+            localExecutor
+        );
+        consecutivePacks.push_back(TMaybeOwningConstArrayHolder<TFeaturesPack>::CreateOwning(std::move(packs)));
+    }
+
+    for (auto floatFeatureIdx : xrange(Data.FloatFeatures.size())) {
+        const auto& packedIndex = FloatFeaturesPackedIndices[floatFeatureIdx];
+        if (!packedIndex) {
+            continue;
+        }
+        Data.FloatFeatures[floatFeatureIdx] = MakeHolder<TPackedFloatValuesHolder>(
+            Data.FloatFeatures[floatFeatureIdx]->GetId(),
+            consecutivePacks[packedIndex->PackIdx],
+            packedIndex->BitOffset,
+            packedIndex->BitCount,
+            newSubsetIndexing
+        );
+    }
+    FeaturesPacks = std::move(consecutivePacks);
 }
 
 
@@ -888,6 +1178,11 @@ static void MakeConsecutiveArrayFeatures(
 
     featuresLayout.IterateOverAvailableFeatures<FeatureType>(
         [&] (TFeatureIdx<FeatureType> featureIdx) {
+            // features stored otherwise (packed) are made consecutive by the data provider
+            if (!dynamic_cast<const TCompressedValuesHolderImpl<IColumnType>*>(src[*featureIdx].Get())) {
+                Y_ASSERT(&src == dst);
+                return;
+            }
             tasks.emplace_back(
                 [&, featureIdx]() {
                     auto& srcCompressedValuesHolder = dynamic_cast<TCompressedValuesHolderImpl<IColumnType>&>(
@@ -941,6 +1236,8 @@ void NCB::TQuantizedForCPUObjectsDataProvider::EnsureConsecutiveFeaturesData(
         localExecutor,
         &Data.FloatFeatures
     );
+    MakeConsecutiveFeaturesPacks(newSubsetIndexing.Get(), localExecutor);
+    MakeConsecutiveSparseFloatFeatures(newSubsetIndexing.Get(), localExecutor);
     MakeConsecutiveArrayFeatures<EFeatureType::Categorical>(
         *GetFeaturesLayout(),
         GetObjectCount(),
@@ -951,10 +1248,13 @@ void NCB::TQuantizedForCPUObjectsDataProvider::EnsureConsecutiveFeaturesData(
     );
 
     CommonData.SubsetIndexing = std::move(newSubsetIndexing);
+
+    MakeSparseFloatFeatures(localExecutor);
+    PackFloatFeatures(localExecutor);
 }
 
 
-template <class TRequiredFeatureColumn, class TRawArrayType, class TBaseFeatureColumn>
+template <class TRequiredFeatureColumn, class TRawArrayType, class... TAllowedFeatureColumns, class TBaseFeatureColumn>
 static void CheckIsRequiredType(
     EFeatureType featureType,
     // not TConstArrayRef to allow template parameter deduction
@@ -966,6 +1266,9 @@ static void CheckIsRequiredType(
         if (!dataPtr) {
             continue;
         }
+        if ((dynamic_cast<TAllowedFeatureColumns*>(dataPtr) || ...)) {
+            continue;
+        }
 
         auto requiredTypePtr = dynamic_cast<TRequiredFeatureColumn*>(dataPtr);
         CB_ENSURE_INTERNAL(
@@ -980,10 +1283,10 @@ static void CheckIsRequiredType(
 
 void NCB::TQuantizedForCPUObjectsDataProvider::Check() const {
     try {
-        CheckIsRequiredType<TQuantizedFloatValuesHolder, ui8>(
+        CheckIsRequiredType<TQuantizedFloatValuesHolder, ui8, TPackedFloatValuesHolder, TSparseFloatValuesHolder>(
             EFeatureType::Float,
             Data.FloatFeatures,
-            "TQuantizedFloatValuesHolder"
+            "TQuantizedFloatValuesHolder, TPackedFloatValuesHolder or TSparseFloatValuesHolder"
         );
         CheckIsRequiredType<TQuantizedCatValuesHolder, ui32>(
             EFeatureType::Categorical,
@@ -27,6 +27,7 @@
 #include <util/generic/string.h>
 #include <util/generic/vector.h>
 #include <util/generic/xrange.h>
+#include <util/system/spinlock.h>
 #include <util/system/types.h>
 
 
@@ -453,24 +454,28 @@ namespace NCB {
             return *CommonData.SubsetIndexing;
         }
 
-        /* overrides base class implementation with more restricted type
-         * (more efficient for CPU score calculation)
-         * features guaranteed to be stored as an array of ui8
+        /* float features are stored as arrays of ui8 (TQuantizedFloatValuesHolder)
+         * except packed features that are stored only in packs (TPackedFloatValuesHolder)
+         * and sparse features that are stored only as non-default bins (TSparseFloatValuesHolder)
          */
-        TMaybeData<const TQuantizedFloatValuesHolder*> GetFloatFeature(ui32 floatFeatureIdx) const {
-            return MakeMaybeData(
-                // already checked in ctor that this cast is safe
-                static_cast<const TQuantizedFloatValuesHolder*>(
-                    Data.FloatFeatures[floatFeatureIdx].Get()
-                )
-            );
-        }
 
         // low-level function, data is without subset indexing, apply external subset indexing!
+        // nullptr if feature is not stored as an array of ui8
         const ui8* GetFloatFeatureRawSrcData(ui32 floatFeatureIdx) const {
-            return *((*GetFloatFeature(floatFeatureIdx))->GetArrayData().GetSrc());
+            if (FloatFeaturesPackedIndices[floatFeatureIdx] || FloatFeaturesSparseValues[floatFeatureIdx]) {
+                return nullptr;
+            }
+            // already checked in ctor that this cast is safe
+            return *(static_cast<const TQuantizedFloatValuesHolder&>(*Data.FloatFeatures[floatFeatureIdx])
+                .GetArrayData().GetSrc());
         }
 
+        /* low-level function, data is without subset indexing, apply external subset indexing!
+         * bins of features that are not stored as an array of ui8 are decoded to a temporary array,
+         * use DispatchFloatFeatureSrcBins in calculations
+         */
+        TMaybeOwningConstArrayHolder<ui8> GetFloatFeatureSrcBins(ui32 floatFeatureIdx) const;
+
         /* overrides base class implementation with more restricted type
          * (more efficient for CPU score calculation)
          * features guaranteed to be stored as an array of ui32
@@ -493,13 +498,113 @@ namespace NCB {
             return CatFeatureUniqueValuesCounts[catFeatureIdx];
         }
 
+        /* Float features with at most MaxPackedFeatureBitCount bits per bin are stored packed,
+         * several features per TFeaturesPack, so that score calculation can build histograms
+         * for all features of the pack in one pass
+         */
+        using TFeaturesPack = TPackedFloatValuesHolder::TFeaturesPack;
+
+        static constexpr ui32 MaxPackedFeatureBitCount = 4;
+
+        struct TPackedFeatureIndex {
+            ui32 PackIdx = 0;
+            ui32 BitOffset = 0;
+            ui32 BitCount = 0;
+        };
+
+        ui32 GetFeaturesPackCount() const {
+            return FeaturesPacks.size();
+        }
+
+        // low-level function, data is without subset indexing, apply external subset indexing!
+        const TFeaturesPack* GetFeaturesPackRawSrcData(ui32 packIdx) const {
+            return (*FeaturesPacks[packIdx]).data();
+        }
+
+        const TMaybe<TPackedFeatureIndex>& GetFloatFeaturePackedIndex(ui32 floatFeatureIdx) const {
+            return FloatFeaturesPackedIndices[floatFeatureIdx];
+        }
+
+        // bins of a packed feature, they are read from the pack on access
+        struct TPackedFloatFeatureSrcBins {
+            const TFeaturesPack* Packs = nullptr;
+            ui32 BitOffset = 0;
+            TFeaturesPack Mask = 0;
+
+        public:
+            ui8 operator[](size_t srcIdx) const {
+                return (Packs[srcIdx] >> BitOffset) & Mask;
+            }
+        };
+
+        /* Float features with at most MaxSparseFeatureNonDefaultShare of objects outside of the most
+         * frequent (default) bin are stored only as their non-default bins, so that score
+         * calculation can accumulate histograms only for these objects.
+         * Such features are not packed.
+         */
+        static constexpr double MaxSparseFeatureNonDefaultShare = 0.03;
+
+        using TSparseFeatureValues = TSparseFloatValues;
+
+        // nullptr if feature is not sparse
+        const TSparseFeatureValues* GetFloatFeatureSparseValues(ui32 floatFeatureIdx) const {
+            return FloatFeaturesSparseValues[floatFeatureIdx];
+        }
+
+        /* low-level function, data is without subset indexing, apply external subset indexing!
+         * f is called with bins of the feature indexed by srcIdx:
+         *  TPackedFloatFeatureSrcBins for packed features,
+         *  const ui8* for other features, bins of sparse features are decoded once on the first call
+         */
+        template <class F>
+        decltype(auto) DispatchFloatFeatureSrcBins(ui32 floatFeatureIdx, F&& f) const {
+            if (const auto& packedIndex = FloatFeaturesPackedIndices[floatFeatureIdx]) {
+                TPackedFloatFeatureSrcBins srcBins;
+                srcBins.Packs = GetFeaturesPackRawSrcData(packedIndex->PackIdx);
+                srcBins.BitOffset = packedIndex->BitOffset;
+                srcBins.Mask = (TFeaturesPack(1) << packedIndex->BitCount) - 1;
+                return f(srcBins);
+            }
+            if (FloatFeaturesSparseValues[floatFeatureIdx]) {
+                return f(static_cast<const ui8*>(GetSparseFloatFeatureDecodedSrcBins(floatFeatureIdx)));
+            }
+            return f(GetFloatFeatureRawSrcData(floatFeatureIdx));
+        }
+
     private:
         // check that additional CPU-specific constraints are respected
         void Check() const;
 
+        // replaces sparse features stored as arrays of ui8 and registers values of sparse features
+        void MakeSparseFloatFeatures(NPar::TLocalExecutor* localExecutor);
+
+        // packs features stored as arrays of ui8, dropping these arrays, and registers packs of packed features
+        void PackFloatFeatures(NPar::TLocalExecutor* localExecutor);
+
+        void MakeConsecutiveFeaturesPacks(
+            const TFeaturesArraySubsetIndexing* newSubsetIndexing,
+            NPar::TLocalExecutor* localExecutor
+        );
+
+        void MakeConsecutiveSparseFloatFeatures(
+            const TFeaturesArraySubsetIndexing* newSubsetIndexing,
+            NPar::TLocalExecutor* localExecutor
+        );
+
+        const ui8* GetSparseFloatFeatureDecodedSrcBins(ui32 floatFeatureIdx) const;
+
     private:
         // store directly instead of looking up in Data.QuantizedFeaturesInfo for runtime efficiency
         TVector<TCatFeatureUniqueValuesCounts> CatFeatureUniqueValuesCounts; // [catFeatureIdx]
+
+        TVector<TMaybeOwningConstArrayHolder<TFeaturesPack>> FeaturesPacks; // [packIdx][srcObjectIdx]
+        TVector<TMaybe<TPackedFeatureIndex>> FloatFeaturesPackedIndices; // [floatFeatureIdx]
+        // point to values owned by TSparseFloatValuesHolder s in Data.FloatFeatures
+        TVector<const TSparseFeatureValues*> FloatFeaturesSparseValues; // [floatFeatureIdx]
+
+        // bins of sparse features decoded by DispatchFloatFeatureSrcBins
+        mutable TVector<THolder<TVector<ui8>>> SparseFloatFeaturesDecodedSrcBins; // [floatFeatureIdx]
+        mutable TAdaptiveLock SparseFloatFeaturesDecodedSrcBinsLock;
     };
 
 
@@ -38,17 +38,21 @@ Y_UNIT_TEST_SUITE(LoadDataFromDsv) {
         NPar::TLocalExecutor localExecutor;
         localExecutor.RunAdditionalThreads(3);
 
-        TDataProviderPtr dataProvider = ReadDataset(
-            readDatasetMainParams.PoolPath,
-            readDatasetMainParams.PairsFilePath, // can be uninited
-            readDatasetMainParams.GroupWeightsFilePath, // can be uninited
-            readDatasetMainParams.DsvPoolFormatParams,
-            testCase.SrcData.IgnoredFeatures,
-            testCase.SrcData.ObjectsOrder,
-            &localExecutor
-        );
-
-        Compare<TRawObjectsDataProvider>(std::move(dataProvider), testCase.ExpectedData);
+        for (TStringBuf scheme : {AsStringBuf("dsv"), AsStringBuf("mmap-dsv")}) {
+            readDatasetMainParams.PoolPath.Scheme = scheme;
+
+            TDataProviderPtr dataProvider = ReadDataset(
+                readDatasetMainParams.PoolPath,
+                readDatasetMainParams.PairsFilePath, // can be uninited
+                readDatasetMainParams.GroupWeightsFilePath, // can be uninited
+                readDatasetMainParams.DsvPoolFormatParams,
+                testCase.SrcData.IgnoredFeatures,
+                testCase.SrcData.ObjectsOrder,
+                &localExecutor
+            );
+
+            Compare<TRawObjectsDataProvider>(std::move(dataProvider), testCase.ExpectedData);
+        }
     }
 
 
@@ -49,6 +49,25 @@ static TTObjectsDataProvider GetMaybeSubsetDataProvider(
     return std::move(objectsDataProvider);
 }
 
+// bins read by DispatchFloatFeatureSrcBins, subset indexing of the provider is applied
+static TVector<ui8> GetDispatchedFloatFeatureBins(
+    const TQuantizedForCPUObjectsDataProvider& objectsDataProvider,
+    ui32 floatFeatureIdx
+) {
+    TVector<ui8> bins;
+    objectsDataProvider.DispatchFloatFeatureSrcBins(
+        floatFeatureIdx,
+        [&] (const auto& srcBins) {
+            objectsDataProvider.GetFeaturesArraySubsetIndexing().ForEach(
+                [&] (ui32 /*idx*/, ui32 srcIdx) {
+                    bins.push_back(srcBins[srcIdx]);
+                }
+            );
+        }
+    );
+    return bins;
+}
+
 template <class T>
 bool Equal(TMaybeData<TConstArrayRef<T>> lhs, TMaybeData<TVector<T>> rhs) {
     if (!lhs) {
@@ -860,10 +879,21 @@ Y_UNIT_TEST_SUITE(TQuantizedObjectsData) {
 
                     if (useFeatureTypes.first) {
                         for (auto i : xrange(subsetFloatFeatures.size())) {
+                            const auto srcBins = quantizedForCPUObjectsDataProvider.GetFloatFeatureSrcBins(i);
+                            const ui8* srcBinsData = (*srcBins).data();
                             UNIT_ASSERT(
                                 Equal<ui8>(
                                     subsetFloatFeatures[i],
-                                    (*quantizedForCPUObjectsDataProvider.GetFloatFeature(i))->GetArrayData()
+                                    TConstPtrArraySubset<ui8>(
+                                        &srcBinsData,
+                                        &quantizedForCPUObjectsDataProvider.GetFeaturesArraySubsetIndexing()
+                                    )
+                                )
+                            );
+                            UNIT_ASSERT(
+                                Equal<ui8>(
+                                    subsetFloatFeatures[i],
+                                    GetDispatchedFloatFeatureBins(quantizedForCPUObjectsDataProvider, i)
                                 )
                             );
                         }
@@ -1139,4 +1169,242 @@ Y_UNIT_TEST_SUITE(TQuantizedObjectsData) {
         );
 
     }
+
+    Y_UNIT_TEST(PackedFloatFeaturesForCPU) {
+        TCommonObjectsData commonData;
+        commonData.FeaturesLayout = MakeIntrusive<TFeaturesLayout>((ui32)5, TVector<ui32>{}, TVector<TString>{});
+        commonData.SubsetIndexing = MakeAtomicShared<TArraySubsetIndexing<ui32>>(
+            TIndexedSubset<ui32>{0, 4, 3, 1}
+        );
+
+        // binary, 2 bits, 8 bits, binary, 4 bits
+        const TVector<ui32> borderCounts = {1, 3, 254, 1, 10};
+        const TVector<TVector<ui8>> srcFloatFeatures = {
+            {0, 1, 1, 0, 1},
+            {3, 0, 2, 1, 0},
+            {9, 0, 200, 7, 1},
+            {1, 1, 0, 0, 1},
+            {10, 4, 0, 7, 2}
+        };
+
+        TQuantizedObjectsData data;
+        data.QuantizedFeaturesInfo = MakeIntrusive<TQuantizedFeaturesInfo>(
+            *commonData.FeaturesLayout,
+            TConstArrayRef<ui32>(),
+            NCatboostOptions::TBinarizationOptions()
+        );
+        for (auto floatFeatureIdx : xrange(srcFloatFeatures.size())) {
+            TVector<float> borders(borderCounts[floatFeatureIdx]);
+            Iota(borders.begin(), borders.end(), 0.5f);
+            data.QuantizedFeaturesInfo->SetBorders(TFloatFeatureIdx(floatFeatureIdx), std::move(borders));
+
+            const auto& floatFeature = srcFloatFeatures[floatFeatureIdx];
+            auto storage = TMaybeOwningArrayHolder<ui64>::CreateOwning(
+                CompressVector<ui64>(floatFeature.data(), floatFeature.size(), 8)
+            );
+            data.FloatFeatures.emplace_back(
+                MakeHolder<TQuantizedFloatValuesHolder>(
+                    floatFeatureIdx,
+                    TCompressedArray(floatFeature.size(), 8, storage),
+                    commonData.SubsetIndexing.Get()
+                )
+            );
+        }
+
+        NPar::TLocalExecutor localExecutor;
+        TQuantizedForCPUObjectsDataProvider objectsDataProvider(
+            Nothing(),
+            std::move(commonData),
+            std::move(data),
+            false,
+            &localExecutor
+        );
+
+        UNIT_ASSERT_VALUES_EQUAL(objectsDataProvider.GetFeaturesPackCount(), 1);
+        UNIT_ASSERT(!objectsDataProvider.GetFloatFeaturePackedIndex(2));
+        const TVector<ui32> expectedBitOffsets = {0, 1, 0, 3, 4};
+        const TVector<ui32> expectedBitCounts = {1, 2, 0, 1, 4};
+        for (auto floatFeatureIdx : {0, 1, 3, 4}) {
+            const auto& packedIndex = objectsDataProvider.GetFloatFeaturePackedIndex(floatFeatureIdx);
+            UNIT_ASSERT(packedIndex);
+            UNIT_ASSERT_VALUES_EQUAL(packedIndex->PackIdx, 0);
+            UNIT_ASSERT_VALUES_EQUAL(packedIndex->BitOffset, expectedBitOffsets[floatFeatureIdx]);
+            UNIT_ASSERT_VALUES_EQUAL(packedIndex->BitCount, expectedBitCounts[floatFeatureIdx]);
+
+            // packs are indexed as source data
+            const auto* pack = objectsDataProvider.GetFeaturesPackRawSrcData(0);
+            const ui32 mask = (1 << packedIndex->BitCount) - 1;
+            for (auto srcIdx : xrange(srcFloatFeatures[floatFeatureIdx].size())) {
+                UNIT_ASSERT_VALUES_EQUAL(
+                    (pack[srcIdx] >> packedIndex->BitOffset) & mask,
+                    srcFloatFeatures[floatFeatureIdx][srcIdx]
+                );
+            }
+
+            // packed features keep only packs, their values are decoded from them
+            UNIT_ASSERT(!objectsDataProvider.GetFloatFeatureRawSrcData(floatFeatureIdx));
+            UNIT_ASSERT(
+                dynamic_cast<const TPackedFloatValuesHolder*>(*objectsDataProvider.GetFloatFeature(floatFeatureIdx))
+            );
+            const TVector<ui8> expectedValues = {
+                srcFloatFeatures[floatFeatureIdx][0],
+                srcFloatFeatures[floatFeatureIdx][4],
+                srcFloatFeatures[floatFeatureIdx][3],
+                srcFloatFeatures[floatFeatureIdx][1]
+            };
+            UNIT_ASSERT(
+                Equal<ui8>(
+                    *(*objectsDataProvider.GetFloatFeature(floatFeatureIdx))->ExtractValues(&localExecutor),
+                    expectedValues
+                )
+            );
+            UNIT_ASSERT(Equal<ui8>(expectedValues, GetDispatchedFloatFeatureBins(objectsDataProvider, floatFeatureIdx)));
+        }
+    }
+
+    Y_UNIT_TEST(SparseFloatFeaturesForCPU) {
+        const ui32 objectCount = 100;
+
+        TCommonObjectsData commonData;
+        commonData.FeaturesLayout = MakeIntrusive<TFeaturesLayout>((ui32)3, TVector<ui32>{}, TVector<TString>{});
+        commonData.SubsetIndexing = MakeAtomicShared<TArraySubsetIndexing<ui32>>(
+            TFullSubset<ui32>(objectCount)
+        );
+
+        // sparse with default bin 0, sparse with default bin 1, dense
+        TVector<TVector<ui8>> srcFloatFeatures(3, TVector<ui8>(objectCount, 0));
+        srcFloatFeatures[0][10] = 2;
+        srcFloatFeatures[0][50] = 1;
+        Fill(srcFloatFeatures[1].begin(), srcFloatFeatures[1].end(), 1);
+        srcFloatFeatures[1][99] = 0;
+        for (auto objectIdx : xrange(objectCount)) {
+            srcFloatFeatures[2][objectIdx] = objectIdx % 3;
+        }
+
+        TQuantizedObjectsData data;
+        data.QuantizedFeaturesInfo = MakeIntrusive<TQuantizedFeaturesInfo>(
+            *commonData.FeaturesLayout,
+            TConstArrayRef<ui32>(),
+            NCatboostOptions::TBinarizationOptions()
+        );
+        for (auto floatFeatureIdx : xrange(srcFloatFeatures.size())) {
+            data.QuantizedFeaturesInfo->SetBorders(TFloatFeatureIdx(floatFeatureIdx), {0.5f, 1.5f});
+
+            const auto& floatFeature = srcFloatFeatures[floatFeatureIdx];
+            auto storage = TMaybeOwningArrayHolder<ui64>::CreateOwning(
+                CompressVector<ui64>(floatFeature.data(), floatFeature.size(), 8)
+            );
+            data.FloatFeatures.emplace_back(
+                MakeHolder<TQuantizedFloatValuesHolder>(
+                    floatFeatureIdx,
+                    TCompressedArray(floatFeature.size(), 8, storage),
+                    commonData.SubsetIndexing.Get()
+                )
+            );
+        }
+
+        NPar::TLocalExecutor localExecutor;
+        TQuantizedForCPUObjectsDataProvider objectsDataProvider(
+            Nothing(),
+            std::move(commonData),
+            std::move(data),
+            false,
+            &localExecutor
+        );
+
+        const auto& sparseValues0 = objectsDataProvider.GetFloatFeatureSparseValues(0);
+        UNIT_ASSERT(sparseValues0);
+        UNIT_ASSERT_VALUES_EQUAL(sparseValues0->DefaultBin, 0);
+        UNIT_ASSERT_EQUAL(sparseValues0->NonDefaultSrcIndices, (TVector<ui32>{10, 50}));
+        UNIT_ASSERT_EQUAL(sparseValues0->NonDefaultBins, (TVector<ui8>{2, 1}));
+
+        const auto& sparseValues1 = objectsDataProvider.GetFloatFeatureSparseValues(1);
+        UNIT_ASSERT(sparseValues1);
+        UNIT_ASSERT_VALUES_EQUAL(sparseValues1->DefaultBin, 1);
+        UNIT_ASSERT_EQUAL(sparseValues1->NonDefaultSrcIndices, (TVector<ui32>{99}));
+        UNIT_ASSERT_EQUAL(sparseValues1->NonDefaultBins, (TVector<ui8>{0}));
+
+        UNIT_ASSERT(!objectsDataProvider.GetFloatFeatureSparseValues(2));
+
+        // sparse features are not packed, so the dense one has no pack companions
+        UNIT_ASSERT_VALUES_EQUAL(objectsDataProvider.GetFeaturesPackCount(), 0);
+
+        // sparse features keep only non-default bins, their values are decoded from them
+        for (auto floatFeatureIdx : {0, 1}) {
+            UNIT_ASSERT(!objectsDataProvider.GetFloatFeatureRawSrcData(floatFeatureIdx));
+            UNIT_ASSERT(
+                dynamic_cast<const TSparseFloatValuesHolder*>(*objectsDataProvider.GetFloatFeature(floatFeatureIdx))
+            );
+        }
+        for (auto floatFeatureIdx : xrange(srcFloatFeatures.size())) {
+            UNIT_ASSERT(
+                Equal<ui8>(
+                    *(*objectsDataProvider.GetFloatFeature(floatFeatureIdx))->ExtractValues(&localExecutor),
+                    srcFloatFeatures[floatFeatureIdx]
+                )
+            );
+            UNIT_ASSERT(
+                Equal<ui8>(
+                    *objectsDataProvider.GetFloatFeatureSrcBins(floatFeatureIdx),
+                    srcFloatFeatures[floatFeatureIdx]
+                )
+            );
+            // decoded bins of sparse features are kept
+            for (auto i : xrange(2)) {
+                Y_UNUSED(i);
+                UNIT_ASSERT(
+                    Equal<ui8>(
+                        srcFloatFeatures[floatFeatureIdx],
+                        GetDispatchedFloatFeatureBins(objectsDataProvider, floatFeatureIdx)
+                    )
+                );
+            }
+        }
+
+        // subsets share sparse values, consecutive data has its own
+        const TVector<ui32> subsetIndices = {99, 10, 3, 50};
+        auto subsetDataProvider = objectsDataProvider.GetSubset(
+            GetSubset(
+                objectsDataProvider.GetObjectsGrouping(),
+                TArraySubsetIndexing<ui32>(TIndexedSubset<ui32>(subsetIndices)),
+                EObjectsOrder::Undefined
+            ),
+            &localExecutor
+        );
+        auto& subsetObjectsDataProvider = dynamic_cast<TQuantizedForCPUObjectsDataProvider&>(*subsetDataProvider);
+        UNIT_ASSERT_EQUAL(subsetObjectsDataProvider.GetFloatFeatureSparseValues(0), sparseValues0);
+        UNIT_ASSERT_EQUAL(subsetObjectsDataProvider.GetFloatFeatureSparseValues(1), sparseValues1);
+
+        const auto checkSubsetValues = [&] () {
+            for (auto floatFeatureIdx : xrange(srcFloatFeatures.size())) {
+                TVector<ui8> expectedValues;
+                for (auto srcIdx : subsetIndices) {
+                    expectedValues.push_back(srcFloatFeatures[floatFeatureIdx][srcIdx]);
+                }
+                UNIT_ASSERT(
+                    Equal<ui8>(
+                        *(*subsetObjectsDataProvider.GetFloatFeature(floatFeatureIdx))->ExtractValues(&localExecutor),
+                        expectedValues
+                    )
+                );
+            }
+        };
+        checkSubsetValues();
+
+        subsetObjectsDataProvider.EnsureConsecutiveFeaturesData(&localExecutor);
+        checkSubsetValues();
+
+        const auto* consecutiveSparseValues0 = subsetObjectsDataProvider.GetFloatFeatureSparseValues(0);
+        UNIT_ASSERT(consecutiveSparseValues0);
+        UNIT_ASSERT_VALUES_EQUAL(consecutiveSparseValues0->SrcSize, subsetIndices.size());
+        UNIT_ASSERT_VALUES_EQUAL(consecutiveSparseValues0->DefaultBin, 0);
+        UNIT_ASSERT_EQUAL(consecutiveSparseValues0->NonDefaultSrcIndices, (TVector<ui32>{1, 3}));
+        UNIT_ASSERT_EQUAL(consecutiveSparseValues0->NonDefaultBins, (TVector<ui8>{2, 1}));
+
+        const auto* consecutiveSparseValues1 = subsetObjectsDataProvider.GetFloatFeatureSparseValues(1);
+        UNIT_ASSERT(consecutiveSparseValues1);
+        UNIT_ASSERT_VALUES_EQUAL(consecutiveSparseValues1->DefaultBin, 1);
+        UNIT_ASSERT_EQUAL(consecutiveSparseValues1->NonDefaultSrcIndices, (TVector<ui32>{0}));
+        UNIT_ASSERT_EQUAL(consecutiveSparseValues1->NonDefaultBins, (TVector<ui8>{0}));
+    }
 }
@@ -205,6 +205,12 @@ namespace NCB {
             TMaybeOwningConstArrayHolder<ui8> featuresPart // per-object data size depends on BitsPerKey
         ) = 0;
 
+        /* whole 8-bit feature column that is used in place without copying (memory mapped file for example),
+         * data is kept alive by resourceHolders passed to Start.
+         * data must be aligned and readable up to ui64 boundary because it is used as TCompressedArray storage
+         */
+        virtual void AddFloatFeature(ui32 flatFeatureIdx, TMaybeOwningConstArrayHolder<ui8> features) = 0;
+
 
         // TRawTargetData
 
@@ -77,6 +77,7 @@ namespace NCB {
     TLineDataReaderFactory::TRegistrator<TFileLineDataReader> DefLineDataReaderReg("");
     TLineDataReaderFactory::TRegistrator<TFileLineDataReader> FileLineDataReaderReg("file");
     TLineDataReaderFactory::TRegistrator<TFileLineDataReader> DsvLineDataReaderReg("dsv");
+    TLineDataReaderFactory::TRegistrator<TFileLineDataReader> MappedDsvLineDataReaderReg("mmap-dsv");
 
     }
 }
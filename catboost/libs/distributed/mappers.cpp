@@ -3,6 +3,7 @@
 #include <catboost/libs/algo/approx_calcer.h>
 #include <catboost/libs/algo/approx_calcer_multi.h>
 #include <catboost/libs/algo/error_functions.h>
+#include <catboost/libs/algo/greedy_tensor_search.h>
 #include <catboost/libs/algo/score_calcer.h>
 #include <catboost/libs/algo/learn_context.h>
 #include <catboost/libs/algo/online_ctr.h>
@@ -32,6 +33,7 @@ void TPlainFoldBuilder::DoMap(NPar::IUserContext* ctx, int hostId, TInput* /*unu
         trainData->ApproxDimension,
         localData.StoreExpApprox,
         UsesPairsForCalculation(localData.Params.LossFunctionDescription->GetLossFunction()),
+        localData.Params.BoostingOptions->DevSinglePrecisionDerivatives,
         *localData.Rand,
         &NPar::LocalExecutor());
     Y_ASSERT(localData.Progress.AveragingFold.BodyTailArr.ysize() == 1);
@@ -43,24 +45,35 @@ void TPlainFoldBuilder::DoMap(NPar::IUserContext* ctx, int hostId, TInput* /*unu
         localData.Progress.AvrgApprox.resize(trainData->ApproxDimension, TVector<double>(trainData->TrainData->GetObjectCount()));
     }
 
+    const int nonCtrBucketCount = CountNonCtrBuckets(
+        trainData->SplitCounts,
+        *(trainData->TrainData->ObjectsData->GetQuantizedFeaturesInfo()),
+        localData.Params.CatFeatureParams->OneHotMaxSize.Get());
+    const ui64 treeLevelCacheSizeLimit = CalcTreeLevelCacheSizeLimit(localData.Params);
     localData.UseTreeLevelCaching = NeedToUseTreeLevelCaching(
         localData.Params,
         /*maxBodyTailCount=*/1,
-        localData.Progress.AveragingFold.GetApproxDimension());
+        localData.Progress.AveragingFold.GetApproxDimension(),
+        nonCtrBucketCount,
+        treeLevelCacheSizeLimit);
 
     const bool isPairwiseScoring = IsPairwiseScoring(localData.Params.LossFunctionDescription->GetLossFunction());
     const int defaultCalcStatsObjBlockSize = static_cast<int>(localData.Params.ObliviousTreeOptions->DevScoreCalcObjBlockSize);
     auto& plainFold = localData.Progress.AveragingFold;
-    localData.SampledDocs.Create({plainFold}, isPairwiseScoring, defaultCalcStatsObjBlockSize, GetBernoulliSampleRate(localData.Params.ObliviousTreeOptions->BootstrapConfig));
+    const auto& bootstrapConfig = localData.Params.ObliviousTreeOptions->BootstrapConfig;
+    localData.SampledDocs.Create(
+        {plainFold},
+        isPairwiseScoring,
+        defaultCalcStatsObjBlockSize,
+        GetBernoulliSampleRate(bootstrapConfig),
+        IsSampledBySampleWeights(bootstrapConfig)
+    );
     if (localData.UseTreeLevelCaching) {
         localData.SmallestSplitSideDocs.Create({plainFold}, isPairwiseScoring, defaultCalcStatsObjBlockSize);
         localData.PrevTreeLevelStats.Create({plainFold},
-            CountNonCtrBuckets(
-                trainData->SplitCounts,
-                *(trainData->TrainData->ObjectsData->GetQuantizedFeaturesInfo()),
-                localData.Params.CatFeatureParams->OneHotMaxSize.Get()
-            ),
-            localData.Params.ObliviousTreeOptions->MaxDepth);
+            nonCtrBucketCount,
+            localData.Params.ObliviousTreeOptions->MaxDepth,
+            treeLevelCacheSizeLimit);
     }
     localData.Indices.yresize(plainFold.GetLearnSampleCount());
     localData.AllDocCount = trainData->AllDocCount;
@@ -69,7 +82,6 @@ void TPlainFoldBuilder::DoMap(NPar::IUserContext* ctx, int hostId, TInput* /*unu
 
 void TApproxReconstructor::DoMap(NPar::IUserContext* ctx, int hostId, TInput* valuedForest, TOutput* /*unused*/) const {
     NPar::TCtxPtr<TTrainData> trainData(ctx, SHARED_ID_TRAIN_DATA, hostId);
-    Y_ASSERT(!trainData->TrainData->MetaInfo.FeaturesLayout->GetCatFeatureCount());
 
     auto& localData = TLocalTensorSearchData::GetRef();
     Y_ASSERT(IsPlainMode(localData.Params.BoostingOptions->BoostingType));
@@ -96,6 +108,7 @@ void TTensorSearchStarter::DoMap(NPar::IUserContext* /*ctx*/, int /*hostId*/, TI
     auto& localData = TLocalTensorSearchData::GetRef();
     localData.Depth = 0;
     Fill(localData.Indices.begin(), localData.Indices.end(), 0);
+    TrimOnlineCTRcache({&localData.Progress.AveragingFold});
     if (localData.UseTreeLevelCaching) {
         localData.PrevTreeLevelStats.GarbageCollect();
     }
@@ -111,6 +124,42 @@ void TBootstrapMaker::DoMap(NPar::IUserContext* /*ctx*/, int /*hostId*/, TInput*
         localData.Rand.Get());
 }
 
+static TVector<ui64> CalcLearnHashes(const NPar::TCtxPtr<TTrainData>& trainData, const TProjection& proj) {
+    const auto& fold = TLocalTensorSearchData::GetRef().Progress.AveragingFold;
+    TVector<ui64> hashArr;
+    hashArr.yresize(fold.GetLearnSampleCount());
+    CalcOnlineCtrHashes(proj, *trainData->TrainData->ObjectsData, fold.LearnPermutationFeaturesSubset, hashArr);
+    return hashArr;
+}
+
+void TOnlineCtrHashCounter::DoMap(NPar::IUserContext* ctx, int hostId, TInput* projections, TOutput* hashCounts) const {
+    NPar::TCtxPtr<TTrainData> trainData(ctx, SHARED_ID_TRAIN_DATA, hostId);
+    const auto& fold = TLocalTensorSearchData::GetRef().Progress.AveragingFold;
+    hashCounts->resize(projections->size());
+    NPar::ParallelFor(0, projections->ysize(), [&] (int projIdx) {
+        const auto& proj = (*projections)[projIdx];
+        const auto& ctrs = fold.GetCtrs(proj);
+        if (!ctrs.contains(proj) || ctrs.at(proj).Feature.empty()) {
+            (*hashCounts)[projIdx] = CountOnlineCtrHashes(CalcLearnHashes(trainData, proj), fold);
+        }
+    });
+}
+
+void TOnlineCtrCalcer::DoMap(NPar::IUserContext* ctx, int hostId, TInput* shardStats, TOutput* /*unused*/) const {
+    NPar::TCtxPtr<TTrainData> trainData(ctx, SHARED_ID_TRAIN_DATA, hostId);
+    auto& fold = TLocalTensorSearchData::GetRef().Progress.AveragingFold;
+    const auto& projections = shardStats->Data.first;
+    const auto& stats = shardStats->Data.second;
+    Y_ASSERT(projections.size() == stats.size());
+    for (const auto& proj : projections) {
+        fold.GetCtrRef(proj); // insert outside of parallel section
+    }
+    NPar::ParallelFor(0, projections.ysize(), [&] (int projIdx) {
+        const auto& proj = projections[projIdx];
+        ComputeOnlineCTRsForShard(stats[projIdx], CalcLearnHashes(trainData, proj), fold, &fold.GetCtrRef(proj));
+    });
+}
+
 template <typename TMapFunc, typename TInputType, typename TOutputType>
 static void MapVector(const TMapFunc mapFunc,
     const TVector<TInputType>& inputs,
@@ -157,6 +206,7 @@ static void CalcStats3D(const NPar::TCtxPtr<TTrainData>& trainData,
         stats3D,
         /*pairwiseStats*/nullptr,
         /*scoreBins*/nullptr);
+    stats3D->SplitType = candidate.SplitCandidate.Type;
 }
 
 static void CalcPairwiseStats(const NPar::TCtxPtr<TTrainData>& trainData,
@@ -181,6 +231,7 @@ static void CalcPairwiseStats(const NPar::TCtxPtr<TTrainData>& trainData,
         /*stats3D*/nullptr,
         pairwiseStats,
         /*scoreBins*/nullptr);
+    pairwiseStats->SplitType = candidate.SplitCandidate.Type;
 }
 
 void TScoreCalcer::DoMap(NPar::IUserContext* ctx, int hostId, TInput* candidateList, TOutput* bucketStats) const {
@@ -231,7 +282,7 @@ void TRemotePairwiseScoreCalcer::DoMap(NPar::IUserContext* /*ctx*/, int /*hostId
         CalculatePairwiseScore(
             candidatePairwiseStats,
             bucketCount,
-            ESplitType::FloatFeature,
+            candidatePairwiseStats.SplitType,
             localData.Params.ObliviousTreeOptions->L2Reg,
             localData.Params.ObliviousTreeOptions->PairwiseNonDiagReg,
             &scoreBins
@@ -264,14 +315,13 @@ void TRemoteBinCalcer::DoReduce(TVector<TOutput>* statsFromAllWorkers, TOutput*
 void TRemoteScoreCalcer::DoMap(NPar::IUserContext* /*ctx*/, int /*hostId*/, TInput* bucketStats, TOutput* scores) const { // TStats4D -> TVector<TVector<double>> [subcandidate][bucket]
     const auto& localData = TLocalTensorSearchData::GetRef();
     const auto getScores = [&] (const TStats3D& candidateStats3D, TVector<double>* candidateScores) {
-        *candidateScores = GetScores(GetScoreBins(candidateStats3D, ESplitType::FloatFeature, localData.Depth, localData.SumAllWeights, localData.AllDocCount, localData.Params));
+        *candidateScores = GetScores(GetScoreBins(candidateStats3D, candidateStats3D.SplitType, localData.Depth, localData.SumAllWeights, localData.AllDocCount, localData.Params));
     };
     MapVector(getScores, *bucketStats, scores);
 }
 
 void TLeafIndexSetter::DoMap(NPar::IUserContext* ctx, int hostId, TInput* bestSplitCandidate, TOutput* /*unused*/) const {
     const TSplit bestSplit(bestSplitCandidate->Data.SplitCandidate, bestSplitCandidate->Data.BestBinBorderId);
-    Y_ASSERT(bestSplit.Type != ESplitType::OnlineCtr);
     auto& localData = TLocalTensorSearchData::GetRef();
     NPar::TCtxPtr<TTrainData> trainData(ctx, SHARED_ID_TRAIN_DATA, hostId);
     SetPermutedIndices(bestSplit,
@@ -403,30 +453,17 @@ void TBucketMultiUpdater::DoMap(NPar::IUserContext* /*ctx*/, int /*hostId*/, TIn
     const auto error = BuildError(localData.Params, /*custom objective*/ Nothing());
     const auto estimationMethod = localData.Params.ObliviousTreeOptions->LeavesEstimationMethod;
 
-    if (estimationMethod == ELeavesEstimation::Newton) {
-        UpdateBucketsMulti(AddSampleToBucketNewtonMulti,
-            localData.Indices,
-            localData.Progress.AveragingFold.LearnTarget,
-            localData.Progress.AveragingFold.GetLearnWeights(),
-            localData.Progress.AveragingFold.BodyTailArr[0].Approx,
-            localData.ApproxDeltas,
-            *error,
-            localData.Progress.AveragingFold.BodyTailArr[0].BodyFinish,
-            localData.GradientIteration,
-            &localData.MultiBuckets);
-    } else {
-        Y_ASSERT(estimationMethod == ELeavesEstimation::Gradient);
-        UpdateBucketsMulti(AddSampleToBucketGradientMulti,
-            localData.Indices,
-            localData.Progress.AveragingFold.LearnTarget,
-            localData.Progress.AveragingFold.GetLearnWeights(),
-            localData.Progress.AveragingFold.BodyTailArr[0].Approx,
-            localData.ApproxDeltas,
-            *error,
-            localData.Progress.AveragingFold.BodyTailArr[0].BodyFinish,
-            localData.GradientIteration,
-            &localData.MultiBuckets);
-    }
+    UpdateBucketsMulti(estimationMethod,
+        localData.Indices,
+        localData.Progress.AveragingFold.LearnTarget,
+        localData.Progress.AveragingFold.GetLearnWeights(),
+        localData.Progress.AveragingFold.BodyTailArr[0].Approx,
+        localData.ApproxDeltas,
+        *error,
+        localData.Progress.AveragingFold.BodyTailArr[0].BodyFinish,
+        localData.GradientIteration,
+        &NPar::LocalExecutor(),
+        &localData.MultiBuckets);
     sums->Data = std::make_pair(localData.MultiBuckets, TUnusedInitializedParam());
 }
 
@@ -434,6 +471,7 @@ void TDeltaMultiUpdater::DoMap(NPar::IUserContext* /*ctx*/, int /*hostId*/, TInp
     auto& localData = TLocalTensorSearchData::GetRef();
     UpdateApproxDeltasMulti(localData.StoreExpApprox, localData.Indices,
         localData.Progress.AveragingFold.BodyTailArr[0].BodyFinish,
+        &NPar::LocalExecutor(),
         leafValues,
         &localData.ApproxDeltas);
     ++localData.GradientIteration; // gradient iteration completed
@@ -504,3 +542,5 @@ REGISTER_SAVELOAD_NM_CLASS(0xd66d4d4, NCatboostDistributed, TErrorCalcer);
 
 REGISTER_SAVELOAD_NM_CLASS(0xd66d4d6, NCatboostDistributed, TApproxReconstructor);
 REGISTER_SAVELOAD_NM_CLASS(0xd66d4e0, NCatboostDistributed, TLeafWeightsGetter);
+REGISTER_SAVELOAD_NM_CLASS(0xd66d4e1, NCatboostDistributed, TOnlineCtrHashCounter);
+REGISTER_SAVELOAD_NM_CLASS(0xd66d4e2, NCatboostDistributed, TOnlineCtrCalcer);
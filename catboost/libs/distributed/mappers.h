@@ -2,6 +2,7 @@
 
 #include "data_types.h"
 
+#include <catboost/libs/algo/online_ctr.h>
 #include <catboost/libs/algo/tensor_search_helpers.h>
 
 #include <library/par/par.h>
@@ -26,6 +27,14 @@ class TBootstrapMaker: public NPar::TMapReduceCmd<TUnusedInitializedParam, TUnus
     OBJECT_NOCOPY_METHODS(TBootstrapMaker);
     void DoMap(NPar::IUserContext* ctx, int hostId, TInput* /*unused*/, TOutput* /*unused*/) const final;
 };
+class TOnlineCtrHashCounter: public NPar::TMapReduceCmd<TVector<TProjection>, TVector<TMaybe<TOnlineCtrHashCounts>>> { // [proj], Nothing() for ctrs computed earlier
+    OBJECT_NOCOPY_METHODS(TOnlineCtrHashCounter);
+    void DoMap(NPar::IUserContext* ctx, int hostId, TInput* projections, TOutput* hashCounts) const final;
+};
+class TOnlineCtrCalcer: public NPar::TMapReduceCmd<TEnvelope<std::pair<TVector<TProjection>, TVector<TOnlineCtrShardStats>>>, TUnusedInitializedParam> {
+    OBJECT_NOCOPY_METHODS(TOnlineCtrCalcer);
+    void DoMap(NPar::IUserContext* ctx, int hostId, TInput* shardStats, TOutput* /*unused*/) const final;
+};
 class TScoreCalcer: public NPar::TMapReduceCmd<TEnvelope<TCandidateList>, TEnvelope<TStats5D>> { // [cand][subcand]
     OBJECT_NOCOPY_METHODS(TScoreCalcer);
     void DoMap(NPar::IUserContext* ctx, int hostId, TInput* candidateList, TOutput* bucketStats) const final;
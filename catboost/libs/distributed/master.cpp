@@ -3,11 +3,15 @@
 
 #include <catboost/libs/algo/error_functions.h>
 #include <catboost/libs/algo/index_calcer.h>
+#include <catboost/libs/algo/online_ctr.h>
 #include <catboost/libs/algo/score_bin.h>
 #include <catboost/libs/algo/score_calcer.h>
 
 #include <library/par/par_settings.h>
 
+#include <util/generic/hash_set.h>
+#include <util/generic/xrange.h>
+
 using namespace NCatboostDistributed;
 using namespace NCB;
 
@@ -74,8 +78,15 @@ void MapBuildPlainFold(NCB::TTrainingForCPUDataProviderPtr trainData, TLearnCont
     ApplyMapper<TPlainFoldBuilder>(workerCount, ctx->SharedTrainData);
 }
 
-void MapRestoreApproxFromTreeStruct(TLearnContext* ctx) {
+void MapRestoreApproxFromTreeStruct(const NCB::TTrainingForCPUDataProviders& data, TLearnContext* ctx) {
     Y_ASSERT(ctx->Params.SystemOptions->IsMaster());
+    THashSet<TProjection> ctrProjections;
+    for (const auto& tree : ctx->LearnProgress.TreeStruct) {
+        for (const auto& ctrSplit : tree.GetCtrSplits()) {
+            ctrProjections.insert(ctrSplit.Projection);
+        }
+    }
+    MapCalcOnlineCtrs(data, TVector<TProjection>(ctrProjections.begin(), ctrProjections.end()), &ctx->LearnProgress.Folds[0], ctx);
     ApplyMapper<TApproxReconstructor>(
         ctx->RootEnvironment->GetSlaveCount(),
         ctx->SharedTrainData,
@@ -92,6 +103,87 @@ void MapBootstrap(TLearnContext* ctx) {
     ApplyMapper<TBootstrapMaker>(ctx->RootEnvironment->GetSlaveCount(), ctx->SharedTrainData);
 }
 
+void MapCalcOnlineCtrs(const NCB::TTrainingForCPUDataProviders& data, const TVector<TProjection>& projections, TFold* fold, TLearnContext* ctx) {
+    Y_ASSERT(ctx->Params.SystemOptions->IsMaster());
+    if (projections.empty()) {
+        return;
+    }
+    const int workerCount = ctx->RootEnvironment->GetSlaveCount();
+    auto hashCountsFromAllWorkers = ApplyMapper<TOnlineCtrHashCounter>(workerCount, ctx->SharedTrainData, projections); // [workerIdx][projIdx]
+
+    TVector<int> projIndices; // ctrs not computed on workers yet
+    for (int projIdx : xrange(projections.ysize())) {
+        const bool isComputed = !hashCountsFromAllWorkers[0][projIdx].Defined();
+        for (int workerIdx : xrange(1, workerCount)) {
+            Y_VERIFY(isComputed == !hashCountsFromAllWorkers[workerIdx][projIdx].Defined());
+        }
+        if (!isComputed) {
+            projIndices.push_back(projIdx);
+        }
+    }
+    if (projIndices.empty()) {
+        return;
+    }
+
+    const auto& catFeatureParams = ctx->Params.CatFeatureParams.Get();
+    const ui32 testSampleCount = data.GetTestSampleCount();
+    TVector<TProjection> newProjections(projIndices.size());
+    TVector<TVector<TOnlineCtrShardStats>> shardStats(projIndices.size()); // [newProjIdx][workerIdx]
+    ctx->LocalExecutor->ExecRange([&] (int newProjIdx) {
+        const int projIdx = projIndices[newProjIdx];
+        const auto& proj = projections[projIdx];
+        const auto& ctrInfo = ctx->CtrsHelper.GetCtrInfo(proj);
+
+        TVector<TOnlineCtrHashCounts> shardHashCounts(workerCount);
+        for (int workerIdx : xrange(workerCount)) {
+            shardHashCounts[workerIdx] = std::move(*hashCountsFromAllWorkers[workerIdx][projIdx]);
+        }
+        TVector<ui64> testHashArr;
+        const bool needTestHashes = catFeatureParams.CounterCalcMethod == ECounterCalc::Full
+            && AnyOf(ctrInfo, [] (const auto& info) { return info.Type == ECtrType::Counter; });
+        if (needTestHashes) {
+            testHashArr.yresize(testSampleCount);
+            size_t docOffset = 0;
+            for (const auto& testSet : data.Test) {
+                CalcOnlineCtrHashes(
+                    proj,
+                    *testSet->ObjectsData,
+                    testSet->ObjectsData->GetFeaturesArraySubsetIndexing(),
+                    TArrayRef<ui64>(testHashArr.data() + docOffset, testSet->GetObjectCount()));
+                docOffset += testSet->GetObjectCount();
+            }
+        }
+        ui64 topSize = catFeatureParams.CtrLeafCountLimit;
+        if (proj.IsSingleCatFeature() && catFeatureParams.StoreAllSimpleCtrs) {
+            topSize = Max<ui64>();
+        }
+        newProjections[newProjIdx] = proj;
+        shardStats[newProjIdx] = MergeOnlineCtrHashCounts(
+            shardHashCounts,
+            testHashArr,
+            ctrInfo,
+            fold->TargetClassesCount,
+            topSize,
+            catFeatureParams.CounterCalcMethod);
+    }, 0, projIndices.ysize(), NPar::TLocalExecutor::WAIT_COMPLETE);
+
+    // master keeps only unique value counts used by model size regularization
+    for (int newProjIdx : xrange(newProjections.ysize())) {
+        auto& ctr = fold->GetCtrRef(newProjections[newProjIdx]);
+        ctr.UniqueValuesCount = shardStats[newProjIdx][0].UniqueValuesCount;
+        ctr.CounterUniqueValuesCount = shardStats[newProjIdx][0].CounterUniqueValuesCount;
+    }
+
+    TVector<TOnlineCtrCalcer::TInput> workerInputs(workerCount);
+    for (int workerIdx : xrange(workerCount)) {
+        workerInputs[workerIdx].Data.first = newProjections;
+        for (auto& projShardStats : shardStats) {
+            workerInputs[workerIdx].Data.second.push_back(std::move(projShardStats[workerIdx]));
+        }
+    }
+    ApplyMapperPerWorker<TOnlineCtrCalcer>(ctx->SharedTrainData, &workerInputs);
+}
+
 template <typename TScoreCalcMapper, typename TGetScore>
 void MapGenericCalcScore(TGetScore getScore, double scoreStDev, TCandidateList* candidateList, TLearnContext* ctx) {
     Y_ASSERT(ctx->Params.SystemOptions->IsMaster());
@@ -208,7 +300,7 @@ void MapCalcErrors(TLearnContext* ctx) {
 }
 
 template <typename TApproxDefs>
-void MapSetApproxes(const IDerCalcer& error, const TSplitTree& splitTree, TConstArrayRef<NCB::TTrainingForCPUDataProviderPtr> testData, TVector<TVector<double>>* averageLeafValues, TVector<double>* sumLeafWeights, TLearnContext* ctx) {
+void MapSetApproxes(const IDerCalcer& error, const TSplitTree& splitTree, const NCB::TTrainingForCPUDataProviders& data, TVector<TVector<double>>* averageLeafValues, TVector<double>* sumLeafWeights, TLearnContext* ctx) {
     using namespace NCatboostDistributed;
     using TSum = typename TApproxDefs::TSumType;
     using TPairwiseBuckets = typename TApproxDefs::TPairwiseBuckets;
@@ -262,8 +354,15 @@ void MapSetApproxes(const IDerCalcer& error, const TSplitTree& splitTree, TConst
     // update learn approx and average approx
     ApplyMapper<TApproxUpdater>(workerCount, ctx->SharedTrainData, *averageLeafValues);
     // update test
-    const auto indices = BuildIndices(/*unused fold*/{}, splitTree, /*learnData*/ {}, testData, ctx->LocalExecutor);
-    UpdateAvrgApprox(error.GetIsExpApprox(), /*learnSampleCount*/ 0, indices, *averageLeafValues, testData, &ctx->LearnProgress, ctx->LocalExecutor);
+    TVector<TIndexType> indices;
+    if (splitTree.GetCtrSplits().empty()) {
+        indices = BuildIndices(/*unused fold*/{}, splitTree, /*learnData*/ {}, data.Test, ctx->LocalExecutor);
+    } else {
+        // online ctrs of averaging fold are stored on master for learn and test objects
+        indices = BuildIndices(ctx->LearnProgress.AveragingFold, splitTree, data.Learn, data.Test, ctx->LocalExecutor);
+        indices.erase(indices.begin(), indices.begin() + data.Learn->GetObjectCount());
+    }
+    UpdateAvrgApprox(error.GetIsExpApprox(), /*learnSampleCount*/ 0, indices, *averageLeafValues, data.Test, &ctx->LearnProgress, ctx->LocalExecutor);
 }
 
 struct TSetApproxesSimpleDefs {
@@ -326,12 +425,12 @@ struct TSetApproxesMultiDefs {
     }
 };
 
-void MapSetApproxesSimple(const IDerCalcer& error, const TSplitTree& splitTree, TConstArrayRef<NCB::TTrainingForCPUDataProviderPtr> testData, TVector<TVector<double>>* averageLeafValues, TVector<double>* sumLeafWeights, TLearnContext* ctx) {
-    MapSetApproxes<TSetApproxesSimpleDefs>(error, splitTree, testData, averageLeafValues, sumLeafWeights, ctx);
+void MapSetApproxesSimple(const IDerCalcer& error, const TSplitTree& splitTree, const NCB::TTrainingForCPUDataProviders& data, TVector<TVector<double>>* averageLeafValues, TVector<double>* sumLeafWeights, TLearnContext* ctx) {
+    MapSetApproxes<TSetApproxesSimpleDefs>(error, splitTree, data, averageLeafValues, sumLeafWeights, ctx);
 }
 
-void MapSetApproxesMulti(const IDerCalcer& error, const TSplitTree& splitTree, TConstArrayRef<NCB::TTrainingForCPUDataProviderPtr> testData, TVector<TVector<double>>* averageLeafValues, TVector<double>* sumLeafWeights, TLearnContext* ctx) {
-    MapSetApproxes<TSetApproxesMultiDefs>(error, splitTree, testData, averageLeafValues, sumLeafWeights, ctx);
+void MapSetApproxesMulti(const IDerCalcer& error, const TSplitTree& splitTree, const NCB::TTrainingForCPUDataProviders& data, TVector<TVector<double>>* averageLeafValues, TVector<double>* sumLeafWeights, TLearnContext* ctx) {
+    MapSetApproxes<TSetApproxesMultiDefs>(error, splitTree, data, averageLeafValues, sumLeafWeights, ctx);
 }
 
 void MapSetDerivatives(TLearnContext* ctx) {
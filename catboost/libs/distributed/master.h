@@ -11,9 +11,10 @@
 void InitializeMaster(TLearnContext* ctx);
 void FinalizeMaster(TLearnContext* ctx);
 void MapBuildPlainFold(NCB::TTrainingForCPUDataProviderPtr trainData, TLearnContext* ctx);
-void MapRestoreApproxFromTreeStruct(TLearnContext* ctx);
+void MapRestoreApproxFromTreeStruct(const NCB::TTrainingForCPUDataProviders& data, TLearnContext* ctx);
 void MapTensorSearchStart(TLearnContext* ctx);
 void MapBootstrap(TLearnContext* ctx);
+void MapCalcOnlineCtrs(const NCB::TTrainingForCPUDataProviders& data, const TVector<TProjection>& projections, TFold* fold, TLearnContext* ctx);
 void MapCalcScore(double scoreStDev, int depth, TCandidateList* candidateList, TLearnContext* ctx);
 void MapRemoteCalcScore(double scoreStDev, int depth, TCandidateList* candidateList, TLearnContext* ctx);
 void MapRemotePairwiseCalcScore(double scoreStDev, TCandidateList* candidateList, TLearnContext* ctx);
@@ -34,8 +35,22 @@ TVector<typename TMapper::TOutput> ApplyMapper(int workerCount, TObj<NPar::IEnvi
     return mapperOutput;
 }
 
-void MapSetApproxesSimple(const IDerCalcer& error, const TSplitTree& splitTree, TConstArrayRef<NCB::TTrainingForCPUDataProviderPtr> testData, TVector<TVector<double>>* averageLeafValues, TVector<double>* sumLeafWeights, TLearnContext* ctx);
+template <typename TMapper>
+TVector<typename TMapper::TOutput> ApplyMapperPerWorker(TObj<NPar::IEnvironment> environment, TVector<typename TMapper::TInput>* workerInputs) { // [workerIdx]
+    NPar::TJobDescription job;
+    job.SetCurrentOperation(new TMapper());
+    for (int workerIdx = 0; workerIdx < workerInputs->ysize(); ++workerIdx) {
+        job.AddQuery(workerIdx, (*workerInputs)[workerIdx]);
+    }
+    job.SeparateResults(workerInputs->ysize());
+    NPar::TJobExecutor exec(&job, environment);
+    TVector<typename TMapper::TOutput> mapperOutput;
+    exec.GetResultVec(&mapperOutput);
+    return mapperOutput;
+}
+
+void MapSetApproxesSimple(const IDerCalcer& error, const TSplitTree& splitTree, const NCB::TTrainingForCPUDataProviders& data, TVector<TVector<double>>* averageLeafValues, TVector<double>* sumLeafWeights, TLearnContext* ctx);
 
-void MapSetApproxesMulti(const IDerCalcer& error, const TSplitTree& splitTree, TConstArrayRef<NCB::TTrainingForCPUDataProviderPtr> testData, TVector<TVector<double>>* averageLeafValues, TVector<double>* sumLeafWeights, TLearnContext* ctx);
+void MapSetApproxesMulti(const IDerCalcer& error, const TSplitTree& splitTree, const NCB::TTrainingForCPUDataProviders& data, TVector<TVector<double>>* averageLeafValues, TVector<double>* sumLeafWeights, TLearnContext* ctx);
 
 void MapSetDerivatives(TLearnContext* ctx);
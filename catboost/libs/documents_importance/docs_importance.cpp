@@ -8,6 +8,7 @@
 #include <catboost/libs/logging/logging.h>
 #include <catboost/libs/target/data_providers.h>
 
+#include <util/generic/algorithm.h>
 #include <util/generic/cast.h>
 #include <util/generic/maybe.h>
 #include <util/generic/ptr.h>
@@ -16,7 +17,6 @@
 #include <util/string/iterator.h>
 
 #include <functional>
-#include <numeric>
 
 
 using namespace NCB;
@@ -40,72 +40,144 @@ static TUpdateMethod ParseUpdateMethod(const TString& updateMethod) {
     return TUpdateMethod(updateType, topSize);
 }
 
+namespace {
+    // Keeps topSize train objects with the largest absolute importance or, if not ordered, first topSize train objects.
+    class TTopDocumentImportances {
+    public:
+        TTopDocumentImportances(ui32 topSize, bool orderByAbsValue)
+            : TopSize(topSize)
+            , OrderByAbsValue(orderByAbsValue)
+        {
+        }
+
+        // train objects should be added in increasing order of trainDocId
+        void Add(ui32 trainDocId, double importance) {
+            const TItem item{importance, trainDocId};
+            if (Items.size() < TopSize) {
+                Items.push_back(item);
+                if (OrderByAbsValue) {
+                    PushHeap(Items.begin(), Items.end(), IsMoreImportant);
+                }
+            } else if (OrderByAbsValue && TopSize > 0 && IsMoreImportant(item, Items.front())) {
+                PopHeap(Items.begin(), Items.end(), IsMoreImportant);
+                Items.back() = item;
+                PushHeap(Items.begin(), Items.end(), IsMoreImportant);
+            }
+        }
+
+        template <class TPredicate>
+        void GetResult(const TPredicate& predicate, TVector<ui32>* indices, TVector<double>* scores) {
+            if (OrderByAbsValue) {
+                Sort(Items.begin(), Items.end(), IsMoreImportant);
+            }
+            for (const TItem& item : Items) {
+                if (predicate(item.Importance)) {
+                    scores->push_back(item.Importance);
+                    indices->push_back(item.TrainDocId);
+                }
+            }
+        }
+
+    private:
+        struct TItem {
+            double Importance;
+            ui32 TrainDocId;
+        };
+
+        // items are kept in a heap with the least important item at the top
+        static bool IsMoreImportant(const TItem& left, const TItem& right) {
+            const double leftAbsImportance = Abs(left.Importance);
+            const double rightAbsImportance = Abs(right.Importance);
+            return leftAbsImportance > rightAbsImportance
+                || (leftAbsImportance == rightAbsImportance && left.TrainDocId < right.TrainDocId);
+        }
+
+    private:
+        ui32 TopSize;
+        bool OrderByAbsValue;
+        TVector<TItem> Items;
+    };
+}
+
 static TDStrResult GetFinalDocumentImportances(
-    const TVector<TVector<double>>& rawImportances,
+    TDocumentImportancesEvaluator* leafInfluenceEvaluator,
+    const TProcessedDataProvider& testProcessedData,
+    ui32 trainDocCount,
     EDocumentStrengthType docImpMethod,
     int topSize,
-    EImportanceValuesSign importanceValuesSign
+    EImportanceValuesSign importanceValuesSign,
+    NPar::TLocalExecutor* localExecutor,
+    int logPeriod
 ) {
-    const ui32 trainDocCount = rawImportances.size();
-    Y_ASSERT(rawImportances.size() != 0);
-    const ui32 testDocCount = rawImportances[0].size();
-    TVector<TVector<double>> preprocessedImportances;
-    if (docImpMethod == EDocumentStrengthType::Average) {
-        preprocessedImportances = TVector<TVector<double>>(1, TVector<double>(trainDocCount));
-        for (ui32 trainDocId = 0; trainDocId < trainDocCount; ++trainDocId) {
-            for (ui32 testDocId = 0; testDocId < testDocCount; ++testDocId) {
-                preprocessedImportances[0][trainDocId] += rawImportances[trainDocId][testDocId];
-            }
-        }
-        for (ui32 trainDocId = 0; trainDocId < trainDocCount; ++trainDocId) {
-            preprocessedImportances[0][trainDocId] /= testDocCount;
-        }
+    Y_ASSERT(trainDocCount != 0);
+    const ui32 testDocCount = testProcessedData.GetObjectCount();
+    const bool orderByAbsValue = docImpMethod != EDocumentStrengthType::Raw;
 
+    TVector<TTopDocumentImportances> topImportances;
+    TVector<double> averageImportances;
+    if (docImpMethod == EDocumentStrengthType::Average) {
+        averageImportances.resize(trainDocCount);
+        topImportances.emplace_back(topSize, orderByAbsValue);
     } else {
         Y_ASSERT(docImpMethod == EDocumentStrengthType::PerObject || docImpMethod == EDocumentStrengthType::Raw);
-        preprocessedImportances = TVector<TVector<double>>(testDocCount, TVector<double>(trainDocCount));
-        for (ui32 trainDocId = 0; trainDocId < trainDocCount; ++trainDocId) {
-            for (ui32 testDocId = 0; testDocId < testDocCount; ++testDocId) {
-                preprocessedImportances[testDocId][trainDocId] = rawImportances[trainDocId][testDocId];
-            }
-        }
+        topImportances.resize(testDocCount, TTopDocumentImportances(topSize, orderByAbsValue));
     }
 
-    TDStrResult result(preprocessedImportances.size());
-    for (ui32 testDocId = 0; testDocId < preprocessedImportances.size(); ++testDocId) {
-        TVector<double>& preprocessedImportancesRef = preprocessedImportances[testDocId];
-
-        const ui32 docCount = preprocessedImportancesRef.size();
-        TVector<ui32> indices(docCount);
-        std::iota(indices.begin(), indices.end(), 0);
-        if (docImpMethod != EDocumentStrengthType::Raw) {
-            Sort(indices.begin(), indices.end(), [&](ui32 first, ui32 second) {
-                return Abs(preprocessedImportancesRef[first]) > Abs(preprocessedImportancesRef[second]);
-            });
-        }
-
-        std::function<bool(double)> predicate;
-        if (importanceValuesSign == EImportanceValuesSign::Positive) {
-            predicate = [](double v){return v > 0;};
-        } else if (importanceValuesSign == EImportanceValuesSign::Negative) {
-            predicate = [](double v){return v < 0;};
-        } else {
-            Y_ASSERT(importanceValuesSign == EImportanceValuesSign::All);
-            predicate = [](double){return true;};
-        }
+    NPar::TLocalExecutor::TExecRangeParams testBlockParams(0, testDocCount);
+    if (testDocCount != 0) {
+        testBlockParams.SetBlockCount(localExecutor->GetThreadCount() + 1);
+    }
 
-        int currentSize = 0;
-        for (ui32 i = 0; i < docCount; ++i) {
-            if (currentSize == topSize) {
-                break;
+    leafInfluenceEvaluator->ProcessDocumentImportancesByBlocks(
+        testProcessedData,
+        [&] (ui32 trainDocStart, TVector<TVector<double>>* blockImportances) {
+            const ui32 trainDocEnd = trainDocStart + blockImportances->size();
+            if (docImpMethod == EDocumentStrengthType::Average) {
+                for (ui32 trainDocId = trainDocStart; trainDocId < trainDocEnd; ++trainDocId) {
+                    for (ui32 testDocId = 0; testDocId < testDocCount; ++testDocId) {
+                        averageImportances[trainDocId] += (*blockImportances)[trainDocId - trainDocStart][testDocId];
+                    }
+                }
+                return;
             }
-            if (predicate(preprocessedImportancesRef[indices[i]])) {
-                result.Scores[testDocId].push_back(preprocessedImportancesRef[indices[i]]);
-                result.Indices[testDocId].push_back(indices[i]);
+            if (testDocCount == 0) {
+                return;
             }
-            ++currentSize;
+            localExecutor->ExecRange([&] (int testBlockId) {
+                const ui32 testDocBlockStart = testBlockId * testBlockParams.GetBlockSize();
+                const ui32 testDocBlockEnd = Min<ui32>(testDocBlockStart + testBlockParams.GetBlockSize(), testDocCount);
+                for (ui32 trainDocId = trainDocStart; trainDocId < trainDocEnd; ++trainDocId) {
+                    const TVector<double>& importances = (*blockImportances)[trainDocId - trainDocStart];
+                    for (ui32 testDocId = testDocBlockStart; testDocId < testDocBlockEnd; ++testDocId) {
+                        topImportances[testDocId].Add(trainDocId, importances[testDocId]);
+                    }
+                }
+            }, 0, testBlockParams.GetBlockCount(), NPar::TLocalExecutor::WAIT_COMPLETE);
+        },
+        logPeriod
+    );
+
+    if (docImpMethod == EDocumentStrengthType::Average) {
+        for (ui32 trainDocId = 0; trainDocId < trainDocCount; ++trainDocId) {
+            averageImportances[trainDocId] /= testDocCount;
+            topImportances[0].Add(trainDocId, averageImportances[trainDocId]);
         }
     }
+
+    std::function<bool(double)> predicate;
+    if (importanceValuesSign == EImportanceValuesSign::Positive) {
+        predicate = [](double v){return v > 0;};
+    } else if (importanceValuesSign == EImportanceValuesSign::Negative) {
+        predicate = [](double v){return v < 0;};
+    } else {
+        Y_ASSERT(importanceValuesSign == EImportanceValuesSign::All);
+        predicate = [](double){return true;};
+    }
+
+    TDStrResult result(topImportances.size());
+    localExecutor->ExecRange([&] (int testDocId) {
+        topImportances[testDocId].GetResult(predicate, &result.Indices[testDocId], &result.Scores[testDocId]);
+    }, 0, topImportances.size(), NPar::TLocalExecutor::WAIT_COMPLETE);
     return result;
 }
 
@@ -159,8 +231,15 @@ TDStrResult GetDocumentImportances(
     ExecuteTasksInParallel(&tasks, localExecutor.Get());
 
     TDocumentImportancesEvaluator leafInfluenceEvaluator(model, *trainProcessedData, updateMethod, localExecutor, logPeriod);
-    const TVector<TVector<double>> documentImportances
-        = leafInfluenceEvaluator.GetDocumentImportances(*testProcessedData, logPeriod);
-    return GetFinalDocumentImportances(documentImportances, dstrType, topSize, importanceValuesSign);
+    return GetFinalDocumentImportances(
+        &leafInfluenceEvaluator,
+        *testProcessedData,
+        trainProcessedData->GetObjectCount(),
+        dstrType,
+        topSize,
+        importanceValuesSign,
+        localExecutor.Get(),
+        logPeriod
+    );
 }
 
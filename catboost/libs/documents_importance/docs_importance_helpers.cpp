@@ -20,6 +20,24 @@ using namespace NCB;
 
 TVector<TVector<double>> TDocumentImportancesEvaluator::GetDocumentImportances(
     const TProcessedDataProvider& processedData, int logPeriod
+) {
+    TVector<TVector<double>> documentImportances(DocCount);
+    ProcessDocumentImportancesByBlocks(
+        processedData,
+        [&] (ui32 trainDocStart, TVector<TVector<double>>* blockImportances) {
+            for (ui32 idx = 0; idx < blockImportances->size(); ++idx) {
+                documentImportances[trainDocStart + idx] = std::move((*blockImportances)[idx]);
+            }
+        },
+        logPeriod
+    );
+    return documentImportances;
+}
+
+void TDocumentImportancesEvaluator::ProcessDocumentImportancesByBlocks(
+    const TProcessedDataProvider& processedData,
+    const std::function<void(ui32, TVector<TVector<double>>*)>& processBlock,
+    int logPeriod
 ) {
     const auto* rawObjectsData = dynamic_cast<TRawObjectsDataProvider*>(processedData.ObjectsData.Get());
     CB_ENSURE(rawObjectsData, "Quantized datasets are not supported yet");
@@ -32,8 +50,8 @@ TVector<TVector<double>> TDocumentImportancesEvaluator::GetDocumentImportances(
 
 
     UpdateFinalFirstDerivatives(leafIndices, GetTarget(processedData.TargetData));
-    TVector<TVector<double>> documentImportances(DocCount, TVector<double>(processedData.GetObjectCount()));
     const size_t docBlockSize = 1000;
+    TVector<TVector<double>> blockImportances;
     TImportanceLogger documentsLogger(DocCount, "documents processed", "Processing documents...", logPeriod);
     TProfileInfo processDocumentsProfile(DocCount);
 
@@ -41,18 +59,21 @@ TVector<TVector<double>> TDocumentImportancesEvaluator::GetDocumentImportances(
         const size_t end = Min<size_t>(start + docBlockSize, DocCount);
         processDocumentsProfile.StartIterationBlock();
 
+        blockImportances.resize(end - start);
         LocalExecutor->ExecRange([&] (int docId) {
             // The derivative of leaf values with respect to train doc weight.
             TVector<TVector<TVector<double>>> leafDerivatives(TreeCount, TVector<TVector<double>>(LeavesEstimationIterations)); // [treeCount][LeavesEstimationIterationsCount][leafCount]
             UpdateLeavesDerivatives(docId, &leafDerivatives);
-            GetDocumentImportancesForOneTrainDoc(leafDerivatives, leafIndices, &documentImportances[docId]);
+            TVector<double>& documentImportance = blockImportances[docId - start];
+            documentImportance.resize(processedData.GetObjectCount());
+            GetDocumentImportancesForOneTrainDoc(leafDerivatives, leafIndices, &documentImportance);
         }, NPar::TLocalExecutor::TExecRangeParams(start, end), NPar::TLocalExecutor::WAIT_COMPLETE);
+        processBlock(start, &blockImportances);
 
         processDocumentsProfile.FinishIterationBlock(end - start);
         auto profileResults = processDocumentsProfile.GetProfileResults();
         documentsLogger.Log(profileResults);
-        }
-    return documentImportances;
+    }
 }
 
 void TDocumentImportancesEvaluator::UpdateFinalFirstDerivatives(const TVector<TVector<ui32>>& leafIndices, TConstArrayRef<float> target) {
@@ -16,6 +16,8 @@
 #include <util/system/types.h>
 #include <util/system/yassert.h>
 
+#include <functional>
+
 
 /*
  * This is the implementation of the LeafInfluence algorithm from the following paper:
@@ -73,6 +75,16 @@ public:
     // Getting the importance of all train objects for all objects from pool.
     TVector<TVector<double>> GetDocumentImportances(const NCB::TProcessedDataProvider& processedData, int logPeriod = 0);
 
+    /* Same as GetDocumentImportances, but importances are passed to processBlock(trainDocStart, &importances)
+     * for consecutive blocks of train objects as importances[trainDocId - trainDocStart][docId],
+     * so only one block is kept in memory.
+     */
+    void ProcessDocumentImportancesByBlocks(
+        const NCB::TProcessedDataProvider& processedData,
+        const std::function<void(ui32, TVector<TVector<double>>*)>& processBlock,
+        int logPeriod = 0
+    );
+
 private:
     // Evaluate first derivatives at the final approxes
     void UpdateFinalFirstDerivatives(const TVector<TVector<ui32>>& leafIndices, TConstArrayRef<float> target);
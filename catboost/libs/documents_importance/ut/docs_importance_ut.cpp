@@ -0,0 +1,161 @@
+#include <catboost/libs/documents_importance/docs_importance.h>
+#include <catboost/libs/documents_importance/docs_importance_helpers.h>
+
+#include <catboost/libs/algo/ut/lib/random_data.h>
+#include <catboost/libs/target/data_providers.h>
+
+#include <library/threading/local_executor/local_executor.h>
+#include <library/unittest/registar.h>
+
+#include <util/generic/algorithm.h>
+#include <util/generic/xrange.h>
+#include <util/generic/ymath.h>
+
+#include <numeric>
+
+
+using namespace NCB;
+using namespace NCB::NAlgoUT;
+
+
+static TDataProviderPtr CreateRandomRegressionDataProvider(ui32 objectCount, ui64 seed) {
+    TRandomDataSpec spec;
+    spec.ObjectCount = objectCount;
+    spec.DenseFeatureCount = 4;
+    spec.TargetNoiseShare = 0.2f;
+    spec.Seed = seed;
+    return CreateRandomDataProvider(spec);
+}
+
+// returned: importances[trainDocId][testDocId]
+static TVector<TVector<double>> CalcAllDocumentImportances(
+    const TFullModel& model,
+    const TDataProvider& trainData,
+    const TDataProvider& testData,
+    int threadCount
+) {
+    auto localExecutor = MakeAtomicShared<NPar::TLocalExecutor>();
+    localExecutor->RunAdditionalThreads(threadCount - 1);
+
+    TRestorableFastRng64 rand(0);
+    const auto trainProcessedData = CreateModelCompatibleProcessedDataProvider(
+        trainData,
+        {},
+        model,
+        &rand,
+        localExecutor.Get()
+    );
+    const auto testProcessedData = CreateModelCompatibleProcessedDataProvider(
+        testData,
+        {},
+        model,
+        &rand,
+        localExecutor.Get()
+    );
+    TDocumentImportancesEvaluator evaluator(
+        model,
+        trainProcessedData,
+        TUpdateMethod(EUpdateType::SinglePoint),
+        localExecutor,
+        /*logPeriod*/ 0
+    );
+    return evaluator.GetDocumentImportances(testProcessedData);
+}
+
+// selection of top importances from the full train x test matrix, objects with equal importance are ordered by index
+static TDStrResult SelectTopDocumentImportances(
+    const TVector<TVector<double>>& allImportances,
+    EDocumentStrengthType dstrType,
+    int topSize
+) {
+    const ui32 trainDocCount = allImportances.size();
+    const ui32 testDocCount = allImportances[0].size();
+    if (topSize == -1) {
+        topSize = trainDocCount;
+    }
+
+    TVector<TVector<double>> importances;
+    if (dstrType == EDocumentStrengthType::Average) {
+        importances.assign(1, TVector<double>(trainDocCount, 0.0));
+        for (auto trainDocId : xrange(trainDocCount)) {
+            for (auto testDocId : xrange(testDocCount)) {
+                importances[0][trainDocId] += allImportances[trainDocId][testDocId];
+            }
+            importances[0][trainDocId] /= testDocCount;
+        }
+    } else {
+        importances.assign(testDocCount, TVector<double>(trainDocCount));
+        for (auto trainDocId : xrange(trainDocCount)) {
+            for (auto testDocId : xrange(testDocCount)) {
+                importances[testDocId][trainDocId] = allImportances[trainDocId][testDocId];
+            }
+        }
+    }
+
+    TDStrResult result(importances.size());
+    for (auto resultIdx : xrange(importances.size())) {
+        const TVector<double>& rowImportances = importances[resultIdx];
+        TVector<ui32> indices(trainDocCount);
+        std::iota(indices.begin(), indices.end(), 0);
+        if (dstrType != EDocumentStrengthType::Raw) {
+            StableSort(indices.begin(), indices.end(), [&] (ui32 left, ui32 right) {
+                return Abs(rowImportances[left]) > Abs(rowImportances[right]);
+            });
+        }
+        for (auto i : xrange(Min<ui32>(topSize, trainDocCount))) {
+            result.Indices[resultIdx].push_back(indices[i]);
+            result.Scores[resultIdx].push_back(rowImportances[indices[i]]);
+        }
+    }
+    return result;
+}
+
+static void CheckTopDocumentImportances(ui32 trainDocCount, ui32 testDocCount) {
+    const auto trainData = CreateRandomRegressionDataProvider(trainDocCount, /*seed*/ 0);
+    const auto testData = CreateRandomRegressionDataProvider(testDocCount, /*seed*/ 1);
+    const TFullModel model = TrainRandomModel(trainData);
+    const int threadCount = 4;
+
+    const auto allImportances = CalcAllDocumentImportances(model, *trainData, *testData, threadCount);
+    UNIT_ASSERT_VALUES_EQUAL(allImportances.size(), trainDocCount);
+
+    for (auto dstrType : {EDocumentStrengthType::Average, EDocumentStrengthType::PerObject, EDocumentStrengthType::Raw}) {
+        for (int topSize : {-1, 1, static_cast<int>(trainDocCount) + 10}) {
+            const TDStrResult expected = SelectTopDocumentImportances(allImportances, dstrType, topSize);
+            const TDStrResult result = GetDocumentImportances(
+                model,
+                *trainData,
+                *testData,
+                ToString(dstrType),
+                topSize,
+                "SinglePoint",
+                "All",
+                threadCount
+            );
+            UNIT_ASSERT_VALUES_EQUAL(result.Indices, expected.Indices);
+            UNIT_ASSERT_VALUES_EQUAL(result.Scores.size(), expected.Scores.size());
+            for (auto resultIdx : xrange(expected.Scores.size())) {
+                UNIT_ASSERT_VALUES_EQUAL(result.Scores[resultIdx].size(), expected.Scores[resultIdx].size());
+                for (auto i : xrange(expected.Scores[resultIdx].size())) {
+                    const double expectedScore = expected.Scores[resultIdx][i];
+                    UNIT_ASSERT_DOUBLES_EQUAL(
+                        result.Scores[resultIdx][i],
+                        expectedScore,
+                        1e-9 * Max(1.0, Abs(expectedScore))
+                    );
+                }
+            }
+        }
+    }
+}
+
+Y_UNIT_TEST_SUITE(TDocumentImportancesTest) {
+    Y_UNIT_TEST(TestTopDocumentImportances) {
+        CheckTopDocumentImportances(/*trainDocCount*/ 300, /*testDocCount*/ 50);
+    }
+
+    Y_UNIT_TEST(TestTopDocumentImportancesByBlocks) {
+        // train objects are processed in blocks of 1000
+        CheckTopDocumentImportances(/*trainDocCount*/ 2500, /*testDocCount*/ 20);
+    }
+}
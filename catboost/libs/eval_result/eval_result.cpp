@@ -148,9 +148,9 @@ namespace NCB {
     ) {
         TIntrusivePtr<IPoolColumnsPrinter> poolColumnsPrinter;
         if (testSetPath.Inited()) {
-            if (testSetPath.Scheme == "quantized") {
+            if (testSetPath.Scheme == "quantized" || testSetPath.Scheme.StartsWith("quantized-mmap")) {
                 poolColumnsPrinter = TIntrusivePtr<IPoolColumnsPrinter>(new TQuantizedPoolColumnsPrinter(testSetPath));
-            } else if (testSetPath.Scheme == "dsv" || testSetPath.Scheme == "yt-dsv") {
+            } else if (testSetPath.Scheme == "dsv" || testSetPath.Scheme == "mmap-dsv" || testSetPath.Scheme == "yt-dsv") {
                 poolColumnsPrinter = TIntrusivePtr<IPoolColumnsPrinter>(new TDSVPoolColumnsPrinter(testSetPath, testSetFormat, columnsMetaInfo));
             }
         }
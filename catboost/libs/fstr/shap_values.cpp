@@ -7,11 +7,18 @@
 #include <catboost/libs/helpers/exception.h>
 #include <catboost/libs/loggers/logger.h>
 #include <catboost/libs/logging/profile_info.h>
+#include <catboost/libs/model/formula_evaluator.h>
 #include <catboost/libs/options/restrictions.h>
 
+#include <library/threading/future/future.h>
+
+#include <util/digest/city.h>
 #include <util/generic/algorithm.h>
 #include <util/generic/utility.h>
 #include <util/generic/ymath.h>
+#include <util/stream/file.h>
+#include <util/ysaveload.h>
+#include <util/stream/str.h>
 
 
 using namespace NCB;
@@ -409,6 +416,8 @@ void CalcShapValuesForDocumentMulti(
     }
 }
 
+// calls processDocument(documentIdxInBlock, &shapValues) for each document of the block in parallel
+template <class TProcessDocumentFunc>
 static void CalcShapValuesForDocumentBlockMulti(
     const TFullModel& model,
     const TObjectsDataProvider& objectsData,
@@ -416,38 +425,90 @@ static void CalcShapValuesForDocumentBlockMulti(
     size_t start,
     size_t end,
     NPar::TLocalExecutor* localExecutor,
-    TVector<TVector<TVector<double>>>* shapValuesForAllDocuments
+    TProcessDocumentFunc processDocument
 ) {
     const auto* rawObjectsData = dynamic_cast<const TRawObjectsDataProvider*>(&objectsData);
     CB_ENSURE(rawObjectsData, "Quantized datasets are not supported yet");
 
     const TObliviousTrees& forest = model.ObliviousTrees;
-    const size_t documentCount = end - start;
-
-    TVector<ui8> binarizedFeaturesForBlock = BinarizeFeatures(model, *rawObjectsData, start, end);
-
+    const int approxDimension = forest.ApproxDimension;
+    const size_t treeCount = forest.GetTreeCount();
+    const bool needXorMask = !forest.OneHotFeatures.empty();
     const int flatFeatureCount = objectsData.GetFeaturesLayout()->GetExternalFeatureCount();
 
-    const int oldShapValuesSize = shapValuesForAllDocuments->size();
-    shapValuesForAllDocuments->resize(oldShapValuesSize + end - start);
+    // leaf indexes are calculated by the same kernel as in model evaluation, for a small subblock at a time
+    const size_t subblockSize = FORMULA_EVALUATION_BLOCK_SIZE;
+    const int subblockCount = (end - start + subblockSize - 1) / subblockSize;
 
-    NPar::TLocalExecutor::TExecRangeParams blockParams(0, documentCount);
-    localExecutor->ExecRange([&] (size_t documentIdx) {
-        TVector<TVector<double>>& shapValues = (*shapValuesForAllDocuments)[oldShapValuesSize + documentIdx];
+    NPar::TLocalExecutor::TExecRangeParams blockParams(0, subblockCount);
+    localExecutor->ExecRange([&] (int subblockIdx) {
+        const size_t subblockStart = start + subblockIdx * subblockSize;
+        const size_t subblockEnd = Min(subblockStart + subblockSize, end);
+        const size_t documentCount = subblockEnd - subblockStart;
 
-        CalcShapValuesForDocumentMulti(
-            forest,
-            preparedTrees,
-            binarizedFeaturesForBlock,
-            flatFeatureCount,
-            documentIdx,
+        const TVector<ui8> binarizedFeatures = BinarizeFeatures(model, *rawObjectsData, subblockStart, subblockEnd);
+
+        TVector<TVector<TVector<double>>> shapValues(
             documentCount,
-            &shapValues
+            TVector<TVector<double>>(approxDimension, TVector<double>(flatFeatureCount + 1, 0.0))
         );
+        TVector<ui32> leafIndexes(documentCount);
+        for (size_t treeIdx = 0; treeIdx < treeCount; ++treeIdx) {
+            Fill(leafIndexes.begin(), leafIndexes.end(), 0);
+            CalcIndexes(
+                needXorMask,
+                binarizedFeatures.data(),
+                documentCount,
+                leafIndexes.data(),
+                forest.GetRepackedBins().data() + forest.TreeStartOffsets[treeIdx],
+                forest.TreeSizes[treeIdx]
+            );
+            const auto& shapValuesByLeaf = preparedTrees.ShapValuesByLeafForAllTrees[treeIdx];
+            const auto& meanValue = preparedTrees.MeanValuesForAllTrees[treeIdx];
+            for (size_t documentIdx = 0; documentIdx < documentCount; ++documentIdx) {
+                auto& documentShapValues = shapValues[documentIdx];
+                for (const TShapValue& shapValue : shapValuesByLeaf[leafIndexes[documentIdx]]) {
+                    for (int dimension = 0; dimension < approxDimension; ++dimension) {
+                        documentShapValues[dimension][shapValue.Feature] += shapValue.Value[dimension];
+                    }
+                }
+                for (int dimension = 0; dimension < approxDimension; ++dimension) {
+                    documentShapValues[dimension][flatFeatureCount] += meanValue[dimension];
+                }
+            }
+        }
 
+        for (size_t documentIdx = 0; documentIdx < documentCount; ++documentIdx) {
+            processDocument(subblockStart - start + documentIdx, &shapValues[documentIdx]);
+        }
     }, blockParams, NPar::TLocalExecutor::WAIT_COMPLETE);
 }
 
+static void CalcShapValuesForDocumentBlockMulti(
+    const TFullModel& model,
+    const TObjectsDataProvider& objectsData,
+    const TShapPreparedTrees& preparedTrees,
+    size_t start,
+    size_t end,
+    NPar::TLocalExecutor* localExecutor,
+    TVector<TVector<TVector<double>>>* shapValuesForAllDocuments
+) {
+    const int oldShapValuesSize = shapValuesForAllDocuments->size();
+    shapValuesForAllDocuments->resize(oldShapValuesSize + end - start);
+
+    CalcShapValuesForDocumentBlockMulti(
+        model,
+        objectsData,
+        preparedTrees,
+        start,
+        end,
+        localExecutor,
+        [&] (int documentIdx, TVector<TVector<double>>* shapValues) {
+            (*shapValuesForAllDocuments)[oldShapValuesSize + documentIdx] = std::move(*shapValues);
+        }
+    );
+}
+
 static void CalcShapValuesByLeafForTreeBlock(
     const TObliviousTrees& forest,
     const TVector<TVector<double>>& leafWeights,
@@ -497,9 +558,9 @@ static void WarnForComplexCtrs(const TObliviousTrees& forest) {
     }
 }
 
-static TShapPreparedTrees PrepareTrees(
+TShapPreparedTrees PrepareTrees(
     const TFullModel& model,
-    const TDataProvider* dataset, // can be nullptr if model has LeafWeights
+    const TDataProvider* dataset,
     int logPeriod,
     NPar::TLocalExecutor* localExecutor
 ) {
@@ -559,6 +620,54 @@ TShapPreparedTrees PrepareTrees(const TFullModel& model, NPar::TLocalExecutor* l
     return PrepareTrees(model, nullptr, 0, localExecutor);
 }
 
+static void CheckPreparedTrees(const TFullModel& model, const TShapPreparedTrees& preparedTrees) {
+    const TObliviousTrees& forest = model.ObliviousTrees;
+    CB_ENSURE(
+        preparedTrees.ShapValuesByLeafForAllTrees.size() == forest.GetTreeCount()
+            && preparedTrees.MeanValuesForAllTrees.size() == forest.GetTreeCount(),
+        "Prepared SHAP trees do not match the model: different tree count"
+    );
+    for (size_t treeIdx = 0; treeIdx < forest.GetTreeCount(); ++treeIdx) {
+        CB_ENSURE(
+            preparedTrees.ShapValuesByLeafForAllTrees[treeIdx].size() == (size_t(1) << forest.TreeSizes[treeIdx])
+                && preparedTrees.MeanValuesForAllTrees[treeIdx].ysize() == forest.ApproxDimension,
+            "Prepared SHAP trees do not match the model: different tree " << treeIdx
+        );
+    }
+}
+
+ui64 CalcShapPreparedTreesModelHash(const TFullModel& model) {
+    TStringStream modelStream;
+    model.Save(&modelStream);
+    return CityHash64(modelStream.Str());
+}
+
+void SaveShapPreparedTrees(const TFullModel& model, const TShapPreparedTrees& preparedTrees, const TString& path) {
+    CheckPreparedTrees(model, preparedTrees);
+    TOFStream out(path);
+    ::SaveMany(&out, SHAP_PREPARED_TREES_FORMAT_VERSION, CalcShapPreparedTreesModelHash(model), preparedTrees);
+}
+
+TShapPreparedTrees LoadShapPreparedTrees(const TFullModel& model, const TString& path) {
+    TIFStream in(path);
+    ui32 formatVersion = 0;
+    ui64 modelHash = 0;
+    TShapPreparedTrees preparedTrees;
+    ::Load(&in, formatVersion);
+    CB_ENSURE(
+        formatVersion == SHAP_PREPARED_TREES_FORMAT_VERSION,
+        "Unsupported prepared SHAP trees format version " << formatVersion
+    );
+    ::Load(&in, modelHash);
+    CB_ENSURE(
+        modelHash == CalcShapPreparedTreesModelHash(model),
+        "Prepared SHAP trees from " << path << " were prepared for another model"
+    );
+    ::Load(&in, preparedTrees);
+    CheckPreparedTrees(model, preparedTrees);
+    return preparedTrees;
+}
+
 TVector<TVector<TVector<double>>> CalcShapValuesMulti(
     const TFullModel& model,
     const TDataProvider& dataset,
@@ -571,6 +680,17 @@ TVector<TVector<TVector<double>>> CalcShapValuesMulti(
         logPeriod,
         localExecutor
     );
+    return CalcShapValuesMulti(model, preparedTrees, dataset, logPeriod, localExecutor);
+}
+
+TVector<TVector<TVector<double>>> CalcShapValuesMulti(
+    const TFullModel& model,
+    const TShapPreparedTrees& preparedTrees,
+    const TDataProvider& dataset,
+    int logPeriod,
+    NPar::TLocalExecutor* localExecutor
+) {
+    CheckPreparedTrees(model, preparedTrees);
 
     const size_t documentCount = dataset.ObjectsGrouping->GetObjectCount();
     const size_t documentBlockSize = CB_THREAD_LIMIT; // least necessary for threading
@@ -626,23 +746,58 @@ TVector<TVector<double>> CalcShapValues(
     return shapValues;
 }
 
-static void OutputShapValuesMulti(const TVector<TVector<TVector<double>>>& shapValues, TFileOutput& out) {
-    for (const auto& shapValuesForDocument : shapValues) {
-        for (const auto& shapValuesForClass : shapValuesForDocument) {
-            int valuesCount = shapValuesForClass.size();
+template <class T>
+static inline void WriteBinary(const T& value, IOutputStream* out) {
+    out->Write(&value, sizeof(value));
+}
+
+static void OutputShapValuesForDocument(
+    const TVector<TVector<double>>& shapValues,
+    EShapValuesOutputFormat format,
+    ui32 topSize,
+    IOutputStream* out
+) {
+    for (const auto& shapValuesForClass : shapValues) {
+        const int valuesCount = shapValuesForClass.size();
+        if (format == EShapValuesOutputFormat::Tsv) {
             for (int valueIdx = 0; valueIdx < valuesCount; ++valueIdx) {
-                out << shapValuesForClass[valueIdx] << (valueIdx + 1 == valuesCount ? '\n' : '\t');
+                *out << shapValuesForClass[valueIdx] << (valueIdx + 1 == valuesCount ? '\n' : '\t');
+            }
+        } else if (topSize == 0) {
+            for (double value : shapValuesForClass) {
+                WriteBinary<float>(value, out);
+            }
+        } else {
+            // last value is expected value of the model, it is written always
+            const int featureCount = valuesCount - 1;
+            TVector<int> topFeatures(featureCount);
+            Iota(topFeatures.begin(), topFeatures.end(), 0);
+            const auto byAbsValue = [&] (int left, int right) {
+                const double leftAbsValue = Abs(shapValuesForClass[left]);
+                const double rightAbsValue = Abs(shapValuesForClass[right]);
+                return leftAbsValue > rightAbsValue || (leftAbsValue == rightAbsValue && left < right);
+            };
+            PartialSort(topFeatures.begin(), topFeatures.begin() + topSize, topFeatures.end(), byAbsValue);
+            WriteBinary<float>(shapValuesForClass[featureCount], out);
+            for (ui32 topIdx = 0; topIdx < topSize; ++topIdx) {
+                WriteBinary<ui32>(topFeatures[topIdx], out);
+                WriteBinary<float>(shapValuesForClass[topFeatures[topIdx]], out);
             }
         }
     }
 }
 
+// documents are serialized in parallel and previous block is written while next one is calculated
+static constexpr size_t SHAP_VALUES_OUTPUT_BLOCK_VALUE_COUNT = 1 << 22;
+
 void CalcAndOutputShapValues(
     const TFullModel& model,
     const TDataProvider& dataset,
     const TString& outputPath,
     int logPeriod,
-    NPar::TLocalExecutor* localExecutor
+    NPar::TLocalExecutor* localExecutor,
+    EShapValuesOutputFormat format,
+    ui32 topSize
 ) {
     TShapPreparedTrees preparedTrees = PrepareTrees(
         model,
@@ -650,36 +805,107 @@ void CalcAndOutputShapValues(
         logPeriod,
         localExecutor
     );
+    CalcAndOutputShapValues(model, preparedTrees, dataset, outputPath, logPeriod, localExecutor, format, topSize);
+}
+
+void CalcAndOutputShapValues(
+    const TFullModel& model,
+    const TShapPreparedTrees& preparedTrees,
+    const TDataProvider& dataset,
+    const TString& outputPath,
+    int logPeriod,
+    NPar::TLocalExecutor* localExecutor,
+    EShapValuesOutputFormat format,
+    ui32 topSize
+) {
+    CB_ENSURE(
+        topSize == 0 || format == EShapValuesOutputFormat::Binary,
+        "Top of SHAP values is supported only for binary output format"
+    );
+    CheckPreparedTrees(model, preparedTrees);
 
     const size_t documentCount = dataset.ObjectsGrouping->GetObjectCount();
-    const size_t documentBlockSize = CB_THREAD_LIMIT; // least necessary for threading
+    const ui32 approxDimension = model.ObliviousTrees.ApproxDimension;
+    const ui32 flatFeatureCount = dataset.ObjectsData->GetFeaturesLayout()->GetExternalFeatureCount();
+    topSize = Min(topSize, flatFeatureCount);
+    const size_t documentBlockSize = Max<size_t>(
+        CB_THREAD_LIMIT, // least necessary for threading
+        SHAP_VALUES_OUTPUT_BLOCK_VALUE_COUNT / (approxDimension * (flatFeatureCount + 1))
+    );
 
     TImportanceLogger documentsLogger(documentCount, "documents processed", "Processing documents...", logPeriod);
 
     TProfileInfo processDocumentsProfile(documentCount);
 
     TFileOutput out(outputPath);
-    for (size_t start = 0; start < documentCount; start += documentBlockSize) {
-        size_t end = Min(start + documentBlockSize, documentCount);
-        processDocumentsProfile.StartIterationBlock();
+    if (format == EShapValuesOutputFormat::Binary) {
+        WriteBinary<ui32>(SHAP_VALUES_BINARY_FORMAT_VERSION, &out);
+        WriteBinary<ui64>(documentCount, &out);
+        WriteBinary<ui32>(approxDimension, &out);
+        WriteBinary<ui32>(flatFeatureCount + 1, &out);
+        WriteBinary<ui32>(topSize, &out);
+    }
 
-        TVector<TVector<TVector<double>>> shapValuesForBlock;
-        shapValuesForBlock.reserve(end - start);
+    TVector<TString> serializedBlock;
+    TVector<TString> writtenBlock;
+    NThreading::TFuture<void> writeFuture;
+    const auto writeBlock = [&] (int) {
+        for (const auto& serializedDocument : writtenBlock) {
+            out.Write(serializedDocument.data(), serializedDocument.size());
+        }
+    };
+    const auto waitWrite = [&] () {
+        if (writeFuture.Initialized()) {
+            writeFuture.GetValueSync(); // will rethrow if there was an exception during write
+            writeFuture = NThreading::TFuture<void>();
+        }
+    };
 
-        CalcShapValuesForDocumentBlockMulti(
-            model,
-            *dataset.ObjectsData,
-            preparedTrees,
-            start,
-            end,
-            localExecutor,
-            &shapValuesForBlock
-        );
+    try {
+        for (size_t start = 0; start < documentCount; start += documentBlockSize) {
+            size_t end = Min(start + documentBlockSize, documentCount);
+            processDocumentsProfile.StartIterationBlock();
+
+            serializedBlock.resize(end - start);
+            CalcShapValuesForDocumentBlockMulti(
+                model,
+                *dataset.ObjectsData,
+                preparedTrees,
+                start,
+                end,
+                localExecutor,
+                [&] (int documentIdx, TVector<TVector<double>>* shapValues) {
+                    serializedBlock[documentIdx].clear();
+                    TStringOutput documentOut(serializedBlock[documentIdx]);
+                    OutputShapValuesForDocument(*shapValues, format, topSize, &documentOut);
+                }
+            );
 
-        OutputShapValuesMulti(shapValuesForBlock, out);
+            waitWrite();
+            serializedBlock.swap(writtenBlock);
+            if (localExecutor->GetThreadCount() > 0) {
+                auto writeFutures = localExecutor->ExecRangeWithFutures(
+                    writeBlock,
+                    0,
+                    1,
+                    NPar::TLocalExecutor::HIGH_PRIORITY
+                );
+                Y_VERIFY(writeFutures.size() == 1);
+                writeFuture = std::move(writeFutures[0]);
+            } else {
+                writeBlock(0);
+            }
 
-        processDocumentsProfile.FinishIterationBlock(end - start);
-        auto profileResults = processDocumentsProfile.GetProfileResults();
-        documentsLogger.Log(profileResults);
+            processDocumentsProfile.FinishIterationBlock(end - start);
+            auto profileResults = processDocumentsProfile.GetProfileResults();
+            documentsLogger.Log(profileResults);
+        }
+        waitWrite();
+    } catch (...) {
+        // make sure that async write which uses writtenBlock and out has finished
+        if (writeFuture.Initialized()) {
+            writeFuture.Wait();
+        }
+        throw;
     }
 }
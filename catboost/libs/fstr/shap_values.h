@@ -2,6 +2,7 @@
 
 #include <catboost/libs/data_new/data_provider.h>
 #include <catboost/libs/model/model.h>
+#include <catboost/libs/options/enums.h>
 
 #include <library/threading/local_executor/local_executor.h>
 
@@ -59,6 +60,27 @@ void CalcShapValuesForDocumentMulti(
 
 TShapPreparedTrees PrepareTrees(const TFullModel& model, NPar::TLocalExecutor* localExecutor);
 
+TShapPreparedTrees PrepareTrees(
+    const TFullModel& model,
+    const NCB::TDataProvider* dataset, // can be nullptr if model has LeafWeights
+    int logPeriod,
+    NPar::TLocalExecutor* localExecutor
+);
+
+/* Prepared trees depend only on the model (and on the dataset if the model has no LeafWeights),
+ * so they can be calculated once, saved and then used for many calculations of SHAP values
+ * which are reduced to leaf indexes calculation as in model evaluation.
+ * The file header contains the hash of the serialized model the trees were prepared for.
+ */
+constexpr ui32 SHAP_PREPARED_TREES_FORMAT_VERSION = 2;
+
+ui64 CalcShapPreparedTreesModelHash(const TFullModel& model);
+
+void SaveShapPreparedTrees(const TFullModel& model, const TShapPreparedTrees& preparedTrees, const TString& path);
+
+// checks that loaded trees were prepared for the model
+TShapPreparedTrees LoadShapPreparedTrees(const TFullModel& model, const TString& path);
+
 // returned: ShapValues[documentIdx][dimenesion][feature]
 TVector<TVector<TVector<double>>> CalcShapValuesMulti(
     const TFullModel& model,
@@ -67,6 +89,14 @@ TVector<TVector<TVector<double>>> CalcShapValuesMulti(
     NPar::TLocalExecutor* localExecutor
 );
 
+TVector<TVector<TVector<double>>> CalcShapValuesMulti(
+    const TFullModel& model,
+    const TShapPreparedTrees& preparedTrees,
+    const NCB::TDataProvider& dataset,
+    int logPeriod,
+    NPar::TLocalExecutor* localExecutor
+);
+
 // returned: ShapValues[documentIdx][feature]
 TVector<TVector<double>> CalcShapValues(
     const TFullModel& model,
@@ -75,11 +105,38 @@ TVector<TVector<double>> CalcShapValues(
     NPar::TLocalExecutor* localExecutor
 );
 
-// outputs for each document in order for each dimension in order an array of feature contributions
+constexpr ui32 SHAP_VALUES_BINARY_FORMAT_VERSION = 1;
+
+/* outputs for each document in order for each dimension in order an array of feature contributions,
+ * last value in array is expected value of the model
+ *
+ * Tsv format: a line of tab-separated values per array
+ *
+ * Binary format, little-endian:
+ *   header: ui32 version, ui64 document count, ui32 approx dimension, ui32 array size, ui32 topSize
+ *   if topSize == 0: float array for each array
+ *   otherwise: float expected value followed by topSize (ui32 feature, float value) pairs
+ *     of the features with the largest absolute values for each array
+ *
+ * memory used is proportional to the size of documents block, not to the document count
+ */
 void CalcAndOutputShapValues(
     const TFullModel& model,
     const NCB::TDataProvider& dataset,
     const TString& outputPath,
     int logPeriod,
-    NPar::TLocalExecutor* localExecutor
+    NPar::TLocalExecutor* localExecutor,
+    EShapValuesOutputFormat format = EShapValuesOutputFormat::Tsv,
+    ui32 topSize = 0
+);
+
+void CalcAndOutputShapValues(
+    const TFullModel& model,
+    const TShapPreparedTrees& preparedTrees,
+    const NCB::TDataProvider& dataset,
+    const TString& outputPath,
+    int logPeriod,
+    NPar::TLocalExecutor* localExecutor,
+    EShapValuesOutputFormat format = EShapValuesOutputFormat::Tsv,
+    ui32 topSize = 0
 );
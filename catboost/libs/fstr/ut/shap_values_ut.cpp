@@ -0,0 +1,244 @@
+#include <catboost/libs/fstr/shap_values.h>
+
+#include <catboost/libs/algo/ut/lib/random_data.h>
+#include <catboost/libs/helpers/exception.h>
+
+#include <library/threading/local_executor/local_executor.h>
+#include <library/unittest/registar.h>
+
+#include <util/generic/algorithm.h>
+#include <util/generic/xrange.h>
+#include <util/stream/file.h>
+#include <util/string/cast.h>
+#include <util/string/iterator.h>
+#include <util/system/mktemp.h>
+#include <util/system/tempfile.h>
+
+
+using namespace NCB;
+using namespace NCB::NAlgoUT;
+
+
+// features after informativeFeatureCount are constant, they only make SHAP values arrays longer
+static TRandomDataSpec MakeRandomDataSpec(
+    ui32 objectCount,
+    ui32 informativeFeatureCount,
+    ui32 featureCount,
+    ui32 classCount, // 0 for regression
+    ui64 seed
+) {
+    TRandomDataSpec spec;
+    spec.ObjectCount = objectCount;
+    spec.DenseFeatureCount = informativeFeatureCount;
+    spec.ConstFeatureCount = featureCount - informativeFeatureCount;
+    spec.ClassCount = classCount;
+    spec.Seed = seed;
+    return spec;
+}
+
+static NJson::TJsonValue MakeTrainParams(ui32 classCount) {
+    NJson::TJsonValue params;
+    params.InsertValue("loss_function", classCount > 0 ? "MultiClass" : "RMSE");
+    return params;
+}
+
+template <class T>
+static T ReadBinary(IInputStream* in) {
+    T value;
+    UNIT_ASSERT_VALUES_EQUAL(in->Load(&value, sizeof(value)), sizeof(value));
+    return value;
+}
+
+// expected: ShapValues[documentIdx][dimension][feature]
+static void CheckTsvShapValues(const TString& path, const TVector<TVector<TVector<double>>>& expected) {
+    TIFStream in(path);
+    TString line;
+    for (const auto& documentShapValues : expected) {
+        for (const auto& shapValues : documentShapValues) {
+            UNIT_ASSERT(in.ReadLine(line));
+            const TVector<TStringBuf> tokens = StringSplitter(line).Split('\t');
+            UNIT_ASSERT_VALUES_EQUAL(tokens.size(), shapValues.size());
+            for (auto valueIdx : xrange(shapValues.size())) {
+                const double expectedValue = shapValues[valueIdx];
+                UNIT_ASSERT_DOUBLES_EQUAL(
+                    FromString<double>(tokens[valueIdx]),
+                    expectedValue,
+                    1e-6 * Max(1.0, Abs(expectedValue))
+                );
+            }
+        }
+    }
+    UNIT_ASSERT(!in.ReadLine(line));
+}
+
+static void CheckBinaryShapValues(
+    const TString& path,
+    const TVector<TVector<TVector<double>>>& expected,
+    ui32 expectedTopSize
+) {
+    TIFStream in(path);
+    UNIT_ASSERT_VALUES_EQUAL(ReadBinary<ui32>(&in), SHAP_VALUES_BINARY_FORMAT_VERSION);
+    UNIT_ASSERT_VALUES_EQUAL(ReadBinary<ui64>(&in), expected.size());
+    const ui32 approxDimension = ReadBinary<ui32>(&in);
+    const ui32 arraySize = ReadBinary<ui32>(&in);
+    const ui32 topSize = ReadBinary<ui32>(&in);
+    UNIT_ASSERT_VALUES_EQUAL(topSize, expectedTopSize);
+
+    for (const auto& documentShapValues : expected) {
+        UNIT_ASSERT_VALUES_EQUAL(documentShapValues.size(), approxDimension);
+        for (const auto& shapValues : documentShapValues) {
+            UNIT_ASSERT_VALUES_EQUAL(shapValues.size(), arraySize);
+            if (topSize == 0) {
+                for (double value : shapValues) {
+                    UNIT_ASSERT_VALUES_EQUAL(ReadBinary<float>(&in), static_cast<float>(value));
+                }
+                continue;
+            }
+
+            const ui32 featureCount = arraySize - 1;
+            UNIT_ASSERT_VALUES_EQUAL(ReadBinary<float>(&in), static_cast<float>(shapValues[featureCount]));
+            TVector<ui32> features(featureCount);
+            Iota(features.begin(), features.end(), 0);
+            StableSort(
+                features.begin(),
+                features.end(),
+                [&] (ui32 left, ui32 right) { return Abs(shapValues[left]) > Abs(shapValues[right]); }
+            );
+            for (auto topIdx : xrange(topSize)) {
+                UNIT_ASSERT_VALUES_EQUAL(ReadBinary<ui32>(&in), features[topIdx]);
+                UNIT_ASSERT_VALUES_EQUAL(ReadBinary<float>(&in), static_cast<float>(shapValues[features[topIdx]]));
+            }
+        }
+    }
+    char extraByte;
+    UNIT_ASSERT_VALUES_EQUAL(in.Read(&extraByte, 1), size_t(0));
+}
+
+static void CheckOutputShapValues(
+    ui32 objectCount,
+    ui32 informativeFeatureCount,
+    ui32 featureCount,
+    ui32 classCount
+) {
+    const auto dataProvider = CreateRandomDataProvider(MakeRandomDataSpec(
+        objectCount,
+        informativeFeatureCount,
+        featureCount,
+        classCount,
+        /*seed*/ 0
+    ));
+    const TFullModel model = TrainRandomModel(dataProvider, MakeTrainParams(classCount));
+
+    NPar::TLocalExecutor localExecutor;
+    localExecutor.RunAdditionalThreads(3);
+    const auto expected = CalcShapValuesMulti(model, *dataProvider, /*logPeriod*/ 0, &localExecutor);
+
+    TTempFile tsvFile(MakeTempName());
+    CalcAndOutputShapValues(model, *dataProvider, tsvFile.Name(), /*logPeriod*/ 0, &localExecutor);
+    CheckTsvShapValues(tsvFile.Name(), expected);
+
+    TTempFile binaryFile(MakeTempName());
+    CalcAndOutputShapValues(
+        model,
+        *dataProvider,
+        binaryFile.Name(),
+        /*logPeriod*/ 0,
+        &localExecutor,
+        EShapValuesOutputFormat::Binary
+    );
+    CheckBinaryShapValues(binaryFile.Name(), expected, /*expectedTopSize*/ 0);
+
+    // top size larger than feature count is reduced to it
+    for (ui32 topSize : {1u, informativeFeatureCount, featureCount + 1}) {
+        TTempFile topFile(MakeTempName());
+        CalcAndOutputShapValues(
+            model,
+            *dataProvider,
+            topFile.Name(),
+            /*logPeriod*/ 0,
+            &localExecutor,
+            EShapValuesOutputFormat::Binary,
+            topSize
+        );
+        CheckBinaryShapValues(topFile.Name(), expected, Min(topSize, featureCount));
+    }
+}
+
+static void CheckSavedShapPreparedTrees(ui32 classCount) {
+    const auto dataProvider = CreateRandomDataProvider(MakeRandomDataSpec(
+        /*objectCount*/ 300,
+        /*informativeFeatureCount*/ 4,
+        /*featureCount*/ 6,
+        classCount,
+        /*seed*/ 0
+    ));
+    const TFullModel model = TrainRandomModel(dataProvider, MakeTrainParams(classCount));
+
+    NPar::TLocalExecutor localExecutor;
+    localExecutor.RunAdditionalThreads(3);
+    const auto expected = CalcShapValuesMulti(model, *dataProvider, /*logPeriod*/ 0, &localExecutor);
+
+    TTempFile preparedTreesFile(MakeTempName());
+    SaveShapPreparedTrees(model, PrepareTrees(model, &localExecutor), preparedTreesFile.Name());
+    const TShapPreparedTrees preparedTrees = LoadShapPreparedTrees(model, preparedTreesFile.Name());
+    const auto shapValues = CalcShapValuesMulti(
+        model,
+        preparedTrees,
+        *dataProvider,
+        /*logPeriod*/ 0,
+        &localExecutor
+    );
+    UNIT_ASSERT_VALUES_EQUAL(shapValues, expected);
+
+    // same tree shapes, so only the model hash tells the models apart
+    const auto otherDataProvider = CreateRandomDataProvider(MakeRandomDataSpec(
+        /*objectCount*/ 300,
+        /*informativeFeatureCount*/ 4,
+        /*featureCount*/ 6,
+        classCount,
+        /*seed*/ 1
+    ));
+    const TFullModel otherModel = TrainRandomModel(otherDataProvider, MakeTrainParams(classCount));
+    UNIT_ASSERT_EXCEPTION(
+        LoadShapPreparedTrees(otherModel, preparedTreesFile.Name()),
+        TCatBoostException
+    );
+}
+
+Y_UNIT_TEST_SUITE(TShapValuesTest) {
+    Y_UNIT_TEST(TestOutputShapValues) {
+        CheckOutputShapValues(
+            /*objectCount*/ 300,
+            /*informativeFeatureCount*/ 4,
+            /*featureCount*/ 6,
+            /*classCount*/ 0
+        );
+    }
+
+    Y_UNIT_TEST(TestOutputShapValuesMultiClass) {
+        CheckOutputShapValues(
+            /*objectCount*/ 300,
+            /*informativeFeatureCount*/ 4,
+            /*featureCount*/ 6,
+            /*classCount*/ 3
+        );
+    }
+
+    Y_UNIT_TEST(TestOutputShapValuesByBlocks) {
+        // about 4M values per output block, so documents are calculated and written in several blocks
+        CheckOutputShapValues(
+            /*objectCount*/ 5000,
+            /*informativeFeatureCount*/ 4,
+            /*featureCount*/ 1000,
+            /*classCount*/ 0
+        );
+    }
+
+    Y_UNIT_TEST(TestSavedShapPreparedTrees) {
+        CheckSavedShapPreparedTrees(/*classCount*/ 0);
+    }
+
+    Y_UNIT_TEST(TestSavedShapPreparedTreesMultiClass) {
+        CheckSavedShapPreparedTrees(/*classCount*/ 3);
+    }
+}
@@ -3,7 +3,9 @@
 #include <util/generic/algorithm.h>
 #include <util/generic/array_ref.h>
 #include <util/generic/vector.h>
+#include <util/generic/xrange.h>
 
+using NMetrics::TBinClassSample;
 using NMetrics::TSample;
 
 static double MergeAndCountInversions(TVector<TSample>* samples, TVector<TSample>* aux, ui32 lo, ui32 hi, ui32 mid) {
@@ -78,3 +80,151 @@ double CalcAUC(TVector<TSample>* samples, double* outWeightSum, double* outPairW
     return (optimisticAUC + pessimisticAUC) / 2.0;
 }
 
+
+static double SumWeights(TConstArrayRef<TBinClassSample> samples) {
+    double weightSum = 0;
+    for (const auto& sample : samples) {
+        weightSum += sample.Weight;
+    }
+    return weightSum;
+}
+
+static TVector<TArrayRef<TBinClassSample>> SplitIntoBlocks(TVector<TBinClassSample>* samples, int blockCount) {
+    NPar::TLocalExecutor::TExecRangeParams blockParams(0, samples->ysize());
+    blockParams.SetBlockCount(blockCount);
+    TVector<TArrayRef<TBinClassSample>> blocks;
+    for (int blockIdx : xrange(blockParams.GetBlockCount())) {
+        const int blockBegin = blockIdx * blockParams.GetBlockSize();
+        const int blockEnd = Min(blockBegin + blockParams.GetBlockSize(), samples->ysize());
+        blocks.push_back(MakeArrayRef(samples->data() + blockBegin, blockEnd - blockBegin));
+    }
+    return blocks;
+}
+
+// Weight of pairs where positive sample has greater prediction, pairs with equal predictions count as half,
+// samples are sorted by prediction
+static double CountOrderedPairs(TConstArrayRef<TBinClassSample> positives, TConstArrayRef<TBinClassSample> negatives) {
+    double result = 0;
+    size_t lessEnd = 0;
+    double lessWeight = 0;
+    double equalWeight = 0;
+    for (auto positiveIdx : xrange(positives.size())) {
+        const double prediction = positives[positiveIdx].Prediction;
+        if (positiveIdx == 0 || prediction != positives[positiveIdx - 1].Prediction) {
+            while (lessEnd < negatives.size() && negatives[lessEnd].Prediction < prediction) {
+                lessWeight += negatives[lessEnd].Weight;
+                ++lessEnd;
+            }
+            equalWeight = 0;
+            for (size_t equalEnd = lessEnd; equalEnd < negatives.size() && negatives[equalEnd].Prediction == prediction; ++equalEnd) {
+                equalWeight += negatives[equalEnd].Weight;
+            }
+        }
+        result += positives[positiveIdx].Weight * (lessWeight + equalWeight / 2);
+    }
+    return result;
+}
+
+double CalcBinClassAuc(
+    TVector<TBinClassSample>* positiveSamples,
+    TVector<TBinClassSample>* negativeSamples,
+    NPar::TLocalExecutor* localExecutor
+) {
+    const double pairWeightSum = SumWeights(*positiveSamples) * SumWeights(*negativeSamples);
+    if (pairWeightSum == 0) {
+        return 0;
+    }
+
+    const int blockCount = localExecutor->GetThreadCount() + 1;
+    const auto positiveBlocks = SplitIntoBlocks(positiveSamples, blockCount);
+    const auto negativeBlocks = SplitIntoBlocks(negativeSamples, blockCount);
+
+    TVector<TArrayRef<TBinClassSample>> allBlocks = positiveBlocks;
+    allBlocks.insert(allBlocks.end(), negativeBlocks.begin(), negativeBlocks.end());
+    localExecutor->ExecRangeWithThrow(
+        [&] (int blockIdx) {
+            Sort(allBlocks[blockIdx].begin(), allBlocks[blockIdx].end(), [](const TBinClassSample& left, const TBinClassSample& right) {
+                return left.Prediction < right.Prediction;
+            });
+        },
+        0,
+        allBlocks.ysize(),
+        NPar::TLocalExecutor::WAIT_COMPLETE
+    );
+
+    const int negativeBlockCount = negativeBlocks.ysize();
+    TVector<double> blockPairsOrderedWeights(positiveBlocks.size() * negativeBlockCount);
+    localExecutor->ExecRangeWithThrow(
+        [&] (int blockPairIdx) {
+            blockPairsOrderedWeights[blockPairIdx] = CountOrderedPairs(
+                positiveBlocks[blockPairIdx / negativeBlockCount],
+                negativeBlocks[blockPairIdx % negativeBlockCount]
+            );
+        },
+        0,
+        blockPairsOrderedWeights.ysize(),
+        NPar::TLocalExecutor::WAIT_COMPLETE
+    );
+    return Accumulate(blockPairsOrderedWeights, 0.0) / pairWeightSum;
+}
+
+double CalcApproximateBinClassAuc(
+    TConstArrayRef<TBinClassSample> positiveSamples,
+    TConstArrayRef<TBinClassSample> negativeSamples,
+    ui32 binCount,
+    NPar::TLocalExecutor* localExecutor
+) {
+    Y_ASSERT(binCount > 0);
+    const double pairWeightSum = SumWeights(positiveSamples) * SumWeights(negativeSamples);
+    if (pairWeightSum == 0) {
+        return 0;
+    }
+
+    double minPrediction = positiveSamples[0].Prediction;
+    double maxPrediction = minPrediction;
+    for (auto samples : {positiveSamples, negativeSamples}) {
+        for (const auto& sample : samples) {
+            minPrediction = Min(minPrediction, sample.Prediction);
+            maxPrediction = Max(maxPrediction, sample.Prediction);
+        }
+    }
+    const double binScale = maxPrediction > minPrediction ? binCount / (maxPrediction - minPrediction) : 0;
+
+    const auto calcHistogram = [&] (TConstArrayRef<TBinClassSample> samples) {
+        NPar::TLocalExecutor::TExecRangeParams blockParams(0, samples.size());
+        blockParams.SetBlockCount(localExecutor->GetThreadCount() + 1);
+        TVector<TVector<double>> blockHistograms(blockParams.GetBlockCount(), TVector<double>(binCount, 0.0));
+        localExecutor->ExecRangeWithThrow(
+            [&] (int blockIdx) {
+                auto& histogram = blockHistograms[blockIdx];
+                const int blockBegin = blockIdx * blockParams.GetBlockSize();
+                const int blockEnd = Min(blockBegin + blockParams.GetBlockSize(), (int)samples.size());
+                for (int sampleIdx : xrange(blockBegin, blockEnd)) {
+                    const auto& sample = samples[sampleIdx];
+                    const ui32 bin = Min<ui32>(binCount - 1, (sample.Prediction - minPrediction) * binScale);
+                    histogram[bin] += sample.Weight;
+                }
+            },
+            0,
+            blockParams.GetBlockCount(),
+            NPar::TLocalExecutor::WAIT_COMPLETE
+        );
+        TVector<double> histogram(binCount, 0.0);
+        for (const auto& blockHistogram : blockHistograms) {
+            for (auto bin : xrange(binCount)) {
+                histogram[bin] += blockHistogram[bin];
+            }
+        }
+        return histogram;
+    };
+    const TVector<double> positiveHistogram = calcHistogram(positiveSamples);
+    const TVector<double> negativeHistogram = calcHistogram(negativeSamples);
+
+    double orderedPairsWeight = 0;
+    double lessNegativeWeight = 0;
+    for (auto bin : xrange(binCount)) {
+        orderedPairsWeight += positiveHistogram[bin] * (lessNegativeWeight + negativeHistogram[bin] / 2);
+        lessNegativeWeight += negativeHistogram[bin];
+    }
+    return orderedPairsWeight / pairWeightSum;
+}
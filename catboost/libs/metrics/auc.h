@@ -2,4 +2,36 @@
 
 #include "sample.h"
 
+#include <library/threading/local_executor/local_executor.h>
+
+#include <util/generic/array_ref.h>
+#include <util/generic/vector.h>
+
 double CalcAUC(TVector<NMetrics::TSample>* samples, double* outWeightSum = nullptr, double* outPairWeightSum = nullptr);
+
+namespace NMetrics {
+    struct TBinClassSample {
+        double Prediction = 0;
+        double Weight = 0;
+    };
+}
+
+/* Same as CalcAUC for binary target, but positive and negative samples are sorted only by prediction,
+ * in blocks in parallel, and pairs are counted for each pair of positive and negative blocks in parallel.
+ * Samples are reordered.
+ */
+double CalcBinClassAuc(
+    TVector<NMetrics::TBinClassSample>* positiveSamples,
+    TVector<NMetrics::TBinClassSample>* negativeSamples,
+    NPar::TLocalExecutor* localExecutor
+);
+
+/* Approximation of CalcBinClassAuc with predictions bucketed into binCount equal-width bins,
+ * pairs within one bin are counted as ties. No sorting is needed.
+ */
+double CalcApproximateBinClassAuc(
+    TConstArrayRef<NMetrics::TBinClassSample> positiveSamples,
+    TConstArrayRef<NMetrics::TBinClassSample> negativeSamples,
+    ui32 binCount,
+    NPar::TLocalExecutor* localExecutor
+);
@@ -19,6 +19,7 @@
 #include <util/generic/hash.h>
 #include <util/generic/maybe.h>
 #include <util/generic/string.h>
+#include <util/generic/xrange.h>
 #include <util/generic/ymath.h>
 #include <util/string/builder.h>
 #include <util/string/cast.h>
@@ -1542,14 +1543,16 @@ void TR2Metric::GetBestValue(EMetricBestValue* valueType, float*) const {
 
 namespace {
     struct TAUCMetric: public TNonAdditiveMetric {
-        explicit TAUCMetric(double border = GetDefaultClassificationBorder())
-                : Border(border) {
+        explicit TAUCMetric(double border = GetDefaultClassificationBorder(), ui32 histBinCount = 0)
+                : Border(border)
+                , HistBinCount(histBinCount) {
             UseWeights.SetDefaultValue(false);
         }
 
-        explicit TAUCMetric(int positiveClass)
+        explicit TAUCMetric(int positiveClass, ui32 histBinCount = 0)
             : PositiveClass(positiveClass)
-            , IsMultiClass(true) {
+            , IsMultiClass(true)
+            , HistBinCount(histBinCount) {
         }
 
         TMetricHolder Eval(
@@ -1567,15 +1570,17 @@ namespace {
         int PositiveClass = 1;
         bool IsMultiClass = false;
         double Border = GetDefaultClassificationBorder();
+        // approximate AUC by prediction histogram if nonzero
+        ui32 HistBinCount = 0;
     };
 }
 
-THolder<IMetric> MakeBinClassAucMetric(double border) {
-    return MakeHolder<TAUCMetric>(border);
+THolder<IMetric> MakeBinClassAucMetric(double border, ui32 histBinCount) {
+    return MakeHolder<TAUCMetric>(border, histBinCount);
 }
 
-THolder<IMetric> MakeMultiClassAucMetric(int positiveClass) {
-    return MakeHolder<TAUCMetric>(positiveClass);
+THolder<IMetric> MakeMultiClassAucMetric(int positiveClass, ui32 histBinCount) {
+    return MakeHolder<TAUCMetric>(positiveClass, histBinCount);
 }
 
 TMetricHolder TAUCMetric::Eval(
@@ -1585,49 +1590,38 @@ TMetricHolder TAUCMetric::Eval(
     TConstArrayRef<TQueryInfo> /*queriesInfo*/,
     int begin,
     int end,
-    NPar::TLocalExecutor& /* executor */
+    NPar::TLocalExecutor& executor
 ) const {
     Y_ASSERT((approx.size() > 1) == IsMultiClass);
     const auto& approxVec = approx.ysize() == 1 ? approx.front() : approx[PositiveClass];
     Y_ASSERT(approxVec.size() == target.size());
     auto weight = UseWeights ? weightIn : TConstArrayRef<float>{};
 
-    TVector<double> approxCopy(approxVec.begin() + begin, approxVec.begin() + end);
-    TVector<double> targetCopy(target.begin() + begin, target.begin() + end);
-
-    if (!IsMultiClass) {
-        for (ui32 i = 0; i < targetCopy.size(); ++i) {
-            targetCopy[i] = targetCopy[i] > Border;
-        }
+    TVector<NMetrics::TBinClassSample> positiveSamples;
+    TVector<NMetrics::TBinClassSample> negativeSamples;
+    for (int i : xrange(begin, end)) {
+        const bool isPositive = IsMultiClass ? target[i] == static_cast<float>(PositiveClass) : target[i] > Border;
+        auto& samples = isPositive ? positiveSamples : negativeSamples;
+        samples.push_back({approxVec[i], weight.empty() ? 1.0 : weight[i]});
     }
 
-    if (approx.ysize() > 1) {
-        int positiveClass = PositiveClass;
-        ForEach(targetCopy.begin(), targetCopy.end(), [positiveClass](double& x) {
-            x = (x == static_cast<double>(positiveClass));
-        });
-    }
-
-    TVector<NMetrics::TSample> samples;
-    if (weight.empty()) {
-        samples = NMetrics::TSample::FromVectors(targetCopy, approxCopy);
+    TMetricHolder error(2);
+    if (HistBinCount > 0) {
+        error.Stats[0] = CalcApproximateBinClassAuc(positiveSamples, negativeSamples, HistBinCount, &executor);
     } else {
-        TVector<double> weightCopy(weight.begin() + begin, weight.begin() + end);
-        samples = NMetrics::TSample::FromVectors(targetCopy, approxCopy, weightCopy);
+        error.Stats[0] = CalcBinClassAuc(&positiveSamples, &negativeSamples, &executor);
     }
-
-    TMetricHolder error(2);
-    error.Stats[0] = CalcAUC(&samples);
     error.Stats[1] = 1.0;
     return error;
 }
 
 TString TAUCMetric::GetDescription() const {
+    const TMetricParam<ui32> histBinCount("hist_bins", HistBinCount, /*userDefined*/HistBinCount > 0);
     if (IsMultiClass) {
         const TMetricParam<int> positiveClass("class", PositiveClass, /*userDefined*/true);
-        return BuildDescription(ELossFunction::AUC, UseWeights, positiveClass);
+        return BuildDescription(ELossFunction::AUC, UseWeights, positiveClass, histBinCount);
     } else {
-        return BuildDescription(ELossFunction::AUC, UseWeights, "%.3g", MakeBorderParam(Border));
+        return BuildDescription(ELossFunction::AUC, UseWeights, "%.3g", MakeBorderParam(Border), histBinCount);
     }
 }
 
@@ -3372,13 +3366,15 @@ static TVector<THolder<IMetric>> CreateMetric(ELossFunction metric, TMap<TString
             break;
         }
         case ELossFunction::AUC: {
+            const ui32 histBinCount = params.contains("hist_bins") ? FromString<ui32>(params.at("hist_bins")) : 0;
             if (approxDimension == 1) {
-                result.push_back(MakeBinClassAucMetric(border));
-                validParams = {"border"};
+                result.push_back(MakeBinClassAucMetric(border, histBinCount));
+                validParams = {"border", "hist_bins"};
             } else {
                 for (int i = 0; i < approxDimension; ++i) {
-                    result.push_back(MakeMultiClassAucMetric(i));
+                    result.push_back(MakeMultiClassAucMetric(i, histBinCount));
                 }
+                validParams = {"hist_bins"};
             }
             break;
         }
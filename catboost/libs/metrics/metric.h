@@ -229,8 +229,9 @@ THolder<IMetric> MakeNdcgMetric(int topSize = -1, ENdcgMetricType type = ENdcgMe
 
 THolder<IMetric> MakeQuerySoftMaxMetric();
 
-THolder<IMetric> MakeBinClassAucMetric(double border = GetDefaultClassificationBorder());
-THolder<IMetric> MakeMultiClassAucMetric(int positiveClass);
+// histBinCount > 0 means approximate AUC calculation by prediction histogram with so many bins
+THolder<IMetric> MakeBinClassAucMetric(double border = GetDefaultClassificationBorder(), ui32 histBinCount = 0);
+THolder<IMetric> MakeMultiClassAucMetric(int positiveClass, ui32 histBinCount = 0);
 
 THolder<IMetric> MakeAccuracyMetric(double border = GetDefaultClassificationBorder());
 
@@ -0,0 +1,63 @@
+#include <library/unittest/registar.h>
+
+#include <catboost/libs/metrics/auc.h>
+#include <catboost/libs/metrics/metric.h>
+#include <catboost/libs/metrics/metric_holder.h>
+
+#include <util/generic/xrange.h>
+#include <util/random/fast.h>
+
+Y_UNIT_TEST_SUITE(AUCMetricTest) {
+Y_UNIT_TEST(BinClassAucMatchesCalcAUC) {
+    TReallyFastRng32 rng(0);
+    const size_t sampleCount = 10000;
+    TVector<NMetrics::TSample> samples;
+    TVector<NMetrics::TBinClassSample> positiveSamples;
+    TVector<NMetrics::TBinClassSample> negativeSamples;
+    for (auto i : xrange(sampleCount)) {
+        Y_UNUSED(i);
+        const double target = rng.Uniform(2);
+        // few distinct predictions to have ties
+        const double prediction = rng.Uniform(100) + target * rng.Uniform(20);
+        const double weight = rng.GenRandReal1();
+        samples.emplace_back(target, prediction, weight);
+        (target == 1 ? positiveSamples : negativeSamples).push_back({prediction, weight});
+    }
+    const double expectedAuc = CalcAUC(&samples);
+
+    for (int threadCount : {1, 4}) {
+        NPar::TLocalExecutor executor;
+        executor.RunAdditionalThreads(threadCount - 1);
+        auto positiveSamplesCopy = positiveSamples;
+        auto negativeSamplesCopy = negativeSamples;
+        UNIT_ASSERT_DOUBLES_EQUAL(
+            CalcBinClassAuc(&positiveSamplesCopy, &negativeSamplesCopy, &executor),
+            expectedAuc,
+            1e-9);
+
+        // bins are finer than distinct predictions, so the histogram is exact
+        UNIT_ASSERT_DOUBLES_EQUAL(
+            CalcApproximateBinClassAuc(positiveSamples, negativeSamples, 1 << 16, &executor),
+            expectedAuc,
+            1e-9);
+        UNIT_ASSERT_DOUBLES_EQUAL(
+            CalcApproximateBinClassAuc(positiveSamples, negativeSamples, 16, &executor),
+            expectedAuc,
+            0.05);
+    }
+}
+
+Y_UNIT_TEST(AucMetric) {
+    TVector<TVector<double>> approx{{0.1, 0.4, 0.35, 0.8}};
+    TVector<float> target{0, 0, 1, 1};
+    TVector<float> weight{1, 1, 1, 1};
+
+    NPar::TLocalExecutor executor;
+    for (ui32 histBinCount : {0, 1000}) {
+        const auto metric = MakeBinClassAucMetric(GetDefaultClassificationBorder(), histBinCount);
+        TMetricHolder score = metric->Eval(approx, target, weight, {}, 0, target.size(), executor);
+        UNIT_ASSERT_DOUBLES_EQUAL(metric->GetFinalError(score), 0.75, 1e-9);
+    }
+    UNIT_ASSERT_VALUES_EQUAL(MakeBinClassAucMetric(GetDefaultClassificationBorder(), 1000)->GetDescription(), "AUC:hist_bins=1000");
+}
+}
@@ -18,6 +18,9 @@ struct TCtrData {
     void Save(IOutputStream* s) const;
 
     void Load(IInputStream* s);
+
+    //! Load all tables as thin views over the input buffer (see TCtrValueTable::LoadThin)
+    void LoadNonOwning(TMemoryInput* in);
 };
 
 struct TCtrDataStreamWriter {
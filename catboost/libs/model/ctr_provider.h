@@ -47,6 +47,11 @@ public:
         Y_FAIL("Deserialization not allowed");
     };
 
+    // zero-copy deserialization, provider data references input buffer memory
+    virtual void LoadNonOwning(TMemoryInput* ) {
+        Y_FAIL("Zero-copy deserialization not allowed");
+    };
+
     // can use this later for complex model deserialization logic
     virtual TString ModelPartIdentifier() const = 0;
 
@@ -1,5 +1,7 @@
 #include "ctr_value_table.h"
 #include "flatbuffers_serializer_helper.h"
+
+#include <catboost/libs/helpers/exception.h>
 #include <catboost/libs/model/flatbuffers/model.fbs.h>
 #include <util/stream/input.h>
 #include <util/ysaveload.h>
@@ -62,3 +64,25 @@ void TCtrValueTable::LoadSolid(void* buf, size_t length) {
     solid.CTRBlob.assign(ctrValueTable->CTRBlob()->data(),
                          ctrValueTable->CTRBlob()->data() + ctrValueTable->CTRBlob()->size());
 }
+
+void TCtrValueTable::LoadThin(TMemoryInput* in) {
+    const ui32 size = LoadSize(in);
+    CB_ENSURE(in->Avail() >= size, "Not enough data for ctr value table");
+    const ui8* buf = reinterpret_cast<const ui8*>(in->Buf());
+    {
+        flatbuffers::Verifier verifier(buf, size);
+        CB_ENSURE(NCatBoostFbs::VerifyTCtrValueTableBuffer(verifier), "Flatbuffers ctr value table verification failed");
+    }
+    in->Skip(size);
+
+    Impl = TThinTable();
+    auto& thin = Get<TThinTable>(Impl);
+    auto ctrValueTable = flatbuffers::GetRoot<NCatBoostFbs::TCtrValueTable>(buf);
+    ModelCtrBase.FBDeserialize(ctrValueTable->ModelCtrBase());
+    CounterDenominator = ctrValueTable->CounterDenominator();
+    TargetClassesCount = ctrValueTable->TargetClassesCount();
+    thin.IndexBuckets = MakeArrayRef(
+        reinterpret_cast<const NCatboost::TBucket*>(ctrValueTable->IndexHashRaw()->data()),
+        ctrValueTable->IndexHashRaw()->size() / sizeof(NCatboost::TBucket));
+    thin.CTRBlob = MakeArrayRef(ctrValueTable->CTRBlob()->data(), ctrValueTable->CTRBlob()->size());
+}
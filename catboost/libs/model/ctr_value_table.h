@@ -8,6 +8,7 @@
 #include <util/generic/variant.h>
 #include <tuple>
 #include <util/stream/input.h>
+#include <util/stream/mem.h>
 #include <util/stream/output.h>
 
 class TCtrValueTable {
@@ -88,9 +89,31 @@ public:
 
     void LoadSolid(void* buf, size_t length);
 
+    /**
+     * Load table as a view over the stream buffer, without copying index and CTR data.
+     * Buffer memory must outlive this table.
+     */
+    void LoadThin(TMemoryInput* in);
+
+    bool IsThin() const {
+        return HoldsAlternative<TThinTable>(Impl);
+    }
+
     bool operator==(const TCtrValueTable& other) const {
-        return std::tie(CounterDenominator, TargetClassesCount, Impl) ==
-               std::tie(other.CounterDenominator, other.TargetClassesCount, other.Impl);
+        // solid and thin tables with the same content are equal
+        return std::tie(CounterDenominator, TargetClassesCount) ==
+               std::tie(other.CounterDenominator, other.TargetClassesCount) &&
+               GetIndexBuckets() == other.GetIndexBuckets() &&
+               GetTypedArrayRefForBlobData<ui8>() == other.GetTypedArrayRefForBlobData<ui8>();
+    }
+
+private:
+    TConstArrayRef<NCatboost::TBucket> GetIndexBuckets() const {
+        if (HoldsAlternative<TSolidTable>(Impl)) {
+            return Get<TSolidTable>(Impl).IndexBuckets;
+        } else {
+            return Get<TThinTable>(Impl).IndexBuckets;
+        }
     }
 
 public:
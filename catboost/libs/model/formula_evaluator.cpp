@@ -1,6 +1,7 @@
 #include "formula_evaluator.h"
 
 #include <util/stream/format.h>
+#include <util/system/cpu_id.h>
 
 #ifdef _sse2_
 #include <emmintrin.h>
@@ -12,7 +13,7 @@ void TFeatureCachedTreeEvaluator::Calc(size_t treeStart, size_t treeEnd, TArrayR
     CB_ENSURE(results.size() == DocCount * Model.ObliviousTrees.ApproxDimension);
     Fill(results.begin(), results.end(), 0.0);
 
-    TVector<TCalcerIndexType> indexesVec(BlockSize);
+    TVector<TCalcerIndexType> indexesVec(BlockSize * CALCER_INDEXES_PER_DOCUMENT);
     int id = 0;
     for (size_t blockStart = 0; blockStart < DocCount; blockStart += BlockSize) {
         const auto docCountInBlock = Min(BlockSize, DocCount - blockStart);
@@ -81,6 +82,8 @@ void CalcIndexes(
 }
 #ifdef _sse2_
 
+#define _mm_cmpge_epu8(a, b) _mm_cmpeq_epi8(_mm_max_epu8((a), (b)), (a))
+
 template <bool NeedXorMask, size_t SSEBlockCount, int curTreeSize>
 Y_FORCE_INLINE void CalcIndexesSseDepthed(
         const ui8* __restrict binFeatures,
@@ -91,7 +94,6 @@ Y_FORCE_INLINE void CalcIndexesSseDepthed(
         CalcIndexesBasic<NeedXorMask, 0>(binFeatures, docCountInBlock, indexesVec, treeSplitsCurPtr, curTreeSize);
         return;
     }
-#define _mm_cmpge_epu8(a, b) _mm_cmpeq_epi8(_mm_max_epu8((a), (b)), (a))
 #define LOAD_16_DOC_HISTS(reg, binFeaturesPtr16) \
         const __m128i val##reg = _mm_lddqu_si128((const __m128i *)(binFeaturesPtr16));
 #define UPDATE_16_DOC_BINS(reg) \
@@ -132,7 +134,6 @@ Y_FORCE_INLINE void CalcIndexesSseDepthed(
     if (SSEBlockCount != 8) {
         CalcIndexesBasic<NeedXorMask, SSEBlockCount>(binFeatures, docCountInBlock, indexesVec, treeSplitsCurPtr, curTreeSize);
     }
-#undef _mm_cmpge_epu8
 #undef LOAD_16_DOC_HISTS
 #undef UPDATE_16_DOC_BINS
 #undef LOAD_AND_UPDATE_16_DOCUMENT_BITS_XORED
@@ -177,6 +178,43 @@ static void CalcIndexesSse(
     }
 }
 
+/**
+ * Index calculation for trees with depth in (8, 16]: bins are compared by 16 documents at once as in CalcIndexesSseDepthed,
+ * comparison masks are widened to ui16 lanes.
+ */
+template <bool NeedXorMask, size_t SSEBlockCount>
+static void CalcIndexesSse16(
+    const ui8* __restrict binFeatures,
+    size_t docCountInBlock,
+    ui16* __restrict indexesVec,
+    const TRepackedBin* __restrict treeSplitsCurPtr,
+    const int curTreeSize) {
+    for (size_t regId = 0; regId < SSEBlockCount; ++regId) {
+        __m128i lo = _mm_setzero_si128();
+        __m128i hi = _mm_setzero_si128();
+        __m128i mask = _mm_set1_epi16(0x01);
+        for (int depth = 0; depth < curTreeSize; ++depth) {
+            const ui8 *__restrict binFeaturePtr = binFeatures + treeSplitsCurPtr[depth].FeatureIndex * docCountInBlock + SSE_BLOCK_SIZE * regId;
+            const __m128i borderValVec = _mm_set1_epi8(treeSplitsCurPtr[depth].SplitIdx);
+            __m128i val = _mm_loadu_si128((const __m128i *)binFeaturePtr);
+            if (NeedXorMask) {
+                val = _mm_xor_si128(val, _mm_set1_epi8(treeSplitsCurPtr[depth].XorMask));
+            }
+            const __m128i isGreaterOrEqual = _mm_cmpge_epu8(val, borderValVec);
+            lo = _mm_or_si128(lo, _mm_and_si128(_mm_unpacklo_epi8(isGreaterOrEqual, isGreaterOrEqual), mask));
+            hi = _mm_or_si128(hi, _mm_and_si128(_mm_unpackhi_epi8(isGreaterOrEqual, isGreaterOrEqual), mask));
+            mask = _mm_slli_epi16(mask, 1);
+        }
+        _mm_storeu_si128((__m128i *)(indexesVec + SSE_BLOCK_SIZE * regId), lo);
+        _mm_storeu_si128((__m128i *)(indexesVec + SSE_BLOCK_SIZE * regId + SSE_BLOCK_SIZE / 2), hi);
+    }
+    if (SSEBlockCount != 8) {
+        CalcIndexesBasic<NeedXorMask, SSEBlockCount>(binFeatures, docCountInBlock, indexesVec, treeSplitsCurPtr, curTreeSize);
+    }
+}
+
+#undef _mm_cmpge_epu8
+
 #endif
 
 template <typename TIndexType>
@@ -199,6 +237,25 @@ Y_FORCE_INLINE void CalculateLeafValues(const size_t docCountInBlock, const doub
     }
 }
 
+template <typename TIndexType>
+Y_FORCE_INLINE void CalculateLeafValues4Basic(
+    const size_t docCountInBlock,
+    const double* __restrict treeLeafPtr0,
+    const double* __restrict treeLeafPtr1,
+    const double* __restrict treeLeafPtr2,
+    const double* __restrict treeLeafPtr3,
+    const TIndexType* __restrict indexesPtr0,
+    const TIndexType* __restrict indexesPtr1,
+    const TIndexType* __restrict indexesPtr2,
+    const TIndexType* __restrict indexesPtr3,
+    double* __restrict writePtr)
+{
+    for (size_t docId = 0; docId < docCountInBlock; ++docId) {
+        writePtr[docId] += treeLeafPtr0[indexesPtr0[docId]] + treeLeafPtr1[indexesPtr1[docId]]
+            + treeLeafPtr2[indexesPtr2[docId]] + treeLeafPtr3[indexesPtr3[docId]];
+    }
+}
+
 #ifdef _sse2_
 template <int SSEBlockCount>
 Y_FORCE_INLINE static void GatherAddLeafSSE(const double* __restrict treeLeafPtr, const ui8* __restrict indexesPtr, __m128d* __restrict writePtr) {
@@ -228,7 +285,7 @@ Y_FORCE_INLINE static void GatherAddLeafSSE(const double* __restrict treeLeafPtr
         writePtr += 8;
         indexesPtr += 16;
     }
-#undef LOAD_LEAFS
+#undef GATHER_LEAFS
 #undef ADD_LEAFS
 }
 
@@ -299,12 +356,9 @@ Y_FORCE_INLINE void CalcTreesBlockedImpl(
     const auto treeLeafPtr = model.ObliviousTrees.LeafValues.data();
     auto firstLeafOffsetsPtr = model.ObliviousTrees.GetFirstLeafOffsets().data();
 #ifdef _sse2_
-    bool allTreesAreShallow = AllOf(
-            model.ObliviousTrees.TreeSizes.begin() + treeStart,
-            model.ObliviousTrees.TreeSizes.begin() + treeEnd,
-            [](int depth) { return depth <= 8; }
-    );
-    if (IsSingleClassModel && allTreesAreShallow) {
+    ui16* __restrict indexesVec16 = (ui16*)indexesVecUI32;
+    const auto& treeSizes = model.ObliviousTrees.TreeSizes;
+    if (IsSingleClassModel && treeStart + 4 <= treeEnd) {
         auto alignedResultsPtr = resultsPtr;
         TVector<double> resultsTmpArray;
         const size_t neededMemory = docCountInBlock * model.ObliviousTrees.ApproxDimension * sizeof(double);
@@ -315,37 +369,54 @@ Y_FORCE_INLINE void CalcTreesBlockedImpl(
                 resultsTmpArray.yresize(docCountInBlock * model.ObliviousTrees.ApproxDimension);
                 alignedResultsPtr = resultsTmpArray.data();
             }
-            memset(alignedResultsPtr, 0, neededMemory);
+            memcpy(alignedResultsPtr, resultsPtr, neededMemory);
         }
-        auto treeEnd4 = treeStart + (((treeEnd - treeStart) | 0x3) ^ 0x3);
-        for (size_t treeId = treeStart; treeId < treeEnd4; treeId += 4) {
-            memset(indexesVec, 0, sizeof(ui32) * docCountInBlock);
-            CalcIndexesSse<NeedXorMask, SSEBlockCount>(binFeatures, docCountInBlock, indexesVec + docCountInBlock * 0, treeSplitsCurPtr, model.ObliviousTrees.TreeSizes[treeId]);
-            treeSplitsCurPtr += model.ObliviousTrees.TreeSizes[treeId];
-            CalcIndexesSse<NeedXorMask, SSEBlockCount>(binFeatures, docCountInBlock, indexesVec + docCountInBlock * 1, treeSplitsCurPtr, model.ObliviousTrees.TreeSizes[treeId + 1]);
-            treeSplitsCurPtr += model.ObliviousTrees.TreeSizes[treeId + 1];
-            CalcIndexesSse<NeedXorMask, SSEBlockCount>(binFeatures, docCountInBlock, indexesVec + docCountInBlock * 2, treeSplitsCurPtr, model.ObliviousTrees.TreeSizes[treeId + 2]);
-            treeSplitsCurPtr += model.ObliviousTrees.TreeSizes[treeId + 2];
-            CalcIndexesSse<NeedXorMask, SSEBlockCount>(binFeatures, docCountInBlock, indexesVec + docCountInBlock * 3, treeSplitsCurPtr, model.ObliviousTrees.TreeSizes[treeId + 3]);
-            treeSplitsCurPtr += model.ObliviousTrees.TreeSizes[treeId + 3];
-
-            CalculateLeafValues4<SSEBlockCount>(
-                docCountInBlock,
-                treeLeafPtr + firstLeafOffsetsPtr[treeId + 0],
-                treeLeafPtr + firstLeafOffsetsPtr[treeId + 1],
-                treeLeafPtr + firstLeafOffsetsPtr[treeId + 2],
-                treeLeafPtr + firstLeafOffsetsPtr[treeId + 3],
-                indexesVec + docCountInBlock * 0,
-                indexesVec + docCountInBlock * 1,
-                indexesVec + docCountInBlock * 2,
-                indexesVec + docCountInBlock * 3,
-                alignedResultsPtr
-            );
+        // trees are processed by groups of 4 with ui8 indexes for shallow groups and ui16 indexes for deep ones
+        for (; treeStart + 4 <= treeEnd; treeStart += 4) {
+            const int maxDepth = *MaxElement(treeSizes.begin() + treeStart, treeSizes.begin() + treeStart + 4);
+            if (maxDepth <= 8) {
+                memset(indexesVec, 0, sizeof(ui8) * 4 * docCountInBlock);
+                for (size_t i = 0; i < 4; ++i) {
+                    CalcIndexesSse<NeedXorMask, SSEBlockCount>(binFeatures, docCountInBlock, indexesVec + docCountInBlock * i, treeSplitsCurPtr, treeSizes[treeStart + i]);
+                    treeSplitsCurPtr += treeSizes[treeStart + i];
+                }
+                CalculateLeafValues4<SSEBlockCount>(
+                    docCountInBlock,
+                    treeLeafPtr + firstLeafOffsetsPtr[treeStart + 0],
+                    treeLeafPtr + firstLeafOffsetsPtr[treeStart + 1],
+                    treeLeafPtr + firstLeafOffsetsPtr[treeStart + 2],
+                    treeLeafPtr + firstLeafOffsetsPtr[treeStart + 3],
+                    indexesVec + docCountInBlock * 0,
+                    indexesVec + docCountInBlock * 1,
+                    indexesVec + docCountInBlock * 2,
+                    indexesVec + docCountInBlock * 3,
+                    alignedResultsPtr
+                );
+            } else if (maxDepth <= 16) {
+                memset(indexesVec16, 0, sizeof(ui16) * 4 * docCountInBlock);
+                for (size_t i = 0; i < 4; ++i) {
+                    CalcIndexesSse16<NeedXorMask, SSEBlockCount>(binFeatures, docCountInBlock, indexesVec16 + docCountInBlock * i, treeSplitsCurPtr, treeSizes[treeStart + i]);
+                    treeSplitsCurPtr += treeSizes[treeStart + i];
+                }
+                CalculateLeafValues4Basic(
+                    docCountInBlock,
+                    treeLeafPtr + firstLeafOffsetsPtr[treeStart + 0],
+                    treeLeafPtr + firstLeafOffsetsPtr[treeStart + 1],
+                    treeLeafPtr + firstLeafOffsetsPtr[treeStart + 2],
+                    treeLeafPtr + firstLeafOffsetsPtr[treeStart + 3],
+                    indexesVec16 + docCountInBlock * 0,
+                    indexesVec16 + docCountInBlock * 1,
+                    indexesVec16 + docCountInBlock * 2,
+                    indexesVec16 + docCountInBlock * 3,
+                    alignedResultsPtr
+                );
+            } else {
+                break;
+            }
         }
         if (alignedResultsPtr != resultsPtr) {
             memcpy(resultsPtr, alignedResultsPtr, neededMemory);
         }
-        treeStart = treeEnd4;
     }
 #endif
     for (size_t treeId = treeStart; treeId < treeEnd; ++treeId) {
@@ -359,6 +430,13 @@ Y_FORCE_INLINE void CalcTreesBlockedImpl(
             } else { // mutliclass model
                 CalculateLeafValuesMulti(docCountInBlock, treeLeafPtr + firstLeafOffsetsPtr[treeId], indexesVec, model.ObliviousTrees.ApproxDimension, resultsPtr);
             }
+        } else if (curTreeSize <= 16) {
+            CalcIndexesSse16<NeedXorMask, SSEBlockCount>(binFeatures, docCountInBlock, indexesVec16, treeSplitsCurPtr, curTreeSize);
+            if (IsSingleClassModel) { // single class model
+                CalculateLeafValues(docCountInBlock, treeLeafPtr + firstLeafOffsetsPtr[treeId], indexesVec16, resultsPtr);
+            } else { // mutliclass model
+                CalculateLeafValuesMulti(docCountInBlock, treeLeafPtr + firstLeafOffsetsPtr[treeId], indexesVec16, model.ObliviousTrees.ApproxDimension, resultsPtr);
+            }
         } else {
 #else
         {
@@ -417,6 +495,106 @@ Y_FORCE_INLINE void CalcTreesBlocked(
     }
 }
 
+#ifdef _sse2_
+/**
+ * AVX2 version of CalcTreesBlocked: documents are processed by 32 per register, leaf values are gathered with vgatherdpd.
+ * Blocks smaller than AVX2_BLOCK_SIZE are evaluated by CalcTreesBlocked.
+ */
+template <bool IsSingleClassModel, bool NeedXorMask>
+void CalcTreesBlockedAvx2(
+    const TFullModel& model,
+    const ui8* __restrict binFeatures,
+    size_t docCountInBlock,
+    TCalcerIndexType* __restrict indexesVecUI32,
+    size_t treeStart,
+    size_t treeEnd,
+    double* __restrict resultsPtr)
+{
+    if (docCountInBlock < AVX2_BLOCK_SIZE) {
+        CalcTreesBlocked<IsSingleClassModel, NeedXorMask>(model, binFeatures, docCountInBlock, indexesVecUI32, treeStart, treeEnd, resultsPtr);
+        return;
+    }
+    const auto& treeSizes = model.ObliviousTrees.TreeSizes;
+    const TRepackedBin* treeSplitsCurPtr =
+        model.ObliviousTrees.GetRepackedBins().data() + model.ObliviousTrees.TreeStartOffsets[treeStart];
+
+    ui8* __restrict indexesVec = (ui8*)indexesVecUI32;
+    ui16* __restrict indexesVec16 = (ui16*)indexesVecUI32;
+    const auto treeLeafPtr = model.ObliviousTrees.LeafValues.data();
+    auto firstLeafOffsetsPtr = model.ObliviousTrees.GetFirstLeafOffsets().data();
+    size_t treeId = treeStart;
+    if (IsSingleClassModel) {
+        for (; treeId + 4 <= treeEnd; treeId += 4) {
+            const int maxDepth = *MaxElement(treeSizes.begin() + treeId, treeSizes.begin() + treeId + 4);
+            if (maxDepth <= 8) {
+                for (size_t i = 0; i < 4; ++i) {
+                    CalcIndexesAvx2(NeedXorMask, binFeatures, docCountInBlock, indexesVec + docCountInBlock * i, treeSplitsCurPtr, treeSizes[treeId + i]);
+                    treeSplitsCurPtr += treeSizes[treeId + i];
+                }
+                CalculateLeafValues4Avx2(
+                    docCountInBlock,
+                    treeLeafPtr + firstLeafOffsetsPtr[treeId + 0],
+                    treeLeafPtr + firstLeafOffsetsPtr[treeId + 1],
+                    treeLeafPtr + firstLeafOffsetsPtr[treeId + 2],
+                    treeLeafPtr + firstLeafOffsetsPtr[treeId + 3],
+                    indexesVec + docCountInBlock * 0,
+                    indexesVec + docCountInBlock * 1,
+                    indexesVec + docCountInBlock * 2,
+                    indexesVec + docCountInBlock * 3,
+                    resultsPtr
+                );
+            } else if (maxDepth <= 16) {
+                for (size_t i = 0; i < 4; ++i) {
+                    CalcIndexes16Avx2(NeedXorMask, binFeatures, docCountInBlock, indexesVec16 + docCountInBlock * i, treeSplitsCurPtr, treeSizes[treeId + i]);
+                    treeSplitsCurPtr += treeSizes[treeId + i];
+                }
+                CalculateLeafValues4Avx2(
+                    docCountInBlock,
+                    treeLeafPtr + firstLeafOffsetsPtr[treeId + 0],
+                    treeLeafPtr + firstLeafOffsetsPtr[treeId + 1],
+                    treeLeafPtr + firstLeafOffsetsPtr[treeId + 2],
+                    treeLeafPtr + firstLeafOffsetsPtr[treeId + 3],
+                    indexesVec16 + docCountInBlock * 0,
+                    indexesVec16 + docCountInBlock * 1,
+                    indexesVec16 + docCountInBlock * 2,
+                    indexesVec16 + docCountInBlock * 3,
+                    resultsPtr
+                );
+            } else {
+                break;
+            }
+        }
+    }
+    for (; treeId < treeEnd; ++treeId) {
+        const auto curTreeSize = treeSizes[treeId];
+        if (curTreeSize <= 8) {
+            CalcIndexesAvx2(NeedXorMask, binFeatures, docCountInBlock, indexesVec, treeSplitsCurPtr, curTreeSize);
+            if (IsSingleClassModel) { // single class model
+                CalculateLeafValues(docCountInBlock, treeLeafPtr + firstLeafOffsetsPtr[treeId], indexesVec, resultsPtr);
+            } else { // mutliclass model
+                CalculateLeafValuesMulti(docCountInBlock, treeLeafPtr + firstLeafOffsetsPtr[treeId], indexesVec, model.ObliviousTrees.ApproxDimension, resultsPtr);
+            }
+        } else if (curTreeSize <= 16) {
+            CalcIndexes16Avx2(NeedXorMask, binFeatures, docCountInBlock, indexesVec16, treeSplitsCurPtr, curTreeSize);
+            if (IsSingleClassModel) { // single class model
+                CalculateLeafValues(docCountInBlock, treeLeafPtr + firstLeafOffsetsPtr[treeId], indexesVec16, resultsPtr);
+            } else { // mutliclass model
+                CalculateLeafValuesMulti(docCountInBlock, treeLeafPtr + firstLeafOffsetsPtr[treeId], indexesVec16, model.ObliviousTrees.ApproxDimension, resultsPtr);
+            }
+        } else {
+            memset(indexesVecUI32, 0, sizeof(ui32) * docCountInBlock);
+            CalcIndexesBasic<NeedXorMask, 0>(binFeatures, docCountInBlock, indexesVecUI32, treeSplitsCurPtr, curTreeSize);
+            if (IsSingleClassModel) { // single class model
+                CalculateLeafValues(docCountInBlock, treeLeafPtr + firstLeafOffsetsPtr[treeId], indexesVecUI32, resultsPtr);
+            } else { // mutliclass model
+                CalculateLeafValuesMulti(docCountInBlock, treeLeafPtr + firstLeafOffsetsPtr[treeId], indexesVecUI32, model.ObliviousTrees.ApproxDimension, resultsPtr);
+            }
+        }
+        treeSplitsCurPtr += curTreeSize;
+    }
+}
+#endif
+
 template <bool IsSingleClassModel, bool NeedXorMask>
 inline void CalcTreesSingleDocImpl(
     const TFullModel& model,
@@ -462,6 +640,9 @@ inline void CalcTreesSingleDocImpl(
 
 TTreeCalcFunction GetCalcTreesFunction(const TFullModel& model, size_t docCountInBlock) {
     const bool hasOneHots = !model.ObliviousTrees.OneHotFeatures.empty();
+#ifdef _sse2_
+    const bool useAvx2 = NX86::CachedHaveAVX() && NX86::CachedHaveAVX2();
+#endif
     if (model.ObliviousTrees.ApproxDimension == 1) {
         if (docCountInBlock == 1) {
             if (hasOneHots) {
@@ -470,6 +651,15 @@ TTreeCalcFunction GetCalcTreesFunction(const TFullModel& model, size_t docCountI
                 return CalcTreesSingleDocImpl<true, false>;
             }
         } else {
+#ifdef _sse2_
+            if (useAvx2) {
+                if (hasOneHots) {
+                    return CalcTreesBlockedAvx2<true, true>;
+                } else {
+                    return CalcTreesBlockedAvx2<true, false>;
+                }
+            }
+#endif
             if (hasOneHots) {
                 return CalcTreesBlocked<true, true>;
             } else {
@@ -484,6 +674,15 @@ TTreeCalcFunction GetCalcTreesFunction(const TFullModel& model, size_t docCountI
                 return CalcTreesSingleDocImpl<false, false>;
             }
         } else {
+#ifdef _sse2_
+            if (useAvx2) {
+                if (hasOneHots) {
+                    return CalcTreesBlockedAvx2<false, true>;
+                } else {
+                    return CalcTreesBlockedAvx2<false, false>;
+                }
+            }
+#endif
             if (hasOneHots) {
                 return CalcTreesBlocked<false, true>;
             } else {
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "formula_evaluator_avx2.h"
 #include "model.h"
 
 #include <catboost/libs/helpers/exception.h>
@@ -7,6 +8,7 @@
 #include <util/generic/ymath.h>
 #include <util/stream/labeled.h>
 
+#include <util/system/cpu_id.h>
 #include <util/system/platform.h>
 
 #ifdef _sse2_
@@ -15,6 +17,7 @@
 
 constexpr size_t FORMULA_EVALUATION_BLOCK_SIZE = 128;
 constexpr ui32 MAX_VALUES_PER_BIN = 254;
+constexpr size_t QUANTIZED_FLOAT_BINS_COUNT = 256;
 
 inline void OneHotBinsFromTransposedCatFeatures(
     const TVector<TOneHotFeature>& OneHotFeatures,
@@ -124,9 +127,28 @@ Y_FORCE_INLINE void BinarizeFloats(
     ui8*& result,
     const float nanSubstitutionValue = 0.0f
 ) {
+    size_t docId = 0;
+    if (docCount >= AVX2_BLOCK_SIZE && NX86::CachedHaveAVX() && NX86::CachedHaveAVX2()) {
+        const auto docCount32 = docCount & ~(AVX2_BLOCK_SIZE - 1);
+        alignas(32) float val[AVX2_BLOCK_SIZE];
+        for (; docId < docCount32; docId += AVX2_BLOCK_SIZE) {
+            for (size_t i = 0; i < AVX2_BLOCK_SIZE; ++i) {
+                val[i] = floatAccessor(start + docId + i);
+            }
+            BinarizeFloats32Avx2(
+                val,
+                borders.data(),
+                borders.size(),
+                MAX_VALUES_PER_BIN,
+                UseNanSubstitution,
+                nanSubstitutionValue,
+                result + docId,
+                docCount);
+        }
+    }
     const __m128 substitutionValVec = _mm_set1_ps(nanSubstitutionValue);
     const auto docCount16 = (docCount | 0xf) ^ 0xf;
-    for (size_t docId = 0; docId < docCount16; docId += 16) {
+    for (; docId < docCount16; docId += 16) {
         const float val[16] = {
             floatAccessor(start + docId + 0),
             floatAccessor(start + docId + 1),
@@ -186,7 +208,7 @@ Y_FORCE_INLINE void BinarizeFloats(
             writePtr += docCount;
         }
     }
-    for (size_t docId = docCount16; docId < docCount; ++docId) {
+    for (docId = docCount16; docId < docCount; ++docId) {
         float val = floatAccessor(start + docId);
         if (UseNanSubstitution) {
             if (IsNan(val)) {
@@ -207,6 +229,77 @@ Y_FORCE_INLINE void BinarizeFloats(
 
 #endif
 
+/**
+ * binsRemap is a lookup table from quantized float feature bin to binary feature value:
+ * value of bucket k (see MAX_VALUES_PER_BIN) for bin b is stored at binsRemap[k * QUANTIZED_FLOAT_BINS_COUNT + b]
+ */
+template <typename TFloatBinAccessor>
+Y_FORCE_INLINE void BinarizeQuantizedFloats(
+    const size_t docCount,
+    TFloatBinAccessor binAccessor,
+    const TConstArrayRef<ui8> binsRemap,
+    size_t start,
+    ui8*& result
+) {
+    Y_ASSERT(binsRemap.size() % QUANTIZED_FLOAT_BINS_COUNT == 0);
+    for (size_t bucketStart = 0; bucketStart < binsRemap.size(); bucketStart += QUANTIZED_FLOAT_BINS_COUNT) {
+        const ui8* bucketRemap = binsRemap.data() + bucketStart;
+        for (size_t docId = 0; docId < docCount; ++docId) {
+            result[docId] = bucketRemap[(ui8)binAccessor(start + docId)];
+        }
+        result += docCount;
+    }
+}
+
+template <typename TCatFeatureAccessor>
+inline void BinarizeCatFeatures(
+    const TFullModel& model,
+    TCatFeatureAccessor catFeatureAccessor,
+    size_t start,
+    size_t end,
+    TArrayRef<ui8> result,
+    ui8* resultPtr,
+    TVector<ui32>& transposedHash,
+    TVector<float>& ctrs
+) {
+    const auto docCount = end - start;
+    if (model.HasCategoricalFeatures()) {
+        THashMap<int, int> catFeaturePackedIndexes;
+        int usedFeatureIdx = 0;
+        for (const auto& catFeature : model.ObliviousTrees.CatFeatures) {
+            if (!catFeature.UsedInModel) {
+                continue;
+            }
+            catFeaturePackedIndexes[catFeature.FeatureIndex] = usedFeatureIdx;
+            for (size_t docId = 0, writeIdx = usedFeatureIdx * docCount; docId < docCount; ++docId, ++writeIdx) {
+                transposedHash[writeIdx] = catFeatureAccessor(catFeature, start + docId);
+            }
+            ++usedFeatureIdx;
+        }
+        Y_ASSERT(model.GetUsedCatFeaturesCount() == (size_t)usedFeatureIdx);
+        OneHotBinsFromTransposedCatFeatures(model.ObliviousTrees.OneHotFeatures, catFeaturePackedIndexes, docCount, resultPtr, transposedHash);
+        if (!model.ObliviousTrees.GetUsedModelCtrs().empty()) {
+            model.CtrProvider->CalcCtrs(
+                model.ObliviousTrees.GetUsedModelCtrs(),
+                result,
+                transposedHash,
+                docCount,
+                ctrs
+            );
+        }
+        for (size_t i = 0; i < model.ObliviousTrees.CtrFeatures.size(); ++i) {
+            const auto& ctr = model.ObliviousTrees.CtrFeatures[i];
+            auto ctrFloatsPtr = &ctrs[i * docCount];
+            BinarizeFloats<false>(
+                docCount,
+                [ctrFloatsPtr](size_t index) { return ctrFloatsPtr[index]; },
+                ctr.Borders,
+                0,
+                resultPtr);
+        }
+    }
+}
+
 /**
 * This function binarizes
 */
@@ -257,45 +350,53 @@ inline void BinarizeFeatures(
             }
         }
     }
-    if (model.HasCategoricalFeatures()) {
-        THashMap<int, int> catFeaturePackedIndexes;
-        int usedFeatureIdx = 0;
-        for (const auto& catFeature : model.ObliviousTrees.CatFeatures) {
-            if (!catFeature.UsedInModel) {
-                continue;
-            }
-            catFeaturePackedIndexes[catFeature.FeatureIndex] = usedFeatureIdx;
-            for (size_t docId = 0, writeIdx = usedFeatureIdx * docCount; docId < docCount; ++docId, ++writeIdx) {
-                transposedHash[writeIdx] = catFeatureAccessor(catFeature, start + docId);
-            }
-            ++usedFeatureIdx;
-        }
-        Y_ASSERT(model.GetUsedCatFeaturesCount() == (size_t)usedFeatureIdx);
-        OneHotBinsFromTransposedCatFeatures(model.ObliviousTrees.OneHotFeatures, catFeaturePackedIndexes, docCount, resultPtr, transposedHash);
-        if (!model.ObliviousTrees.GetUsedModelCtrs().empty()) {
-            model.CtrProvider->CalcCtrs(
-                model.ObliviousTrees.GetUsedModelCtrs(),
-                result,
-                transposedHash,
-                docCount,
-                ctrs
-            );
-        }
-        for (size_t i = 0; i < model.ObliviousTrees.CtrFeatures.size(); ++i) {
-            const auto& ctr = model.ObliviousTrees.CtrFeatures[i];
-            auto ctrFloatsPtr = &ctrs[i * docCount];
-            BinarizeFloats<false>(
-                docCount,
-                [ctrFloatsPtr](size_t index) { return ctrFloatsPtr[index]; },
-                ctr.Borders,
-                0,
-                resultPtr);
+    BinarizeCatFeatures(model, catFeatureAccessor, start, end, result, resultPtr, transposedHash, ctrs);
+}
+
+/**
+ * Maps bins of quantized float features (as stored in quantized pools) directly to binary features,
+ * floatBinsRemap holds lookup table for each float feature of the model, see BinarizeQuantizedFloats
+ */
+template <typename TFloatBinAccessor, typename TCatFeatureAccessor>
+inline void BinarizeQuantizedFeatures(
+    const TFullModel& model,
+    TConstArrayRef<TVector<ui8>> floatBinsRemap,
+    TFloatBinAccessor floatBinAccessor,
+    TCatFeatureAccessor catFeatureAccessor,
+    size_t start,
+    size_t end,
+    TArrayRef<ui8> result,
+    TVector<ui32>& transposedHash,
+    TVector<float>& ctrs
+) {
+    const auto docCount = end - start;
+    ui8* resultPtr = result.data();
+    std::fill(result.begin(), result.end(), 0);
+    const auto& floatFeatures = model.ObliviousTrees.FloatFeatures;
+    Y_ASSERT(floatBinsRemap.size() == floatFeatures.size());
+    for (size_t i = 0; i < floatFeatures.size(); ++i) {
+        const auto& floatFeature = floatFeatures[i];
+        if (!floatFeature.UsedInModel()) {
+            continue;
         }
+        BinarizeQuantizedFloats(
+            docCount,
+            [&floatFeature, floatBinAccessor](size_t index) { return floatBinAccessor(floatFeature, index); },
+            floatBinsRemap[i],
+            start,
+            resultPtr);
     }
+    BinarizeCatFeatures(model, catFeatureAccessor, start, end, result, resultPtr, transposedHash, ctrs);
 }
 
 using TCalcerIndexType = ui32;
 
+/**
+ * Indexes buffer passed to TTreeCalcFunction should have size docCountInBlock * CALCER_INDEXES_PER_DOCUMENT:
+ * blocked evaluation keeps ui16 leaf indexes of 4 deep trees at once.
+ */
+constexpr size_t CALCER_INDEXES_PER_DOCUMENT = 2;
+
 using TTreeCalcFunction = std::function<void(
     const TFullModel& model,
     const ui8* __restrict binFeatures,
@@ -322,43 +423,63 @@ inline X* GetAligned(X* val) {
     return val;
 }
 
-template <typename TFloatFeatureAccessor, typename TCatFeatureAccessor>
-inline void CalcGeneric(
+/**
+ * Scratch space of CalcGenericImpl. Callers evaluating many small batches keep one instance per thread
+ * and pass it to every call, so that buffers are allocated once and only grow afterwards.
+ */
+struct TModelEvaluationBuffers {
+    TVector<ui8> BinFeatures;
+    TVector<TCalcerIndexType> Indexes;
+    TVector<ui32> TransposedHash;
+    TVector<float> Ctrs;
+};
+
+template <typename T>
+inline TVector<T>& GetEvaluationBuffer(size_t size, TVector<T>* buffer, TVector<T>* localHolder) {
+    TVector<T>& result = buffer ? *buffer : *localHolder;
+    result.resize(size);
+    return result;
+}
+
+template <typename TBlockBinarizer>
+inline void CalcGenericImpl(
     const TFullModel& model,
-    TFloatFeatureAccessor floatFeatureAccessor,
-    TCatFeatureAccessor catFeaturesAccessor,
+    TBlockBinarizer binarizeBlock,
     size_t docCount,
     size_t treeStart,
     size_t treeEnd,
-    TArrayRef<double> results)
+    TArrayRef<double> results,
+    TModelEvaluationBuffers* buffers = nullptr)
 {
     size_t blockSize = FORMULA_EVALUATION_BLOCK_SIZE;
     blockSize = Min(blockSize, docCount);
     const size_t binSlots = blockSize * model.ObliviousTrees.GetEffectiveBinaryFeaturesBucketsCount();
     TArrayRef<ui8> binFeatures;
     TVector<ui8> binFeaturesHolder;
-    if (binSlots < 65536) { // 65KB of stack maximum
+    if (buffers) {
+        buffers->BinFeatures.yresize(binSlots);
+        binFeatures = buffers->BinFeatures;
+    } else if (binSlots < 65536) { // 65KB of stack maximum
         binFeatures = MakeArrayRef(GetAligned((ui8*)(alloca(binSlots + 0x20))), binSlots);
     } else {
         binFeaturesHolder.yresize(blockSize * model.ObliviousTrees.GetEffectiveBinaryFeaturesBucketsCount());
         binFeatures = binFeaturesHolder;
     }
     auto calcTrees = GetCalcTreesFunction(model, blockSize);
+    TVector<ui32> transposedHashHolder;
+    TVector<float> ctrsHolder;
     if (docCount == 1) {
         CB_ENSURE((int)results.size() == model.ObliviousTrees.ApproxDimension);
         std::fill(results.begin(), results.end(), 0.0);
-        TVector<ui32> transposedHash(model.GetUsedCatFeaturesCount());
-        TVector<float> ctrs(model.ObliviousTrees.GetUsedModelCtrs().size());
-        BinarizeFeatures(
-            model,
-            floatFeatureAccessor,
-            catFeaturesAccessor,
-            0,
-            1,
-            binFeatures,
-            transposedHash,
-            ctrs
-        );
+        auto& transposedHash = GetEvaluationBuffer(
+            model.GetUsedCatFeaturesCount(),
+            buffers ? &buffers->TransposedHash : nullptr,
+            &transposedHashHolder);
+        auto& ctrs = GetEvaluationBuffer(
+            model.ObliviousTrees.GetUsedModelCtrs().size(),
+            buffers ? &buffers->Ctrs : nullptr,
+            &ctrsHolder);
+        binarizeBlock(0, 1, binFeatures, transposedHash, ctrs);
         calcTrees(
                 model,
                 binFeatures.data(),
@@ -376,21 +497,22 @@ inline void CalcGeneric(
         "`results` size is insufficient: "
         LabeledOutput(results.size(), docCount * model.ObliviousTrees.ApproxDimension));
     std::fill(results.begin(), results.end(), 0.0);
-    TVector<TCalcerIndexType> indexesVec(blockSize);
-    TVector<ui32> transposedHash(blockSize * model.GetUsedCatFeaturesCount());
-    TVector<float> ctrs(model.ObliviousTrees.GetUsedModelCtrs().size() * blockSize);
+    TVector<TCalcerIndexType> indexesHolder;
+    auto& indexesVec = GetEvaluationBuffer(
+        blockSize * CALCER_INDEXES_PER_DOCUMENT,
+        buffers ? &buffers->Indexes : nullptr,
+        &indexesHolder);
+    auto& transposedHash = GetEvaluationBuffer(
+        blockSize * model.GetUsedCatFeaturesCount(),
+        buffers ? &buffers->TransposedHash : nullptr,
+        &transposedHashHolder);
+    auto& ctrs = GetEvaluationBuffer(
+        model.ObliviousTrees.GetUsedModelCtrs().size() * blockSize,
+        buffers ? &buffers->Ctrs : nullptr,
+        &ctrsHolder);
     for (size_t blockStart = 0; blockStart < docCount; blockStart += blockSize) {
         const auto docCountInBlock = Min(blockSize, docCount - blockStart);
-        BinarizeFeatures(
-            model,
-            floatFeatureAccessor,
-            catFeaturesAccessor,
-            blockStart,
-            blockStart + docCountInBlock,
-            binFeatures,
-            transposedHash,
-            ctrs
-        );
+        binarizeBlock(blockStart, blockStart + docCountInBlock, binFeatures, transposedHash, ctrs);
         calcTrees(
             model,
             binFeatures.data(),
@@ -403,6 +525,74 @@ inline void CalcGeneric(
     }
 }
 
+template <typename TFloatFeatureAccessor, typename TCatFeatureAccessor>
+inline void CalcGeneric(
+    const TFullModel& model,
+    TFloatFeatureAccessor floatFeatureAccessor,
+    TCatFeatureAccessor catFeaturesAccessor,
+    size_t docCount,
+    size_t treeStart,
+    size_t treeEnd,
+    TArrayRef<double> results,
+    TModelEvaluationBuffers* buffers = nullptr)
+{
+    CalcGenericImpl(
+        model,
+        [&](size_t start, size_t end, TArrayRef<ui8> binFeatures, TVector<ui32>& transposedHash, TVector<float>& ctrs) {
+            BinarizeFeatures(
+                model,
+                floatFeatureAccessor,
+                catFeaturesAccessor,
+                start,
+                end,
+                binFeatures,
+                transposedHash,
+                ctrs
+            );
+        },
+        docCount,
+        treeStart,
+        treeEnd,
+        results,
+        buffers);
+}
+
+/**
+ * Evaluates model on quantized float features skipping float binarization,
+ * floatBinAccessor returns bin of float feature as stored in quantized pool, see BinarizeQuantizedFeatures
+ */
+template <typename TFloatBinAccessor, typename TCatFeatureAccessor>
+inline void CalcGenericQuantized(
+    const TFullModel& model,
+    TConstArrayRef<TVector<ui8>> floatBinsRemap,
+    TFloatBinAccessor floatBinAccessor,
+    TCatFeatureAccessor catFeaturesAccessor,
+    size_t docCount,
+    size_t treeStart,
+    size_t treeEnd,
+    TArrayRef<double> results)
+{
+    CalcGenericImpl(
+        model,
+        [&](size_t start, size_t end, TArrayRef<ui8> binFeatures, TVector<ui32>& transposedHash, TVector<float>& ctrs) {
+            BinarizeQuantizedFeatures(
+                model,
+                floatBinsRemap,
+                floatBinAccessor,
+                catFeaturesAccessor,
+                start,
+                end,
+                binFeatures,
+                transposedHash,
+                ctrs
+            );
+        },
+        docCount,
+        treeStart,
+        treeEnd,
+        results);
+}
+
 
 /**
  * Warning: use aggressive caching. Stores all binarized features in RAM
@@ -417,31 +607,43 @@ public:
                                 size_t docCount)
             : Model(model)
             , DocCount(docCount) {
+        CacheBinFeatures([&](size_t start, size_t end, TArrayRef<ui8> binFeatures, TVector<ui32>& transposedHash, TVector<float>& ctrs) {
+            BinarizeFeatures(model, floatFeatureAccessor, catFeaturesAccessor, start, end, binFeatures, transposedHash, ctrs);
+        });
+    }
+
+    // float features are taken from quantized pool, see BinarizeQuantizedFeatures
+    template <typename TFloatBinAccessor,
+             typename TCatFeatureAccessor>
+    TFeatureCachedTreeEvaluator(const TFullModel& model,
+                                TConstArrayRef<TVector<ui8>> floatBinsRemap,
+                                TFloatBinAccessor floatBinAccessor,
+                                TCatFeatureAccessor catFeaturesAccessor,
+                                size_t docCount)
+            : Model(model)
+            , DocCount(docCount) {
+        CacheBinFeatures([&](size_t start, size_t end, TArrayRef<ui8> binFeatures, TVector<ui32>& transposedHash, TVector<float>& ctrs) {
+            BinarizeQuantizedFeatures(model, floatBinsRemap, floatBinAccessor, catFeaturesAccessor, start, end, binFeatures, transposedHash, ctrs);
+        });
+    }
+
+    void Calc(size_t treeStart, size_t treeEnd, TArrayRef<double> results) const;
+private:
+    template <typename TBlockBinarizer>
+    void CacheBinFeatures(TBlockBinarizer binarizeBlock) {
         size_t blockSize = FORMULA_EVALUATION_BLOCK_SIZE;
-        BlockSize = Min(blockSize, docCount);
+        BlockSize = Min<size_t>(blockSize, DocCount);
         CalcFunction = GetCalcTreesFunction(Model, BlockSize);
-        TVector<ui32> transposedHash(blockSize * model.GetUsedCatFeaturesCount());
-        TVector<float> ctrs(model.ObliviousTrees.GetUsedModelCtrs().size() * blockSize);
-        {
-            for (size_t blockStart = 0; blockStart < docCount; blockStart += blockSize) {
-                const auto docCountInBlock = Min(blockSize, docCount - blockStart);
-                TVector<ui8> binFeatures(model.ObliviousTrees.GetEffectiveBinaryFeaturesBucketsCount() * blockSize);
-                BinarizeFeatures(
-                        model,
-                        floatFeatureAccessor,
-                        catFeaturesAccessor,
-                        blockStart,
-                        blockStart + docCountInBlock,
-                        binFeatures,
-                        transposedHash,
-                        ctrs
-                );
-                BinFeatures.push_back(std::move(binFeatures));
-            }
+        TVector<ui32> transposedHash(blockSize * Model.GetUsedCatFeaturesCount());
+        TVector<float> ctrs(Model.ObliviousTrees.GetUsedModelCtrs().size() * blockSize);
+        for (size_t blockStart = 0; blockStart < DocCount; blockStart += blockSize) {
+            const auto docCountInBlock = Min<size_t>(blockSize, DocCount - blockStart);
+            TVector<ui8> binFeatures(Model.ObliviousTrees.GetEffectiveBinaryFeaturesBucketsCount() * blockSize);
+            binarizeBlock(blockStart, blockStart + docCountInBlock, binFeatures, transposedHash, ctrs);
+            BinFeatures.push_back(std::move(binFeatures));
         }
     }
 
-    void Calc(size_t treeStart, size_t treeEnd, TArrayRef<double> results) const;
 private:
     const TFullModel& Model;
     TVector<TVector<ui8>> BinFeatures;
@@ -464,7 +666,7 @@ inline TVector<TVector<double>> CalcTreeIntervalsGeneric(
     TVector<TVector<double>> results(docCount, TVector<double>(treeStepCount));
     CB_ENSURE(model.ObliviousTrees.ApproxDimension == 1);
     TVector<ui8> binFeatures(model.ObliviousTrees.GetEffectiveBinaryFeaturesBucketsCount() * blockSize);
-    TVector<TCalcerIndexType> indexesVec(blockSize);
+    TVector<TCalcerIndexType> indexesVec(blockSize * CALCER_INDEXES_PER_DOCUMENT);
     TVector<ui32> transposedHash(blockSize * model.GetUsedCatFeaturesCount());
     TVector<float> ctrs(model.ObliviousTrees.GetUsedModelCtrs().size() * blockSize);
     TVector<double> tmpResult(docCount);
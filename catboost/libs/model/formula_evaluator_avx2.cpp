@@ -0,0 +1,322 @@
+#include "formula_evaluator_avx2.h"
+
+#include <util/system/compiler.h>
+#include <util/system/unaligned_mem.h>
+#include <util/system/yassert.h>
+
+#include <algorithm>
+
+#if defined(__AVX2__)
+
+#include <immintrin.h>
+
+void BinarizeFloats32Avx2(
+    const float* values,
+    const float* borders,
+    size_t borderCount,
+    size_t maxValuesPerBin,
+    bool useNanSubstitution,
+    float nanSubstitutionValue,
+    ui8* result,
+    size_t rowStride)
+{
+    __m256 floats0 = _mm256_loadu_ps(values);
+    __m256 floats1 = _mm256_loadu_ps(values + 8);
+    __m256 floats2 = _mm256_loadu_ps(values + 16);
+    __m256 floats3 = _mm256_loadu_ps(values + 24);
+    if (useNanSubstitution) {
+        const __m256 substitutionValVec = _mm256_set1_ps(nanSubstitutionValue);
+#define SUBSTITUTE_NANS(floats) floats = _mm256_blendv_ps(floats, substitutionValVec, _mm256_cmp_ps(floats, floats, _CMP_UNORD_Q));
+        SUBSTITUTE_NANS(floats0);
+        SUBSTITUTE_NANS(floats1);
+        SUBSTITUTE_NANS(floats2);
+        SUBSTITUTE_NANS(floats3);
+#undef SUBSTITUTE_NANS
+    }
+    const __m256i mask = _mm256_set1_epi8(1);
+    // packs work inside 128-bit lanes, so after packing dword k holds documents of group [0, 2, 4, 6, 1, 3, 5, 7][k]
+    const __m256i unpermute = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+    for (size_t blockStart = 0; blockStart < borderCount; blockStart += maxValuesPerBin) {
+        __m256i resultVec = _mm256_setzero_si256();
+        const size_t blockEnd = std::min(blockStart + maxValuesPerBin, borderCount);
+        for (size_t borderId = blockStart; borderId < blockEnd; ++borderId) {
+            const __m256 borderVec = _mm256_set1_ps(borders[borderId]);
+            const __m256i r0 = _mm256_castps_si256(_mm256_cmp_ps(floats0, borderVec, _CMP_GT_OQ));
+            const __m256i r1 = _mm256_castps_si256(_mm256_cmp_ps(floats1, borderVec, _CMP_GT_OQ));
+            const __m256i r2 = _mm256_castps_si256(_mm256_cmp_ps(floats2, borderVec, _CMP_GT_OQ));
+            const __m256i r3 = _mm256_castps_si256(_mm256_cmp_ps(floats3, borderVec, _CMP_GT_OQ));
+            const __m256i packed = _mm256_packs_epi16(_mm256_packs_epi32(r0, r1), _mm256_packs_epi32(r2, r3));
+            resultVec = _mm256_add_epi8(resultVec, _mm256_and_si256(packed, mask));
+        }
+        _mm256_storeu_si256((__m256i*)result, _mm256_permutevar8x32_epi32(resultVec, unpermute));
+        result += rowStride;
+    }
+}
+
+template <bool NeedXorMask>
+static Y_FORCE_INLINE void CalcIndexesAvx2Impl(
+    const ui8* __restrict binFeatures,
+    size_t docCountInBlock,
+    ui8* __restrict indexesVec,
+    const TRepackedBin* __restrict treeSplitsCurPtr,
+    int curTreeSize)
+{
+#define _mm256_cmpge_epu8(a, b) _mm256_cmpeq_epi8(_mm256_max_epu8((a), (b)), (a))
+    const size_t docCountInBlock64 = docCountInBlock & ~(size_t)(2 * AVX2_BLOCK_SIZE - 1);
+    const size_t docCountInBlock32 = docCountInBlock & ~(size_t)(AVX2_BLOCK_SIZE - 1);
+    size_t docId = 0;
+    for (; docId < docCountInBlock64; docId += 2 * AVX2_BLOCK_SIZE) {
+        __m256i v0 = _mm256_setzero_si256();
+        __m256i v1 = _mm256_setzero_si256();
+        __m256i mask = _mm256_set1_epi8(0x01);
+        for (int depth = 0; depth < curTreeSize; ++depth) {
+            const ui8* __restrict binFeaturePtr = binFeatures + treeSplitsCurPtr[depth].FeatureIndex * docCountInBlock + docId;
+            const __m256i borderValVec = _mm256_set1_epi8(treeSplitsCurPtr[depth].SplitIdx);
+            __m256i val0 = _mm256_loadu_si256((const __m256i*)binFeaturePtr);
+            __m256i val1 = _mm256_loadu_si256((const __m256i*)(binFeaturePtr + AVX2_BLOCK_SIZE));
+            if (NeedXorMask) {
+                const __m256i xorMaskVec = _mm256_set1_epi8(treeSplitsCurPtr[depth].XorMask);
+                val0 = _mm256_xor_si256(val0, xorMaskVec);
+                val1 = _mm256_xor_si256(val1, xorMaskVec);
+            }
+            v0 = _mm256_or_si256(v0, _mm256_and_si256(_mm256_cmpge_epu8(val0, borderValVec), mask));
+            v1 = _mm256_or_si256(v1, _mm256_and_si256(_mm256_cmpge_epu8(val1, borderValVec), mask));
+            mask = _mm256_add_epi8(mask, mask);
+        }
+        _mm256_storeu_si256((__m256i*)(indexesVec + docId), v0);
+        _mm256_storeu_si256((__m256i*)(indexesVec + docId + AVX2_BLOCK_SIZE), v1);
+    }
+    for (; docId < docCountInBlock32; docId += AVX2_BLOCK_SIZE) {
+        __m256i v0 = _mm256_setzero_si256();
+        __m256i mask = _mm256_set1_epi8(0x01);
+        for (int depth = 0; depth < curTreeSize; ++depth) {
+            const ui8* __restrict binFeaturePtr = binFeatures + treeSplitsCurPtr[depth].FeatureIndex * docCountInBlock + docId;
+            const __m256i borderValVec = _mm256_set1_epi8(treeSplitsCurPtr[depth].SplitIdx);
+            __m256i val0 = _mm256_loadu_si256((const __m256i*)binFeaturePtr);
+            if (NeedXorMask) {
+                val0 = _mm256_xor_si256(val0, _mm256_set1_epi8(treeSplitsCurPtr[depth].XorMask));
+            }
+            v0 = _mm256_or_si256(v0, _mm256_and_si256(_mm256_cmpge_epu8(val0, borderValVec), mask));
+            mask = _mm256_add_epi8(mask, mask);
+        }
+        _mm256_storeu_si256((__m256i*)(indexesVec + docId), v0);
+    }
+#undef _mm256_cmpge_epu8
+    std::fill(indexesVec + docCountInBlock32, indexesVec + docCountInBlock, 0);
+    for (int depth = 0; depth < curTreeSize; ++depth) {
+        const ui8 borderVal = treeSplitsCurPtr[depth].SplitIdx;
+        const ui8 xorMask = treeSplitsCurPtr[depth].XorMask;
+        const ui8* __restrict binFeaturePtr = binFeatures + treeSplitsCurPtr[depth].FeatureIndex * docCountInBlock;
+        for (docId = docCountInBlock32; docId < docCountInBlock; ++docId) {
+            const ui8 bin = NeedXorMask ? (binFeaturePtr[docId] ^ xorMask) : binFeaturePtr[docId];
+            indexesVec[docId] |= (bin >= borderVal) << depth;
+        }
+    }
+}
+
+void CalcIndexesAvx2(
+    bool needXorMask,
+    const ui8* __restrict binFeatures,
+    size_t docCountInBlock,
+    ui8* __restrict indexesVec,
+    const TRepackedBin* __restrict treeSplitsCurPtr,
+    int curTreeSize)
+{
+    Y_ASSERT(curTreeSize <= 8);
+    if (needXorMask) {
+        CalcIndexesAvx2Impl<true>(binFeatures, docCountInBlock, indexesVec, treeSplitsCurPtr, curTreeSize);
+    } else {
+        CalcIndexesAvx2Impl<false>(binFeatures, docCountInBlock, indexesVec, treeSplitsCurPtr, curTreeSize);
+    }
+}
+
+template <bool NeedXorMask>
+static Y_FORCE_INLINE void CalcIndexes16Avx2Impl(
+    const ui8* __restrict binFeatures,
+    size_t docCountInBlock,
+    ui16* __restrict indexesVec,
+    const TRepackedBin* __restrict treeSplitsCurPtr,
+    int curTreeSize)
+{
+#define _mm_cmpge_epu8(a, b) _mm_cmpeq_epi8(_mm_max_epu8((a), (b)), (a))
+    // 16 bytes of bins are compared at once and sign extended to 16 ui16 masks
+    constexpr size_t docsPerReg = 16;
+    const size_t docCountInBlock32 = docCountInBlock & ~(size_t)(2 * docsPerReg - 1);
+    for (size_t docId = 0; docId < docCountInBlock32; docId += 2 * docsPerReg) {
+        __m256i v0 = _mm256_setzero_si256();
+        __m256i v1 = _mm256_setzero_si256();
+        __m256i mask = _mm256_set1_epi16(0x01);
+        for (int depth = 0; depth < curTreeSize; ++depth) {
+            const ui8* __restrict binFeaturePtr = binFeatures + treeSplitsCurPtr[depth].FeatureIndex * docCountInBlock + docId;
+            const __m128i borderValVec = _mm_set1_epi8(treeSplitsCurPtr[depth].SplitIdx);
+            __m128i val0 = _mm_loadu_si128((const __m128i*)binFeaturePtr);
+            __m128i val1 = _mm_loadu_si128((const __m128i*)(binFeaturePtr + docsPerReg));
+            if (NeedXorMask) {
+                const __m128i xorMaskVec = _mm_set1_epi8(treeSplitsCurPtr[depth].XorMask);
+                val0 = _mm_xor_si128(val0, xorMaskVec);
+                val1 = _mm_xor_si128(val1, xorMaskVec);
+            }
+            v0 = _mm256_or_si256(v0, _mm256_and_si256(_mm256_cvtepi8_epi16(_mm_cmpge_epu8(val0, borderValVec)), mask));
+            v1 = _mm256_or_si256(v1, _mm256_and_si256(_mm256_cvtepi8_epi16(_mm_cmpge_epu8(val1, borderValVec)), mask));
+            mask = _mm256_add_epi16(mask, mask);
+        }
+        _mm256_storeu_si256((__m256i*)(indexesVec + docId), v0);
+        _mm256_storeu_si256((__m256i*)(indexesVec + docId + docsPerReg), v1);
+    }
+#undef _mm_cmpge_epu8
+    std::fill(indexesVec + docCountInBlock32, indexesVec + docCountInBlock, 0);
+    for (int depth = 0; depth < curTreeSize; ++depth) {
+        const ui8 borderVal = treeSplitsCurPtr[depth].SplitIdx;
+        const ui8 xorMask = treeSplitsCurPtr[depth].XorMask;
+        const ui8* __restrict binFeaturePtr = binFeatures + treeSplitsCurPtr[depth].FeatureIndex * docCountInBlock;
+        for (size_t docId = docCountInBlock32; docId < docCountInBlock; ++docId) {
+            const ui8 bin = NeedXorMask ? (binFeaturePtr[docId] ^ xorMask) : binFeaturePtr[docId];
+            indexesVec[docId] |= (bin >= borderVal) << depth;
+        }
+    }
+}
+
+void CalcIndexes16Avx2(
+    bool needXorMask,
+    const ui8* __restrict binFeatures,
+    size_t docCountInBlock,
+    ui16* __restrict indexesVec,
+    const TRepackedBin* __restrict treeSplitsCurPtr,
+    int curTreeSize)
+{
+    Y_ASSERT(curTreeSize <= 16);
+    if (needXorMask) {
+        CalcIndexes16Avx2Impl<true>(binFeatures, docCountInBlock, indexesVec, treeSplitsCurPtr, curTreeSize);
+    } else {
+        CalcIndexes16Avx2Impl<false>(binFeatures, docCountInBlock, indexesVec, treeSplitsCurPtr, curTreeSize);
+    }
+}
+
+static Y_FORCE_INLINE __m128i Load4Indexes(const ui8* indexesPtr) {
+    return _mm_cvtepu8_epi32(_mm_cvtsi32_si128(ReadUnaligned<int>(indexesPtr)));
+}
+
+static Y_FORCE_INLINE __m128i Load4Indexes(const ui16* indexesPtr) {
+    return _mm_cvtepu16_epi32(_mm_loadl_epi64((const __m128i*)indexesPtr));
+}
+
+template <typename TIndexType>
+static Y_FORCE_INLINE void CalculateLeafValues4Avx2Impl(
+    size_t docCountInBlock,
+    const double* __restrict treeLeafPtr0,
+    const double* __restrict treeLeafPtr1,
+    const double* __restrict treeLeafPtr2,
+    const double* __restrict treeLeafPtr3,
+    const TIndexType* __restrict indexesPtr0,
+    const TIndexType* __restrict indexesPtr1,
+    const TIndexType* __restrict indexesPtr2,
+    const TIndexType* __restrict indexesPtr3,
+    double* __restrict writePtr)
+{
+    const size_t docCountInBlock8 = docCountInBlock & ~(size_t)7;
+    size_t docId = 0;
+    for (; docId < docCountInBlock8; docId += 8) {
+        __m256d sum0 = _mm256_loadu_pd(writePtr + docId);
+        __m256d sum1 = _mm256_loadu_pd(writePtr + docId + 4);
+#define GATHER_ADD_LEAFS(treeIdx) \
+        sum0 = _mm256_add_pd(sum0, _mm256_i32gather_pd(treeLeafPtr##treeIdx, Load4Indexes(indexesPtr##treeIdx + docId), sizeof(double))); \
+        sum1 = _mm256_add_pd(sum1, _mm256_i32gather_pd(treeLeafPtr##treeIdx, Load4Indexes(indexesPtr##treeIdx + docId + 4), sizeof(double)));
+        GATHER_ADD_LEAFS(0);
+        GATHER_ADD_LEAFS(1);
+        GATHER_ADD_LEAFS(2);
+        GATHER_ADD_LEAFS(3);
+#undef GATHER_ADD_LEAFS
+        _mm256_storeu_pd(writePtr + docId, sum0);
+        _mm256_storeu_pd(writePtr + docId + 4, sum1);
+    }
+    for (; docId < docCountInBlock; ++docId) {
+        writePtr[docId] += treeLeafPtr0[indexesPtr0[docId]] + treeLeafPtr1[indexesPtr1[docId]]
+            + treeLeafPtr2[indexesPtr2[docId]] + treeLeafPtr3[indexesPtr3[docId]];
+    }
+}
+
+void CalculateLeafValues4Avx2(
+    size_t docCountInBlock,
+    const double* __restrict treeLeafPtr0,
+    const double* __restrict treeLeafPtr1,
+    const double* __restrict treeLeafPtr2,
+    const double* __restrict treeLeafPtr3,
+    const ui8* __restrict indexesPtr0,
+    const ui8* __restrict indexesPtr1,
+    const ui8* __restrict indexesPtr2,
+    const ui8* __restrict indexesPtr3,
+    double* __restrict writePtr)
+{
+    CalculateLeafValues4Avx2Impl(
+        docCountInBlock,
+        treeLeafPtr0, treeLeafPtr1, treeLeafPtr2, treeLeafPtr3,
+        indexesPtr0, indexesPtr1, indexesPtr2, indexesPtr3,
+        writePtr);
+}
+
+void CalculateLeafValues4Avx2(
+    size_t docCountInBlock,
+    const double* __restrict treeLeafPtr0,
+    const double* __restrict treeLeafPtr1,
+    const double* __restrict treeLeafPtr2,
+    const double* __restrict treeLeafPtr3,
+    const ui16* __restrict indexesPtr0,
+    const ui16* __restrict indexesPtr1,
+    const ui16* __restrict indexesPtr2,
+    const ui16* __restrict indexesPtr3,
+    double* __restrict writePtr)
+{
+    CalculateLeafValues4Avx2Impl(
+        docCountInBlock,
+        treeLeafPtr0, treeLeafPtr1, treeLeafPtr2, treeLeafPtr3,
+        indexesPtr0, indexesPtr1, indexesPtr2, indexesPtr3,
+        writePtr);
+}
+
+#else
+
+// non-x86 build: dispatching code never selects AVX2 kernels there
+
+void BinarizeFloats32Avx2(const float*, const float*, size_t, size_t, bool, float, ui8*, size_t) {
+    Y_FAIL("AVX2 is not supported in this build");
+}
+
+void CalcIndexesAvx2(bool, const ui8* __restrict, size_t, ui8* __restrict, const TRepackedBin* __restrict, int) {
+    Y_FAIL("AVX2 is not supported in this build");
+}
+
+void CalcIndexes16Avx2(bool, const ui8* __restrict, size_t, ui16* __restrict, const TRepackedBin* __restrict, int) {
+    Y_FAIL("AVX2 is not supported in this build");
+}
+
+void CalculateLeafValues4Avx2(
+    size_t,
+    const double* __restrict,
+    const double* __restrict,
+    const double* __restrict,
+    const double* __restrict,
+    const ui8* __restrict,
+    const ui8* __restrict,
+    const ui8* __restrict,
+    const ui8* __restrict,
+    double* __restrict)
+{
+    Y_FAIL("AVX2 is not supported in this build");
+}
+
+void CalculateLeafValues4Avx2(
+    size_t,
+    const double* __restrict,
+    const double* __restrict,
+    const double* __restrict,
+    const double* __restrict,
+    const ui16* __restrict,
+    const ui16* __restrict,
+    const ui16* __restrict,
+    const ui16* __restrict,
+    double* __restrict)
+{
+    Y_FAIL("AVX2 is not supported in this build");
+}
+
+#endif
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "repacked_bin.h"
+
+#include <util/system/types.h>
+
+#include <cstddef>
+
+/**
+ * AVX2 kernels for blocked model evaluation. They are compiled with AVX2 codegen in a separate translation unit,
+ * so callers must check NX86::CachedHaveAVX2() before calling any of them.
+ * Only plain pointers are passed here to avoid instantiating inline model code with AVX2 instructions.
+ */
+
+constexpr size_t AVX2_BLOCK_SIZE = 32;
+
+/**
+ * Binarize AVX2_BLOCK_SIZE float values.
+ * @param values 32 feature values of consecutive documents
+ * @param borders feature borders, split by MAX_VALUES_PER_BIN into bucket rows
+ * @param result pointer to first document bin in first bucket row
+ * @param rowStride distance between bucket rows in result (docCount in block)
+ */
+void BinarizeFloats32Avx2(
+    const float* values,
+    const float* borders,
+    size_t borderCount,
+    size_t maxValuesPerBin,
+    bool useNanSubstitution,
+    float nanSubstitutionValue,
+    ui8* result,
+    size_t rowStride);
+
+/**
+ * Calculate ui8 leaf indexes for tree with depth <= 8 on all documents of block.
+ * @param indexesVec output, overwritten
+ */
+void CalcIndexesAvx2(
+    bool needXorMask,
+    const ui8* __restrict binFeatures,
+    size_t docCountInBlock,
+    ui8* __restrict indexesVec,
+    const TRepackedBin* __restrict treeSplitsCurPtr,
+    int curTreeSize);
+
+/**
+ * Calculate ui16 leaf indexes for tree with depth <= 16 on all documents of block.
+ * @param indexesVec output, overwritten
+ */
+void CalcIndexes16Avx2(
+    bool needXorMask,
+    const ui8* __restrict binFeatures,
+    size_t docCountInBlock,
+    ui16* __restrict indexesVec,
+    const TRepackedBin* __restrict treeSplitsCurPtr,
+    int curTreeSize);
+
+/**
+ * Add leaf values of 4 trees with ui8 or ui16 leaf indexes to results using AVX2 gathers.
+ */
+void CalculateLeafValues4Avx2(
+    size_t docCountInBlock,
+    const double* __restrict treeLeafPtr0,
+    const double* __restrict treeLeafPtr1,
+    const double* __restrict treeLeafPtr2,
+    const double* __restrict treeLeafPtr3,
+    const ui8* __restrict indexesPtr0,
+    const ui8* __restrict indexesPtr1,
+    const ui8* __restrict indexesPtr2,
+    const ui8* __restrict indexesPtr3,
+    double* __restrict writePtr);
+
+void CalculateLeafValues4Avx2(
+    size_t docCountInBlock,
+    const double* __restrict treeLeafPtr0,
+    const double* __restrict treeLeafPtr1,
+    const double* __restrict treeLeafPtr2,
+    const double* __restrict treeLeafPtr3,
+    const ui16* __restrict indexesPtr0,
+    const ui16* __restrict indexesPtr1,
+    const ui16* __restrict indexesPtr2,
+    const ui16* __restrict indexesPtr3,
+    double* __restrict writePtr);
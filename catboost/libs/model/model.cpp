@@ -69,6 +69,14 @@ static NJson::TJsonValue RemoveInvalidParams(const NJson::TJsonValue& params) {
     return result;
 }
 
+static void RemoveInvalidModelInfoParams(TFullModel* model) {
+    if (model->ModelInfo.contains("params")) {
+        NJson::TJsonValue paramsJson = ReadTJsonValue(model->ModelInfo.at("params"));
+        paramsJson["flat_params"] = RemoveInvalidParams(paramsJson["flat_params"]);
+        model->ModelInfo["params"] = ToString<NJson::TJsonValue>(paramsJson);
+    }
+}
+
 TFullModel ReadModel(IInputStream* modelStream, EModelType format) {
     TFullModel model;
     if (format == EModelType::CatboostBinary) {
@@ -81,11 +89,7 @@ TFullModel ReadModel(IInputStream* modelStream, EModelType format) {
         CB_ENSURE(coreMLModel.ParseFromString(modelStream->ReadAll()), "coreml model deserialization failed");
         NCatboost::NCoreML::ConvertCoreMLToCatboostModel(coreMLModel, &model);
     }
-    if (model.ModelInfo.contains("params")) {
-        NJson::TJsonValue paramsJson = ReadTJsonValue(model.ModelInfo.at("params"));
-        paramsJson["flat_params"] = RemoveInvalidParams(paramsJson["flat_params"]);
-        model.ModelInfo["params"] = ToString<NJson::TJsonValue>(paramsJson);
-    }
+    RemoveInvalidModelInfoParams(&model);
     return model;
 }
 
@@ -101,6 +105,21 @@ TFullModel ReadModel(const void* binaryBuffer, size_t binaryBufferSize, EModelTy
     return ReadModel(&bs, format);
 }
 
+TFullModel ReadZeroCopyModel(const void* binaryBuffer, size_t binaryBufferSize) {
+    TFullModel model;
+    model.InitNonOwning(binaryBuffer, binaryBufferSize);
+    RemoveInvalidModelInfoParams(&model);
+    return model;
+}
+
+TFullModel ReadMappedModel(const TString& modelFile, bool precharge) {
+    CB_ENSURE(NFs::Exists(modelFile), "Model file doesn't exist: " << modelFile);
+    TFullModel model;
+    model.InitNonOwning(precharge ? TBlob::PrechargedFromFile(modelFile) : TBlob::FromFile(modelFile));
+    RemoveInvalidModelInfoParams(&model);
+    return model;
+}
+
 void OutputModelCoreML(const TFullModel& model, const TString& modelFile, const NJson::TJsonValue& userParameters) {
     CoreML::Specification::Model outModel;
     outModel.set_specificationversion(1);
@@ -332,7 +351,8 @@ void TObliviousTrees::DropUnusedFeatures() {
 void TFullModel::CalcFlat(TConstArrayRef<TConstArrayRef<float>> features,
                           size_t treeStart,
                           size_t treeEnd,
-                          TArrayRef<double> results) const {
+                          TArrayRef<double> results,
+                          TModelEvaluationBuffers* buffers) const {
     const auto expectedFlatVecSize = ObliviousTrees.GetFlatFeatureVectorExpectedSize();
     for (const auto& flatFeaturesVec : features) {
         CB_ENSURE(flatFeaturesVec.size() >= expectedFlatVecSize,
@@ -350,7 +370,8 @@ void TFullModel::CalcFlat(TConstArrayRef<TConstArrayRef<float>> features,
         features.size(),
         treeStart,
         treeEnd,
-        results
+        results,
+        buffers
     );
 }
 
@@ -374,7 +395,8 @@ void TFullModel::CalcFlatSingle(TConstArrayRef<float> features, size_t treeStart
 void TFullModel::CalcFlatTransposed(TConstArrayRef<TConstArrayRef<float>> transposedFeatures,
                                     size_t treeStart,
                                     size_t treeEnd,
-                                    TArrayRef<double> results) const {
+                                    TArrayRef<double> results,
+                                    TModelEvaluationBuffers* buffers) const {
     CB_ENSURE(ObliviousTrees.GetFlatFeatureVectorExpectedSize() <= transposedFeatures.size(), "Not enough features provided");
     CalcGeneric(
         *this,
@@ -387,7 +409,8 @@ void TFullModel::CalcFlatTransposed(TConstArrayRef<TConstArrayRef<float>> transp
         transposedFeatures[0].Size(),
         treeStart,
         treeEnd,
-        results
+        results,
+        buffers
     );
 }
 
@@ -395,7 +418,8 @@ void TFullModel::Calc(TConstArrayRef<TConstArrayRef<float>> floatFeatures,
                       TConstArrayRef<TConstArrayRef<int>> catFeatures,
                       size_t treeStart,
                       size_t treeEnd,
-                      TArrayRef<double> results) const {
+                      TArrayRef<double> results,
+                      TModelEvaluationBuffers* buffers) const {
     if (!floatFeatures.empty() && !catFeatures.empty()) {
         CB_ENSURE(catFeatures.size() == floatFeatures.size());
     }
@@ -423,7 +447,8 @@ void TFullModel::Calc(TConstArrayRef<TConstArrayRef<float>> floatFeatures,
         docCount,
         treeStart,
         treeEnd,
-        results
+        results,
+        buffers
     );
 }
 
@@ -553,32 +578,25 @@ void TFullModel::Save(IOutputStream* s) const {
     }
 }
 
-void TFullModel::Load(IInputStream* s) {
+static TVector<TString> DeserializeModelCore(const ui8* coreData, size_t coreSize, TFullModel* model) {
     using namespace flatbuffers;
     using namespace NCatBoostFbs;
-    ui32 fileDescriptor;
-    ::Load(s, fileDescriptor);
-    CB_ENSURE(fileDescriptor == GetModelFormatDescriptor(), "Incorrect model file descriptor");
-    auto coreSize = ::LoadSize(s);
-    TArrayHolder<ui8> arrayHolder = new ui8[coreSize];
-    s->LoadOrFail(arrayHolder.Get(), coreSize);
-
     {
-        flatbuffers::Verifier verifier(arrayHolder.Get(), coreSize);
+        flatbuffers::Verifier verifier(coreData, coreSize);
         CB_ENSURE(VerifyTModelCoreBuffer(verifier), "Flatbuffers model verification failed");
     }
-    auto fbModelCore = GetTModelCore(arrayHolder.Get());
+    auto fbModelCore = GetTModelCore(coreData);
     CB_ENSURE(
         fbModelCore->FormatVersion() && fbModelCore->FormatVersion()->str() == CURRENT_CORE_FORMAT_STRING,
         "Unsupported model format: " << fbModelCore->FormatVersion()->str()
     );
     if (fbModelCore->ObliviousTrees()) {
-        ObliviousTrees.FBDeserialize(fbModelCore->ObliviousTrees());
+        model->ObliviousTrees.FBDeserialize(fbModelCore->ObliviousTrees());
     }
-    ModelInfo.clear();
+    model->ModelInfo.clear();
     if (fbModelCore->InfoMap()) {
         for (auto keyVal : *fbModelCore->InfoMap()) {
-            ModelInfo[keyVal->Key()->str()] = keyVal->Value()->str();
+            model->ModelInfo[keyVal->Key()->str()] = keyVal->Value()->str();
         }
     }
     TVector<TString> modelParts;
@@ -589,13 +607,50 @@ void TFullModel::Load(IInputStream* s) {
     }
     if (!modelParts.empty()) {
         CB_ENSURE(modelParts.size() == 1, "only single part model supported now");
-        CtrProvider = new TStaticCtrProvider;
-        CB_ENSURE(modelParts[0] == CtrProvider->ModelPartIdentifier(), "only static ctr models supported");
+        model->CtrProvider = new TStaticCtrProvider;
+        CB_ENSURE(modelParts[0] == model->CtrProvider->ModelPartIdentifier(), "only static ctr models supported");
+    }
+    return modelParts;
+}
+
+void TFullModel::Load(IInputStream* s) {
+    ui32 fileDescriptor;
+    ::Load(s, fileDescriptor);
+    CB_ENSURE(fileDescriptor == GetModelFormatDescriptor(), "Incorrect model file descriptor");
+    auto coreSize = ::LoadSize(s);
+    TArrayHolder<ui8> arrayHolder = new ui8[coreSize];
+    s->LoadOrFail(arrayHolder.Get(), coreSize);
+
+    const auto modelParts = DeserializeModelCore(arrayHolder.Get(), coreSize, this);
+    if (!modelParts.empty()) {
         CtrProvider->Load(s);
     }
+    ModelBlob.Drop();
+    UpdateDynamicData();
+}
+
+void TFullModel::InitNonOwning(const void* binaryBuffer, size_t binarySize) {
+    TMemoryInput in(binaryBuffer, binarySize);
+    ui32 fileDescriptor;
+    ::Load(&in, fileDescriptor);
+    CB_ENSURE(fileDescriptor == GetModelFormatDescriptor(), "Incorrect model file descriptor");
+    auto coreSize = ::LoadSize(&in);
+    CB_ENSURE(in.Avail() >= coreSize, "Model buffer is too small: expected at least " << coreSize << " bytes of model core");
+    const ui8* coreData = reinterpret_cast<const ui8*>(in.Buf());
+    in.Skip(coreSize);
+
+    const auto modelParts = DeserializeModelCore(coreData, coreSize, this);
+    if (!modelParts.empty()) {
+        CtrProvider->LoadNonOwning(&in);
+    }
     UpdateDynamicData();
 }
 
+void TFullModel::InitNonOwning(const TBlob& modelBlob) {
+    InitNonOwning(modelBlob.Data(), modelBlob.Size());
+    ModelBlob = modelBlob;
+}
+
 TVector<TString> GetModelUsedFeaturesNames(const TFullModel& model) {
     TVector<int> featuresIdxs;
     TVector<TString> featuresNames;
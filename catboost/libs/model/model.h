@@ -2,6 +2,7 @@
 
 #include "features.h"
 #include "online_ctr.h"
+#include "repacked_bin.h"
 #include "split.h"
 #include "static_ctr_provider.h"
 
@@ -12,10 +13,12 @@
 
 #include <library/json/json_reader.h>
 
+#include <util/memory/blob.h>
 #include <util/stream/file.h>
 #include <util/system/mutex.h>
 
 class TModelPartsCachingSerializer;
+struct TModelEvaluationBuffers;
 
 /*!
     \brief Oblivious tree model structure
@@ -39,12 +42,6 @@ class TModelPartsCachingSerializer;
     - TreeSizes - holds tree depth.
     - TreeStartOffsets - holds offset of first tree split in TreeSplits vector
 */
-struct TRepackedBin {
-    ui16 FeatureIndex = 0;
-    ui8 XorMask = 0;
-    ui8 SplitIdx = 0;
-};
-
 struct TObliviousTrees {
 
     /**
@@ -341,11 +338,17 @@ struct TFullModel {
      */
     THashMap<TString, TString> ModelInfo;
     TIntrusivePtr<ICtrProvider> CtrProvider;
+    /**
+     * Backing storage for models loaded with InitNonOwning(const TBlob&).
+     * CTR tables of such models are views into this memory, so it is shared between model copies.
+     */
+    TBlob ModelBlob;
 
     void Swap(TFullModel& other) {
         DoSwap(ObliviousTrees, other.ObliviousTrees);
         DoSwap(ModelInfo, other.ModelInfo);
         DoSwap(CtrProvider, other.CtrProvider);
+        DoSwap(ModelBlob, other.ModelBlob);
     }
 
     /**
@@ -434,6 +437,21 @@ struct TFullModel {
      */
     void Load(IInputStream* s);
 
+    /**
+     * Deserialize model from memory buffer without copying CTR tables - they will reference buffer memory.
+     * Buffer must stay alive and unchanged while model is used.
+     * @param binaryBuffer pointer to serialized model (f.e. mapped model file)
+     * @param binarySize buffer size in bytes
+     */
+    void InitNonOwning(const void* binaryBuffer, size_t binarySize);
+
+    /**
+     * Same as InitNonOwning for raw buffer, but model holds a reference to the blob,
+     * so mapped memory stays alive as long as the model (or any of its copies) does.
+     * @param modelBlob blob with serialized model, f.e. TBlob::FromFile(modelFile)
+     */
+    void InitNonOwning(const TBlob& modelBlob);
+
     //! Check if TFullModel instance has valid CTR provider.
     // If no ctr features present it will return true
     bool HasValidCtrProvider() const {
@@ -451,8 +469,14 @@ struct TFullModel {
      * @param[in] treeEnd Index of tree after the last tree in model to evaluate. F.e. if you want to evaluate trees 2..5 use treeStart = 2, treeEnd = 6
      * @param[out] results Flat double vector with indexation [objectIndex * ApproxDimension + classId].
      * For single class models it is just [objectIndex]
+     * @param[in] buffers optional scratch buffers reused between calls, see TModelEvaluationBuffers
      */
-    void CalcFlatTransposed(TConstArrayRef<TConstArrayRef<float>> transposedFeatures, size_t treeStart, size_t treeEnd, TArrayRef<double> results) const;
+    void CalcFlatTransposed(
+        TConstArrayRef<TConstArrayRef<float>> transposedFeatures,
+        size_t treeStart,
+        size_t treeEnd,
+        TArrayRef<double> results,
+        TModelEvaluationBuffers* buffers = nullptr) const;
 
     /**
      * Special interface for model evaluation on flat feature vectors. Flat here means that float features and categorical feature are in the same float array.
@@ -462,8 +486,14 @@ struct TFullModel {
      * @param[in] treeEnd Index of tree after the last tree in model to evaluate. F.e. if you want to evaluate trees 2..5 use treeStart = 2, treeEnd = 6
      * @param[out] results Flat double vector with indexation [objectIndex * ApproxDimension + classId].
      * For single class models it is just [objectIndex]
+     * @param[in] buffers optional scratch buffers reused between calls, see TModelEvaluationBuffers
      */
-    void CalcFlat(TConstArrayRef<TConstArrayRef<float>> features, size_t treeStart, size_t treeEnd, TArrayRef<double> results) const;
+    void CalcFlat(
+        TConstArrayRef<TConstArrayRef<float>> features,
+        size_t treeStart,
+        size_t treeEnd,
+        TArrayRef<double> results,
+        TModelEvaluationBuffers* buffers = nullptr) const;
 
     /**
      * Call CalcFlat on all model trees
@@ -531,12 +561,14 @@ struct TFullModel {
      * @param[in] treeStart
      * @param[in] treeEnd
      * @param[out] results results indexation is [objectIndex * ApproxDimension + classId]
+     * @param[in] buffers optional scratch buffers reused between calls, see TModelEvaluationBuffers
      */
     void Calc(TConstArrayRef<TConstArrayRef<float>> floatFeatures,
               TConstArrayRef<TConstArrayRef<int>> catFeatures,
               size_t treeStart,
               size_t treeEnd,
-              TArrayRef<double> results) const;
+              TArrayRef<double> results,
+              TModelEvaluationBuffers* buffers = nullptr) const;
 
     /**
      * Evaluate raw formula predictions on user data. Uses all model trees
@@ -625,6 +657,20 @@ void OutputModel(const TFullModel& model, IOutputStream* out);
 TFullModel ReadModel(const TString& modelFile, EModelType format = EModelType::CatboostBinary);
 TFullModel ReadModel(const void* binaryBuffer, size_t binaryBufferSize, EModelType format = EModelType::CatboostBinary);
 
+/**
+ * Read model in CatboostBinary format from memory buffer without copying CTR tables.
+ * Buffer must outlive returned model.
+ */
+TFullModel ReadZeroCopyModel(const void* binaryBuffer, size_t binaryBufferSize);
+
+/**
+ * Map model file into memory and read model from it in zero-copy mode.
+ * Mapped pages are shared between all processes that map the same file.
+ * @param modelFile model file in CatboostBinary format
+ * @param precharge touch all mapped pages on load (trades startup time for the first predictions latency)
+ */
+TFullModel ReadMappedModel(const TString& modelFile, bool precharge = false);
+
 /**
  * Export model in our binary or protobuf CoreML format
  * @param model
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <util/system/types.h>
+
+/**
+ * Binary condition of oblivious tree level in the layout used by formula evaluator:
+ * | featureIndex | xorMask | splitIdx |
+ * Kept in a separate header, so that ISA-specific evaluation kernels can use it without the full model.h
+ */
+struct TRepackedBin {
+    ui16 FeatureIndex = 0;
+    ui8 XorMask = 0;
+    ui8 SplitIdx = 0;
+};
@@ -58,6 +58,10 @@ public:
         ::Load(inp, CtrData);
     }
 
+    void LoadNonOwning(TMemoryInput* in) override {
+        CtrData.LoadNonOwning(in);
+    }
+
     TString ModelPartIdentifier() const override {
         return "static_provider_v1";
     }
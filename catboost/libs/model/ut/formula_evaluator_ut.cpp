@@ -1,3 +1,5 @@
+#include "model_test_helpers.h"
+
 #include <library/unittest/registar.h>
 
 #include <catboost/libs/data_new/data_provider_builders.h>
@@ -6,6 +8,7 @@
 #include <catboost/libs/train_lib/train_model.h>
 
 #include <util/folder/tempdir.h>
+#include <util/random/fast.h>
 
 
 using namespace NCB;
@@ -73,6 +76,33 @@ static TFullModel MultiValueFloatModel() {
     return model;
 }
 
+static TFullModel RandomDeepFloatModel(TFastRng64& rng) {
+    const int featureCount = 16;
+    TFullModel model;
+    for (int featureId = 0; featureId < featureCount; ++featureId) {
+        model.ObliviousTrees.FloatFeatures.push_back(
+            TFloatFeature{
+                false, featureId, featureId,
+                {0.25f, 0.5f, 0.75f}, // bin splits 3 * featureId .. 3 * featureId + 2
+                ""
+            }
+        );
+    }
+    // first group of 4 trees is deep, second mixes depths, the rest is evaluated tree by tree
+    for (int depth : {10, 12, 9, 16, 6, 11, 3, 8, 14}) {
+        TVector<int> tree;
+        for (int level = 0; level < depth; ++level) {
+            tree.push_back(rng.Uniform(3 * featureCount));
+        }
+        model.ObliviousTrees.AddBinTree(tree);
+        for (int leafId = 0; leafId < (1 << depth); ++leafId) {
+            model.ObliviousTrees.LeafValues.push_back(rng.GenRandReal1());
+        }
+    }
+    model.UpdateDynamicData();
+    return model;
+}
+
 // Deterministically train model that has only 3 categoric features.
 static TFullModel TrainCatOnlyModel() {
     TTempDir trainDir;
@@ -189,4 +219,76 @@ Y_UNIT_TEST_SUITE(TObliviousTreeModel) {
         };
         UNIT_ASSERT_NO_EXCEPTION(applyBatch());
     }
+
+    Y_UNIT_TEST(TestBlockedCalcMatchesSingleDoc) {
+        // block sizes not divisible by SIMD widths check vectorized kernels tails
+        const auto model = TrainFloatCatboostModel(/*iterations*/ 13);
+        TFastRng64 rng(42);
+        const size_t docCount = 1000;
+        TVector<TVector<float>> data(docCount, TVector<float>(model.GetNumFloatFeatures()));
+        for (auto& doc : data) {
+            for (auto& value : doc) {
+                value = rng.GenRandReal1();
+            }
+        }
+        TVector<TConstArrayRef<float>> features(data.begin(), data.end());
+        TVector<double> blockedResult(docCount);
+        model.CalcFlat(features, blockedResult);
+        for (size_t docId = 0; docId < docCount; ++docId) {
+            double singleResult = 0.;
+            model.CalcFlatSingle(features[docId], MakeArrayRef(&singleResult, 1));
+            UNIT_ASSERT_DOUBLES_EQUAL(singleResult, blockedResult[docId], 1e-9);
+        }
+    }
+
+    Y_UNIT_TEST(TestDeepTreesBlockedCalc) {
+        TFastRng64 rng(0);
+        const auto model = RandomDeepFloatModel(rng);
+        const size_t docCount = 300;
+        TVector<TVector<float>> data(docCount, TVector<float>(model.GetNumFloatFeatures()));
+        for (auto& doc : data) {
+            for (auto& value : doc) {
+                value = rng.GenRandReal1();
+            }
+        }
+        TVector<TConstArrayRef<float>> features(data.begin(), data.end());
+        TVector<double> blockedResult(docCount);
+        model.CalcFlat(features, blockedResult);
+        for (size_t docId = 0; docId < docCount; ++docId) {
+            double singleResult = 0.;
+            model.CalcFlatSingle(features[docId], MakeArrayRef(&singleResult, 1));
+            UNIT_ASSERT_DOUBLES_EQUAL(singleResult, blockedResult[docId], 1e-9);
+        }
+    }
+
+    Y_UNIT_TEST(TestCalcWithReusedBuffers) {
+        TFastRng64 rng(1);
+        const auto model = RandomDeepFloatModel(rng);
+        TModelEvaluationBuffers buffers;
+        // batch sizes go down and up again, so buffers are both shrunk and regrown between calls
+        for (size_t docCount : {300, 1, 129, 7, 300}) {
+            TVector<TVector<float>> data(docCount, TVector<float>(model.GetNumFloatFeatures()));
+            for (auto& doc : data) {
+                for (auto& value : doc) {
+                    value = rng.GenRandReal1();
+                }
+            }
+            TVector<TConstArrayRef<float>> features(data.begin(), data.end());
+            TVector<double> expected(docCount);
+            model.CalcFlat(features, expected);
+            TVector<double> actual(docCount);
+            model.CalcFlat(features, 0, model.GetTreeCount(), actual, &buffers);
+            UNIT_ASSERT_EQUAL(expected, actual);
+
+            TVector<TVector<float>> transposedData(model.GetNumFloatFeatures(), TVector<float>(docCount));
+            for (size_t docId = 0; docId < docCount; ++docId) {
+                for (size_t featureId = 0; featureId < transposedData.size(); ++featureId) {
+                    transposedData[featureId][docId] = data[docId][featureId];
+                }
+            }
+            TVector<TConstArrayRef<float>> transposedFeatures(transposedData.begin(), transposedData.end());
+            model.CalcFlatTransposed(transposedFeatures, 0, model.GetTreeCount(), actual, &buffers);
+            UNIT_ASSERT_EQUAL(expected, actual);
+        }
+    }
 }
@@ -1,7 +1,12 @@
 #include "model_test_helpers.h"
 
+#include <catboost/libs/algo/apply.h>
+#include <catboost/libs/train_lib/train_model.h>
+
 #include <library/unittest/registar.h>
 
+#include <util/generic/xrange.h>
+
 using namespace std;
 
 Y_UNIT_TEST_SUITE(TModelSerialization) {
@@ -23,4 +28,44 @@ Y_UNIT_TEST_SUITE(TModelSerialization) {
         UNIT_ASSERT_EQUAL(trainedModel.ObliviousTrees.LeafValues, deserializedModel.ObliviousTrees.LeafValues);
         UNIT_ASSERT_EQUAL(trainedModel.ObliviousTrees.TreeSplits, deserializedModel.ObliviousTrees.TreeSplits);
     }
+
+    Y_UNIT_TEST(TestZeroCopyDeserializeModelWithCtrs) {
+        NJson::TJsonValue params;
+        params.InsertValue("iterations", 10);
+        TFullModel trainedModel;
+        TEvalResult evalResult;
+        NCB::TDataProviderPtr pool = GetAdultPool();
+        TrainModel(
+            params,
+            nullptr,
+            Nothing(),
+            Nothing(),
+            NCB::TDataProviders{pool, {pool}},
+            "",
+            &trainedModel,
+            {&evalResult});
+        UNIT_ASSERT(!trainedModel.ObliviousTrees.GetUsedModelCtrs().empty());
+
+        const TString serializedModel = SerializeModel(trainedModel);
+        TFullModel zeroCopyModel = ReadZeroCopyModel(serializedModel.data(), serializedModel.size());
+        UNIT_ASSERT_EQUAL(trainedModel, zeroCopyModel);
+        UNIT_ASSERT(zeroCopyModel.HasValidCtrProvider());
+        auto& ctrData = dynamic_cast<const TStaticCtrProvider&>(*zeroCopyModel.CtrProvider).CtrData;
+        for (const auto& [base, table] : ctrData.LearnCtrs) {
+            UNIT_ASSERT(table.IsThin());
+        }
+        UNIT_ASSERT_EQUAL(
+            dynamic_cast<const TStaticCtrProvider&>(*trainedModel.CtrProvider).CtrData,
+            ctrData);
+
+        const auto expected = ApplyModel(trainedModel, *(pool->ObjectsData));
+        const auto actual = ApplyModel(zeroCopyModel, *(pool->ObjectsData));
+        UNIT_ASSERT_VALUES_EQUAL(expected.size(), actual.size());
+        for (auto idx : xrange(expected.size())) {
+            UNIT_ASSERT_DOUBLES_EQUAL(expected[idx], actual[idx], 1e-9);
+        }
+
+        TFullModel reserializedModel = DeserializeModel(SerializeModel(zeroCopyModel));
+        UNIT_ASSERT_EQUAL(trainedModel, reserializedModel);
+    }
 }
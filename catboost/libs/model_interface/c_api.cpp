@@ -1,18 +1,64 @@
 #include "c_api.h"
 
+#include <catboost/libs/model/formula_evaluator.h>
 #include <catboost/libs/model/model.h>
 
+#include <library/threading/local_executor/local_executor.h>
+
 #include <util/generic/singleton.h>
+#include <util/generic/ymath.h>
 #include <util/stream/file.h>
 #include <util/string/builder.h>
 
 #define FULL_MODEL_PTR(x) ((TFullModel*)(x))
+#define EVALUATION_CONTEXT_PTR(x) ((TEvaluationContext*)(x))
 
 
 struct TErrorMessageHolder {
     TString Message;
 };
 
+struct TEvaluationContext {
+    NPar::TLocalExecutor LocalExecutor;
+    TVector<TModelEvaluationBuffers> Buffers; // one per part of request
+    TVector<TVector<TConstArrayRef<float>>> FeatureRefs;
+
+    explicit TEvaluationContext(size_t threadCount)
+        : Buffers(threadCount)
+        , FeatureRefs(threadCount)
+    {
+        LocalExecutor.RunAdditionalThreads(threadCount - 1);
+    }
+
+    // Splits objects into at most one part per thread, part sizes are multiples of evaluation block size
+    template <typename TCalcPart>
+    void Calc(const TFullModel& model, size_t docCount, TArrayRef<double> results, TCalcPart calcPart) {
+        const size_t approxDimension = model.ObliviousTrees.ApproxDimension;
+        CB_ENSURE(
+            results.size() == docCount * approxDimension,
+            "`results` size is insufficient: " LabeledOutput(results.size(), docCount * approxDimension));
+        if (docCount == 0) {
+            return;
+        }
+        const size_t partSize = CeilDiv(CeilDiv(docCount, Buffers.size()), FORMULA_EVALUATION_BLOCK_SIZE) * FORMULA_EVALUATION_BLOCK_SIZE;
+        const size_t partCount = CeilDiv(docCount, partSize);
+        LocalExecutor.ExecRangeWithThrow(
+            [&] (int partIdx) {
+                const size_t begin = partIdx * partSize;
+                const size_t end = Min(begin + partSize, docCount);
+                calcPart(
+                    begin,
+                    end,
+                    results.Slice(begin * approxDimension, (end - begin) * approxDimension),
+                    &Buffers[partIdx],
+                    &FeatureRefs[partIdx]);
+            },
+            0,
+            partCount,
+            NPar::TLocalExecutor::WAIT_COMPLETE);
+    }
+};
+
 extern "C" {
 EXPORT ModelCalcerHandle* ModelCalcerCreate() {
     try {
@@ -56,6 +102,28 @@ EXPORT bool LoadFullModelFromBuffer(ModelCalcerHandle* modelHandle, const void*
     return true;
 }
 
+EXPORT bool LoadFullModelZeroCopy(ModelCalcerHandle* modelHandle, const void* binaryBuffer, size_t binaryBufferSize) {
+    try {
+        *FULL_MODEL_PTR(modelHandle) = ReadZeroCopyModel(binaryBuffer, binaryBufferSize);
+    } catch (...) {
+        Singleton<TErrorMessageHolder>()->Message = CurrentExceptionMessage();
+        return false;
+    }
+
+    return true;
+}
+
+EXPORT bool LoadFullModelFromFileMapped(ModelCalcerHandle* modelHandle, const char* filename) {
+    try {
+        *FULL_MODEL_PTR(modelHandle) = ReadMappedModel(filename);
+    } catch (...) {
+        Singleton<TErrorMessageHolder>()->Message = CurrentExceptionMessage();
+        return false;
+    }
+
+    return true;
+}
+
 EXPORT bool CalcModelPredictionFlat(ModelCalcerHandle* modelHandle, size_t docCount, const float** floatFeatures, size_t floatFeaturesSize, double* result, size_t resultSize) {
     try {
         if (docCount == 1) {
@@ -136,6 +204,76 @@ EXPORT bool CalcModelPredictionWithHashedCatFeatures(ModelCalcerHandle* modelHan
     return true;
 }
 
+EXPORT EvaluationContextHandle* EvaluationContextCreate(size_t threadCount) {
+    try {
+        CB_ENSURE(threadCount > 0, "Evaluation context needs at least one thread");
+        return new TEvaluationContext(threadCount);
+    } catch (...) {
+        Singleton<TErrorMessageHolder>()->Message = CurrentExceptionMessage();
+    }
+
+    return nullptr;
+}
+
+EXPORT void EvaluationContextDelete(EvaluationContextHandle* contextHandle) {
+    if (contextHandle != nullptr) {
+        delete EVALUATION_CONTEXT_PTR(contextHandle);
+    }
+}
+
+EXPORT bool CalcModelPredictionFlatWithContext(
+        ModelCalcerHandle* modelHandle,
+        EvaluationContextHandle* contextHandle,
+        size_t docCount,
+        const float** floatFeatures, size_t floatFeaturesSize,
+        double* result, size_t resultSize) {
+    try {
+        const TFullModel& model = *FULL_MODEL_PTR(modelHandle);
+        EVALUATION_CONTEXT_PTR(contextHandle)->Calc(
+            model,
+            docCount,
+            TArrayRef<double>(result, resultSize),
+            [&] (size_t begin, size_t end, TArrayRef<double> partResult, TModelEvaluationBuffers* buffers, TVector<TConstArrayRef<float>>* featureRefs) {
+                featureRefs->yresize(end - begin);
+                for (size_t i = begin; i < end; ++i) {
+                    (*featureRefs)[i - begin] = TConstArrayRef<float>(floatFeatures[i], floatFeaturesSize);
+                }
+                model.CalcFlat(*featureRefs, 0, model.GetTreeCount(), partResult, buffers);
+            });
+    } catch (...) {
+        Singleton<TErrorMessageHolder>()->Message = CurrentExceptionMessage();
+        return false;
+    }
+    return true;
+}
+
+EXPORT bool CalcModelPredictionFlatTransposedWithContext(
+        ModelCalcerHandle* modelHandle,
+        EvaluationContextHandle* contextHandle,
+        size_t docCount,
+        const float** transposedFeatures, size_t featuresCount,
+        double* result, size_t resultSize) {
+    try {
+        const TFullModel& model = *FULL_MODEL_PTR(modelHandle);
+        CB_ENSURE(featuresCount > 0, "No features provided");
+        EVALUATION_CONTEXT_PTR(contextHandle)->Calc(
+            model,
+            docCount,
+            TArrayRef<double>(result, resultSize),
+            [&] (size_t begin, size_t end, TArrayRef<double> partResult, TModelEvaluationBuffers* buffers, TVector<TConstArrayRef<float>>* featureRefs) {
+                featureRefs->yresize(featuresCount);
+                for (size_t featureIdx = 0; featureIdx < featuresCount; ++featureIdx) {
+                    (*featureRefs)[featureIdx] = TConstArrayRef<float>(transposedFeatures[featureIdx] + begin, end - begin);
+                }
+                model.CalcFlatTransposed(*featureRefs, 0, model.GetTreeCount(), partResult, buffers);
+            });
+    } catch (...) {
+        Singleton<TErrorMessageHolder>()->Message = CurrentExceptionMessage();
+        return false;
+    }
+    return true;
+}
+
 EXPORT int GetStringCatFeatureHash(const char* data, size_t size) {
     return CalcCatFeatureHash(TStringBuf(data, size));
 }
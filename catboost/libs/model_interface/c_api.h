@@ -17,6 +17,7 @@ extern "C" {
 #endif
 
 typedef void ModelCalcerHandle;
+typedef void EvaluationContextHandle;
 
 /**
  * Create empty model handle
@@ -59,6 +60,30 @@ EXPORT bool LoadFullModelFromBuffer(
     const void* binaryBuffer,
     size_t binaryBufferSize);
 
+/**
+ * Load model from memory buffer into given model handle without copying CTR tables.
+ * Buffer must stay alive and unchanged until model handle is deleted or reloaded.
+ * @param calcer
+ * @param binaryBuffer pointer to a memory buffer where model file is mapped
+ * @param binaryBufferSize size of the buffer in bytes
+ * @return false if error occured
+ */
+EXPORT bool LoadFullModelZeroCopy(
+    ModelCalcerHandle* modelHandle,
+    const void* binaryBuffer,
+    size_t binaryBufferSize);
+
+/**
+ * Map model file into memory and load model from it without copying CTR tables.
+ * Mapped pages are shared between processes that load the same model file.
+ * @param calcer
+ * @param filename
+ * @return false if error occured
+ */
+EXPORT bool LoadFullModelFromFileMapped(
+    ModelCalcerHandle* modelHandle,
+    const char* filename);
+
 /**
  * **Use this method only if you really understand what you want.**
  * Calculate raw model predictions on flat feature vectors
@@ -139,6 +164,57 @@ EXPORT bool CalcModelPredictionWithHashedCatFeatures(
     const int** catFeatures, size_t catFeaturesSize,
     double* result, size_t resultSize);
 
+/**
+ * Create evaluation context: thread pool and scratch buffers reused between prediction calls.
+ * Context may be used with any model, but only from one thread at a time.
+ * @param threadCount number of threads evaluating each request, including the calling thread
+ * @return context handle or nullptr if error occured
+ */
+EXPORT EvaluationContextHandle* EvaluationContextCreate(size_t threadCount);
+
+/**
+ * Delete evaluation context
+ * @param contextHandle
+ */
+EXPORT void EvaluationContextDelete(EvaluationContextHandle* contextHandle);
+
+/**
+ * Same as CalcModelPredictionFlat, but objects are split between context threads
+ * and no memory is allocated once context buffers have grown to the request size
+ * @param calcer model handle
+ * @param contextHandle evaluation context handle
+ * @param docCount number of objects
+ * @param floatFeatures array of array of float (first dimension is object index, second if feature index)
+ * @param floatFeaturesSize float values array size
+ * @param result pointer to user allocated results vector
+ * @param resultSize Result size should be equal to modelApproxDimension * docCount
+ * @return false if error occured
+ */
+EXPORT bool CalcModelPredictionFlatWithContext(
+    ModelCalcerHandle* modelHandle,
+    EvaluationContextHandle* contextHandle,
+    size_t docCount,
+    const float** floatFeatures, size_t floatFeaturesSize,
+    double* result, size_t resultSize);
+
+/**
+ * Calculate raw model predictions on transposed flat feature vectors using evaluation context
+ * @param calcer model handle
+ * @param contextHandle evaluation context handle
+ * @param docCount number of objects
+ * @param transposedFeatures array of array of float (first dimension is feature index, second is object index)
+ * @param featuresCount flat features count
+ * @param result pointer to user allocated results vector
+ * @param resultSize Result size should be equal to modelApproxDimension * docCount
+ * @return false if error occured
+ */
+EXPORT bool CalcModelPredictionFlatTransposedWithContext(
+    ModelCalcerHandle* modelHandle,
+    EvaluationContextHandle* contextHandle,
+    size_t docCount,
+    const float** transposedFeatures, size_t featuresCount,
+    double* result, size_t resultSize);
+
 /**
  * Get hash for given string value
  * @param data we don't expect data to be zero terminated, so pass correct size
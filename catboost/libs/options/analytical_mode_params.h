@@ -26,6 +26,10 @@ namespace NCB {
         TVector<EPredictionType> PredictionTypes = {EPredictionType::RawFormulaVal};
         TVector<TString> OutputColumnsIds = {"DocId", "RawFormulaVal"};
         EFstrType FstrType = EFstrType::FeatureImportance;
+        EShapValuesOutputFormat ShapValuesOutputFormat = EShapValuesOutputFormat::Tsv;
+        ui32 ShapValuesTopSize = 0;
+        TString ShapPreparedTreesInputPath;
+        TString ShapPreparedTreesOutputPath;
         TVector<TString> ClassNames;
         int ThreadCount = NSystemInfo::CachedNumberOfCpus();
 
@@ -31,6 +31,7 @@ namespace NCatboostOptions {
         TOption<TOverfittingDetectorOptions> OverfittingDetector;
         TOption<EBoostingType> BoostingType;
         TCpuOnlyOption<bool> ApproxOnFullHistory;
+        TCpuOnlyOption<bool> DevSinglePrecisionDerivatives;
 
         TGpuOnlyOption<ui32> MinFoldSize;
         TGpuOnlyOption<EDataPartitionType> DataPartitionType;
@@ -27,6 +27,16 @@ namespace NCatboostOptions {
                 }
                 break;
             }
+            case EBootstrapType::MVS: {
+                if (TaskType == ETaskType::GPU) {
+                    ythrow TCatBoostException()
+                        << "Error: MVS bootstrap is not supported on GPU";
+                }
+                if (BaggingTemperature.IsSet()) {
+                    ythrow TCatBoostException() << "Error: bagging temperature available for bayesian bootstrap only";
+                }
+                break;
+            }
             default: {
                 Y_ASSERT(type == EBootstrapType::Bernoulli);
                 if (BaggingTemperature.IsSet()) {
@@ -367,6 +367,11 @@ void NCatboostOptions::TCatBoostOptions::Validate() const {
         }
     }
 
+    if (ObliviousTreeOptions->BootstrapConfig->GetBootstrapType() == EBootstrapType::MVS) {
+        CB_ENSURE(BoostingOptions->BoostingType.Get() == EBoostingType::Plain, "Error: MVS bootstrap is supported for plain boosting only");
+        CB_ENSURE(!IsPairwiseScoring(lossFunction), "Error: MVS bootstrap is not supported for pairwise scoring");
+    }
+
     if (GetTaskType() == ETaskType::GPU) {
         if (!IsPairwiseScoring(lossFunction)) {
             CB_ENSURE(ObliviousTreeOptions->Rsm.IsDefault(), "Error: rsm on GPU is supported for pairwise modes only");
@@ -70,6 +70,7 @@ enum class EBootstrapType {
     Poisson,
     Bayesian,
     Bernoulli,
+    MVS,
     No
 };
 
@@ -186,6 +187,11 @@ enum class EFstrType {
     ShapValues
 };
 
+enum class EShapValuesOutputFormat {
+    Tsv,
+    Binary
+};
+
 enum class EObservationsToBootstrap {
     LearnAndTest,
     TestOnly
@@ -217,6 +217,7 @@ void NCatboostOptions::PlainJsonToOptions(
     CopyOption(plainOptions, "learning_rate", &boostingOptionsRef, &seenKeys);
     CopyOption(plainOptions, "fold_len_multiplier", &boostingOptionsRef, &seenKeys);
     CopyOption(plainOptions, "approx_on_full_history", &boostingOptionsRef, &seenKeys);
+    CopyOption(plainOptions, "dev_single_precision_derivatives", &boostingOptionsRef, &seenKeys);
     CopyOption(plainOptions, "fold_permutation_block", &boostingOptionsRef, &seenKeys);
     CopyOption(plainOptions, "min_fold_size", &boostingOptionsRef, &seenKeys);
     CopyOption(plainOptions, "permutation_count", &boostingOptionsRef, &seenKeys);
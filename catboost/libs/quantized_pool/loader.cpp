@@ -11,26 +11,44 @@
 #include <catboost/libs/data_util/exists_checker.h>
 #include <catboost/libs/data_util/path_with_scheme.h>
 #include <catboost/libs/helpers/exception.h>
+#include <catboost/libs/helpers/compression.h>
 #include <catboost/libs/helpers/maybe_owning_array_holder.h>
+#include <catboost/libs/helpers/resource_holder.h>
 #include <catboost/libs/quantization_schema/serialization.h>
 
+#include <util/generic/algorithm.h>
 #include <util/generic/cast.h>
 #include <util/generic/mapfindptr.h>
 #include <util/generic/vector.h>
 #include <util/generic/ylimits.h>
+#include <util/memory/blob.h>
 #include <util/system/madvise.h>
 #include <util/system/types.h>
 
 
 namespace NCB {
 
-    class TCBQuantizedDataLoader final : public IQuantizedFeaturesDatasetLoader {
+    class TCBQuantizedDataLoader : public IQuantizedFeaturesDatasetLoader {
     public:
-        explicit TCBQuantizedDataLoader(TDatasetLoaderPullArgs&& args);
+        explicit TCBQuantizedDataLoader(TDatasetLoaderPullArgs&& args)
+            : TCBQuantizedDataLoader(std::move(args), /*keepFeaturesMapped*/ false, GetLoadParameters())
+        {}
 
         void Do(IQuantizedFeaturesDataVisitor* visitor) override;
 
+    protected:
+        /* if keepFeaturesMapped is true float features are not copied where possible but are referenced
+         * directly from mapped pool file for the whole lifetime of the data provider
+         */
+        TCBQuantizedDataLoader(
+            TDatasetLoaderPullArgs&& args,
+            bool keepFeaturesMapped,
+            const TLoadQuantizedPoolParameters& loadParameters
+        );
+
     private:
+        bool CanBeUsedInPlace(const TVector<TQuantizedPool::TChunkDescription>& chunks) const;
+
         void AddColumn(
             const ui32 featureIndex,
             const ui32 baselineIndex,
@@ -45,6 +63,7 @@ namespace NCB {
 
     private:
         ui32 ObjectCount;
+        bool KeepFeaturesMapped;
         TVector<bool> IsFeatureIgnored;
         TQuantizedPool QuantizedPool;
         TPathWithScheme PairsPath;
@@ -53,9 +72,53 @@ namespace NCB {
         EObjectsOrder ObjectsOrder;
     };
 
-    TCBQuantizedDataLoader::TCBQuantizedDataLoader(TDatasetLoaderPullArgs&& args)
+    /* Out-of-core loading: float features stay in the mapped pool file and pages are read (with
+     * readahead) on demand while training, so pools larger than RAM can be used.
+     * Pool has to be saved with one chunk per feature to be used this way (chunks written by
+     * SaveQuantizedPool are properly aligned), other columns are loaded as usual.
+     */
+    class TCBMappedQuantizedDataLoader final : public TCBQuantizedDataLoader {
+    public:
+        explicit TCBMappedQuantizedDataLoader(TDatasetLoaderPullArgs&& args)
+            : TCBQuantizedDataLoader(
+                std::move(args),
+                /*keepFeaturesMapped*/ true,
+                {/*LockMemory*/ false, /*Precharge*/ false, /*Readahead*/ true}
+            )
+        {}
+    };
+
+    // Same as TCBMappedQuantizedDataLoader but pool file is read into page cache beforehand
+    class TCBPrechargedMappedQuantizedDataLoader final : public TCBQuantizedDataLoader {
+    public:
+        explicit TCBPrechargedMappedQuantizedDataLoader(TDatasetLoaderPullArgs&& args)
+            : TCBQuantizedDataLoader(
+                std::move(args),
+                /*keepFeaturesMapped*/ true,
+                {/*LockMemory*/ false, /*Precharge*/ true, /*Readahead*/ false}
+            )
+        {}
+    };
+
+    namespace {
+        struct TBlobsHolder : public IResourceHolder {
+            TVector<TBlob> Blobs;
+
+        public:
+            explicit TBlobsHolder(TVector<TBlob> blobs)
+                : Blobs(std::move(blobs))
+            {}
+        };
+    }
+
+    TCBQuantizedDataLoader::TCBQuantizedDataLoader(
+        TDatasetLoaderPullArgs&& args,
+        bool keepFeaturesMapped,
+        const TLoadQuantizedPoolParameters& loadParameters
+    )
         : ObjectCount(0) // inited later
-        , QuantizedPool(std::forward<TQuantizedPool>(LoadQuantizedPool(args.PoolPath.Path, GetLoadParameters())))
+        , KeepFeaturesMapped(keepFeaturesMapped)
+        , QuantizedPool(std::forward<TQuantizedPool>(LoadQuantizedPool(args.PoolPath.Path, loadParameters)))
         , PairsPath(args.CommonArgs.PairsFilePath)
         , GroupWeightsPath(args.CommonArgs.GroupWeightsFilePath)
         , ObjectsOrder(args.CommonArgs.ObjectsOrder)
@@ -88,6 +151,33 @@ namespace NCB {
         ProcessIgnoredFeaturesList(allIgnoredFeatures, &DataMetaInfo, &IsFeatureIgnored);
     }
 
+    bool TCBQuantizedDataLoader::CanBeUsedInPlace(
+        const TVector<TQuantizedPool::TChunkDescription>& chunks
+    ) const {
+        if (!KeepFeaturesMapped || (chunks.size() != 1)) {
+            return false;
+        }
+        const auto& descriptor = chunks.front();
+        TConstArrayRef<ui8> quants = *descriptor.Chunk->Quants();
+        if ((descriptor.DocumentOffset != 0) || (quants.size() != ObjectCount)) {
+            return false;
+        }
+        if (reinterpret_cast<uintptr_t>(quants.data()) % alignof(ui64)) {
+            return false;
+        }
+
+        // compressed array storage is ui64-based, so memory must be readable up to ui64 boundary
+        const size_t storageSize = TIndexHelper<ui64>(8).CompressedSize(ObjectCount) * sizeof(ui64);
+        return AnyOf(
+            QuantizedPool.Blobs,
+            [&] (const TBlob& blob) {
+                const char* begin = blob.AsCharPtr();
+                const char* quantsBegin = reinterpret_cast<const char*>(quants.data());
+                return (quantsBegin >= begin) && (quantsBegin + storageSize <= begin + blob.Size());
+            }
+        );
+    }
+
     void TCBQuantizedDataLoader::AddColumn(
         const ui32 flatFeatureIndex,
         const ui32 baselineIndex,
@@ -95,6 +185,17 @@ namespace NCB {
         const ui32 localIndex,
         IQuantizedFeaturesDataVisitor* visitor
     ) const {
+        if ((columnType == EColumn::Num) && CanBeUsedInPlace(QuantizedPool.Chunks[localIndex])) {
+            CB_ENSURE(QuantizedPool.Chunks[localIndex].front().Chunk->BitsPerDocument() == NIdl::EBitsPerDocumentFeature_BPDF_8);
+            visitor->AddFloatFeature(
+                flatFeatureIndex,
+                TMaybeOwningConstArrayHolder<ui8>::CreateNonOwning(
+                    *QuantizedPool.Chunks[localIndex].front().Chunk->Quants()
+                )
+            );
+            return;
+        }
+
         auto onColumn = [&](size_t sizeOfElement, auto&& callbackFunction) {
             constexpr size_t MIN_QUANTS_SIZE_TO_FREE_INDIVIDUALLY = 1 << 20;
 
@@ -225,11 +326,16 @@ namespace NCB {
     }
 
     void TCBQuantizedDataLoader::Do(IQuantizedFeaturesDataVisitor* visitor) {
+        TVector<TIntrusivePtr<IResourceHolder>> resourceHolders;
+        if (KeepFeaturesMapped) {
+            resourceHolders.push_back(MakeIntrusive<TBlobsHolder>(QuantizedPool.Blobs));
+        }
+
         visitor->Start(
             DataMetaInfo,
             ObjectCount,
             ObjectsOrder,
-            {},
+            std::move(resourceHolders),
             QuantizationSchemaFromProto(QuantizedPool.QuantizationSchema)
         );
 
@@ -276,6 +382,18 @@ namespace NCB {
     namespace {
         TExistsCheckerFactory::TRegistrator<TFSExistsChecker> FSQuantizedExistsCheckerReg("quantized");
         TDatasetLoaderFactory::TRegistrator<TCBQuantizedDataLoader> CBQuantizedDataLoaderReg("quantized");
+
+        TExistsCheckerFactory::TRegistrator<TFSExistsChecker> FSMappedQuantizedExistsCheckerReg(
+            "quantized-mmap"
+        );
+        TDatasetLoaderFactory::TRegistrator<TCBMappedQuantizedDataLoader> CBMappedQuantizedDataLoaderReg(
+            "quantized-mmap"
+        );
+        TExistsCheckerFactory::TRegistrator<TFSExistsChecker> FSPrechargedMappedQuantizedExistsCheckerReg(
+            "quantized-mmap-precharged"
+        );
+        TDatasetLoaderFactory::TRegistrator<TCBPrechargedMappedQuantizedDataLoader>
+            CBPrechargedMappedQuantizedDataLoaderReg("quantized-mmap-precharged");
     }
 }
 
@@ -27,6 +27,7 @@
 #include <util/stream/mem.h>
 #include <util/stream/output.h>
 #include <util/system/byteorder.h>
+#include <util/system/madvise.h>
 #include <util/system/unaligned_mem.h>
 
 using NCB::NIdl::TPoolMetainfo;
@@ -119,6 +120,9 @@ static void WriteChunk(
 
     builder->Clear();
 
+    // chunk itself is written with 16-byte alignment, so aligned quants can be used in place
+    // directly from mapped file (see out-of-core loading in loader.cpp)
+    builder->ForceVectorAlignment(chunk.Chunk->Quants()->size(), sizeof(ui8), 16);
     const auto quantsOffset = builder->CreateVector(
         chunk.Chunk->Quants()->data(),
         chunk.Chunk->Quants()->size());
@@ -579,16 +583,23 @@ NCB::TQuantizedPool NCB::LoadQuantizedPool(
     const TLoadQuantizedPoolParameters& params) {
 
     TQuantizedPool pool;
-    pool.Blobs.push_back(params.LockMemory
-        ? TBlob::LockedFromFile(TString(path))
-        : TBlob::FromFile(TString(path)));
-
-    // TODO(yazevnul): optionally precharge pool
+    if (params.LockMemory) {
+        // locking memory faults in all pages anyway
+        pool.Blobs.push_back(TBlob::LockedFromFile(TString(path)));
+    } else if (params.Precharge) {
+        pool.Blobs.push_back(TBlob::PrechargedFromFile(TString(path)));
+    } else {
+        pool.Blobs.push_back(TBlob::FromFile(TString(path)));
+    }
 
     const TConstArrayRef<char> blobView{
         pool.Blobs.back().AsCharPtr(),
         pool.Blobs.back().Size()};
 
+    if (params.Readahead) {
+        MadviseSequentialAccess(blobView.data(), blobView.size());
+    }
+
     ValidatePoolPart(blobView);
     CollectChunks(blobView, pool);
 
@@ -19,6 +19,10 @@ namespace NCB {
     struct TLoadQuantizedPoolParameters {
         bool LockMemory = true;
         bool Precharge = true;
+
+        // Hint kernel to read mapped file ahead aggressively, useful when pool data is not
+        // precharged and is read from disk while training (out-of-core).
+        bool Readahead = false;
     };
 
     // Load quantized pool saved by `SaveQuantizedPool` from file.
@@ -186,17 +186,21 @@ Y_UNIT_TEST_SUITE(LoadDataFromQuantized) {
         NPar::TLocalExecutor localExecutor;
         localExecutor.RunAdditionalThreads(3);
 
-        TDataProviderPtr dataProvider = ReadDataset(
-            readDatasetMainParams.PoolPath,
-            readDatasetMainParams.PairsFilePath, // can be uninited
-            readDatasetMainParams.GroupWeightsFilePath, // can be uninited
-            NCatboostOptions::TDsvPoolFormatParams(),
-            testCase.SrcData.IgnoredFeatures,
-            testCase.SrcData.ObjectsOrder,
-            &localExecutor
-        );
+        for (TStringBuf scheme : {"quantized", "quantized-mmap", "quantized-mmap-precharged"}) {
+            readDatasetMainParams.PoolPath.Scheme = scheme;
+
+            TDataProviderPtr dataProvider = ReadDataset(
+                readDatasetMainParams.PoolPath,
+                readDatasetMainParams.PairsFilePath, // can be uninited
+                readDatasetMainParams.GroupWeightsFilePath, // can be uninited
+                NCatboostOptions::TDsvPoolFormatParams(),
+                testCase.SrcData.IgnoredFeatures,
+                testCase.SrcData.ObjectsOrder,
+                &localExecutor
+            );
 
-        Compare<TQuantizedForCPUObjectsDataProvider>(std::move(dataProvider), testCase.ExpectedData);
+            Compare<TQuantizedForCPUObjectsDataProvider>(std::move(dataProvider), testCase.ExpectedData);
+        }
     }
 
 
@@ -836,6 +840,82 @@ Y_UNIT_TEST_SUITE(LoadDataFromQuantized) {
         expectedData.Target.SetTrivialWeights(srcData.DocumentCount);
 
 
+        testCase.SrcData = std::move(srcData);
+        testCase.ExpectedData = std::move(expectedData);
+
+        Test(testCase);
+    }
+
+    // one chunk per feature, such features are used in place from mapped file by "quantized-mmap" loader
+    Y_UNIT_TEST(ReadDatasetSingleChunkColumns) {
+        TTestCase testCase;
+
+        TSrcData srcData;
+        TExpectedQuantizedData expectedData;
+
+        const ui32 binCount = 7;
+        const ui32 featureCount = 5;
+
+        srcData.DocumentCount = 1001; // not a multiple of ui64 size
+        for (auto featureIdx : xrange(featureCount)) {
+            srcData.LocalIndexToColumnIndex.push_back(featureIdx + 1);
+            srcData.PoolQuantizationSchema.FeatureIndices.push_back(featureIdx);
+            srcData.PoolQuantizationSchema.Borders.push_back({0.1f, 0.2f, 0.3f, 0.4f, 0.5f, 0.6f});
+            srcData.PoolQuantizationSchema.NanModes.push_back(ENanMode::Forbidden);
+        }
+        srcData.LocalIndexToColumnIndex.push_back(0);
+
+        for (auto featureIdx : xrange(featureCount)) {
+            Y_UNUSED(featureIdx);
+            expectedData.Objects.FloatFeatures.push_back(
+                GenerateData<ui8>(
+                    srcData.DocumentCount,
+                    [&](ui32 /*i*/) { return RandomNumber<ui8>(binCount); }
+                )
+            );
+            srcData.FloatFeatures.push_back(
+                TSrcColumn<ui8>{EColumn::Num, {*expectedData.Objects.FloatFeatures.back()}}
+            );
+        }
+
+        TVector<float> target = GenerateData<float>(
+            srcData.DocumentCount,
+            [] (ui32 /*i*/) { return RandomNumber<float>(); }
+        );
+        srcData.Target = TSrcColumn<float>{EColumn::Label, {target}};
+        expectedData.Target.Target = GenerateData<TString>(
+            srcData.DocumentCount,
+            [&] (ui32 i) { return ToString(target[i]); }
+        );
+
+        TDataColumnsMetaInfo dataColumnsMetaInfo;
+        dataColumnsMetaInfo.Columns = {{EColumn::Label, ""}};
+        for (auto featureIdx : xrange(featureCount)) {
+            Y_UNUSED(featureIdx);
+            dataColumnsMetaInfo.Columns.push_back({EColumn::Num, ""});
+        }
+
+        expectedData.MetaInfo = TDataMetaInfo(std::move(dataColumnsMetaInfo), false, false);
+        expectedData.Objects.QuantizedFeaturesInfo = MakeIntrusive<TQuantizedFeaturesInfo>(
+            *expectedData.MetaInfo.FeaturesLayout,
+            TConstArrayRef<ui32>(),
+            NCatboostOptions::TBinarizationOptions(EBorderSelectionType::GreedyLogSum, 6)
+        );
+        for (auto i : xrange(featureCount)) {
+            auto floatFeatureIdx = TFloatFeatureIdx(i);
+            expectedData.Objects.QuantizedFeaturesInfo->SetBorders(
+                floatFeatureIdx,
+                TVector<float>(srcData.PoolQuantizationSchema.Borders[i])
+            );
+            expectedData.Objects.QuantizedFeaturesInfo->SetNanMode(
+                floatFeatureIdx,
+                srcData.PoolQuantizationSchema.NanModes[i]
+            );
+        }
+
+        expectedData.ObjectsGrouping = TObjectsGrouping(srcData.DocumentCount);
+        expectedData.Target.SetTrivialWeights(srcData.DocumentCount);
+
         testCase.SrcData = std::move(srcData);
         testCase.ExpectedData = std::move(expectedData);
 
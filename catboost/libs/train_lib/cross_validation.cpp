@@ -30,6 +30,7 @@
 #include <util/generic/ymath.h>
 
 #include <cmath>
+#include <functional>
 #include <numeric>
 
 
@@ -120,6 +121,9 @@ struct TFoldContext {
 
     TRestorableFastRng64 Rand;
 
+    TTrainingForCPUDataProviders TrainingDataForCpu; // used only in resident training
+    THolder<TLearnContext> LearnContext; // used only in resident training
+
 public:
     TFoldContext(
         size_t foldIdx,
@@ -167,33 +171,13 @@ public:
                     return true;
                 }
 
-                bool calcMetrics = DivisibleOrLastIteration(
+                AppendMetricValues(
+                    metricsAndTimeHistory,
+                    metrics,
+                    skipMetricOnTrain,
                     iteration,
                     globalMaxIteration,
-                    OutputOptions.GetMetricPeriod()
-                );
-
-                const bool calcErrorTrackerMetric = calcMetrics || isErrorTrackerActive;
-                const int errorTrackerMetricIdx = calcErrorTrackerMetric ? 0 : -1;
-
-                MetricValuesOnTrain.resize(iteration + 1);
-                MetricValuesOnTest.resize(iteration + 1);
-
-                for (auto metricIdx : xrange((int)metrics.size())) {
-                    if (!calcMetrics && (metricIdx != errorTrackerMetricIdx)) {
-                        continue;
-                    }
-                    const auto& metric = metrics[metricIdx];
-                    const TString& metricDescription = metric->GetDescription();
-
-                    MetricValuesOnTrain[iteration].push_back(
-                        skipMetricOnTrain[metricIdx] ?
-                        0.0 :
-                        metricsAndTimeHistory.LearnMetricsHistory.back().at(metricDescription));
-
-                    MetricValuesOnTest[iteration].push_back(
-                        metricsAndTimeHistory.TestMetricsHistory.back()[0].at(metricDescription));
-                }
+                    isErrorTrackerActive);
 
                 return (iteration + 1) < upToIteration;
             },
@@ -206,6 +190,100 @@ public:
             /*metricsAndTimeHistory*/nullptr
         );
     }
+
+    // Resident training: learn context is created once and kept in memory between iteration batches
+    void InitLearnContext(
+        const NJson::TJsonValue& trainOptionsJson,
+        const TMaybe<TCustomObjectiveDescriptor>& objectiveDescriptor,
+        const TMaybe<TCustomMetricDescriptor>& evalMetricDescriptor,
+        const TLabelConverter& labelConverter,
+        NPar::TLocalExecutor* localExecutor) {
+
+        TrainingDataForCpu = TrainingData.Cast<TQuantizedForCPUObjectsDataProvider>();
+        LearnContext = CreateLearnContext(
+            trainOptionsJson,
+            OutputOptions,
+            objectiveDescriptor,
+            evalMetricDescriptor,
+            TrainingDataForCpu,
+            labelConverter,
+            /*rand*/ Nothing(),
+            localExecutor);
+        CreateIterationCaches(TrainingDataForCpu, LearnContext.Get());
+    }
+
+    void TrainNextIteration(
+        const TVector<THolder<IMetric>>& metrics,
+        TConstArrayRef<bool> skipMetricOnTrain,
+        size_t globalMaxIteration,
+        bool isErrorTrackerActive) {
+
+        const size_t iteration = LearnContext->LearnProgress.TreeStruct.size();
+        TrainOneIteration(TrainingDataForCpu, LearnContext.Get());
+
+        const bool calcMetrics = DivisibleOrLastIteration(
+            iteration,
+            globalMaxIteration,
+            OutputOptions.GetMetricPeriod()
+        );
+        CalcErrors(
+            TrainingDataForCpu,
+            metrics,
+            calcMetrics,
+            /*calcErrorTrackerMetric*/ calcMetrics || isErrorTrackerActive,
+            LearnContext.Get());
+
+        AppendMetricValues(
+            LearnContext->LearnProgress.MetricsAndTimeHistory,
+            metrics,
+            skipMetricOnTrain,
+            iteration,
+            globalMaxIteration,
+            isErrorTrackerActive);
+    }
+
+    void FinishResidentTraining() {
+        LastUpdateEvalResult.SetRawValuesByMove(LearnContext->LearnProgress.TestApprox[0]);
+        LearnContext.Destroy();
+    }
+
+private:
+    void AppendMetricValues(
+        const TMetricsAndTimeLeftHistory& metricsAndTimeHistory,
+        TConstArrayRef<THolder<IMetric>> metrics,
+        TConstArrayRef<bool> skipMetricOnTrain,
+        size_t iteration,
+        size_t globalMaxIteration,
+        bool isErrorTrackerActive) {
+
+        bool calcMetrics = DivisibleOrLastIteration(
+            iteration,
+            globalMaxIteration,
+            OutputOptions.GetMetricPeriod()
+        );
+
+        const bool calcErrorTrackerMetric = calcMetrics || isErrorTrackerActive;
+        const int errorTrackerMetricIdx = calcErrorTrackerMetric ? 0 : -1;
+
+        MetricValuesOnTrain.resize(iteration + 1);
+        MetricValuesOnTest.resize(iteration + 1);
+
+        for (auto metricIdx : xrange((int)metrics.size())) {
+            if (!calcMetrics && (metricIdx != errorTrackerMetricIdx)) {
+                continue;
+            }
+            const auto& metric = metrics[metricIdx];
+            const TString& metricDescription = metric->GetDescription();
+
+            MetricValuesOnTrain[iteration].push_back(
+                skipMetricOnTrain[metricIdx] ?
+                0.0 :
+                metricsAndTimeHistory.LearnMetricsHistory.back().at(metricDescription));
+
+            MetricValuesOnTest[iteration].push_back(
+                metricsAndTimeHistory.TestMetricsHistory.back()[0].at(metricDescription));
+        }
+    }
 };
 
 
@@ -474,6 +552,46 @@ void CrossValidate(
 
     ui32 globalMaxIteration = catBoostOptions.BoostingOptions->IterationCount;
 
+    /* On CPU fold learn contexts are kept in memory for the whole cross-validation instead of being
+       restored from snapshots for each iterations batch.
+       Folds are trained concurrently on the shared executor if there's at least one thread per fold,
+       nested parallel loops of fold training use the remaining threads.
+       Custom objectives and metrics are called from one fold at a time.
+    */
+    const bool useResidentFolds = (taskType == ETaskType::CPU) && catBoostOptions.SystemOptions->IsSingleHost();
+    const bool trainFoldsConcurrently = useResidentFolds
+        && (catBoostOptions.SystemOptions->NumThreads.Get() >= (int)cvParams.FoldCount)
+        && !objectiveDescriptor
+        && !evalMetricDescriptor;
+
+    const auto forEachFold = [&] (const std::function<void(TFoldContext&)>& func) {
+        if (trainFoldsConcurrently) {
+            localExecutor.ExecRangeWithThrow(
+                [&] (int foldIdx) {
+                    func(foldContexts[foldIdx]);
+                },
+                0,
+                foldContexts.ysize(),
+                NPar::TLocalExecutor::WAIT_COMPLETE);
+        } else {
+            for (auto& foldContext : foldContexts) {
+                func(foldContext);
+            }
+        }
+    };
+
+    if (useResidentFolds) {
+        TSetLoggingSilent silentMode;
+        forEachFold([&] (TFoldContext& foldContext) {
+            foldContext.InitLearnContext(
+                updatedTrainOptionsJson,
+                objectiveDescriptor,
+                evalMetricDescriptor,
+                labelConverter,
+                &localExecutor);
+        });
+    }
+
     TProfileInfo profile(globalMaxIteration);
 
     ui32 iteration = 0;
@@ -488,19 +606,30 @@ void CrossValidate(
             batchStartIteration + cvParams.IterationsBatchSize,
             globalMaxIteration);
 
-        for (auto& foldContext : foldContexts) {
-            foldContext.TrainUpToIteration(
-                updatedTrainOptionsJson,
-                objectiveDescriptor,
-                evalMetricDescriptor,
-                labelConverter,
-                metrics,
-                skipMetricOnTrain,
-                batchEndIteration,
-                globalMaxIteration,
-                errorTracker.IsActive(),
-                modelTrainerHolder.Get(),
-                &localExecutor);
+        if (useResidentFolds) {
+            TSetLoggingSilent silentMode;
+            const bool isErrorTrackerActive = errorTracker.IsActive();
+            forEachFold([&] (TFoldContext& foldContext) {
+                for (auto foldIteration : xrange(batchStartIteration, batchEndIteration)) {
+                    Y_UNUSED(foldIteration);
+                    foldContext.TrainNextIteration(metrics, skipMetricOnTrain, globalMaxIteration, isErrorTrackerActive);
+                }
+            });
+        } else {
+            for (auto& foldContext : foldContexts) {
+                foldContext.TrainUpToIteration(
+                    updatedTrainOptionsJson,
+                    objectiveDescriptor,
+                    evalMetricDescriptor,
+                    labelConverter,
+                    metrics,
+                    skipMetricOnTrain,
+                    batchEndIteration,
+                    globalMaxIteration,
+                    errorTracker.IsActive(),
+                    modelTrainerHolder.Get(),
+                    &localExecutor);
+            }
         }
 
         while (true) {
@@ -584,6 +713,12 @@ void CrossValidate(
         }
     }
 
+    if (useResidentFolds) {
+        for (auto& foldContext : foldContexts) {
+            foldContext.FinishResidentTraining();
+        }
+    }
+
     if (!outputFileOptions.GetRocOutputPath().empty()) {
         CB_ENSURE(
             catBoostOptions.LossFunctionDescription->GetLossFunction() == ELossFunction::Logloss,
@@ -145,7 +145,9 @@ TDataProviderPtr ShuffleLearnDataIfNeeded(const NCatboostOptions::TCatBoostOptio
                                           NPar::TLocalExecutor* localExecutor,
                                           TRestorableFastRng64* rand) {
 
-    if (NeedShuffle(
+    // already shuffled data is not shuffled again - it also keeps data mapped from files in place
+    if ((learnData->ObjectsData->GetOrder() != EObjectsOrder::RandomShuffled) &&
+        NeedShuffle(
             learnData->MetaInfo.FeaturesLayout->GetCatFeatureCount(),
             learnData->ObjectsData->GetObjectCount(),
             catBoostOptions))
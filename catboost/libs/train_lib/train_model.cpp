@@ -126,6 +126,81 @@ static bool HasInvalidValues(const TVector<TVector<TVector<double>>>& leafValues
     return false;
 }
 
+void CreateIterationCaches(const TTrainingForCPUDataProviders& data, TLearnContext* ctx) {
+    const bool isPairwiseScoring = IsPairwiseScoring(ctx->Params.LossFunctionDescription->GetLossFunction());
+    const int defaultCalcStatsObjBlockSize = static_cast<int>(ctx->Params.ObliviousTreeOptions->DevScoreCalcObjBlockSize);
+
+    if (ctx->UseTreeLevelCaching()) {
+        ctx->SmallestSplitSideDocs.Create(ctx->LearnProgress.Folds, isPairwiseScoring, defaultCalcStatsObjBlockSize);
+        ctx->PrevTreeLevelStats.Create(
+            ctx->LearnProgress.Folds,
+            CountNonCtrBuckets(
+                CountSplits(ctx->LearnProgress.FloatFeatures),
+                *data.Learn->ObjectsData->GetQuantizedFeaturesInfo(),
+                ctx->Params.CatFeatureParams->OneHotMaxSize),
+            static_cast<int>(ctx->Params.ObliviousTreeOptions->MaxDepth),
+            ctx->GetTreeLevelCacheSizeLimit()
+        );
+    }
+    ctx->SampledDocs.Create(
+        ctx->LearnProgress.Folds,
+        isPairwiseScoring,
+        defaultCalcStatsObjBlockSize,
+        GetBernoulliSampleRate(ctx->Params.ObliviousTreeOptions->BootstrapConfig),
+        IsSampledBySampleWeights(ctx->Params.ObliviousTreeOptions->BootstrapConfig)
+    ); // TODO(espetrov): create only if sample rate < 1
+}
+
+THolder<TLearnContext> CreateLearnContext(
+    const NJson::TJsonValue& jsonParams,
+    const NCatboostOptions::TOutputFilesOptions& outputOptions,
+    const TMaybe<TCustomObjectiveDescriptor>& objectiveDescriptor,
+    const TMaybe<TCustomMetricDescriptor>& evalMetricDescriptor,
+    const TTrainingForCPUDataProviders& trainingDataForCpu,
+    const TLabelConverter& labelConverter,
+    const TMaybe<TRestorableFastRng64*> rand,
+    NPar::TLocalExecutor* localExecutor
+) {
+    NCatboostOptions::TCatBoostOptions updatedParams(NCatboostOptions::LoadOptions(jsonParams));
+    NCatboostOptions::TOutputFilesOptions updatedOutputOptions = outputOptions;
+
+    SetDataDependentDefaults(
+        trainingDataForCpu.Learn->GetObjectCount(),
+        /*testPoolSize*/ trainingDataForCpu.GetTestSampleCount(),
+        /*hasTestLabels*/ trainingDataForCpu.Test.size() > 0 &&
+            trainingDataForCpu.Test[0]->MetaInfo.HasTarget &&
+            IsConst(GetTarget(trainingDataForCpu.Test[0]->TargetData)),
+        /*hasTestPairs*/ trainingDataForCpu.Test.size() > 0 &&
+            trainingDataForCpu.Test[0]->TargetData.contains(TTargetDataSpecification(ETargetType::GroupPairwiseRanking)),
+        &updatedOutputOptions.UseBestModel,
+        &updatedParams
+    );
+
+    auto ctx = MakeHolder<TLearnContext>(
+        updatedParams,
+        objectiveDescriptor,
+        evalMetricDescriptor,
+        updatedOutputOptions,
+        trainingDataForCpu.Learn->MetaInfo.FeaturesLayout,
+        rand,
+        localExecutor
+    );
+
+    ctx->LearnProgress.ApproxDimension = GetApproxDimension(updatedParams, labelConverter);
+    if (ctx->LearnProgress.ApproxDimension > 1) {
+        ctx->LearnProgress.LabelConverter = labelConverter;
+    }
+
+    const auto& quantizedFeaturesInfo = *trainingDataForCpu.Learn->ObjectsData->GetQuantizedFeaturesInfo();
+
+    ctx->LearnProgress.FloatFeatures = CreateFloatFeatures(quantizedFeaturesInfo);
+    ctx->LearnProgress.CatFeatures = CreateCatFeatures(quantizedFeaturesInfo);
+
+    ctx->InitContext(trainingDataForCpu);
+
+    return ctx;
+}
+
 static void Train(
     const TTrainingForCPUDataProviders& data,
     const TMaybe<TOnEndIterationCallback>& onEndIterationCallback,
@@ -159,7 +234,7 @@ static void Train(
     const bool useBestModel = ctx->OutputOptions.ShrinkModelToBestIteration();
 
     if (ctx->TryLoadProgress() && ctx->Params.SystemOptions->IsMaster()) {
-        MapRestoreApproxFromTreeStruct(ctx);
+        MapRestoreApproxFromTreeStruct(data, ctx);
     }
 
     if (ctx->OutputOptions.GetMetricPeriod() > 1 && errorTracker.IsActive() && hasTest) {
@@ -235,27 +310,8 @@ static void Train(
         &logger
     );
 
-    const bool isPairwiseScoring = IsPairwiseScoring(ctx->Params.LossFunctionDescription->GetLossFunction());
-    const int defaultCalcStatsObjBlockSize = static_cast<int>(ctx->Params.ObliviousTreeOptions->DevScoreCalcObjBlockSize);
-
     if (continueTraining) {
-        if (ctx->UseTreeLevelCaching()) {
-            ctx->SmallestSplitSideDocs.Create(ctx->LearnProgress.Folds, isPairwiseScoring, defaultCalcStatsObjBlockSize);
-            ctx->PrevTreeLevelStats.Create(
-                ctx->LearnProgress.Folds,
-                CountNonCtrBuckets(
-                    CountSplits(ctx->LearnProgress.FloatFeatures),
-                    *data.Learn->ObjectsData->GetQuantizedFeaturesInfo(),
-                    ctx->Params.CatFeatureParams->OneHotMaxSize),
-                static_cast<int>(ctx->Params.ObliviousTreeOptions->MaxDepth)
-            );
-        }
-        ctx->SampledDocs.Create(
-            ctx->LearnProgress.Folds,
-            isPairwiseScoring,
-            defaultCalcStatsObjBlockSize,
-            GetBernoulliSampleRate(ctx->Params.ObliviousTreeOptions->BootstrapConfig)
-        ); // TODO(espetrov): create only if sample rate < 1
+        CreateIterationCaches(data, ctx);
     }
 
     THPTimer timer;
@@ -401,61 +457,26 @@ namespace {
                 }
             }
 
-            NCatboostOptions::TCatBoostOptions updatedParams(NCatboostOptions::LoadOptions(jsonParams));
-            NCatboostOptions::TOutputFilesOptions updatedOutputOptions = outputOptions;
-
-            SetDataDependentDefaults(
-                trainingDataForCpu.Learn->GetObjectCount(),
-                /*testPoolSize*/ trainingDataForCpu.GetTestSampleCount(),
-                /*hasTestLabels*/ trainingDataForCpu.Test.size() > 0 &&
-                    trainingDataForCpu.Test[0]->MetaInfo.HasTarget &&
-                    IsConst(GetTarget(trainingDataForCpu.Test[0]->TargetData)),
-                /*hasTestPairs*/ trainingDataForCpu.Test.size() > 0 &&
-                    trainingDataForCpu.Test[0]->TargetData.contains(TTargetDataSpecification(ETargetType::GroupPairwiseRanking)),
-                &updatedOutputOptions.UseBestModel,
-                &updatedParams
-            );
-
-            TLearnContext ctx(
-                updatedParams,
+            THolder<TLearnContext> ctxHolder = CreateLearnContext(
+                jsonParams,
+                outputOptions,
                 objectiveDescriptor,
                 evalMetricDescriptor,
-                updatedOutputOptions,
-                trainingDataForCpu.Learn->MetaInfo.FeaturesLayout,
+                trainingDataForCpu,
+                labelConverter,
                 rand,
                 localExecutor
             );
-
-            ctx.LearnProgress.ApproxDimension = GetApproxDimension(updatedParams, labelConverter);
-            if (ctx.LearnProgress.ApproxDimension > 1) {
-                ctx.LearnProgress.LabelConverter = labelConverter;
-            }
-
-            TVector<ELossFunction> metrics;
-            if (ctx.Params.MetricOptions->EvalMetric.IsSet()) {
-                metrics.push_back(ctx.Params.MetricOptions->EvalMetric->GetLossFunction());
-            }
-            metrics.push_back(ctx.Params.LossFunctionDescription->GetLossFunction());
-            for (const auto& metric : ctx.Params.MetricOptions->CustomMetrics.Get()) {
-                metrics.push_back(metric.GetLossFunction());
-            }
+            TLearnContext& ctx = *ctxHolder;
 
             ctx.OutputMeta();
 
-            const auto& quantizedFeaturesInfo = *trainingDataForCpu.Learn->ObjectsData->GetQuantizedFeaturesInfo();
-
-            ctx.LearnProgress.FloatFeatures = CreateFloatFeatures(quantizedFeaturesInfo);
-            ctx.LearnProgress.CatFeatures = CreateCatFeatures(quantizedFeaturesInfo);
-
-            ctx.InitContext(trainingDataForCpu);
-
             DumpMemUsage("Before start train");
 
             const auto& systemOptions = ctx.Params.SystemOptions;
             if (!systemOptions->IsSingleHost()) { // send target, weights, baseline (if present), binarized features to workers and ask them to create plain folds
                 InitializeMaster(&ctx);
                 CB_ENSURE(IsPlainMode(ctx.Params.BoostingOptions->BoostingType), "Distributed training requires plain boosting");
-                CB_ENSURE(!ctx.Layout->GetCatFeatureCount(), "Distributed training requires all numeric data");
                 MapBuildPlainFold(trainingDataForCpu.Learn, &ctx);
             }
             TVector<TVector<double>> oneRawValues(ctx.LearnProgress.ApproxDimension);
@@ -14,6 +14,7 @@
 #include <library/object_factory/object_factory.h>
 
 #include <util/generic/maybe.h>
+#include <util/generic/ptr.h>
 #include <util/generic/string.h>
 
 #include <functional>
@@ -66,4 +67,18 @@ void TrainModel(
 /// Used by cross validation, hence one test dataset.
 void TrainOneIteration(const NCB::TTrainingForCPUDataProviders& data, TLearnContext* ctx);
 
+/// Creates CPU learn context with initialized folds, TrainOneIteration can be called on it
+/// after CreateIterationCaches.
+THolder<TLearnContext> CreateLearnContext(
+    const NJson::TJsonValue& jsonParams,
+    const NCatboostOptions::TOutputFilesOptions& outputOptions,
+    const TMaybe<TCustomObjectiveDescriptor>& objectiveDescriptor,
+    const TMaybe<TCustomMetricDescriptor>& evalMetricDescriptor,
+    const NCB::TTrainingForCPUDataProviders& trainingDataForCpu,
+    const TLabelConverter& labelConverter,
+    const TMaybe<TRestorableFastRng64*> rand,
+    NPar::TLocalExecutor* localExecutor);
+
+void CreateIterationCaches(const NCB::TTrainingForCPUDataProviders& data, TLearnContext* ctx);
+
 using TTrainerFactory = NObjectFactory::TParametrizedObjectFactory<IModelTrainer, ETaskType>;
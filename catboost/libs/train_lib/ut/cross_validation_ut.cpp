@@ -0,0 +1,132 @@
+#include <catboost/libs/algo/custom_objective_descriptor.h>
+#include <catboost/libs/algo/ut/lib/random_data.h>
+#include <catboost/libs/train_lib/cross_validation.h>
+
+#include <library/unittest/registar.h>
+
+#include <util/folder/tempdir.h>
+#include <util/generic/maybe.h>
+#include <util/generic/xrange.h>
+
+
+using namespace NCB;
+using namespace NCB::NAlgoUT;
+
+
+static void CalcRmseDersRange(
+    int count,
+    const double* approxes,
+    const float* targets,
+    const float* weights,
+    TDers* ders,
+    void* /*customData*/
+) {
+    for (int i = 0; i < count; ++i) {
+        const double weight = weights ? weights[i] : 1.0;
+        ders[i].Der1 = weight * (targets[i] - approxes[i]);
+        ders[i].Der2 = -weight;
+        ders[i].Der3 = 0.0;
+    }
+}
+
+static TVector<TCVResult> CrossValidateRandomPool(
+    NJson::TJsonValue params,
+    ui32 iterationCount,
+    ui32 iterationsBatchSize,
+    const TMaybe<TCustomObjectiveDescriptor>& objectiveDescriptor = Nothing()
+) {
+    TTempDir trainDir;
+
+    params.InsertValue("iterations", iterationCount);
+    params.InsertValue("random_seed", 1);
+    params.InsertValue("logging_level", "Silent");
+    params.InsertValue("allow_writing_files", false);
+    params.InsertValue("train_dir", trainDir.Name());
+
+    TCrossValidationParams cvParams;
+    cvParams.FoldCount = 3;
+    cvParams.IterationsBatchSize = iterationsBatchSize;
+
+    TRandomDataSpec dataSpec;
+    dataSpec.ObjectCount = 300;
+    dataSpec.DenseFeatureCount = 3;
+    dataSpec.TargetNoiseShare = 1.0f;
+    dataSpec.Seed = 20190308;
+
+    TVector<TCVResult> results;
+    CrossValidate(params, objectiveDescriptor, Nothing(), CreateRandomDataProvider(dataSpec), cvParams, &results);
+    return results;
+}
+
+static void CheckEqualResults(const TVector<TCVResult>& lhsResults, const TVector<TCVResult>& rhsResults, ui32 iterationCount) {
+    UNIT_ASSERT(!lhsResults.empty());
+    UNIT_ASSERT_VALUES_EQUAL(lhsResults.size(), rhsResults.size());
+    for (auto metricIdx : xrange(lhsResults.size())) {
+        const auto& lhs = lhsResults[metricIdx];
+        const auto& rhs = rhsResults[metricIdx];
+        UNIT_ASSERT_VALUES_EQUAL(lhs.Metric, rhs.Metric);
+        UNIT_ASSERT_VALUES_EQUAL(lhs.AverageTest.size(), iterationCount);
+        UNIT_ASSERT_VALUES_EQUAL(rhs.AverageTest.size(), iterationCount);
+        for (auto iteration : xrange(iterationCount)) {
+            UNIT_ASSERT_DOUBLES_EQUAL(lhs.AverageTrain[iteration], rhs.AverageTrain[iteration], 1e-9);
+            UNIT_ASSERT_DOUBLES_EQUAL(lhs.AverageTest[iteration], rhs.AverageTest[iteration], 1e-9);
+            UNIT_ASSERT_DOUBLES_EQUAL(lhs.StdDevTest[iteration], rhs.StdDevTest[iteration], 1e-9);
+        }
+    }
+}
+
+Y_UNIT_TEST_SUITE(CrossValidationTests) {
+    Y_UNIT_TEST(ResultsDoNotDependOnIterationsBatchSize) {
+        const ui32 iterationCount = 20;
+
+        NJson::TJsonValue params;
+        params.InsertValue("thread_count", 4);
+
+        CheckEqualResults(
+            CrossValidateRandomPool(params, iterationCount, /*iterationsBatchSize*/ 1),
+            CrossValidateRandomPool(params, iterationCount, /*iterationsBatchSize*/ 100),
+            iterationCount
+        );
+    }
+
+    Y_UNIT_TEST(ResultsDoNotDependOnThreadCount) {
+        const ui32 iterationCount = 20;
+
+        // 4 threads for 3 folds train folds concurrently, 1 thread trains them one by one
+        NJson::TJsonValue concurrentParams;
+        concurrentParams.InsertValue("thread_count", 4);
+        NJson::TJsonValue sequentialParams;
+        sequentialParams.InsertValue("thread_count", 1);
+
+        for (ui32 iterationsBatchSize : {1, 7, 100}) {
+            CheckEqualResults(
+                CrossValidateRandomPool(concurrentParams, iterationCount, iterationsBatchSize),
+                CrossValidateRandomPool(sequentialParams, iterationCount, iterationsBatchSize),
+                iterationCount
+            );
+        }
+    }
+
+    Y_UNIT_TEST(ResultsWithCustomObjective) {
+        const ui32 iterationCount = 20;
+
+        TCustomObjectiveDescriptor objectiveDescriptor;
+        objectiveDescriptor.CalcDersRange = &CalcRmseDersRange;
+
+        // custom objective makes folds train one by one even if there are enough threads
+        TVector<TCVResult> results[2];
+        const int threadCount[2] = {4, 1};
+        for (auto i : xrange(2)) {
+            NJson::TJsonValue params;
+            params.InsertValue("thread_count", threadCount[i]);
+            params.InsertValue("loss_function", "Custom");
+            params.InsertValue("eval_metric", "RMSE");
+            results[i] = CrossValidateRandomPool(params, iterationCount, /*iterationsBatchSize*/ 7, objectiveDescriptor);
+        }
+        CheckEqualResults(results[0], results[1], iterationCount);
+        for (const auto& result : results[0]) {
+            UNIT_ASSERT_VALUES_EQUAL(result.Metric, "RMSE");
+            UNIT_ASSERT(result.AverageTest.back() < result.AverageTest.front());
+        }
+    }
+}
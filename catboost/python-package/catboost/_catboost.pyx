@@ -624,6 +624,17 @@ cdef extern from "catboost/libs/algo/custom_objective_descriptor.h":
             void* customData
         ) except * with gil
 
+        void (*CalcDersMultiRange)(
+            int count,
+            int approxDimension,
+            const double* approxes,
+            const float* targets,
+            const float* weights,
+            double* ders,
+            double* der2s,
+            void* customData
+        ) except * with gil
+
 cdef extern from "catboost/libs/options/cross_validation_params.h":
     cdef cppclass TCrossValidationParams:
         ui32 FoldCount
@@ -1039,11 +1050,42 @@ cdef TCustomMetricDescriptor _BuildCustomMetricDescriptor(object metricObject):
     descriptor.GetFinalErrorFunc = &_MetricGetFinalError
     return descriptor
 
+cdef void _ObjectiveCalcDersMultiRange(
+    int count,
+    int approxDimension,
+    const double* approxes,
+    const float* targets,
+    const float* weights,
+    double* ders,
+    double* der2s,
+    void* customData
+) except * with gil:
+    cdef objectiveObject = <object>(customData)
+    cdef int der2Size = approxDimension * (approxDimension + 1) // 2
+
+    approx = np.asarray(<double[:approxDimension, :count]><double*>approxes)
+    target = np.asarray(<float[:count]><float*>targets)
+
+    if weights:
+        weight = np.asarray(<float[:count]><float*>weights)
+    else:
+        weight = None
+
+    ders_matrix, second_ders = objectiveObject.calc_ders_multi_range(approx, target, weight)
+    np.asarray(<double[:count, :approxDimension]>ders)[:] = ders_matrix
+
+    if der2s:
+        # upper triangle of each hessian in row order, as in THessianInfo
+        rows, columns = np.triu_indices(approxDimension)
+        np.asarray(<double[:count, :der2Size]>der2s)[:] = np.asarray(second_ders, dtype=np.float64)[:, rows, columns]
+
 cdef TCustomObjectiveDescriptor _BuildCustomObjectiveDescriptor(object objectiveObject):
     cdef TCustomObjectiveDescriptor descriptor
     descriptor.CustomData = <void*>objectiveObject
     descriptor.CalcDersRange = &_ObjectiveCalcDersRange
     descriptor.CalcDersMulti = &_ObjectiveCalcDersMulti
+    if hasattr(objectiveObject, 'calc_ders_multi_range'):
+        descriptor.CalcDersMultiRange = &_ObjectiveCalcDersMultiRange
     return descriptor
 
 cdef class PyPredictionType:
@@ -1443,6 +1485,58 @@ cdef get_cat_factor_bytes_representation(
         )
 
 
+# numpy arrays of these kinds are converted to float32 by numpy without per-element python calls
+cdef _np_numeric_kinds = 'biuf'
+
+# for these kinds get_id_object_bytes_string_representation does not fail
+# and depends only on the value, so it is enough to convert unique values
+cdef _np_cat_feature_by_unique_values_kinds = 'iuSU'
+
+# pandas keeps string columns with object dtype, such columns are checked to contain strings only
+cdef _pd_cat_feature_by_unique_values_inferred_types = ('string', 'unicode', 'bytes')
+
+
+cdef bool_t _can_add_cat_feature_by_unique_values(np.ndarray column_values):
+    if column_values.dtype.kind in _np_cat_feature_by_unique_values_kinds:
+        return True
+    return (
+        (column_values.dtype.kind == 'O') and
+        (pd.api.types.infer_dtype(column_values, skipna=False) in _pd_cat_feature_by_unique_values_inferred_types)
+    )
+
+
+cdef _add_cat_feature_by_unique_values(
+    ui32 flat_feature_idx,
+    np.ndarray column_values,
+    IRawFeaturesOrderDataVisitor* builder_visitor
+):
+    cdef ui32 doc_count = len(column_values)
+    cdef ui32 doc_idx
+    cdef size_t unique_idx
+    cdef const np.int64_t [:] unique_value_indices
+
+    cdef TString factor_string
+    cdef TVector[TString] unique_factor_strings
+    cdef TVector[TStringBuf] cat_factor_data
+
+    unique_values, inverse_indices = np.unique(column_values, return_inverse=True)
+    unique_value_indices = inverse_indices.astype(np.int64)
+
+    unique_factor_strings.reserve(len(unique_values))
+    for unique_idx in range(len(unique_values)):
+        get_id_object_bytes_string_representation(unique_values[unique_idx], &factor_string)
+        unique_factor_strings.push_back(factor_string)
+
+    cat_factor_data.resize(doc_count)
+    for doc_idx in range(doc_count):
+        unique_idx = unique_value_indices[doc_idx]
+        cat_factor_data[doc_idx] = TStringBuf(
+            unique_factor_strings[unique_idx].data(),
+            unique_factor_strings[unique_idx].size()
+        )
+    builder_visitor[0].AddCatFeature(flat_feature_idx, <TConstArrayRef[TStringBuf]>cat_factor_data)
+
+
 # returns new data holders array
 cdef object _set_features_order_data_pd_data_frame(
     data_frame,
@@ -1468,7 +1562,12 @@ cdef object _set_features_order_data_pd_data_frame(
     new_data_holders = []
     for flat_feature_idx, (column_name, column_data) in enumerate(data_frame.iteritems()):
         column_values = column_data.values
-        if is_cat_feature_mask[flat_feature_idx]:
+        if (is_cat_feature_mask[flat_feature_idx] and
+              isinstance(column_values, np.ndarray) and
+              _can_add_cat_feature_by_unique_values(column_values)
+            ):
+            _add_cat_feature_by_unique_values(flat_feature_idx, column_values, builder_visitor)
+        elif is_cat_feature_mask[flat_feature_idx]:
             cat_factor_data.clear()
             for doc_idx in range(doc_count):
                 get_cat_factor_bytes_representation(
@@ -1479,10 +1578,14 @@ cdef object _set_features_order_data_pd_data_frame(
                 )
                 cat_factor_data.push_back(factor_string)
             builder_visitor[0].AddCatFeature(flat_feature_idx, <TConstArrayRef[TString]>cat_factor_data)
-        elif ((column_values.dtype == np.float32) and
-              column_values.flags.aligned and
-              column_values.flags.c_contiguous
+        elif (isinstance(column_values, np.ndarray) and
+              column_values.dtype.kind in _np_numeric_kinds
             ):
+            if not ((column_values.dtype == np.float32) and
+                    column_values.flags.aligned and
+                    column_values.flags.c_contiguous
+                ):
+                column_values = np.ascontiguousarray(column_values, dtype=np.float32)
 
             new_data_holders.append(column_values)
             column_values.setflags(write=0)
@@ -1529,15 +1632,28 @@ cdef _set_data_np(
     cdef ui32 cat_feature_idx
 
     cdef ui32 dst_feature_idx
+
+    # float features go first, so whole rows of C-ordered data can be passed at once
+    cdef bool_t add_all_float_features = (
+        (num_feature_count > 0) and (num_feature_values.strides[1] == sizeof(float))
+    )
+
     for doc_idx in range(doc_count):
         dst_feature_idx = <ui32>0
-        for num_feature_idx in range(num_feature_count):
-            builder_visitor[0].AddFloatFeature(
+        if add_all_float_features:
+            builder_visitor[0].AddAllFloatFeatures(
                 doc_idx,
-                dst_feature_idx,
-                num_feature_values[doc_idx, num_feature_idx]
+                TConstArrayRef[float](&num_feature_values[doc_idx, 0], num_feature_count)
             )
-            dst_feature_idx += 1
+            dst_feature_idx = num_feature_count
+        else:
+            for num_feature_idx in range(num_feature_count):
+                builder_visitor[0].AddFloatFeature(
+                    doc_idx,
+                    dst_feature_idx,
+                    num_feature_values[doc_idx, num_feature_idx]
+                )
+                dst_feature_idx += 1
         for cat_feature_idx in range(cat_feature_count):
             builder_visitor[0].AddCatFeature(
                 doc_idx,
@@ -1758,6 +1758,10 @@ class CatBoostClassifier(CatBoost):
         problem to solve. If string, then the name of a supported metric,
         optionally suffixed with parameter description.
         If object, it shall provide methods 'calc_ders_range' or 'calc_ders_multi'.
+        Multi-dimensional objects may also provide 'calc_ders_multi_range(approxes, targets, weights)'
+        which gets approxes as numpy array of shape (approx_dimension, object_count) and returns
+        derivatives of shape (object_count, approx_dimension) and second derivatives of shape
+        (object_count, approx_dimension, approx_dimension) for a block of objects at once.
     border_count : int, [default=32]
         The number of partitions for Num features. Used in the preliminary calculation.
         range: (0,+inf]
@@ -1956,12 +1960,14 @@ class CatBoostClassifier(CatBoost):
         String format is: '0' for 1 device or '0:1:3' for multiple devices or '0-3' for range of devices.
         List format is : [0] for 1 device or [0,1,3] for multiple devices.
 
-    bootstrap_type : string, Bayesian, Bernoulli, Poisson.
+    bootstrap_type : string, Bayesian, Bernoulli, MVS, Poisson.
         Default bootstrap is Bayesian.
         Poisson bootstrap is supported only on GPU.
+        MVS bootstrap samples objects with probabilities proportional to their gradients,
+        it is supported only on CPU for plain boosting.
 
     subsample : float, [default=None]
-        Sample rate for bagging. This parameter can be used Poisson or Bernoully bootstrap types.
+        Sample rate for bagging. This parameter can be used Poisson, Bernoully or MVS bootstrap types.
 
     dev_score_calc_obj_block_size: int, [default=5000000]
         CPU only. Size of block of samples in score calculation. Should be > 0
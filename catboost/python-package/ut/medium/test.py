@@ -1420,6 +1420,43 @@ def test_custom_objective(task_type):
         assert abs(p1 - p2) < EPS
 
 
+@fails_on_gpu(how='cuda/train_lib/train.cpp:283: Error: loss function is not supported for GPU learning Custom')
+def test_custom_multi_objective_range(task_type):
+    class SoftmaxObjective(object):
+        def calc_ders_multi(self, approxes, target, weight):
+            approxes = np.array(approxes)
+            p = np.exp(approxes - approxes.max())
+            p /= p.sum()
+            der1 = -p
+            der1[int(target)] += 1
+            der2 = np.outer(p, p) - np.diag(p)
+            return list(der1 * weight), list(der2 * weight)
+
+    class SoftmaxRangeObjective(SoftmaxObjective):
+        def calc_ders_multi_range(self, approxes, targets, weights):
+            assert approxes.shape[1] == len(targets)
+            p = np.exp(approxes - approxes.max(axis=0)).T
+            p /= p.sum(axis=1, keepdims=True)
+            der1 = -p
+            der1[np.arange(len(targets)), targets.astype(int)] += 1
+            der2 = p[:, :, np.newaxis] * p[:, np.newaxis, :] - p[:, :, np.newaxis] * np.eye(p.shape[1])
+            if weights is not None:
+                der1 *= weights[:, np.newaxis]
+                der2 *= weights[:, np.newaxis, np.newaxis]
+            return der1, der2
+
+    train_pool = Pool(CLOUDNESS_TRAIN_FILE, column_description=CLOUDNESS_CD_FILE)
+    predictions = []
+    for objective in [SoftmaxObjective(), SoftmaxRangeObjective()]:
+        model = CatBoost({'loss_function': objective, 'eval_metric': 'MultiClass', 'iterations': 5,
+                          'leaf_estimation_method': 'Newton', 'thread_count': 4,
+                          'task_type': task_type, 'devices': '0'})
+        model.fit(train_pool)
+        predictions.append(model.predict(train_pool, prediction_type='RawFormulaVal'))
+
+    assert np.allclose(predictions[0], predictions[1], atol=EPS)
+
+
 def test_pool_after_fit(task_type):
     pool1 = Pool(TRAIN_FILE, column_description=CD_FILE)
     pool2 = Pool(TRAIN_FILE, column_description=CD_FILE)
@@ -2550,6 +2587,86 @@ def test_loading_pool_with_lists():
     assert _check_shape(Pool([['abc', 2], ['1', 2]], [1, 3], cat_features=[0]), object_count=2, features_count=2)
 
 
+def _check_same_quantized_pool(pool, expected_pool):
+    assert pool == expected_pool
+
+    # data is quantized when the model is trained, so same models mean same quantized pools
+    params = {'iterations': 5, 'random_seed': 0, 'thread_count': 4, 'logging_level': 'Silent'}
+    model = CatBoostRegressor(**params)
+    model.fit(pool)
+    expected_model = CatBoostRegressor(**params)
+    expected_model.fit(expected_pool)
+    assert np.array_equal(model.predict(pool), expected_model.predict(expected_pool))
+
+
+def _strided_copy(matrix):
+    # same values, but each row is not contiguous, so Pool constructor passes them one by one
+    strided = np.zeros((matrix.shape[0], 2 * matrix.shape[1]), dtype=matrix.dtype)
+    strided[:, ::2] = matrix
+    return strided[:, ::2]
+
+
+def test_pool_from_c_ordered_float32_matrix():
+    prng = np.random.RandomState(seed=20190701)
+    label = prng.randint(0, 2, size=100)
+    num_feature_data = np.ascontiguousarray(prng.random_sample((100, 5)).astype(np.float32))
+    assert num_feature_data.flags.c_contiguous and not num_feature_data.flags.f_contiguous
+
+    _check_same_quantized_pool(
+        Pool(num_feature_data, label),
+        Pool(_strided_copy(num_feature_data), label)
+    )
+
+    cat_feature_data = np.array(
+        [[str(value).encode() for value in row] for row in prng.randint(0, 10, size=(100, 2))],
+        dtype=object
+    )
+    _check_same_quantized_pool(
+        Pool(FeaturesData(num_feature_data=num_feature_data, cat_feature_data=cat_feature_data), label),
+        Pool(FeaturesData(num_feature_data=_strided_copy(num_feature_data), cat_feature_data=cat_feature_data), label)
+    )
+
+
+def _object_columns_copy(data_frame):
+    # same values in columns of object dtype, so Pool constructor converts them one by one
+    return DataFrame({column_name: data_frame[column_name].astype(object) for column_name in data_frame.columns},
+                     columns=data_frame.columns)
+
+
+@pytest.mark.parametrize('dtype', [np.int8, np.int64, np.uint8, np.uint32, np.bool_, np.float32, np.float64])
+def test_pool_from_numeric_data_frame_columns(dtype):
+    prng = np.random.RandomState(seed=20190702)
+    label = prng.randint(0, 2, size=100)
+    data_frame = DataFrame({
+        'a': (prng.random_sample(100) * 100).astype(dtype),
+        'b': (prng.random_sample(100) * 10).astype(dtype),
+        'c': prng.random_sample(100).astype(np.float32)
+    }, columns=['a', 'b', 'c'])
+    assert data_frame['a'].dtype == dtype
+
+    _check_same_quantized_pool(
+        Pool(data_frame, label),
+        Pool(_object_columns_copy(data_frame), label)
+    )
+
+
+@pytest.mark.parametrize('dtype', [np.int32, np.int64, np.uint64, np.bytes_, np.unicode_])
+def test_pool_from_cat_data_frame_columns(dtype):
+    prng = np.random.RandomState(seed=20190703)
+    label = prng.randint(0, 2, size=100)
+    data_frame = DataFrame({
+        'num': prng.random_sample(100).astype(np.float32),
+        'cat0': prng.randint(0, 10, size=100).astype(dtype),
+        'cat1': prng.randint(0, 1000, size=100).astype(dtype)
+    }, columns=['num', 'cat0', 'cat1'])
+
+    # string columns have object dtype in pandas, so build the expected pool from lists
+    _check_same_quantized_pool(
+        Pool(data_frame, label, cat_features=[1, 2]),
+        Pool(data_frame.values.tolist(), label, cat_features=[1, 2], feature_names=list(data_frame.columns))
+    )
+
+
 def test_pairs_generation(task_type):
     model = CatBoost({"loss_function": "PairLogit", "iterations": 2, "task_type": task_type})
     pool = Pool(QUERYWISE_TRAIN_FILE, column_description=QUERYWISE_CD_FILE)